@@ -100,7 +100,7 @@ int main(int argc, char** argv) {
     surface.numVertices = 4;
     surface.numIndices = 6;
     surface.vertices = new Vector3[surface.numVertices];
-    surface.indices = new unsigned short[surface.numIndices];
+    surface.indices = new unsigned int[surface.numIndices];
     surface.vertices[0] = Vector3(-1.0f, -1.0f, 0.0f); surface.vertices[1] = Vector3(-1.0f, 1.0f, 0.0f); surface.vertices[2] = Vector3(1.0f, 1.0f, 0.0f); surface.vertices[3] = Vector3(1.0f, -1.0f, 0.0f);
     surface.indices[0] = 0; surface.indices[1] = 2; surface.indices[2] = 1; surface.indices[3] = 0; surface.indices[4] = 3; surface.indices[5] = 2;
     fullscreenQuadMesh.AddSurface(&surface);
@@ -44,7 +44,7 @@ int main(int argc, char** argv) {
     surface.numIndices = 6;
     surface.vertices = new Vector3[surface.numVertices];
     surface.texCoords = new Vector2[surface.numTexCoords];
-    surface.indices = new unsigned short[surface.numIndices];
+    surface.indices = new unsigned int[surface.numIndices];
 
     surface.vertices[0] = Vector3(-1.2f, -1.5f, 1.0f); surface.vertices[1] = Vector3(-1.2f, 1.5f, 1.0f); surface.vertices[2] = Vector3(1.2f, 1.5f, 1.0f); surface.vertices[3] = Vector3(1.2f, -1.5f, 1.0f);
     surface.texCoords[0] = Vector2(0.0f, 0.0f); surface.texCoords[1] = Vector2(0.0f, 1.0f); surface.texCoords[2] = Vector2(1.0f, 1.0f); surface.texCoords[3] = Vector2(1.0f, 0.0f);
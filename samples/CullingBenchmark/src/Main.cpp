@@ -0,0 +1,108 @@
+#include <math/Plane.h>
+#include <math/Sphere.h>
+#include <math/Vector3.h>
+
+#include <render/Renderer_Common.h>
+using namespace Sketch3D;
+
+#include <chrono>
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+using namespace std;
+
+#if PLATFORM == PLATFORM_WIN32
+#include <Windows.h>
+#endif
+
+const int NUM_ITERATIONS = 20;
+
+static FrustumPlanes_t CreateFrustum() {
+    // Camera at the origin looking down -z with a 90 degrees field of view
+    FrustumPlanes_t frustumPlanes;
+    frustumPlanes.nearPlane = Plane(0.0f, 0.0f, -1.0f, -1.0f);
+    frustumPlanes.farPlane = Plane(0.0f, 0.0f, 1.0f, 1000.0f);
+    frustumPlanes.leftPlane = Plane(0.707107f, 0.0f, -0.707107f, 0.0f);
+    frustumPlanes.rightPlane = Plane(-0.707107f, 0.0f, -0.707107f, 0.0f);
+    frustumPlanes.bottomPlane = Plane(0.0f, 0.707107f, -0.707107f, 0.0f);
+    frustumPlanes.topPlane = Plane(0.0f, -0.707107f, -0.707107f, 0.0f);
+    return frustumPlanes;
+}
+
+static float RandomFloat(float minValue, float maxValue) {
+    return minValue + (maxValue - minValue) * (rand() / (float)RAND_MAX);
+}
+
+static void RunBenchmark(const FrustumPlanes_t& frustumPlanes, size_t numSpheres) {
+    BoundingSpheres_t boundingSpheres;
+    vector<Sphere> spheres;
+    spheres.reserve(numSpheres);
+
+    srand(1234);
+    for (size_t i = 0; i < numSpheres; i++) {
+        Vector3 center(RandomFloat(-1000.0f, 1000.0f), RandomFloat(-1000.0f, 1000.0f), RandomFloat(-1000.0f, 10.0f));
+        float radius = RandomFloat(0.5f, 5.0f);
+
+        boundingSpheres.Add(center, radius);
+        spheres.push_back(Sphere(center, radius));
+    }
+
+    // One sphere at a time, as the scene tree traversal used to do it
+    size_t numVisibleScalar = 0;
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < NUM_ITERATIONS; i++) {
+        numVisibleScalar = 0;
+        for (size_t j = 0; j < numSpheres; j++) {
+            if (!frustumPlanes.IsSphereOutside(spheres[j])) {
+                numVisibleScalar++;
+            }
+        }
+    }
+    chrono::duration<double> scalarTime = chrono::high_resolution_clock::now() - start;
+
+    // All the spheres at once
+    vector<uint32_t> visibility((numSpheres + 31) / 32);
+    size_t numVisibleBatch = 0;
+    start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < NUM_ITERATIONS; i++) {
+        numVisibleBatch = frustumPlanes.CullSpheres(&boundingSpheres.centersX[0], &boundingSpheres.centersY[0],
+                                                    &boundingSpheres.centersZ[0], &boundingSpheres.radii[0],
+                                                    numSpheres, &visibility[0]);
+    }
+    chrono::duration<double> batchTime = chrono::high_resolution_clock::now() - start;
+
+    double scalarRate = numSpheres * NUM_ITERATIONS / scalarTime.count();
+    double batchRate = numSpheres * NUM_ITERATIONS / batchTime.count();
+
+    cout << numSpheres << " spheres (" << numVisibleScalar << " visible)" << endl;
+    cout << "    IsSphereOutside: " << scalarRate / 1.0e6 << " million spheres/s" << endl;
+    cout << "    CullSpheres:     " << batchRate / 1.0e6 << " million spheres/s (" << numVisibleBatch << " visible)" << endl;
+    cout << "    Speedup:         " << scalarTime.count() / batchTime.count() << "x" << endl;
+
+    if (numVisibleScalar != numVisibleBatch) {
+        cout << "    WARNING: both methods didn't find the same number of visible spheres" << endl;
+    }
+}
+
+#if PLATFORM == PLATFORM_WIN32
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine, int iCmdShow) {
+    int argc = 0;
+    char** argv = nullptr;
+#else
+int main(int argc, char** argv) {
+#endif
+
+    FrustumPlanes_t frustumPlanes = CreateFrustum();
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            RunBenchmark(frustumPlanes, strtoul(argv[i], nullptr, 10));
+        }
+    } else {
+        RunBenchmark(frustumPlanes, 100000);
+        RunBenchmark(frustumPlanes, 1000000);
+    }
+
+    return 0;
+}
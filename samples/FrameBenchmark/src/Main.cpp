@@ -0,0 +1,148 @@
+#include <math/Quaternion.h>
+#include <math/Vector3.h>
+
+#include <render/Material.h>
+#include <render/Mesh.h>
+#include <render/Node.h>
+#include <render/Null/RenderSystemNull.h>
+#include <render/Renderer.h>
+#include <render/SceneTree.h>
+#include <render/Shader.h>
+
+#include <system/Profiler.h>
+using namespace Sketch3D;
+
+#include <chrono>
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+using namespace std;
+
+#if PLATFORM == PLATFORM_WIN32
+#include <Windows.h>
+#endif
+
+const size_t NUM_MESHES = 4;
+const size_t NUM_MATERIALS = 8;
+
+static Mesh* CreateBoxMesh(float size) {
+    SurfaceTriangles_t* surface = new SurfaceTriangles_t;
+    surface->numVertices = 8;
+    surface->vertices = new Vector3[8];
+    for (size_t i = 0; i < 8; i++) {
+        surface->vertices[i] = Vector3((i & 1) ? size : -size, (i & 2) ? size : -size, (i & 4) ? size : -size);
+    }
+
+    const unsigned int indices[] = {
+        0, 2, 1, 1, 2, 3,   4, 5, 6, 5, 7, 6,
+        0, 1, 4, 1, 5, 4,   2, 6, 3, 3, 6, 7,
+        0, 4, 2, 2, 4, 6,   1, 3, 5, 3, 7, 5
+    };
+    surface->numIndices = sizeof(indices) / sizeof(indices[0]);
+    surface->indices = new unsigned int[surface->numIndices];
+    for (size_t i = 0; i < surface->numIndices; i++) {
+        surface->indices[i] = indices[i];
+    }
+
+    VertexAttributesMap_t vertexAttributes;
+    vertexAttributes[VERTEX_ATTRIBUTES_POSITION] = 0;
+
+    Mesh* mesh = new Mesh;
+    mesh->AddSurface(surface);
+    mesh->Initialize(vertexAttributes);
+    return mesh;
+}
+
+#if PLATFORM == PLATFORM_WIN32
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine, int iCmdShow) {
+    int argc = 0;
+    char** argv = nullptr;
+#else
+int main(int argc, char** argv) {
+#endif
+
+    size_t numNodes = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 10000;
+    size_t numFrames = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 200;
+    size_t numThreads = (argc > 3) ? strtoul(argv[3], nullptr, 10) : 1;
+
+    RenderParameters_t renderParameters;
+    renderParameters.width = 1024;
+    renderParameters.height = 768;
+
+    Renderer* renderer = Renderer::GetInstance();
+    if (!renderer->Initialize(RENDER_SYSTEM_NULL, renderParameters)) {
+        return 1;
+    }
+    RenderSystemNull* renderSystem = static_cast<RenderSystemNull*>(renderer->GetRenderSystem());
+
+    vector<Mesh*> meshes;
+    for (size_t i = 0; i < NUM_MESHES; i++) {
+        meshes.push_back(CreateBoxMesh(0.5f + 0.25f * i));
+    }
+
+    vector<Material*> materials;
+    for (size_t i = 0; i < NUM_MATERIALS; i++) {
+        materials.push_back(new Material(renderer->CreateShader()));
+    }
+
+    // Square grid of nodes around the camera
+    size_t side = (size_t)ceil(sqrt((double)numNodes));
+    vector<Node*> nodes;
+    for (size_t i = 0; i < numNodes; i++) {
+        Vector3 position(((float)(i % side) - side * 0.5f) * 4.0f, 0.0f, ((float)(i / side) - side * 0.5f) * 4.0f);
+        Node* node = new Node(position, Vector3(1.0f, 1.0f, 1.0f), Quaternion::IDENTITY);
+        node->SetMesh(meshes[i % NUM_MESHES]);
+        node->SetMaterial(materials[(i / NUM_MESHES) % NUM_MATERIALS]);
+        renderer->GetSceneTree().AddNode(node);
+        nodes.push_back(node);
+    }
+
+    renderer->GetSceneTree().SetNumberOfThreads(numThreads);
+    renderer->PerspectiveProjection(60.0f, 1024.0f / 768.0f, 1.0f, side * 4.0f);
+
+#if defined(SKETCH_3D_PROFILING)
+    Profiler::GetInstance()->SetEnabled(true);
+#endif
+
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < numFrames; i++) {
+        float angle = 6.2831853f * i / numFrames;
+        renderer->CameraLookAt(Vector3(0.0f, 10.0f, 0.0f), Vector3(cosf(angle), 10.0f, sinf(angle)));
+
+        renderSystem->ResetApiCallCounters();
+        renderer->Clear();
+        renderer->StartRender();
+        renderer->Render();
+        renderer->EndRender();
+        renderer->PresentFrame();
+    }
+    chrono::duration<double, milli> totalTime = chrono::high_resolution_clock::now() - start;
+
+#if defined(SKETCH_3D_PROFILING)
+    Profiler::GetInstance()->SetEnabled(false);
+    Profiler::GetInstance()->ExportChromeTrace("FrameBenchmark.json");
+#endif
+
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    cout << numNodes << " nodes, " << numFrames << " frames, " << renderer->GetSceneTree().GetNumberOfThreads() << " threads" << endl;
+    cout << "    Average frame time: " << totalTime.count() / numFrames << " ms" << endl;
+    cout << "    Last frame: " << counters.drawCalls << " draw calls, " << counters.instancedDrawCalls << " instanced draw calls, "
+         << counters.shaderBinds << " shader binds, " << counters.textureBinds << " texture binds, "
+         << counters.uniformUpdates << " uniform updates, " << counters.stateChanges << " state changes" << endl;
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        renderer->GetSceneTree().RemoveNode(nodes[i]);
+        delete nodes[i];
+    }
+
+    for (size_t i = 0; i < materials.size(); i++) {
+        delete materials[i];
+    }
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        delete meshes[i];
+    }
+
+    return 0;
+}
@@ -67,7 +67,7 @@ int main(int argc, char** argv) {
     }
 
     surface.numIndices = NUM_CELLS * NUM_CELLS * 6;
-    surface.indices = new unsigned short[surface.numIndices];
+    surface.indices = new unsigned int[surface.numIndices];
     idx = 0;
 
     for (size_t i = 0; i < NUM_CELLS; i++) {
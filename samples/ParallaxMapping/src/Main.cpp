@@ -54,7 +54,7 @@ int main(int argc, char** argv) {
     surface.tangents[0] = surface.tangents[1] = surface.tangents[2] = surface.tangents[3] = Vector3::RIGHT;
     
     surface.numIndices = 6;
-    surface.indices = new unsigned short[surface.numIndices];
+    surface.indices = new unsigned int[surface.numIndices];
     surface.indices[0] = 0; surface.indices[1] = 1; surface.indices[2] = 2; surface.indices[3] = 0; surface.indices[4] = 2; surface.indices[5] = 3;
 
     Mesh mesh;
@@ -111,7 +111,7 @@ int main(int argc, char** argv) {
     surface.vertices = new Vector3[surface.numVertices];
     surface.normals = new Vector3[surface.numNormals];
     surface.texCoords = new Vector2[surface.numTexCoords];
-    surface.indices = new unsigned short[surface.numIndices];
+    surface.indices = new unsigned int[surface.numIndices];
     surface.textures = new Texture2D* [surface.numTextures];
     
     surface.vertices[0] = Vector3(-50.0f, 0.0f, -50.0f); surface.vertices[1] = Vector3(-50.0f, 0.0f, 50.0f); surface.vertices[2] = Vector3(50.0f, 0.0f, 50.0f); surface.vertices[3] = Vector3(50.0f, 0.0f, -50.0f);
@@ -4,6 +4,7 @@
 #include "render/Material.h"
 #include "render/Renderer.h"
 #include "render/Shader.h"
+#include "system/Profiler.h"
 using namespace Sketch3D;
 
 #include <string>
@@ -54,7 +55,7 @@ Ocean::Ocean(const int numberOfPoints, const float amplitude, const Vector2& win
     // Compute the indices of the mesh
     int size = numberOfPoints_ - 1;
     oceanSurface_.numIndices = size * size * 6;
-    oceanSurface_.indices = new unsigned short[oceanSurface_.numIndices];
+    oceanSurface_.indices = new unsigned int[oceanSurface_.numIndices];
     idx = 0;
 
     for (int i = 0; i < size; i++) {
@@ -148,6 +149,8 @@ Ocean::~Ocean() {
 }
 
 void Ocean::EvaluateWaves(double t) {
+    PROFILE_ZONE("Ocean::EvaluateWaves");
+
     Vector2 k;
     float kLength;
     size_t index;
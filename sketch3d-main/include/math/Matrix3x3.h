@@ -149,6 +149,25 @@ class SKETCH_3D_API Matrix3x3
 		 */
 		INLINE void				GetData(float* data) const;
 
+        // BATCH TRANSFORMATIONS
+        /**
+         * Transform an array of vectors
+         * @param vectors The vectors to transform
+         * @param result The transformed vectors. Can be the same array as vectors
+         * @param count The number of vectors
+         */
+        void                    TransformVectors(const Vector3* vectors, Vector3* result, size_t count) const;
+
+        /**
+         * Transform an array of vectors and normalize them. To transform
+         * normals, this matrix should be the transposed inverse of the model
+         * matrix
+         * @param normals The normals to transform
+         * @param result The transformed normals. Can be the same array as normals
+         * @param count The number of normals
+         */
+        void                    TransformNormals(const Vector3* normals, Vector3* result, size_t count) const;
+
     private:
 		float                   data_[3][3];	/**< The matrix represented as a 2D array */
 };
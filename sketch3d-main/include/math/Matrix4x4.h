@@ -12,6 +12,18 @@ namespace Sketch3D
 class Matrix3x3;
 class Vector4;
 
+/**
+ * @enum MatrixKernel_t
+ * Implementations of the matrix kernels (multiplication, transpose, inverse
+ * and matrix-vector product). The scalar kernel is the reference
+ * implementation, the others are only available if the CPU supports them.
+ */
+enum MatrixKernel_t {
+    MATRIX_KERNEL_SCALAR,
+    MATRIX_KERNEL_SSE2,
+    MATRIX_KERNEL_AVX_FMA
+};
+
 /**
  * @class Matrix4x4
  * Represents a column-major 4x4 matrix.
@@ -63,6 +75,14 @@ class SKETCH_3D_API Matrix4x4
          */
         Matrix4x4               Inverse() const;
 
+        /**
+         * Return the inverse of this matrix, assuming that it is an affine
+         * transformation, i.e. that its last row is (0, 0, 0, 1). This is the
+         * case of the model and view matrices and is a lot cheaper than
+         * Inverse()
+         */
+        Matrix4x4               InverseAffine() const;
+
         /**
          * Transform this matrix into a translation matrix
          * @param translation A vector representing the translation
@@ -126,14 +146,14 @@ class SKETCH_3D_API Matrix4x4
         // BINARY OPERATORS
         INLINE Matrix4x4        operator+(const Matrix4x4& m) const;
         INLINE Matrix4x4        operator-(const Matrix4x4& m) const;
-        INLINE Matrix4x4        operator*(const Matrix4x4& m) const;
+        Matrix4x4               operator*(const Matrix4x4& m) const;
         INLINE Matrix4x4        operator*(float f) const;
         Vector4                 operator*(const Vector3& v) const;
         Vector4					operator*(const Vector4& v) const;
 
         INLINE void             operator+=(const Matrix4x4& m);
         INLINE void             operator-=(const Matrix4x4& m);
-        INLINE void             operator*=(const Matrix4x4& m);
+        void                    operator*=(const Matrix4x4& m);
         INLINE void             operator*=(float f);
 
         INLINE bool             operator==(const Matrix4x4& m) const;
@@ -153,8 +173,82 @@ class SKETCH_3D_API Matrix4x4
 
         INLINE void             SetTranslation(const Vector3& vec);
 
+        // BATCH TRANSFORMATIONS
+        /**
+         * Transform an array of points, that is with their w component set to 1
+         * @param points The points to transform
+         * @param result The transformed points. Can be the same array as points
+         * @param count The number of points
+         */
+        void                    TransformPoints(const Vector3* points, Vector3* result, size_t count) const;
+
+        /**
+         * Transform an array of directions, that is with their w component set to 0
+         * @param directions The directions to transform
+         * @param result The transformed directions. Can be the same array as directions
+         * @param count The number of directions
+         */
+        void                    TransformDirections(const Vector3* directions, Vector3* result, size_t count) const;
+
+        /**
+         * Transform an array of directions and normalize them. To transform
+         * normals, this matrix should be the transposed inverse of the model
+         * matrix
+         * @param normals The normals to transform
+         * @param result The transformed normals. Can be the same array as normals
+         * @param count The number of normals
+         */
+        void                    TransformNormals(const Vector3* normals, Vector3* result, size_t count) const;
+
+        /**
+         * Transform an array of 4D vectors
+         * @param vectors The vectors to transform
+         * @param result The transformed vectors. Can be the same array as vectors
+         * @param count The number of vectors
+         */
+        void                    TransformVectors(const Vector4* vectors, Vector4* result, size_t count) const;
+
+        /**
+         * Select the implementation used by the matrix kernels. The best one
+         * supported by the CPU is selected the first time a kernel is used.
+         * @param kernel The kernel to use
+         * @return false if the CPU doesn't support that kernel, true otherwise
+         */
+        static bool             SetKernel(MatrixKernel_t kernel);
+
+        /**
+         * Returns the implementation currently used by the matrix kernels
+         */
+        static MatrixKernel_t   GetKernel();
+
     private:
 		float                   data_[4][4];	/**< The matrix represented as 2d array */
+
+        // Kernels. The results can safely alias the parameters. The SIMD
+        // versions are defined in Matrix4x4_SIMD.cpp
+        static void             MultiplyScalar(const Matrix4x4& lhs, const Matrix4x4& rhs, Matrix4x4& result);
+        static void             TransposeScalar(const Matrix4x4& m, Matrix4x4& result);
+        static void             InverseScalar(const Matrix4x4& m, Matrix4x4& result);
+        static void             TransformScalar(const Matrix4x4& m, const Vector4& v, Vector4& result);
+
+        static void             MultiplySSE2(const Matrix4x4& lhs, const Matrix4x4& rhs, Matrix4x4& result);
+        static void             TransposeSSE2(const Matrix4x4& m, Matrix4x4& result);
+        static void             InverseSSE2(const Matrix4x4& m, Matrix4x4& result);
+        static void             TransformSSE2(const Matrix4x4& m, const Vector4& v, Vector4& result);
+
+        static void             MultiplyAVX(const Matrix4x4& lhs, const Matrix4x4& rhs, Matrix4x4& result);
+        static void             TransformAVX(const Matrix4x4& m, const Vector4& v, Vector4& result);
+
+        // Batch kernels working on the upper 3x4 part of the matrix. 'w' is
+        // the implicit fourth component of the vectors
+        void                    TransformVector3Batch(const Vector3* v, Vector3* result, size_t count, float w,
+                                                      bool normalize) const;
+        static void             TransformVector3Scalar(const Matrix4x4& m, const Vector3* v, Vector3* result,
+                                                       size_t count, float w, bool normalize);
+        static void             TransformVector3SSE2(const Matrix4x4& m, const Vector3* v, Vector3* result,
+                                                     size_t count, float w, bool normalize);
+        static void             TransformVector3AVX(const Matrix4x4& m, const Vector3* v, Vector3* result,
+                                                    size_t count, float w, bool normalize);
 };
 
 INLINE const float* Matrix4x4::operator[] (int row) const
@@ -204,32 +298,6 @@ INLINE Matrix4x4 Matrix4x4::operator-(const Matrix4x4& m) const {
     return mat;
 }
 
-INLINE Matrix4x4 Matrix4x4::operator*(const Matrix4x4& m) const
-{
-    Matrix4x4 mat;
-    mat.data_[0][0] = data_[0][0] * m.data_[0][0] + data_[0][1] * m.data_[1][0] + data_[0][2] * m.data_[2][0] + data_[0][3] * m.data_[3][0];
-    mat.data_[0][1] = data_[0][0] * m.data_[0][1] + data_[0][1] * m.data_[1][1] + data_[0][2] * m.data_[2][1] + data_[0][3] * m.data_[3][1];
-    mat.data_[0][2] = data_[0][0] * m.data_[0][2] + data_[0][1] * m.data_[1][2] + data_[0][2] * m.data_[2][2] + data_[0][3] * m.data_[3][2];
-    mat.data_[0][3] = data_[0][0] * m.data_[0][3] + data_[0][1] * m.data_[1][3] + data_[0][2] * m.data_[2][3] + data_[0][3] * m.data_[3][3];
-
-    mat.data_[1][0] = data_[1][0] * m.data_[0][0] + data_[1][1] * m.data_[1][0] + data_[1][2] * m.data_[2][0] + data_[1][3] * m.data_[3][0];
-    mat.data_[1][1] = data_[1][0] * m.data_[0][1] + data_[1][1] * m.data_[1][1] + data_[1][2] * m.data_[2][1] + data_[1][3] * m.data_[3][1];
-    mat.data_[1][2] = data_[1][0] * m.data_[0][2] + data_[1][1] * m.data_[1][2] + data_[1][2] * m.data_[2][2] + data_[1][3] * m.data_[3][2];
-    mat.data_[1][3] = data_[1][0] * m.data_[0][3] + data_[1][1] * m.data_[1][3] + data_[1][2] * m.data_[2][3] + data_[1][3] * m.data_[3][3];
-
-    mat.data_[2][0] = data_[2][0] * m.data_[0][0] + data_[2][1] * m.data_[1][0] + data_[2][2] * m.data_[2][0] + data_[2][3] * m.data_[3][0];
-    mat.data_[2][1] = data_[2][0] * m.data_[0][1] + data_[2][1] * m.data_[1][1] + data_[2][2] * m.data_[2][1] + data_[2][3] * m.data_[3][1];
-    mat.data_[2][2] = data_[2][0] * m.data_[0][2] + data_[2][1] * m.data_[1][2] + data_[2][2] * m.data_[2][2] + data_[2][3] * m.data_[3][2];
-    mat.data_[2][3] = data_[2][0] * m.data_[0][3] + data_[2][1] * m.data_[1][3] + data_[2][2] * m.data_[2][3] + data_[2][3] * m.data_[3][3];
-
-    mat.data_[3][0] = data_[3][0] * m.data_[0][0] + data_[3][1] * m.data_[1][0] + data_[3][2] * m.data_[2][0] + data_[3][3] * m.data_[3][0];
-    mat.data_[3][1] = data_[3][0] * m.data_[0][1] + data_[3][1] * m.data_[1][1] + data_[3][2] * m.data_[2][1] + data_[3][3] * m.data_[3][1];
-    mat.data_[3][2] = data_[3][0] * m.data_[0][2] + data_[3][1] * m.data_[1][2] + data_[3][2] * m.data_[2][2] + data_[3][3] * m.data_[3][2];
-    mat.data_[3][3] = data_[3][0] * m.data_[0][3] + data_[3][1] * m.data_[1][3] + data_[3][2] * m.data_[2][3] + data_[3][3] * m.data_[3][3];
-
-    return mat;
-}
-
 INLINE Matrix4x4 Matrix4x4::operator*(float f) const {
     Matrix4x4 mat;
 
@@ -258,32 +326,6 @@ INLINE void Matrix4x4::operator-=(const Matrix4x4& m) {
     }
 }
 
-INLINE void Matrix4x4::operator*=(const Matrix4x4& m)
-{
-	Matrix4x4 mat = ZERO;
-    mat.data_[0][0] = data_[0][0] * m.data_[0][0] + data_[0][1] * m.data_[1][0] + data_[0][2] * m.data_[2][0] + data_[0][3] * m.data_[3][0];
-    mat.data_[0][1] = data_[0][0] * m.data_[0][1] + data_[0][1] * m.data_[1][1] + data_[0][2] * m.data_[2][1] + data_[0][3] * m.data_[3][1];
-    mat.data_[0][2] = data_[0][0] * m.data_[0][2] + data_[0][1] * m.data_[1][2] + data_[0][2] * m.data_[2][2] + data_[0][3] * m.data_[3][2];
-    mat.data_[0][3] = data_[0][0] * m.data_[0][3] + data_[0][1] * m.data_[1][3] + data_[0][2] * m.data_[2][3] + data_[0][3] * m.data_[3][3];
-
-    mat.data_[1][0] = data_[1][0] * m.data_[0][0] + data_[1][1] * m.data_[1][0] + data_[1][2] * m.data_[2][0] + data_[1][3] * m.data_[3][0];
-    mat.data_[1][1] = data_[1][0] * m.data_[0][1] + data_[1][1] * m.data_[1][1] + data_[1][2] * m.data_[2][1] + data_[1][3] * m.data_[3][1];
-    mat.data_[1][2] = data_[1][0] * m.data_[0][2] + data_[1][1] * m.data_[1][2] + data_[1][2] * m.data_[2][2] + data_[1][3] * m.data_[3][2];
-    mat.data_[1][3] = data_[1][0] * m.data_[0][3] + data_[1][1] * m.data_[1][3] + data_[1][2] * m.data_[2][3] + data_[1][3] * m.data_[3][3];
-
-    mat.data_[2][0] = data_[2][0] * m.data_[0][0] + data_[2][1] * m.data_[1][0] + data_[2][2] * m.data_[2][0] + data_[2][3] * m.data_[3][0];
-    mat.data_[2][1] = data_[2][0] * m.data_[0][1] + data_[2][1] * m.data_[1][1] + data_[2][2] * m.data_[2][1] + data_[2][3] * m.data_[3][1];
-    mat.data_[2][2] = data_[2][0] * m.data_[0][2] + data_[2][1] * m.data_[1][2] + data_[2][2] * m.data_[2][2] + data_[2][3] * m.data_[3][2];
-    mat.data_[2][3] = data_[2][0] * m.data_[0][3] + data_[2][1] * m.data_[1][3] + data_[2][2] * m.data_[2][3] + data_[2][3] * m.data_[3][3];
-
-    mat.data_[3][0] = data_[3][0] * m.data_[0][0] + data_[3][1] * m.data_[1][0] + data_[3][2] * m.data_[2][0] + data_[3][3] * m.data_[3][0];
-    mat.data_[3][1] = data_[3][0] * m.data_[0][1] + data_[3][1] * m.data_[1][1] + data_[3][2] * m.data_[2][1] + data_[3][3] * m.data_[3][1];
-    mat.data_[3][2] = data_[3][0] * m.data_[0][2] + data_[3][1] * m.data_[1][2] + data_[3][2] * m.data_[2][2] + data_[3][3] * m.data_[3][2];
-    mat.data_[3][3] = data_[3][0] * m.data_[0][3] + data_[3][1] * m.data_[1][3] + data_[3][2] * m.data_[2][3] + data_[3][3] * m.data_[3][3];
-
-    (*this) = mat;
-}
-
 INLINE void Matrix4x4::operator*=(float f) {
     for (size_t i = 0; i < 4; i++) {
         for (size_t j = 0; j < 4; j++) {
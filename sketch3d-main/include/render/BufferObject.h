@@ -4,6 +4,7 @@
 #include "system/Platform.h"
 
 #include <map>
+#include <stdint.h>
 #include <vector>
 using namespace std;
 
@@ -27,11 +28,25 @@ enum BufferObjectError_t {
  * @enum BufferUsage_t
  * Determines how to internally manage the buffer
  *  - Static means that the buffer should be written once and never modified (you can, but it's slow);
- *  - Dynamic means that the buffer will be updated several times (faster than static)
+ *  - Dynamic means that the buffer will be updated several times (faster than static);
+ *  - Static shared is like static, but when the render system supports indirect draws, the data is stored in buffers
+ *    shared with the other buffer objects that have the same vertex layout, so that they can be drawn together with a
+ *    single indirect draw call
  */
 enum BufferUsage_t {
     BUFFER_USAGE_STATIC,
-    BUFFER_USAGE_DYNAMIC
+    BUFFER_USAGE_DYNAMIC,
+    BUFFER_USAGE_STATIC_SHARED
+};
+
+/**
+ * @enum IndexFormat_t
+ * Size of the indices stored in an index buffer. The indices are given on 32 bits and the buffer objects store them on
+ * 16 bits when they all fit, which halves the size of the index buffers of the small meshes
+ */
+enum IndexFormat_t {
+    INDEX_FORMAT_16,
+    INDEX_FORMAT_32
 };
 
 /**
@@ -52,6 +67,18 @@ enum VertexAttributes_t {
 // Typdefs
 typedef map<VertexAttributes_t, size_t> VertexAttributesMap_t;
 
+/**
+ * @struct DrawIndirectCommand_t
+ * Parameters of one draw of an indirect draw call. The layout is the one expected by the rendering APIs
+ */
+struct DrawIndirectCommand_t {
+    uint32_t    indexCount;     /**< Number of indices to draw */
+    uint32_t    instanceCount;  /**< Number of instances to draw */
+    uint32_t    firstIndex;     /**< Offset of the first index in the shared index buffer */
+    int32_t     baseVertex;     /**< Offset added to the indices to find the vertices in the shared vertex buffer */
+    uint32_t    baseInstance;   /**< Index of the model matrix of the first instance */
+};
+
 /**
  * @class BufferObject
  * This class represents the base class for API dependent buffer object of a vertex buffer
@@ -83,6 +110,15 @@ class SKETCH_3D_API BufferObject {
          */
         virtual void                RenderInstances(const vector<Matrix4x4>& modelMatrices) = 0;
 
+        /**
+         * Render several buffer objects sharing the storage of this one with a single indirect draw call
+         * @param commands The draws to make, constructed with FillDrawIndirectCommand from the buffer objects to draw
+         * @param numCommands The number of draws
+         * @param modelMatrices The transposed model matrices of all the draws, indexed by their base instance
+         */
+        virtual void                RenderIndirect(const DrawIndirectCommand_t* commands, size_t numCommands,
+                                                   const vector<Matrix4x4>& modelMatrices) = 0;
+
         /**
          * Set the vertices for the vertex buffer
          * @param vertexData An array of float that represent the vertex data
@@ -101,25 +137,43 @@ class SKETCH_3D_API BufferObject {
 
         /**
          * Set the indices for the index buffer
-         * @param indexData An array of unsigned short that represent the index data
+         * @param indexData An array of unsigned int that represent the index data
          * @param numIndex The number of index in the array
          * @return An error code from the BufferObjectError_t enum
          */
-        virtual BufferObjectError_t SetIndexData(unsigned short* indexData, size_t numIndex) = 0;
+        virtual BufferObjectError_t SetIndexData(unsigned int* indexData, size_t numIndex) = 0;
 
         /**
          * Append indices data at the end of the index buffer
-         * @param indexData an array of unsigned short that represent the index data to append
+         * @param indexData an array of unsigned int that represent the index data to append
          * @param numIndex The number of index in the array to append
          * @return An error code from the BufferObjectError_t enum
          */
-        virtual BufferObjectError_t AppendIndexData(unsigned short* indexData, size_t numIndex) = 0;
+        virtual BufferObjectError_t AppendIndexData(unsigned int* indexData, size_t numIndex) = 0;
 
         /**
          * Prepare buffers for instanced rendering
          */
         virtual void            PrepareInstanceBuffers() = 0;
 
+        /**
+         * Fill the parameters to draw this buffer object as part of an indirect draw call
+         * @param command The command to fill
+         * @param baseInstance Index of the model matrix of the buffer object in the matrices given to RenderIndirect
+         */
+        void                    FillDrawIndirectCommand(DrawIndirectCommand_t& command, uint32_t baseInstance) const;
+
+        /**
+         * Returns the id of the storage shared with other buffer objects, 0 if the buffer object has its own storage.
+         * Buffer objects with the same non zero id can be drawn together with RenderIndirect
+         */
+        size_t                  GetSharedStorageId() const;
+
+        /**
+         * Returns the format in which the indices are stored
+         */
+        IndexFormat_t           GetIndexFormat() const;
+
         size_t                  GetVertexAttributesBitField() const;
         size_t                  GetId() const;
 
@@ -129,7 +183,11 @@ class SKETCH_3D_API BufferObject {
         size_t                  vertexCount_;
         size_t                  stride_;
         size_t                  indexCount_;
+        IndexFormat_t           indexFormat_;       /**< Format in which the indices are stored */
         size_t                  id_;
+        size_t                  sharedStorageId_;   /**< Id of the shared storage in which the data is, 0 if none */
+        size_t                  firstIndex_;        /**< Offset of the first index in the shared index buffer */
+        size_t                  baseVertex_;        /**< Offset of the first vertex in the shared vertex buffer */
 
         static size_t           nextAvailableId_;
 
@@ -153,6 +211,35 @@ class SKETCH_3D_API BufferObject {
 void PackSurfaceTriangleVertices(const SurfaceTriangles_t* surface, const map<size_t, VertexAttributes_t>& attributesFromIndex,
                                  vector<float>& vertexData, int& presentVertexAttributes, size_t& stride);
 
+/**
+ * Get the narrowest index format in which indices fit
+ * @param indexData The indices
+ * @param numIndex The number of indices
+ * @return INDEX_FORMAT_16 if all the indices are smaller than 65536, INDEX_FORMAT_32 otherwise
+ */
+IndexFormat_t GetIndexFormatForIndices(const unsigned int* indexData, size_t numIndex);
+
+/**
+ * Get the narrowest index format able to address all the vertices of a vertex buffer
+ * @param numVertices The number of vertices in the vertex buffer
+ */
+IndexFormat_t GetIndexFormatForVertices(size_t numVertices);
+
+/**
+ * Returns the size of an index in bytes
+ */
+size_t GetIndexSize(IndexFormat_t format);
+
+/**
+ * Convert indices to the format of an index buffer
+ * @param indexData The indices, which must fit in the format
+ * @param numIndex The number of indices
+ * @param format The format of the index buffer
+ * @param shortIndices Storage of the converted indices when the format is INDEX_FORMAT_16
+ * @return A pointer to the indices in the requested format, either indexData or the data of shortIndices
+ */
+const void* ConvertIndices(const unsigned int* indexData, size_t numIndex, IndexFormat_t format, vector<unsigned short>& shortIndices);
+
 }
 
 #endif
\ No newline at end of file
@@ -17,19 +17,31 @@ namespace Sketch3D {
  */
 class BufferObjectDirect3D9 : public BufferObject {
     public:
-                                        BufferObjectDirect3D9(IDirect3DDevice9* device, const VertexAttributesMap_t& vertexAttributes,
+        /**
+         * Constructor
+         * @param device The Direct3D9 device
+         * @param maxVertexIndex Largest vertex index that the device can draw. At 0xFFFF or below, the buffer can't
+         * hold more vertices than 16 bit indices can address
+         * @param vertexAttributes The vertex attributes of the buffer
+         * @param usage How the buffer is used
+         */
+                                        BufferObjectDirect3D9(IDirect3DDevice9* device, unsigned int maxVertexIndex,
+                                                              const VertexAttributesMap_t& vertexAttributes,
                                                               BufferUsage_t usage=BUFFER_USAGE_STATIC);
         virtual                        ~BufferObjectDirect3D9();
         virtual void                    Render();
         virtual void                    RenderInstances(const vector<Matrix4x4>& modelMatrices);
+        virtual void                    RenderIndirect(const DrawIndirectCommand_t* commands, size_t numCommands,
+                                                       const vector<Matrix4x4>& modelMatrices);
         virtual BufferObjectError_t     SetVertexData(const vector<float>& vertexData, int presentVertexAttributes);
         virtual BufferObjectError_t     AppendVertexData(const vector<float>& vertexData, int presentVertexAttributes);
-        virtual BufferObjectError_t     SetIndexData(unsigned short* indexdata, size_t numIndex);
-        virtual BufferObjectError_t     AppendIndexData(unsigned short* indexData, size_t numIndex);
+        virtual BufferObjectError_t     SetIndexData(unsigned int* indexdata, size_t numIndex);
+        virtual BufferObjectError_t     AppendIndexData(unsigned int* indexData, size_t numIndex);
         virtual void                    PrepareInstanceBuffers();
 
     private:
         IDirect3DDevice9*               device_;
+        unsigned int                    maxVertexIndex_;
         IDirect3DVertexBuffer9*         vertexBuffer_;
         IDirect3DIndexBuffer9*          indexBuffer_;
         IDirect3DVertexDeclaration9*    vertexDeclaration_;
@@ -14,11 +14,17 @@ namespace Sketch3D {
  */
 class BufferObjectManagerDirect3D9 : public BufferObjectManager {
     public:
-                                BufferObjectManagerDirect3D9(IDirect3DDevice9* device);
+        /**
+         * Constructor
+         * @param device The Direct3D9 device
+         * @param maxVertexIndex The MaxVertexIndex capability of the device, given to the buffer objects
+         */
+                                BufferObjectManagerDirect3D9(IDirect3DDevice9* device, unsigned int maxVertexIndex);
         virtual BufferObject*   CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage=BUFFER_USAGE_STATIC);
 
     private:
         IDirect3DDevice9*       device_;
+        unsigned int            maxVertexIndex_;    /**< Largest vertex index that the device can draw */
 };
 
 }
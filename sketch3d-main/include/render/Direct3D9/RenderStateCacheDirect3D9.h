@@ -12,7 +12,7 @@ namespace Sketch3D {
  */
 class RenderStateCacheDirect3D9 : public RenderStateCache {
     public:
-                            RenderStateCacheDirect3D9(IDirect3DDevice9* device);
+                            RenderStateCacheDirect3D9(IDirect3DDevice9* device, FrameStats_t* frameStats);
         virtual            ~RenderStateCacheDirect3D9();
 
     protected:
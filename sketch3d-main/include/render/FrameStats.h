@@ -0,0 +1,39 @@
+#ifndef SKETCH_3D_FRAME_STATS_H
+#define SKETCH_3D_FRAME_STATS_H
+
+#include "system/Platform.h"
+
+#include <stddef.h>
+
+namespace Sketch3D {
+
+/**
+ * @struct FrameStats_t
+ * Counters describing the work done to render the current frame. They are reset when a frame is started and are
+ * only incremented, so that reading them costs nothing and collecting them costs a few additions per frame
+ */
+struct SKETCH_3D_API FrameStats_t {
+                FrameStats_t() { Reset(); }
+
+    size_t      nodesVisited;       /**< Number of renderable nodes gathered from the scene tree */
+    size_t      nodesCulled;        /**< Number of renderable nodes rejected by the frustum culling */
+    size_t      queueItems;         /**< Number of items drawn by the render queues */
+    long long   sortTime;           /**< Time spent sorting the render queues, in microseconds */
+    size_t      drawCalls;          /**< Number of non-instanced draw calls issued by the render queues */
+    size_t      instancedDrawCalls; /**< Number of instanced draw calls issued by the render queues */
+    size_t      drawnInstances;     /**< Number of instances drawn by the instanced draw calls */
+    size_t      indirectDrawCalls;  /**< Number of indirect draw calls issued by the render queues */
+    size_t      indirectDraws;      /**< Number of draws made by the indirect draw calls */
+    size_t      shaderBinds;        /**< Number of times a different shader was bound */
+    size_t      textureBinds;       /**< Number of textures bound to a texture unit */
+    size_t      uniformUploads;     /**< Number of uniforms sent to the shaders */
+    size_t      skippedUniformUploads;  /**< Number of uniforms not sent because the shader already had their value */
+    size_t      bufferBytesUploaded;/**< Number of bytes of vertex, index, instance and draw command data sent to buffers */
+    size_t      stateChanges;       /**< Number of render states and object bindings applied by the render state cache */
+
+    void        Reset();
+};
+
+}
+
+#endif
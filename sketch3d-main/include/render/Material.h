@@ -1,11 +1,11 @@
 #ifndef SKETCH_3D_MATERIAL_H
 #define SKETCH_3D_MATERIAL_H
 
+#include "render/RenderState.h"
 #include "render/Shader.h"
 
 #include "system/Platform.h"
 
-#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -15,6 +15,7 @@ namespace Sketch3D {
 
 // Forward declarations
 class Mesh;
+class PipelineState;
 class Texture;
 
 enum TransluencyType_t {
@@ -28,6 +29,9 @@ enum TransluencyType_t {
  * will be run to render the mesh as well as a set of general material
  * properties that will be pass to the shader to control how the mesh will be
  * rendered.
+ *
+ * The properties are packed in a single block with the handles of their uniforms. They are only sent to the shader
+ * when they changed or when another material was applied to the shader since the last time
  */
 class SKETCH_3D_API Material {
 	public:
@@ -36,6 +40,13 @@ class SKETCH_3D_API Material {
 		 */
 					                    Material(Shader* shader);
 
+        /**
+         * Copy constructor. The copy gets its own id, so that the shader knows they can diverge
+         */
+                                        Material(const Material& src);
+
+        Material&                       operator=(const Material& rhs);
+
         /**
          * Apply the material's uniform to its shader
          * @return false if the material couldn't apply its uniform, true otherwise
@@ -45,6 +56,12 @@ class SKETCH_3D_API Material {
         void		                    SetShader(Shader* shader);
         void                            SetTransluencyType(TransluencyType_t type);
 
+        /**
+         * Draw with a render state of its own instead of the one set through the renderer
+         * @param renderState The render state to draw with
+         */
+        void                            SetRenderState(const RenderState_t& renderState);
+
         // UNIFORM SETTERS
         void	                        SetUniformInt(const string& uniform, int value);
         void	                        SetUniformFloat(const string& uniform, float value);
@@ -58,23 +75,105 @@ class SKETCH_3D_API Material {
         void	                        SetUniformTexture(const string& uniform, const Texture* texture);
 
 		Shader*		                    GetShader() const;
+
+        /**
+         * Get the pipeline state made of the shader and of the render state of the material. The render state set
+         * through the renderer is used if the material doesn't have one. The pipeline state is resolved when the
+         * shader or the render state is set, so that it can be read by several threads while the render queues are
+         * populated. It is null if the material was created before the renderer was initialized
+         */
+        const PipelineState*            GetPipelineState() const;
         TransluencyType_t               GetTransluencyType() const;
+        uint32_t                        GetId() const { return id_; }
 
 	private:
-		Shader*		                    shader_;	/**< Shader used by the material */
-        TransluencyType_t               transluencyType_;   /**< The transluency type for this material */
-
-        // List of uniforms to set during rendering with this material
-        map<string, int>                intUniforms_;
-        map<string, float>              floatUniforms_;
-        map<string, Vector2>            vector2Uniforms_;
-        map<string, Vector3>            vector3Uniforms_;
-        map<string, vector<Vector3>>    vector3ArrayUniforms_;
-        map<string, Vector4>            vector4Uniforms_;
-        map<string, Matrix3x3>          matrix3x3Uniforms_;
-        map<string, Matrix4x4>          matrix4x4Uniforms_;
-        map<string, vector<Matrix4x4>>  matrix4x4ArrayUniforms_;
-        map<string, const Texture*>     textureUniforms_;
+        /**
+         * @enum MaterialParameterType_t
+         * Type of the uniform of a parameter
+         */
+        enum MaterialParameterType_t {
+            MATERIAL_PARAMETER_INT,
+            MATERIAL_PARAMETER_FLOAT,
+            MATERIAL_PARAMETER_VECTOR2,
+            MATERIAL_PARAMETER_VECTOR3,
+            MATERIAL_PARAMETER_VECTOR3_ARRAY,
+            MATERIAL_PARAMETER_VECTOR4,
+            MATERIAL_PARAMETER_MATRIX3X3,
+            MATERIAL_PARAMETER_MATRIX4X4,
+            MATERIAL_PARAMETER_MATRIX4X4_ARRAY
+        };
+
+        /**
+         * @struct MaterialParameter_t
+         * A parameter of the material, whose value is stored in the parameter block
+         */
+        struct MaterialParameter_t {
+            string                  name;       /**< Name of the uniform */
+            UniformHandle_t         handle;     /**< Handle of the uniform in the material's shader */
+            MaterialParameterType_t type;       /**< Type of the uniform */
+            size_t                  offset;     /**< Index of the first float of the value in the parameter block */
+            size_t                  size;       /**< Number of floats of the value */
+            bool                    dirty;      /**< Was the value changed since it was last sent to the shader? */
+        };
+
+        /**
+         * @struct TextureParameter_t
+         * A texture of the material. The textures are bound every time the material is applied since the texture units
+         * are shared by all the shaders
+         */
+        struct TextureParameter_t {
+            string                  name;       /**< Name of the uniform */
+            UniformHandle_t         handle;     /**< Handle of the uniform in the material's shader */
+            const Texture*          texture;    /**< The texture */
+        };
+
+        uint32_t                            id_;        /**< Id of the material, used by the shader to know which material was last applied */
+		Shader*		                        shader_;	/**< Shader used by the material */
+        TransluencyType_t                   transluencyType_;   /**< The transluency type for this material */
+        bool                                hasRenderState_;    /**< Does the material have its own render state? */
+        RenderState_t                       renderState_;       /**< Render state of the material if hasRenderState_ is true */
+        const PipelineState*                pipelineState_;     /**< Pipeline state of the material, resolved when the shader or render state is set */
+
+        mutable vector<MaterialParameter_t> parameters_;        /**< Parameters of the material, in the order they were added */
+        vector<float>                       parameterBlock_;    /**< Packed values of the parameters */
+        mutable vector<TextureParameter_t>  textureParameters_; /**< Textures of the material */
+        mutable bool                        hasDirtyParameters_;/**< Is any parameter dirty? */
+        mutable uint32_t                    shaderLinkCount_;   /**< Link count of the shader when the handles were resolved */
+
+        static uint32_t                     nextAvailableId_;
+
+        /**
+         * Store the value of a parameter in the parameter block, marking it dirty if it changed
+         * @param uniform The name of the uniform
+         * @param type The type of the uniform
+         * @param values The floats representing the value
+         * @param size The number of floats
+         */
+        void                            SetParameter(const string& uniform, MaterialParameterType_t type, const float* values, size_t size);
+
+        /**
+         * Get the pipeline state of the shader and render state of the material from the render state cache
+         */
+        void                            ResolvePipelineState();
+
+        /**
+         * Resolve the handles of the parameters against the shader, if it was linked since they were last resolved
+         */
+        void                            ResolveHandles() const;
+
+        /**
+         * Get the handle of a uniform of the shader without waiting for the shader to be linked
+         * @param uniform The name of the uniform
+         * @return INVALID_UNIFORM_HANDLE if there is no shader or if it is still being linked. The handle is then
+         * resolved when the link count of the shader changes
+         */
+        UniformHandle_t                 FindHandle(const string& uniform) const;
+
+        /**
+         * Send a parameter to the shader
+         * @param parameter The parameter to send
+         */
+        void                            UploadParameter(const MaterialParameter_t& parameter) const;
 };
 
 }
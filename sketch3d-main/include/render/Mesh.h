@@ -41,7 +41,7 @@ struct SKETCH_3D_API SurfaceTriangles_t {
     Vector3*        tangents;   /**< List of tangents */
     Vector4*        bones;      /**< List of indices of attached bones. Maximum of 4 bones */
     Vector4*        weights;    /**< List of weights for their corresponding bones */
-    unsigned short* indices;    /**< List of indices */
+    unsigned int*   indices;    /**< List of indices */
     Texture2D**     textures;   /**< List of textures to apply to the surface */
 
     size_t          numVertices;
@@ -143,6 +143,12 @@ class SKETCH_3D_API Mesh {
 		 */
         void					        GetRenderInfo(BufferObject**& bufferObjects, vector<SurfaceTriangles_t*>& surfaces) const;
 
+        /**
+         * Get the buffer objects and the surfaces of the mesh. Unlike GetRenderInfo, the list of surfaces isn't copied
+         */
+        BufferObject**                  GetBufferObjects() const;
+        const vector<SurfaceTriangles_t*>&  GetSurfaces() const;
+
         const Sphere&                   GetBoundingSphere() const;
         const VertexAttributesMap_t&    GetVertexAttributes() const;
         size_t                          GetVertexAttributesBitField() const;
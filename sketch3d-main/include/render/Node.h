@@ -8,12 +8,14 @@
 #include "system/Platform.h"
 
 #include <map>
+#include <stdint.h>
 #include <string>
+#include <vector>
 using namespace std;
 
 namespace Sketch3D {
 // Forward struct declaration
-struct FrustumPlanes_t;
+struct BoundingSpheres_t;
 
 // Forward class declaration
 class Material;
@@ -25,6 +27,7 @@ class RenderQueue;
  * This class provides the base functionnality of a node the SceneTree
  */
 class SKETCH_3D_API Node {
+    friend class RenderQueue;
     friend class SceneTree;
 
 	public:
@@ -156,6 +159,12 @@ class SKETCH_3D_API Node {
          */
         Matrix4x4           ConstructModelMatrix();
 
+        /**
+         * Construct the matrix used to transform the normals of this node, that is the transposed inverse of the
+         * model matrix. It is cached and only recomputed when the transformation of the node or of its parent changes
+         */
+        const Matrix4x4&    ConstructNormalMatrix();
+
 		void				SetParent(Node* parent);
 		void				SetPosition(const Vector3& position);
 		void				SetScale(const Vector3& scale);
@@ -177,6 +186,7 @@ class SKETCH_3D_API Node {
 
 	private:
 		static long long	nextNameIndex_;	/**< The next available number for the automatic name */
+        static const unsigned int   identityTransformationVersion_; /**< Version of the identity transformation used when there is no parent */
 
 		string				name_;		/**< The name of this node */
 		Node*				parent_;	/**< The parent of this node */
@@ -187,24 +197,38 @@ class SKETCH_3D_API Node {
 		Quaternion			orientation_;	/**< The orientation of this node */
 
         const Matrix4x4*    parentTransformation_;  /**< Transformation matrix from the parent */
+        const unsigned int* parentTransformationVersion_;   /**< Version of the transformation matrix from the parent */
 		Matrix4x4			cachedTransformation_;	/**< The cached matrix transformation */
+        unsigned int        transformationVersion_; /**< Incremented every time the cached transformation changes */
         bool                needTransformationUpdate_;
 
+        Matrix4x4           cachedNormalMatrix_;        /**< The cached transposed inverse of the model matrix */
+        unsigned int        normalMatrixVersion_;       /**< transformationVersion_ when the normal matrix was computed */
+        unsigned int        normalMatrixParentVersion_; /**< Parent's version when the normal matrix was computed */
+
 		Mesh*				mesh_; /**< Geometric represention of the node */
 		Material*			material_; /**< The material of the node. It will be applied to the mesh, if any */
         
         bool                useInstancing_; /**< If set to true, the node will use instanced rendering */
         bool                isStatic_;      /**< If set to true, the node will be batched with other static nodes */
 
+        unsigned int        stateVersion_;      /**< Incremented every time the mesh, material or rendering options change */
+        RenderQueue*        renderQueue_;       /**< The retained render queue in which the node has an entry, if any */
+        uint32_t            renderQueueEntry_;  /**< Index of the node's entry in the retained render queue */
+
 		/**
-		 * This function sends the data required for the rendering.
-         * @param frustumPlanes The 6 view frustum planes to cull nodes
-         * @param useFrustumCulling If set to true, the frustum planes will be used to cull this node
-         * @param opaqueRenderQueue The render queue to use for drawing opaque objects
-         * @param transparentRenderQueue The render queue to use for drawing transparent objects
+		 * Gather this node and its children if they have to be added to the render queues
+         * @param nodes The list to which the nodes to render are appended
+         * @param boundingSpheres If not null, the world space bounding spheres of the nodes are appended to it, in
+         * the same order as the nodes, so that they can be culled all at once
 		 */
-		void                Render(const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling, RenderQueue& opaqueRenderQueue,
-                                   RenderQueue& transparentRenderQueue);
+		void                CollectRenderableNodes(vector<Node*>& nodes, BoundingSpheres_t* boundingSpheres);
+
+        /**
+         * Append the world space bounding sphere of the node's mesh
+         * @param boundingSpheres The list to which the bounding sphere is appended
+         */
+        void                AddBoundingSphere(BoundingSpheres_t& boundingSpheres);
 };
 
 }
@@ -0,0 +1,48 @@
+#ifndef SKETCH_3D_BUFFER_OBJECT_MANAGER_NULL_H
+#define SKETCH_3D_BUFFER_OBJECT_MANAGER_NULL_H
+
+#include "render/BufferObjectManager.h"
+
+#include <map>
+#include <utility>
+using namespace std;
+
+namespace Sketch3D {
+
+// Forward declaration
+struct ApiCallCounters_t;
+struct FrameStats_t;
+
+/**
+ * @class BufferObjectManagerNull
+ * Null implementation of the buffer object manager
+ */
+class BufferObjectManagerNull : public BufferObjectManager {
+    public:
+                                BufferObjectManagerNull(ApiCallCounters_t* apiCallCounters, FrameStats_t* frameStats, bool useSharedStorage);
+
+        virtual BufferObject*   CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage=BUFFER_USAGE_STATIC);
+
+        /**
+         * Returns the id of the storage shared by the buffer objects with the given vertex layout and index format, or 0
+         * if the buffer objects can't share their storage
+         * @param vertexAttributes The vertex attributes of the buffer object
+         * @param presentVertexAttributes Bitfield specifying what vertex attributes are actually present
+         * @param indexFormat The format of the indices of the buffer object
+         */
+        size_t                  GetSharedStorageId(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes,
+                                                   IndexFormat_t indexFormat);
+
+    private:
+        typedef pair<VertexAttributesMap_t, int>    VertexLayout_t;
+        typedef pair<VertexLayout_t, IndexFormat_t> SharedStorageKey_t;
+
+        ApiCallCounters_t*      apiCallCounters_;   /**< Counters of the render system that created this manager */
+        FrameStats_t*           frameStats_;        /**< Frame counters of the render system that created this manager */
+        bool                    useSharedStorage_;  /**< Can the static shared buffer objects share their storage? */
+        map<SharedStorageKey_t, size_t> sharedStorageIds_;  /**< Id of the shared storage of each vertex layout and index format */
+};
+
+}
+
+#endif
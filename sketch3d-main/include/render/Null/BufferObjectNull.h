@@ -0,0 +1,43 @@
+#ifndef SKETCH_3D_BUFFER_OBJECT_NULL_H
+#define SKETCH_3D_BUFFER_OBJECT_NULL_H
+
+#include "render/BufferObject.h"
+
+namespace Sketch3D {
+
+// Forward declaration
+struct ApiCallCounters_t;
+class BufferObjectManagerNull;
+struct FrameStats_t;
+
+/**
+ * @class BufferObjectNull
+ * Buffer object that doesn't store its data anywhere. It only keeps track of its size to report the
+ * same errors as the other implementations
+ */
+class BufferObjectNull : public BufferObject {
+    public:
+                                    BufferObjectNull(BufferObjectManagerNull* manager, ApiCallCounters_t* apiCallCounters, FrameStats_t* frameStats,
+                                                     const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage=BUFFER_USAGE_STATIC);
+
+        virtual                    ~BufferObjectNull();
+
+        virtual void                Render();
+        virtual void                RenderInstances(const vector<Matrix4x4>& modelMatrices);
+        virtual void                RenderIndirect(const DrawIndirectCommand_t* commands, size_t numCommands,
+                                                   const vector<Matrix4x4>& modelMatrices);
+        virtual BufferObjectError_t SetVertexData(const vector<float>& vertexData, int presentVertexAttributes);
+        virtual BufferObjectError_t AppendVertexData(const vector<float>& vertexData, int presentVertexAttributes);
+        virtual BufferObjectError_t SetIndexData(unsigned int* indexData, size_t numIndex);
+        virtual BufferObjectError_t AppendIndexData(unsigned int* indexData, size_t numIndex);
+        virtual void                PrepareInstanceBuffers();
+
+    private:
+        BufferObjectManagerNull*    manager_;           /**< The manager that created this buffer */
+        ApiCallCounters_t*          apiCallCounters_;   /**< Counters of the render system that created this buffer */
+        FrameStats_t*               frameStats_;        /**< Frame counters of the render system that created this buffer */
+};
+
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SKETCH_3D_RENDER_STATE_CACHE_NULL_H
+#define SKETCH_3D_RENDER_STATE_CACHE_NULL_H
+
+#include "render/RenderStateCache.h"
+
+namespace Sketch3D {
+
+// Forward declaration
+struct ApiCallCounters_t;
+
+/**
+ * @class RenderStateCacheNull
+ * Null implementation of the RenderStateCache. Every state that would be sent to the device is counted
+ */
+class RenderStateCacheNull : public RenderStateCache {
+    public:
+                            RenderStateCacheNull(ApiCallCounters_t* apiCallCounters, FrameStats_t* frameStats);
+        virtual            ~RenderStateCacheNull();
+
+    protected:
+        virtual void        EnableDepthTestImpl();
+        virtual void        EnableDepthWriteImpl();
+        virtual void        EnableColorWriteImpl();
+        virtual void        EnableBlendingImpl();
+        virtual void        SetDepthComparisonFuncImpl();
+        virtual void        SetCullingMethodImpl();
+        virtual void        SetBlendingEquationImpl();
+        virtual void        SetBlendingFactorImpl();
+        virtual void        SetRenderFillModeImpl();
+
+    private:
+        ApiCallCounters_t*  apiCallCounters_;   /**< Counters of the render system that created this cache */
+};
+
+}
+
+#endif
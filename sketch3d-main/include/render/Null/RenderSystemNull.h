@@ -0,0 +1,85 @@
+#ifndef SKETCH_3D_RENDER_SYSTEM_NULL_H
+#define SKETCH_3D_RENDER_SYSTEM_NULL_H
+
+#include "render/RenderSystem.h"
+
+namespace Sketch3D {
+
+/**
+ * @struct ApiCallCounters_t
+ * Number of calls that were made to the null render system. Each counter corresponds to a call (or a group of
+ * calls) that a real rendering API would have to perform
+ */
+struct SKETCH_3D_API ApiCallCounters_t {
+                ApiCallCounters_t() { Reset(); }
+
+    size_t      clears;             /**< Number of times the framebuffer was cleared */
+    size_t      presentedFrames;    /**< Number of frames presented to the front buffer */
+    size_t      viewportChanges;    /**< Number of times the viewport was set */
+    size_t      stateChanges;       /**< Number of render states that were sent to the device */
+    size_t      shaderCompilations; /**< Number of shader programs created */
+    size_t      shaderLinks;        /**< Number of shader programs whose link was finished */
+    size_t      shaderBinds;        /**< Number of times a different shader was bound */
+    size_t      uniformUpdates;     /**< Number of uniforms set on the shaders */
+    size_t      textureBinds;       /**< Number of textures bound to a texture unit */
+    size_t      textureUploads;     /**< Number of times pixel data was sent to a texture */
+    size_t      renderTargetBinds;  /**< Number of times a render texture or the screen buffer was bound */
+    size_t      bufferUploads;      /**< Number of times vertex, index or instance data was sent to a buffer */
+    size_t      drawCalls;          /**< Number of non-instanced draw calls */
+    size_t      instancedDrawCalls; /**< Number of instanced draw calls */
+    size_t      drawnInstances;     /**< Number of instances drawn by the instanced draw calls */
+    size_t      indirectDrawCalls;  /**< Number of indirect draw calls */
+    size_t      indirectDraws;      /**< Number of draws made by the indirect draw calls */
+    size_t      drawnIndices;       /**< Number of indices drawn by all the draw calls */
+
+    void        Reset();
+};
+
+/**
+ * @class RenderSystemNull
+ * Render system that doesn't touch the GPU. It only counts the calls that are made to it, which makes it possible to
+ * measure the CPU cost of a frame on machines that have no window or no graphics device
+ */
+class SKETCH_3D_API RenderSystemNull : public RenderSystem {
+	public:
+        /**
+         * Constructor
+         * @param width The width of the virtual screen
+         * @param height The height of the virtual screen
+         */
+        RenderSystemNull(unsigned int width, unsigned int height);
+		virtual ~RenderSystemNull();
+		virtual bool Initialize(const RenderParameters_t& renderParameters);
+		virtual void SetClearColor(float red, float green, float blue, float alpha=1.0f);
+		virtual void Clear(int buffer) const;
+        virtual void StartRender();
+		virtual void EndRender();
+        virtual void PresentFrame();
+        virtual Matrix4x4 OrthoProjection(float left, float right, float bottom, float top, float nearPlane, float farPlane) const;
+        virtual Matrix4x4 PerspectiveProjection(float left, float right, float bottom, float top, float nearPlane, float farPlane) const;
+        virtual void SetViewport(size_t x, size_t y, size_t width, size_t height);
+        virtual Shader* CreateShader();
+        virtual Texture2D* CreateTexture2D() const;
+        virtual Texture3D* CreateTexture3D() const;
+        virtual RenderTexture* CreateRenderTexture(unsigned int width, unsigned int height, TextureFormat_t format);
+        virtual void BindScreenBuffer() const;
+        virtual size_t BindTexture(const Texture* texture);
+        virtual void BindShader(const Shader* shader);
+        virtual FrustumPlanes_t ExtractViewFrustumPlanes(const Matrix4x4& viewProjection) const;
+        virtual void EnableDeferredShaderCompilation(bool val);
+
+        const ApiCallCounters_t& GetApiCallCounters() const { return apiCallCounters_; }
+        void ResetApiCallCounters() { apiCallCounters_.Reset(); }
+
+	private:
+        mutable ApiCallCounters_t apiCallCounters_;   /**< Calls made to the render system and to the objects it created */
+        bool                    deferShaderLinks_;      /**< Do the shaders wait for their link only when they are used? */
+
+        virtual void QueryDeviceCapabilities();
+        virtual void CreateTextShader();
+        virtual void UploadCameraUniforms();
+};
+
+}
+
+#endif
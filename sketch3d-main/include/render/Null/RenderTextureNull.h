@@ -0,0 +1,48 @@
+#ifndef SKETCH_3D_RENDER_TEXTURE_NULL_H
+#define SKETCH_3D_RENDER_TEXTURE_NULL_H
+
+#include "render/RenderTexture.h"
+
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+// Forward declaration
+struct ApiCallCounters_t;
+
+/**
+ * @class RenderTextureNull
+ * Render texture that validates its attachments like the other implementations but doesn't create any framebuffer
+ */
+class RenderTextureNull : public RenderTexture {
+    public:
+        /**
+         * Constructor
+         * @param apiCallCounters Counters of the render system that created this render texture
+         * @param width The width of the render texture
+         * @param height The height of the render texture
+         * @param format The format of the render texture
+         */
+                            RenderTextureNull(ApiCallCounters_t* apiCallCounters, unsigned int width, unsigned int height,
+                                              TextureFormat_t format);
+
+        virtual            ~RenderTextureNull();
+
+        virtual bool        AddDepthBuffer();
+        virtual Texture2D*  CreateTexture2D() const;
+        virtual Texture2D*  CreateDepthBufferTexture() const;
+        virtual bool        AttachTextureToDepthBuffer(Texture2D* texture);
+        virtual bool        AttachTextures(const vector<Texture2D*>& textures);
+        virtual void        Bind() const;
+
+    private:
+        ApiCallCounters_t*  apiCallCounters_;   /**< Counters of the render system that created this render texture */
+        bool                hasDepthRenderbuffer_;  /**< Set to true if AddDepthBuffer was called */
+        vector<Texture2D*>  textures_;   /**< The textures used to receive the output of the rendering */
+        static int          numGeneratedTextures_;
+};
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef SKETCH_3D_SHADER_NULL_H
+#define SKETCH_3D_SHADER_NULL_H
+
+#include "render/Shader.h"
+
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+namespace Sketch3D {
+
+// Forward declaration
+struct ApiCallCounters_t;
+struct FrameStats_t;
+
+/**
+ * @class ShaderNull
+ * Shader that doesn't compile anything. Every uniform exists, setting one always succeeds and is counted
+ */
+class ShaderNull : public Shader {
+    friend class RenderSystemNull;
+
+	public:
+        /**
+         * Constructor
+         * @param apiCallCounters The counters of the render system
+         * @param frameStats The frame counters of the render system
+         * @param deferLink If true, a link started by setting the source is only finished when the shader is first bound
+         * or one of its uniforms is looked up, like the deferred links of the OpenGL render system
+         */
+		ShaderNull(ApiCallCounters_t* apiCallCounters, FrameStats_t* frameStats, bool deferLink);
+        virtual ~ShaderNull();
+
+        virtual bool SetSourceFile(const string& vertexFilename, const string& fragmentFilename);
+        virtual bool SetSource(const string& vertexSource, const string& fragmentSource);
+
+        virtual UniformHandle_t GetUniformHandle(const string& uniform) const;
+        virtual bool IsLinkPending() const;
+
+    protected:
+        virtual void SetUniformIntImpl(UniformHandle_t uniform, int value);
+        virtual void SetUniformFloatImpl(UniformHandle_t uniform, float value);
+        virtual void SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2);
+        virtual void SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value);
+        virtual void SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize);
+        virtual void SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value);
+        virtual void SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value);
+        virtual void SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value);
+        virtual void SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize);
+        virtual void SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture);
+
+	private:
+        ApiCallCounters_t*  apiCallCounters_;   /**< Counters of the render system that created this shader */
+        FrameStats_t*       frameStats_;        /**< Frame counters of the render system that created this shader */
+        bool                deferLink_;         /**< Is the link only finished when the shader is needed? */
+        bool                linkPending_;       /**< Was the source set without finishing the link yet? */
+        mutable unordered_map<string, UniformHandle_t> nameToUniforms_;  /**< Handles given to the uniforms so far */
+
+        /**
+         * Start the link of the program, which is finished right away unless the links are deferred
+         */
+        void    StartLink();
+
+        /**
+         * Finish the link of the program, which resolves the builtin uniforms and counts the link
+         */
+        void    FinishLink();
+};
+
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef SKETCH_3D_TEXTURE_2D_NULL_H
+#define SKETCH_3D_TEXTURE_2D_NULL_H
+
+#include "render/Texture2D.h"
+
+namespace Sketch3D {
+
+// Forward declaration
+struct ApiCallCounters_t;
+
+/**
+ * @class Texture2DNull
+ * 2D texture that only lives in main memory
+ */
+class Texture2DNull : public Texture2D {
+    public:
+        /**
+         * Constructor
+         * @param apiCallCounters Counters of the render system that created this texture
+         * @param generateMipmaps If set to true, generate mipmaps for this texture
+         */
+                            Texture2DNull(ApiCallCounters_t* apiCallCounters, bool generateMipmaps=false);
+
+        virtual            ~Texture2DNull();
+
+        /**
+         * Create the actual texture handle
+         * @return true if the texture was created correctly
+         */
+        virtual bool        Create();
+
+        /**
+         * Get the data from the texture. Since nothing is kept on a device, this is null unless the texture was loaded from a file
+         */
+        virtual const void* GetData() const;
+
+    private:
+        ApiCallCounters_t*  apiCallCounters_;   /**< Counters of the render system that created this texture */
+
+        virtual void        SetFilterModeImpl() const;
+        virtual void        SetWrapModeImpl() const;
+        virtual void        SetPixelDataBytesImp(unsigned char* data);
+        virtual void        SetPixelDataFloatsImp(float* data);
+};
+
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SKETCH_3D_TEXTURE_3D_NULL_H
+#define SKETCH_3D_TEXTURE_3D_NULL_H
+
+#include "render/Texture3D.h"
+
+namespace Sketch3D {
+
+// Forward declaration
+struct ApiCallCounters_t;
+
+/**
+ * @class Texture3DNull
+ * 3D texture that only lives in main memory
+ */
+class Texture3DNull : public Texture3D {
+    public:
+        /**
+         * Constructor
+         * @param apiCallCounters Counters of the render system that created this texture
+         * @param generateMipmaps If set to true, generate mipmaps for this texture
+         */
+                            Texture3DNull(ApiCallCounters_t* apiCallCounters, bool generateMipmaps=false);
+
+        virtual            ~Texture3DNull();
+
+        /**
+         * Create the actual texture handle
+         * @return true if the texture was created correctly
+         */
+        virtual bool        Create();
+
+    private:
+        ApiCallCounters_t*  apiCallCounters_;   /**< Counters of the render system that created this texture */
+
+        virtual void        SetFilterModeImpl() const;
+        virtual void        SetWrapModeImpl() const;
+        virtual void        SetPixelDataBytesImp(unsigned char* data);
+        virtual void        SetPixelDataFloatsImp(float* data);
+};
+
+}
+
+#endif
@@ -3,17 +3,65 @@
 
 #include "render/BufferObjectManager.h"
 
+#include <map>
+#include <utility>
+using namespace std;
+
 namespace Sketch3D {
 
+// Forward declaration
+struct FrameStats_t;
+class RenderStateCacheOpenGL;
+class SharedBufferStorageOpenGL;
+
 /**
  * @class BufferObjectManagerOpenGL
- * OpenGL implementation of the buffer object manager
+ * OpenGL implementation of the buffer object manager. It also owns the storages shared by the static shared buffer
+ * objects
  */
 class BufferObjectManagerOpenGL : public BufferObjectManager {
     public:
+        /**
+         * Constructor
+         * @param useSharedStorage Can the static shared buffer objects share their storage? Requires indirect draws
+         * @param frameStats The counters of the render system in which the uploaded bytes are counted
+         * @param renderStateCache The cache through which the buffers are bound
+         */
+                              BufferObjectManagerOpenGL(bool useSharedStorage, FrameStats_t* frameStats,
+                                                        RenderStateCacheOpenGL* renderStateCache);
+
+        /**
+         * Destructor - releases the shared storages
+         */
+        virtual              ~BufferObjectManagerOpenGL();
+
         virtual BufferObject* CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage=BUFFER_USAGE_STATIC);
+
+        /**
+         * Returns the storage shared by the buffer objects with the given vertex layout and index format, creating it if
+         * needed
+         * @param vertexAttributes The vertex attributes of the buffer object
+         * @param presentVertexAttributes Bitfield specifying what vertex attributes are actually present
+         * @param stride The size of a single vertex in bytes
+         * @param indexFormat The format of the indices of the buffer object
+         * @return The shared storage, or null if the buffer objects can't share their storage
+         */
+        SharedBufferStorageOpenGL*  GetSharedStorage(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes, size_t stride,
+                                                     IndexFormat_t indexFormat);
+
+        FrameStats_t*         GetFrameStats() const { return frameStats_; }
+        RenderStateCacheOpenGL* GetRenderStateCache() const { return renderStateCache_; }
+
+    private:
+        typedef pair<VertexAttributesMap_t, int>    VertexLayout_t;
+        typedef pair<VertexLayout_t, IndexFormat_t> SharedStorageKey_t;
+
+        bool                  useSharedStorage_;  /**< Can the static shared buffer objects share their storage? */
+        FrameStats_t*         frameStats_;        /**< Counters of the render system that created this manager */
+        RenderStateCacheOpenGL* renderStateCache_;  /**< Render state cache of the render system that created this manager */
+        map<SharedStorageKey_t, SharedBufferStorageOpenGL*> sharedStorages_;    /**< The shared storage of each vertex layout and index format */
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -8,23 +8,37 @@
 
 namespace Sketch3D {
 
+// Forward declaration
+class BufferObjectManagerOpenGL;
+struct FrameStats_t;
+class RenderStateCacheOpenGL;
+class SharedBufferStorageOpenGL;
+
 /**
  * @class BufferObjectOpenGL
- * OpenGL implementation of vertex paired with an index buffer
+ * OpenGL implementation of vertex paired with an index buffer. The static shared buffer objects live in a range of a
+ * SharedBufferStorageOpenGL instead of having their own buffers when indirect draws are supported
  */
 class BufferObjectOpenGL : public BufferObject {
     public:
-                                    BufferObjectOpenGL(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage=BUFFER_USAGE_STATIC);
+                                    BufferObjectOpenGL(BufferObjectManagerOpenGL* manager, const VertexAttributesMap_t& vertexAttributes,
+                                                       BufferUsage_t usage=BUFFER_USAGE_STATIC);
         virtual                    ~BufferObjectOpenGL();
         virtual void                Render();
         virtual void                RenderInstances(const vector<Matrix4x4>& modelMatrices);
+        virtual void                RenderIndirect(const DrawIndirectCommand_t* commands, size_t numCommands,
+                                                   const vector<Matrix4x4>& modelMatrices);
         virtual BufferObjectError_t SetVertexData(const vector<float>& vertexData, int presentVertexAttributes);
         virtual BufferObjectError_t AppendVertexData(const vector<float>& vertexData, int presentVertexAttributes);
-        virtual BufferObjectError_t SetIndexData(unsigned short* indexData, size_t numIndex);
-        virtual BufferObjectError_t AppendIndexData(unsigned short* indexData, size_t numIndex);
+        virtual BufferObjectError_t SetIndexData(unsigned int* indexData, size_t numIndex);
+        virtual BufferObjectError_t AppendIndexData(unsigned int* indexData, size_t numIndex);
         virtual void                PrepareInstanceBuffers();
 
     private:
+        BufferObjectManagerOpenGL*  manager_;   /**< The manager that created this buffer object */
+        FrameStats_t*               frameStats_;    /**< Counters of the render system, in which the uploaded bytes are counted */
+        RenderStateCacheOpenGL*     renderStateCache_;  /**< Cache through which the buffers are bound */
+        SharedBufferStorageOpenGL*  sharedStorage_; /**< The storage in which the data is, null if the buffer object has its own buffers */
         GLuint                      vao_;   /**< Vertex array object */
         GLuint                      vbo_;   /**< Vertex buffer object */
         GLuint                      ibo_;   /**< infex buffer object */
@@ -34,8 +48,36 @@ class BufferObjectOpenGL : public BufferObject {
          * Generate the buffers' name
          */
         void                        GenerateBuffers();
+
+        /**
+         * Move the data of the buffer object to the shared storage using another index format, when its vertices can't
+         * be addressed with the index format of its current shared storage anymore
+         * @param indexFormat The index format required by the vertices of the buffer object
+         * @param presentVertexAttributes Bitfield specifying what vertex attributes are actually present
+         * @param moveVertices Are the vertices moved too? If not, they have to be set again
+         */
+        void                        ChangeSharedStorage(IndexFormat_t indexFormat, int presentVertexAttributes, bool moveVertices);
 };
 
+/**
+ * Set the vertex attribute pointers of the bound vertex array object for the interleaved data of the bound vertex buffer
+ * @param vertexAttributes The vertex attributes and their locations
+ * @param presentVertexAttributes Bitfield specifying what vertex attributes are actually present
+ * @param stride The size of a single vertex in bytes
+ */
+void SetVertexAttributePointersOpenGL(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes, size_t stride);
+
+/**
+ * Set the per instance attribute pointers of the model matrix of the bound vertex array object to the bound buffer
+ * @param vertexAttributes The vertex attributes and their locations. The model matrix uses the following locations
+ */
+void SetInstanceAttributePointersOpenGL(const VertexAttributesMap_t& vertexAttributes);
+
+/**
+ * Returns the OpenGL type of the indices of an index format
+ */
+GLenum GetIndexTypeOpenGL(IndexFormat_t format);
+
 }
 
 #endif
\ No newline at end of file
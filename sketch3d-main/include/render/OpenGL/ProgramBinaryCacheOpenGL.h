@@ -0,0 +1,71 @@
+#ifndef SKETCH_3D_PROGRAM_BINARY_CACHE_OPENGL_H
+#define SKETCH_3D_PROGRAM_BINARY_CACHE_OPENGL_H
+
+#include "gl/glew.h"
+
+#include <stdint.h>
+#include <string>
+using namespace std;
+
+namespace Sketch3D {
+
+/**
+ * @class ProgramBinaryCacheOpenGL
+ * Stores the binaries of the linked shader programs in a directory, so that the programs can be loaded instead of
+ * being compiled and linked again the next time the application starts. The binaries are keyed by a hash of the
+ * shader sources and of the driver, since a binary can only be loaded by the driver that created it
+ */
+class ProgramBinaryCacheOpenGL {
+    public:
+        /**
+         * Constructor. The cache is disabled until a directory is set
+         */
+                        ProgramBinaryCacheOpenGL();
+
+        /**
+         * Set the directory where the binaries are stored. The directory has to exist
+         * @param directory The cache directory. If empty, the cache is disabled
+         */
+        void            SetDirectory(const string& directory);
+
+        /**
+         * Is the cache enabled? It requires a directory and a driver able to retrieve the program binaries
+         */
+        bool            IsEnabled() const;
+
+        /**
+         * Compute the key of a program
+         * @param vertexSource The source code of the vertex shader
+         * @param fragmentSource The source code of the fragment shader
+         * @return The key under which the binary of the program is stored
+         */
+        uint64_t        ComputeKey(const string& vertexSource, const string& fragmentSource) const;
+
+        /**
+         * Load a program from its cached binary
+         * @param program The program object in which the binary is loaded
+         * @param key The key of the program
+         * @return true if the binary was found and accepted by the driver, false if the program has to be built
+         */
+        bool            LoadProgram(GLuint program, uint64_t key) const;
+
+        /**
+         * Store the binary of a linked program in the cache
+         * @param program The linked program
+         * @param key The key of the program
+         */
+        void            SaveProgram(GLuint program, uint64_t key) const;
+
+    private:
+        string          directory_;     /**< Directory of the cached binaries. Empty if the cache is disabled */
+        mutable uint64_t driverHash_;   /**< Hash of the vendor, renderer and version strings of the driver */
+
+        /**
+         * Returns the name of the file holding the binary of a program
+         */
+        string          GetFilename(uint64_t key) const;
+};
+
+}
+
+#endif
@@ -14,6 +14,13 @@ class RenderContextOpenGL : public RenderContext {
 	public:
 		virtual bool Initialize(Window& window, const RenderParameters_t& renderParameters) = 0;
 		virtual void SwapBuffers() = 0;
+
+        /**
+         * Returns the address of an OpenGL function that GLEW doesn't load
+         * @param name The name of the function
+         * @return The address of the function, nullptr if the driver doesn't have it
+         */
+        virtual void* GetFunctionAddress(const char* name) const = 0;
 };
 
 }
@@ -3,17 +3,66 @@
 
 #include "render/RenderStateCache.h"
 
+#include "render/OpenGL/gl/glew.h"
+
 namespace Sketch3D {
 
 /**
  * @class RenderStateCacheOpenGL
- * OpenGL implementation of the RenderStateCache
+ * OpenGL implementation of the RenderStateCache. It also shadows the object bindings of the context, which, unlike the
+ * render states, are applied immediately since the OpenGL calls that follow them depend on them. All the OpenGL code
+ * binds its objects through this cache so that the bindings it knows about are the ones of the context
  */
 class RenderStateCacheOpenGL : public RenderStateCache {
     public:
-                        RenderStateCacheOpenGL();
+                        RenderStateCacheOpenGL(FrameStats_t* frameStats);
         virtual        ~RenderStateCacheOpenGL();
 
+        /**
+         * Bind a vertex array object if it isn't already bound
+         * @param vertexArray The name of the vertex array object
+         */
+        void            BindVertexArray(GLuint vertexArray);
+
+        /**
+         * Bind a buffer to GL_ARRAY_BUFFER if it isn't already bound
+         * @param buffer The name of the buffer
+         */
+        void            BindArrayBuffer(GLuint buffer);
+
+        /**
+         * Bind a buffer to GL_ELEMENT_ARRAY_BUFFER if it isn't already bound. This binding is part of the bound vertex
+         * array object
+         * @param buffer The name of the buffer
+         */
+        void            BindElementArrayBuffer(GLuint buffer);
+
+        /**
+         * Select the texture unit affected by the texture bindings if it isn't already selected
+         * @param unit The index of the texture unit
+         */
+        void            SetActiveTextureUnit(GLuint unit);
+
+        /**
+         * Bind a framebuffer if it isn't already bound
+         * @param target GL_DRAW_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_FRAMEBUFFER for both
+         * @param framebuffer The name of the framebuffer, 0 for the screen
+         */
+        void            BindFramebuffer(GLenum target, GLuint framebuffer);
+
+        /**
+         * Set the viewport if it isn't already set
+         */
+        void            SetViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+        /**
+         * Forget the bindings of objects that are about to be deleted, since OpenGL unbinds them. Otherwise, a new
+         * object reusing the name wouldn't be bound
+         */
+        void            OnVertexArrayDeleted(GLuint vertexArray);
+        void            OnBufferDeleted(GLuint buffer);
+        void            OnFramebufferDeleted(GLuint framebuffer);
+
     protected:
         virtual void    EnableDepthTestImpl();
         virtual void    EnableDepthWriteImpl();
@@ -26,6 +75,16 @@ class RenderStateCacheOpenGL : public RenderStateCache {
         virtual void    SetRenderFillModeImpl();
 
     private:
+        static const GLuint UNKNOWN_BINDING = 0xFFFFFFFF;
+
+        GLuint          vertexArray_;         /**< Bound vertex array object */
+        GLuint          arrayBuffer_;         /**< Buffer bound to GL_ARRAY_BUFFER */
+        GLuint          elementArrayBuffer_;  /**< Buffer bound to GL_ELEMENT_ARRAY_BUFFER, UNKNOWN_BINDING when the vertex array object changed */
+        GLuint          activeTextureUnit_;   /**< Texture unit selected with glActiveTexture */
+        GLuint          drawFramebuffer_;     /**< Framebuffer bound to GL_DRAW_FRAMEBUFFER */
+        GLuint          readFramebuffer_;     /**< Framebuffer bound to GL_READ_FRAMEBUFFER */
+        GLint           viewport_[4];         /**< x, y, width and height of the viewport. The width is negative until it's set */
+
         unsigned int    GetBlendingFactor(BlendingFactor_t factor) const;
 };
 }
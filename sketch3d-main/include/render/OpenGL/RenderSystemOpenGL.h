@@ -3,18 +3,22 @@
 
 #include "render/RenderSystem.h"
 
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
 namespace Sketch3D {
 
 // Forward declaration
+class ProgramBinaryCacheOpenGL;
 class RenderContextOpenGL;
+class RenderStateCacheOpenGL;
 
 /**
  * @class RenderSystem
  * OpenGL implementation of the render system
  */
 class RenderSystemOpenGL : public RenderSystem {
-    typedef map<const Texture2D*, pair<size_t, size_t>> TextureCacheMap_t;
-
 	public:
         RenderSystemOpenGL(Window& window);
 		virtual ~RenderSystemOpenGL();
@@ -35,31 +39,69 @@ class RenderSystemOpenGL : public RenderSystem {
         virtual size_t BindTexture(const Texture* texture);
         virtual void BindShader(const Shader* shader);
         virtual FrustumPlanes_t ExtractViewFrustumPlanes(const Matrix4x4& viewProjection) const;
+        virtual void SetShaderCacheDirectory(const string& directory);
+        virtual void EnableDeferredShaderCompilation(bool val);
 
 	private:
         /**
-         * @struct TextureUnitNode_t
-         * This texture serves as an element for the texture unit cache. All that it contains is
-         * a pointer to the next element and the texture unit it refers to. It is used as a single
-         * linked list
+         * @struct TextureUnit_t
+         * Element of the texture unit cache. The units are kept in a double linked list, by index, ordered from the
+         * least recently used one to the most recently used one
+         */
+        struct TextureUnit_t {
+            uint32_t        generation; /**< Incremented each time another texture is bound to the unit */
+            unsigned int    sampler;    /**< Sampler object bound to the unit */
+            uint32_t        prev;       /**< Index of the previous unit in the list, NO_TEXTURE_UNIT for the head */
+            uint32_t        next;       /**< Index of the next unit in the list, NO_TEXTURE_UNIT for the tail */
+        };
+
+        /**
+         * @struct TextureUnitSlot_t
+         * Unit on which a texture was last bound. The texture is still bound if the generation of the unit didn't change
          */
-        struct TextureUnitNode_t {
-            size_t              textureUnit;
-            TextureUnitNode_t*  next;
-            TextureUnitNode_t*  prev;
+        struct TextureUnitSlot_t {
+            uint32_t    unit;       /**< Unit on which the texture was bound, NO_TEXTURE_UNIT if it never was */
+            uint32_t    generation; /**< Generation of the unit when the texture was bound */
         };
-        typedef map<size_t, TextureUnitNode_t*> TextureCache_t;
+
+        static const uint32_t   NO_TEXTURE_UNIT = 0xFFFFFFFF;
+        static const size_t     NUM_SAMPLERS = 2 * 3 * 2 * 2;   /**< Filter modes * wrap modes * mipmaps * depth comparison */
 
 		RenderContextOpenGL*	renderContext_;	/**< The render context to create for OpenGL */
+        RenderStateCacheOpenGL* renderStateCacheOpenGL_;    /**< renderStateCache_, which also shadows the object bindings */
 
-		TextureCacheMap_t	    textures_;		/**< Texture mapped to the API representation of the texture */
+        vector<TextureUnit_t>   textureUnits_;          /**< The texture units of the device */
+        vector<TextureUnitSlot_t> textureSlots_;        /**< Unit of each texture, indexed by the id of the texture */
+        uint32_t                leastRecentlyUsedUnit_; /**< Head of the list of texture units, the next one to be reused */
+        uint32_t                mostRecentlyUsedUnit_;  /**< Tail of the list of texture units */
+        unsigned int            samplers_[NUM_SAMPLERS]; /**< Sampler objects shared by the textures, 0 if sampler objects aren't supported */
 
-        TextureUnitNode_t*      head_;                  /**< Head of the double linked list */
-        TextureUnitNode_t*      tail_;                  /**< Tail of the double linked list */
-        TextureCache_t          textureCache_;          /**< Texture pointers refer directly to a cache element for faster lookup */
+        unsigned int            cameraUniformBuffer_;   /**< Uniform buffer bound to the camera uniform block binding point */
+        ProgramBinaryCacheOpenGL* programCache_;        /**< Cache of the binaries of the linked shader programs */
+        bool                    deferShaderLinks_;      /**< Do the shaders wait for their link only when they are used? */
+        void*                   maxShaderCompilerThreads_;  /**< glMaxShaderCompilerThreadsKHR, nullptr if GL_KHR_parallel_shader_compile isn't supported */
 
         virtual void QueryDeviceCapabilities();
+
+        /**
+         * Create one sampler object per combination of filter mode, wrap mode, mipmapping and depth comparison
+         */
+        void CreateSamplers();
+
+        /**
+         * Get the sampler object matching the sampling state of a texture
+         * @param texture The texture to sample
+         * @return The sampler object, 0 if sampler objects aren't supported
+         */
+        unsigned int GetSampler(const Texture* texture) const;
+
+        /**
+         * Move a texture unit at the end of the list of texture units
+         * @param unit The index of the unit that was just used
+         */
+        void TouchTextureUnit(uint32_t unit);
         virtual void CreateTextShader();
+        virtual void UploadCameraUniforms();
 };
 
 }
@@ -8,6 +8,9 @@ using namespace std;
 
 namespace Sketch3D {
 
+// Forward declaration
+class RenderStateCacheOpenGL;
+
 /**
  * @class RenderTextureOpenGL
  * Implements a render texture using the OpenGL API
@@ -19,8 +22,10 @@ class RenderTextureOpenGL : public RenderTexture {
          * @param width The width of the render texture
          * @param height The height of the render texture
          * @param format The format of the render texture
+         * @param renderStateCache The cache through which the framebuffer is bound
          */
-                            RenderTextureOpenGL(unsigned int width, unsigned int height, TextureFormat_t format);
+                            RenderTextureOpenGL(unsigned int width, unsigned int height, TextureFormat_t format,
+                                                RenderStateCacheOpenGL* renderStateCache);
 
         /**
          * Destructor
@@ -67,6 +72,7 @@ class RenderTextureOpenGL : public RenderTexture {
         virtual void        Bind() const;
 
     private:
+        RenderStateCacheOpenGL* renderStateCache_;  /**< Cache through which the framebuffer is bound */
         size_t              framebuffer_; /**< OpenGL's name of the framebuffer */
         size_t              renderbuffer_;    /**< OpenGL's name of the renderbuffer */
         vector<Texture2D*>  textures_;   /**< The textures used to receive the output of the rendering */
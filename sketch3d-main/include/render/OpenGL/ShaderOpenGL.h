@@ -7,12 +7,17 @@
 
 #include <unordered_map>
 #include <map>
+#include <stdint.h>
 #include <string>
 #include <vector>
 using namespace std;
 
 namespace Sketch3D {
 
+// Forward declaration
+struct FrameStats_t;
+class ProgramBinaryCacheOpenGL;
+
 /**
  * @class ShaderOpenGL
  * ement an OpenGL shader object
@@ -21,28 +26,59 @@ class ShaderOpenGL : public Shader {
     friend class RenderSystemOpenGL;
 
 	public:
-		ShaderOpenGL();
+        /**
+         * Constructor
+         * @param frameStats The counters of the render system
+         * @param programCache The cache of the program binaries
+         * @param deferLink If true, the compilation and link results aren't waited for until the shader is first bound
+         * or one of its uniforms is looked up, so that the driver can build several programs in parallel
+         */
+		ShaderOpenGL(FrameStats_t* frameStats, const ProgramBinaryCacheOpenGL* programCache, bool deferLink);
         virtual ~ShaderOpenGL();
 
         virtual bool SetSourceFile(const string& vertexFilename, const string& fragmentFilename);
         virtual bool SetSource(const string& vertexSource, const string& fragmentSource);
-        virtual bool SetUniformInt(const string& uniform, int value);
-        virtual bool SetUniformFloat(const string& uniform, float value);
-        virtual bool SetUniformVector2(const string& uniform, float value1, float value2);
-        virtual bool SetUniformVector3(const string& uniform, const Vector3& value);
-        virtual bool SetUniformVector3Array(const string& uniform, const Vector3* values, int arraySize);
-        virtual bool SetUniformVector4(const string& uniform, const Vector4& value);
-        virtual bool SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value);
-        virtual bool SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value);
-        virtual bool SetUniformMatrix4x4Array(const string& uniform, const Matrix4x4* values, int arraySize);
-        virtual bool SetUniformTexture(const string& uniform, const Texture* texture);
+        virtual UniformHandle_t GetUniformHandle(const string& uniform) const;
+        virtual bool IsLinkPending() const;
+
+    protected:
+        virtual void SetUniformIntImpl(UniformHandle_t uniform, int value);
+        virtual void SetUniformFloatImpl(UniformHandle_t uniform, float value);
+        virtual void SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2);
+        virtual void SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value);
+        virtual void SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize);
+        virtual void SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value);
+        virtual void SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value);
+        virtual void SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value);
+        virtual void SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize);
+        virtual void SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture);
 
 	private:
+        /**
+         * @struct UniformShadow_t
+         * Last value uploaded to a uniform location
+         */
+        struct UniformShadow_t {
+            size_t  offset;         /**< Index of the first byte of the value in shadowValues_ */
+            size_t  capacity;       /**< Size of the uniform in bytes. 0 if its uploads aren't shadowed */
+            size_t  size;           /**< Number of bytes of the value that are known */
+        };
+
+        FrameStats_t*                   frameStats_;    /**< Counters of the render system, in which the uniform uploads are counted */
+        const ProgramBinaryCacheOpenGL* programCache_;  /**< Cache of the program binaries of the render system */
+        bool                            deferLink_;     /**< Is the link result only queried when the shader is needed? */
+        bool                            linkPending_;   /**< Was the program linked without querying the result yet? */
+        uint64_t                        programKey_;    /**< Key of the program in the program binary cache */
+        bool                            saveToProgramCache_;    /**< Does the program have to be stored in the cache once linked? */
+        string                          vertexName_;    /**< Name used to report the errors of the vertex shader */
+        string                          fragmentName_;  /**< Name used to report the errors of the fragment shader */
         GLuint                          vertex_;    /**< Represents the vertex shader */
         GLuint                          fragment_;  /**< Represents the fragment shader */
 		GLuint				            program_;	/**< Represents the shader program */
 		map<GLint, GLuint>	            textures_;	/**< Allows the shader to map textures to its different texture units */
-        unordered_map<string, GLuint>   nameToUniforms_;    /**< Map of uniform names to location */
+        unordered_map<string, GLint>    nameToUniforms_;    /**< Map of uniform names to location */
+        vector<UniformShadow_t>         uniformShadows_;    /**< Last value of each uniform, indexed by location */
+        vector<char>                    shadowValues_;      /**< Storage of the last values of the uniforms */
 
 		/**
 		 * Read the shader file and output a string to pass to the GLSL
@@ -52,6 +88,38 @@ class ShaderOpenGL : public Shader {
 		 */
 		char*	ReadShader(const string& filename);
 
+        /**
+         * Compile and link the program, or load it from the program binary cache
+         * @param vertexSource The source code of the vertex shader
+         * @param vertexName The name used to report the errors of the vertex shader
+         * @param fragmentSource The source code of the fragment shader
+         * @param fragmentName The name used to report the errors of the fragment shader
+         * @return true if the program was created
+         */
+        bool    BuildProgram(const string& vertexSource, const string& vertexName, const string& fragmentSource,
+                             const string& fragmentName);
+
+        /**
+         * Report the compilation and link errors of the program, get its uniforms and store it in the program cache.
+         * Waits for the driver to finish building the program
+         */
+        void    FinishLink();
+
+        /**
+         * Get the location of the active uniforms of the linked program, bind its camera uniform block and resolve the
+         * builtin uniforms
+         */
+        void    QueryUniforms();
+
+        /**
+         * Compare a value with the last one uploaded to a uniform location and remember it if it's different
+         * @param location The location of the uniform
+         * @param value The value about to be uploaded
+         * @param size The size of the value in bytes
+         * @return true if the location already has this value and the upload can be skipped
+         */
+        bool    IsUploadRedundant(GLint location, const void* value, size_t size);
+
 		/**
 		 * Log the errors reported by the program
 		 */
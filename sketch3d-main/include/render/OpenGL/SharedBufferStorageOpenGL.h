@@ -0,0 +1,160 @@
+#ifndef SKETCH_3D_SHARED_BUFFER_STORAGE_OPENGL_H
+#define SKETCH_3D_SHARED_BUFFER_STORAGE_OPENGL_H
+
+#include "render/BufferObject.h"
+
+#include "render/OpenGL/gl/glew.h"
+#include "render/OpenGL/gl/gl.h"
+
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+// Forward declaration
+struct FrameStats_t;
+class RenderStateCacheOpenGL;
+class Matrix4x4;
+
+/**
+ * @class SharedBufferStorageOpenGL
+ * Vertex and index buffers in which the static shared buffer objects having the same vertex layout and index format
+ * are stored one after the other, so that they can be drawn together with glMultiDrawElementsIndirect. The space is
+ * allocated at the end of the buffers, the space of the buffer objects that are deleted or resized isn't reclaimed
+ */
+class SharedBufferStorageOpenGL {
+    public:
+        /**
+         * Constructor
+         * @param id Id of the storage, never 0
+         * @param vertexAttributes The vertex attributes of the buffer objects stored
+         * @param presentVertexAttributes Bitfield specifying what vertex attributes are actually present
+         * @param stride The size of a single vertex in bytes
+         * @param indexFormat The format of the indices of the index buffer
+         * @param frameStats The counters of the render system in which the uploaded bytes are counted
+         * @param renderStateCache The cache through which the buffers are bound
+         */
+                                    SharedBufferStorageOpenGL(size_t id, const VertexAttributesMap_t& vertexAttributes,
+                                                              int presentVertexAttributes, size_t stride, IndexFormat_t indexFormat,
+                                                              FrameStats_t* frameStats, RenderStateCacheOpenGL* renderStateCache);
+
+        /**
+         * Destructor
+         */
+                                   ~SharedBufferStorageOpenGL();
+
+        /**
+         * Reserve space at the end of the vertex buffer, growing it if needed
+         * @param numVertices The number of vertices to reserve
+         * @return The index of the first reserved vertex
+         */
+        size_t                      AllocateVertices(size_t numVertices);
+
+        /**
+         * Reserve space at the end of the index buffer, growing it if needed
+         * @param numIndices The number of indices to reserve
+         * @return The position of the first reserved index
+         */
+        size_t                      AllocateIndices(size_t numIndices);
+
+        /**
+         * Copy vertices in the vertex buffer
+         * @param firstVertex Index of the first vertex to write
+         * @param vertexData The interleaved vertex data
+         * @param numVertices The number of vertices to write
+         */
+        void                        SetVertices(size_t firstVertex, const float* vertexData, size_t numVertices);
+
+        /**
+         * Copy indices in the index buffer
+         * @param firstIndex Position of the first index to write
+         * @param indexData The indices to write, which must fit in the index format of the storage
+         * @param numIndices The number of indices to write
+         */
+        void                        SetIndices(size_t firstIndex, const unsigned int* indexData, size_t numIndices);
+
+        /**
+         * Read back vertices from the vertex buffer
+         * @param firstVertex Index of the first vertex to read
+         * @param numVertices The number of vertices to read
+         * @param vertexData The array receiving the interleaved vertex data
+         */
+        void                        GetVertices(size_t firstVertex, size_t numVertices, float* vertexData) const;
+
+        /**
+         * Read back indices from the index buffer
+         * @param firstIndex Position of the first index to read
+         * @param numIndices The number of indices to read
+         * @param indexData The array receiving the indices
+         */
+        void                        GetIndices(size_t firstIndex, size_t numIndices, unsigned int* indexData) const;
+
+        /**
+         * Move vertices already in the vertex buffer. The source and the destination must not overlap
+         */
+        void                        CopyVertices(size_t sourceFirstVertex, size_t destinationFirstVertex, size_t numVertices);
+
+        /**
+         * Move indices already in the index buffer. The source and the destination must not overlap
+         */
+        void                        CopyIndices(size_t sourceFirstIndex, size_t destinationFirstIndex, size_t numIndices);
+
+        /**
+         * Bind the vertex array object of the storage
+         */
+        void                        Bind() const;
+
+        /**
+         * Add the per instance model matrix to the vertex layout, if it wasn't already done
+         */
+        void                        PrepareInstanceBuffers();
+
+        /**
+         * Send the model matrices of the instances to draw
+         * @param modelMatrices The transposed model matrices
+         */
+        void                        SetInstances(const vector<Matrix4x4>& modelMatrices);
+
+        /**
+         * Draw several ranges of the buffers with a single call
+         * @param commands The draws to make
+         * @param numCommands The number of draws
+         */
+        void                        DrawIndirect(const DrawIndirectCommand_t* commands, size_t numCommands);
+
+        size_t                      GetId() const;
+        IndexFormat_t               GetIndexFormat() const;
+
+    private:
+        size_t                      id_;
+        VertexAttributesMap_t       vertexAttributes_;  /**< The vertex attributes of the buffer objects stored */
+        int                         presentVertexAttributes_;   /**< The vertex attributes actually present */
+        size_t                      stride_;            /**< Size of a vertex in bytes */
+        IndexFormat_t               indexFormat_;       /**< Format of the indices of the index buffer */
+        size_t                      indexSize_;         /**< Size of an index in bytes */
+        FrameStats_t*               frameStats_;        /**< Counters of the render system */
+        RenderStateCacheOpenGL*     renderStateCache_;  /**< Render state cache of the render system */
+
+        GLuint                      vao_;               /**< Vertex array object */
+        GLuint                      vbo_;               /**< Vertex buffer object */
+        GLuint                      ibo_;               /**< Index buffer object */
+        GLuint                      instanceBuffer_;    /**< Buffer of the model matrices of the instances, 0 until prepared */
+        GLuint                      indirectBuffer_;    /**< Buffer of the commands of the indirect draws */
+
+        size_t                      numVertices_;       /**< Number of vertices allocated */
+        size_t                      vertexCapacity_;    /**< Number of vertices that fit in the vertex buffer */
+        size_t                      numIndices_;        /**< Number of indices allocated */
+        size_t                      indexCapacity_;     /**< Number of indices that fit in the index buffer */
+
+        /**
+         * Move the content of a buffer to a bigger one
+         * @param buffer The buffer to grow. It is replaced by the new buffer
+         * @param usedSize The size of the data to keep, in bytes
+         * @param newSize The size of the new buffer, in bytes
+         */
+        void                        GrowBuffer(GLuint& buffer, size_t usedSize, size_t newSize);
+};
+
+}
+
+#endif
@@ -29,6 +29,7 @@ class RenderContextOpenGLUnix : public RenderContextOpenGL {
 
         virtual bool    Initialize(Window& window, const RenderParameters_t& renderParameters);
         virtual void    SwapBuffers();
+        virtual void*   GetFunctionAddress(const char* name) const;
           
     private:
         ::Window        xWindow_;  /**< X11 structure defining the window */
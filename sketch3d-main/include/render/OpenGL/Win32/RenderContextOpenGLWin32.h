@@ -25,6 +25,7 @@ class RenderContextOpenGLWin32 : public RenderContextOpenGL {
 
 		virtual bool	Initialize(Window& window, const RenderParameters_t& renderParameters);
 		virtual void	SwapBuffers();
+		virtual void*	GetFunctionAddress(const char* name) const;
 
 	private:
 		HDC				deviceContext_;		/**< Window's device context */
@@ -0,0 +1,47 @@
+#ifndef SKETCH_3D_PIPELINE_STATE_H
+#define SKETCH_3D_PIPELINE_STATE_H
+
+#include "render/RenderState.h"
+
+#include "system/Platform.h"
+
+#include <stdint.h>
+
+namespace Sketch3D {
+
+// Forward declaration
+class Shader;
+
+/**
+ * @class PipelineState
+ * Immutable association of a shader with the render state used to draw with it. The pipeline states are created and
+ * shared by the RenderStateCache, so that two of them with the same content are the same object. Switching between
+ * them only requires comparing their ids, and their id orders the render queues so that the states are only switched
+ * when the pipeline state changes
+ */
+class SKETCH_3D_API PipelineState {
+    public:
+        /**
+         * Constructor
+         * @param id Id of the pipeline state, never 0
+         * @param shader The shader used to draw
+         * @param hasRenderState If false, the render state set through the renderer is used instead of renderState
+         * @param renderState The render state used to draw
+         */
+                                PipelineState(uint32_t id, Shader* shader, bool hasRenderState, const RenderState_t& renderState);
+
+        uint32_t                GetId() const { return id_; }
+        Shader*                 GetShader() const { return shader_; }
+        bool                    HasRenderState() const { return hasRenderState_; }
+        const RenderState_t&    GetRenderState() const { return renderState_; }
+
+    private:
+        uint32_t                id_;                /**< Id of the pipeline state */
+        Shader*                 shader_;            /**< The shader used to draw */
+        bool                    hasRenderState_;    /**< Does the pipeline state use its own render state? */
+        RenderState_t           renderState_;       /**< The render state used to draw if hasRenderState_ is true */
+};
+
+}
+
+#endif
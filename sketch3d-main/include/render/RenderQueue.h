@@ -1,17 +1,127 @@
 #ifndef SKETCH_3D_RENDER_QUEUE_H
 #define SKETCH_3D_RENDER_QUEUE_H
 
+#include "render/BufferObject.h"
 #include "render/RenderQueueItem.h"
 
+#include "math/Matrix4x4.h"
+
 #include "system/Platform.h"
 
+#include <stdint.h>
 #include <vector>
 using namespace std;
 
 namespace Sketch3D {
 
 // Forward declaration
+class Material;
 class Node;
+class Texture2D;
+
+/**
+ * @enum RenderCommand_t
+ * This enum defines the different rendering command used by the render queue to actually draw
+ * on the screen. The commands are used in an array of commands to sequentially make API calls.
+ */
+enum RenderCommand_t {
+    RENDER_COMMAND_USE_MATERIAL,
+    RENDER_COMMAND_BIND_TEXTURES,
+    RENDER_COMMAND_SET_MODEL_MATRIX,
+    RENDER_COMMAND_RENDER_BUFFER_OBJECTS,
+    RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX,
+    RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES,
+    RENDER_COMMAND_DRAW_INDIRECT,
+
+    NUMBER_RENDER_COMMANDS
+};
+
+/**
+ * @struct BindTextures_t
+ * Little struct used to pack information required textures that we have to bind
+ */
+struct BindTextures_t {
+    Texture2D**             textures;
+    size_t                  numTextures;
+};
+
+/**
+ * @struct IndirectDraws_t
+ * Little struct used to pack the draws made by a single indirect draw call
+ */
+struct IndirectDraws_t {
+    BufferObject*           bufferObject;   /**< One of the buffer objects drawn, they all share its storage */
+    uint32_t                firstCommand;   /**< Index of the first draw in the render queue's list of indirect draws */
+    uint32_t                numCommands;    /**< Number of draws */
+};
+
+/**
+ * @struct RenderCommandRecord_t
+ * A render command along with its parameter. The records have a fixed size so that they can be stored contiguously
+ * and executed with a linear walk
+ */
+struct RenderCommandRecord_t {
+    RenderCommand_t             command;
+    union {
+        Material*               material;       /**< RENDER_COMMAND_USE_MATERIAL */
+        BindTextures_t          textures;       /**< RENDER_COMMAND_BIND_TEXTURES */
+        const RenderQueueItem*  item;           /**< RENDER_COMMAND_SET_MODEL_MATRIX and RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX */
+        BufferObject*           bufferObject;   /**< RENDER_COMMAND_RENDER_BUFFER_OBJECTS and RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES */
+        IndirectDraws_t         indirectDraws;  /**< RENDER_COMMAND_DRAW_INDIRECT */
+    };
+};
+
+/**
+ * @struct RenderQueueSortKey_t
+ * The key of an item paired with its index in the render queue. These pairs are sorted instead of the items themselves
+ */
+struct RenderQueueSortKey_t {
+    uint64_t    key;    /**< Copy of the key of the item */
+    uint32_t    index;  /**< Index of the item in the render queue */
+};
+
+/**
+ * @struct RenderQueueEntry_t
+ * In retained mode, the persistent entry of a node in a render queue. It remembers the state of the node when its
+ * items were last constructed so that they are only reconstructed when the node changes
+ */
+struct RenderQueueEntry_t {
+    Node*           node;                       /**< The node owning the entry, null if the entry is free */
+    uint32_t        firstItem;                  /**< Index of the first item of the node */
+    uint32_t        numItems;                   /**< Number of items of the node, one per surface */
+    unsigned int    stateVersion;               /**< Version of the node's mesh and material */
+    unsigned int    transformationVersion;      /**< Version of the node's transformation */
+    unsigned int    parentTransformationVersion;/**< Version of the node's parent transformation */
+    size_t          frame;                      /**< Last frame in which the node was submitted */
+};
+
+/**
+ * @struct RenderQueueInstanceCandidate_t
+ * An item that could be drawn with automatic instancing. The candidates of a material are sorted so that the items
+ * sharing the same buffer object and textures end up next to each other
+ */
+struct RenderQueueInstanceCandidate_t {
+    BufferObject*   bufferObject;   /**< The buffer object of the item */
+    Texture2D**     textures;       /**< The textures of the item */
+    uint32_t        position;       /**< Position of the item in the sorted keys */
+};
+
+/**
+ * Sort the keys using a least significant digit radix sort. The passes for the bytes that are the same in all the keys
+ * are skipped. The keys must be given in index order, equal keys then stay ordered by index like with InsertionSortKeys
+ * @param keys The keys to sort
+ * @param scratch Temporary storage used by the sort. It is resized to the number of keys
+ */
+SKETCH_3D_API void RadixSortKeys(vector<RenderQueueSortKey_t>& keys, vector<RenderQueueSortKey_t>& scratch);
+
+/**
+ * Sort the keys using an insertion sort, which is fast when they are nearly sorted. Equal keys are ordered by index.
+ * The sort gives up as soon as it has to move the keys more than maxMoves times, leaving them partially sorted
+ * @param keys The keys to sort
+ * @param maxMoves The maximum number of times that a key can be moved by one position
+ * @return true if the keys are sorted, false if the sort gave up
+ */
+SKETCH_3D_API bool InsertionSortKeys(vector<RenderQueueSortKey_t>& keys, size_t maxMoves);
 
 /**
  * @class RenderQueue
@@ -34,6 +144,63 @@ class SKETCH_3D_API RenderQueue {
          */
         void                        AddNode(Node* node, Layer_t layer=LAYER_GAME);
 
+        /**
+         * Switch the queue between immediate mode (default) and retained mode. In immediate mode, the nodes are added
+         * every frame with AddNode and the queue is emptied after rendering. In retained mode, the nodes keep a
+         * persistent entry in the queue and their items are only reconstructed when they change. The items are only
+         * sorted again and the render commands rebuilt when something changed. Switching mode empties the queue
+         * @param retainedMode If set to true, the queue will be in retained mode
+         */
+        void                        SetRetainedMode(bool retainedMode);
+        bool                        IsRetainedMode() const;
+
+        /**
+         * In retained mode, check if the entry of a node is still up to date. If it is, the node is kept in the queue
+         * for this frame. Otherwise, UpdateRetainedNode has to be called. The nodes that aren't submitted through one of
+         * those two functions during a frame are removed from the queue when it is rendered
+         * @param node The node to check
+         * @return true if the node's items are up to date, false if the node has to be updated
+         */
+        bool                        RetainNode(Node* node);
+
+        /**
+         * In retained mode, reconstruct the items of a node, adding it to the queue if it wasn't already. If the node was
+         * in another retained queue, it is removed from it.
+         * Changes made to a material or a mesh that is already assigned to a node aren't detected; assign it again to
+         * have the node updated
+         * @param node The node to update
+         * @param isVisible Should the node be drawn? Culled nodes are kept in the queue to avoid recreating their items
+         * @param layer On which layer are we drawing everything
+         */
+        void                        UpdateRetainedNode(Node* node, bool isVisible, Layer_t layer=LAYER_GAME);
+
+        /**
+         * In retained mode, refresh the distance to the camera and the visibility of a node kept with RetainNode
+         * without reconstructing its items. This is used when the camera moves. The items are only sorted again if
+         * their keys changed
+         * @param node The node to refresh
+         * @param isVisible Should the node be drawn?
+         */
+        void                        RefreshRetainedNode(Node* node, bool isVisible);
+
+        /**
+         * In retained mode, remove a node from the queue
+         * @param node The node to remove
+         */
+        void                        RemoveRetainedNode(Node* node);
+
+        /**
+         * Returns the number of nodes that were updated through UpdateRetainedNode during the last rendered frame
+         */
+        size_t                      GetNumberOfUpdatedNodes() const;
+
+        /**
+         * Move the items of another queue at the end of this one. This is used to gather the items that were added
+         * to several queues in parallel
+         * @param renderQueue The queue from which the items are moved. It is left empty
+         */
+        void                        Merge(RenderQueue& renderQueue);
+
         /**
          * Renders the content of the queue. This invalidates the queue by removing all items in the queue.
          */
@@ -44,9 +211,115 @@ class SKETCH_3D_API RenderQueue {
          */
         bool                        IsEmpty() const;
 
+        /**
+         * If set to true (default), the order of the last frame is used as the starting point of the sort when the
+         * number of items didn't change. Since the items are added in the same order every frame, they are then
+         * nearly sorted and an insertion sort is used instead of a radix sort
+         * @param useTemporalCoherence Should the order of the last frame be reused?
+         */
+        void                        SetUseTemporalCoherence(bool useTemporalCoherence);
+
+        /**
+         * Set the minimum number of opaque items sharing the same material, buffer object and textures that are drawn
+         * with instanced rendering even if their nodes didn't ask for it. Only the materials whose shader supports
+         * instancing are considered. The instance buffers of the buffer objects are prepared when first needed
+         * @param threshold The minimum number of items to draw as instances. 0 disables automatic instancing
+         */
+        void                        SetAutomaticInstancingThreshold(size_t threshold);
+
+        /**
+         * If set to true (default), the consecutive opaque items sharing the same material and textures whose buffer
+         * objects share their storage are drawn with a single indirect draw call. The model matrix of each draw is
+         * read from the instance buffer, so only the materials whose shader supports instancing are considered
+         * @param useIndirectDraws Should the indirect draws be used?
+         */
+        void                        SetUseIndirectDraws(bool useIndirectDraws);
+
     private:
          vector<RenderQueueItem>    items_;         /**< The items in the queue */
-         vector<size_t>             itemsIndex_;    /**< This list is the list that get actually sorted. We can then use temporal coherence to have less things to sort on subsequent frames */
+         vector<Matrix4x4>          modelMatrices_; /**< The model matrices of the nodes added this frame, referred to by the items */
+         vector<RenderQueueSortKey_t>   sortKeys_;  /**< This list is the list that get actually sorted. It keeps the order of the last frame for temporal coherence */
+         vector<RenderQueueSortKey_t>   sortScratch_;   /**< Temporary storage for the radix sort */
+         bool                       useTemporalCoherence_;  /**< Reuse the order of the last frame when sorting */
+         size_t                     automaticInstancingThreshold_;  /**< Minimum number of items drawn automatically as instances */
+         bool                       useIndirectDraws_;      /**< Draw the items sharing their storage with indirect draws */
+
+         // Retained mode data
+         bool                       retainedMode_;          /**< Do the items persist from frame to frame? */
+         vector<RenderQueueEntry_t> entries_;               /**< Entries of the nodes. The model matrix of an entry has the same index */
+         vector<uint32_t>           freeEntries_;           /**< Entries that can be reused */
+         size_t                     frame_;                 /**< Incremented after every render */
+         size_t                     numDeadItems_;          /**< Items of removed nodes that are still in the list of items */
+         size_t                     numUpdatedNodes_;       /**< Nodes updated since the last render */
+         size_t                     numUpdatedNodesLastFrame_;  /**< Nodes updated during the last rendered frame */
+         bool                       keysChanged_;           /**< Do the items have to be sorted again? */
+         bool                       commandsChanged_;       /**< Do the render commands have to be rebuilt? */
+
+         // Per frame data kept around to avoid reallocating it every frame
+         vector<RenderCommandRecord_t>  renderCommands_;    /**< The commands built from the sorted items */
+         size_t                     numVisibleItems_;       /**< Number of items drawn by the render commands */
+         vector<BufferObject*>      instancedBufferObjects_;    /**< Buffer objects waiting for the accumulated instances to be drawn */
+         vector<Matrix4x4>          accumulatedInstances_;  /**< Transposed model matrices of the instances to draw */
+         vector<RenderQueueInstanceCandidate_t> instanceCandidates_;    /**< Items of the current material that could be instanced */
+         vector<uint32_t>           instanceGroups_;        /**< For each sorted key, its first candidate if it is drawn as an instance, UINT32_MAX otherwise */
+         vector<DrawIndirectCommand_t>  indirectCommands_;  /**< The draws of all the indirect draw calls */
+
+        /**
+         * Returns the index of the entry of the node, or UINT32_MAX if the node isn't in this queue
+         */
+        uint32_t                    FindEntry(const Node* node) const;
+
+        /**
+         * Kill the items of an entry and put it back in the list of free entries
+         */
+        void                        FreeEntry(uint32_t entryIndex);
+
+        /**
+         * Remove the entries of the nodes that weren't submitted this frame and compact the items if there are too many
+         * dead ones
+         */
+        void                        RemoveUnsubmittedNodes();
+
+        /**
+         * Sort the keys of the items, the sorted order is stored in sortKeys_
+         */
+        void                        SortItems();
+
+        /**
+         * Construct the list of render commands from the sorted items
+         */
+        void                        BuildRenderCommands();
+
+        /**
+         * Find the groups of items that will be drawn with automatic instancing among the items using the same material
+         * @param firstPosition Position, in the sorted keys, of the first item using the material
+         */
+        void                        FindInstanceGroups(size_t firstPosition);
+
+        /**
+         * Add the commands to draw a group of items found by FindInstanceGroups as instances
+         * @param firstCandidate Index of the first candidate of the group
+         */
+        void                        AddInstanceGroupCommands(uint32_t firstCandidate);
+
+        /**
+         * Add the commands to draw the item at the given position and the following ones that can be drawn with it in
+         * a single indirect draw call
+         * @param position Position, in the sorted keys, of the first item. If the commands are added, it is moved to
+         * the position of the last item drawn
+         * @return true if the commands were added, false if there aren't enough items to use an indirect draw
+         */
+        bool                        AddIndirectDrawCommands(size_t& position);
+
+        /**
+         * Add the commands to draw the accumulated instances of the pending instanced buffer objects
+         */
+        void                        FlushInstancedBufferObjects();
+
+        /**
+         * Execute the render commands sequentially
+         */
+        void                        ExecuteRenderCommands();
 };
 
 }
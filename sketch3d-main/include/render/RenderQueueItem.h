@@ -8,7 +8,6 @@
 #include "system/Platform.h"
 
 #include <map>
-#include <memory>
 #include <stdint.h>
 #include <string>
 #include <utility>
@@ -36,32 +35,34 @@ enum Layer_t {
  * Creates a render queue item which is used to sort draw commands. The render queue item is a pair of key and value,
  * where the key is used to sort and the value is the actual drawing data.
  *
- * The key is composed of the following components
+ * The key is a 64 bits integer made of the following fields, from the most significant bits to the least significant:
  *
- *  - Fullscreen layer :
+ *  - Layer (2 bits) :
  *      --> 00 = game layer (normal drawing);
  *      --> 01 = Fullscreen effect;
  *      --> 10 = HUD.
- *  - Transulency type :
+ *  - Transluency type (2 bits) :
  *      --> 00 = Opaque geometry;
- *      --> 01 = Additive transparency;
- *      --> 10 = Subtractive transparency.
- *  - Depth : The depth value of the object.
- *            When the transluency type is opaque, this is used as front-to-back sorting, otherwise, this is back-to-front sorting
- *  - Material id : The id of the material used.
+ *      --> 01 = Additive transparency.
+ *  - Pipeline state (12 bits) : The id of the pipeline state of the material, that is, of its shader and render
+ *    state.
+ *  - Material (12 bits) : The id of the material, so that the items sharing a pipeline state are grouped by material.
+ *  - Texture set (12 bits) : A hash of the ids of the textures of the sub-mesh.
+ *  - Depth (24 bits) : The distance from the camera, quantized.
  *
- * NOTE: if the transluency type is opaque, the Material Id and Depth value are swapped together, so that opaque objects are sorted
- * through material ids before depth. Otherwise, we sort via depth.
+ * The opaque items are sorted by state first, so that they cause as few binds as possible, then front-to-back. The
+ * transparent items have to be drawn back-to-front, so their depth is inverted and moved right after the transluency
+ * type, before the pipeline state, material and texture set fields.
  */
 class SKETCH_3D_API RenderQueueItem {
     friend class RenderQueue;
-    friend class RenderQueueItemKeyComparator;
 
     public:
         /**
          * Constructor.
          * Creates a render queue item
-         * @param modelMatrix The modelMatrix to position the sub-mesh
+         * @param modelMatrixIndex Index, in the render queue's list of model matrices, of the matrix to position the sub-mesh
+         * @param normalMatrix The transposed inverse of the model matrix, used to transform the normals
          * @param material The material to use to draw the sub-mesh
          * @param textures The textures to use on this sub-mesh
          * @param numTextures The number of textures to use on this sub-mesh
@@ -71,7 +72,8 @@ class SKETCH_3D_API RenderQueueItem {
          * A distance of 0 means on the near plane and a distance corresponding to the maximum value of a unsigned 32 btis word means on the far plane.
          * @param layer On which layer are we drawing everything. This option might change render state, such as depth testing
          */
-                            RenderQueueItem(shared_ptr<Matrix4x4> modelMatrix, Material* material, Texture2D** textures,
+                            RenderQueueItem(uint32_t modelMatrixIndex, const Matrix4x4* normalMatrix,
+                                            Material* material, Texture2D** textures,
                                             size_t numTextures, BufferObject* bufferObject, bool useInstancing,
                                             uint32_t distanceFromCamera, Layer_t layer=LAYER_GAME);
 
@@ -81,36 +83,34 @@ class SKETCH_3D_API RenderQueueItem {
                            ~RenderQueueItem();
 
     private:
-        // Key stuff
-        uint64_t            key_;
-        Layer_t             layer_;
-        TransluencyType_t   transluencyType_;
-        uint32_t            distanceFromCamera_;
-        int                 materialId_;
-
-        shared_ptr<Matrix4x4>   modelMatrix_;       /**< The model matrix to use to position the sub-mesh */
+        uint64_t            key_;               /**< Sort key of the item */
+
+        uint32_t            modelMatrixIndex_;  /**< Index of the model matrix to use to position the sub-mesh */
+        const Matrix4x4*    normalMatrix_;      /**< The transposed inverse of the model matrix. It is cached by the node */
         Material*           material_;          /**< The material to use to draw the sub-mesh */
         Texture2D**         textures_;          /**< The textures to use on this sub-mesh */
         size_t              numTextures_;       /**< The number of textures to use on this sub-mesh */
         BufferObject*       bufferObject_;      /**< The buffer object representing the actual sub-mesh to draw */
         bool                useInstancing_;     /**< Determine if we draw multiple instances of the buffer object */
+        bool                isVisible_;         /**< In retained mode, items of culled or removed nodes are kept but not drawn */
 
         /**
-         * Construct the 30 bits material id from the material properties
+         * Construct the sort key of the item
+         * @param distanceFromCamera The normalized distance of the sub-mesh from the camera
+         * @param layer The layer on which the sub-mesh is drawn
          */
-        uint32_t            ConstructMaterialId() const;
-};
-
-
-class SKETCH_3D_API RenderQueueItemKeyComparator {
-    public:
-        RenderQueueItemKeyComparator(const vector<RenderQueueItem>& items) : items_(items) {
-        }
+        void                ConstructKey(uint32_t distanceFromCamera, Layer_t layer);
 
-        bool operator() (size_t lhs, size_t rhs) const;
+        /**
+         * Replace the depth field of the sort key, leaving the other fields as they are
+         * @param distanceFromCamera The normalized distance of the sub-mesh from the camera
+         */
+        void                SetDistanceFromCamera(uint32_t distanceFromCamera);
 
-    private:
-        const vector<RenderQueueItem>& items_;
+        /**
+         * Construct the 12 bits id of the set of textures of the item
+         */
+        uint32_t            ConstructTextureSetId() const;
 };
 
 }
@@ -75,5 +75,40 @@ enum RenderMode_t {
 	RENDER_MODE_POINT
 };
 
+/**
+ * @struct RenderState_t
+ * The fixed function states used to draw, that is, the raster, depth and blending states
+ */
+struct RenderState_t {
+    /**
+     * Constructor. Sets all the states to their default values
+     */
+                        RenderState_t() : depthTest(true), depthWrite(true), colorWrite(true), blending(false),
+                                          depthFunc(DEPTH_FUNC_LESS), cullingMethod(CULLING_METHOD_BACK_FACE),
+                                          blendingEquation(BLENDING_EQUATION_ADD), sourceBlendingFactor(BLENDING_FACTOR_ONE),
+                                          destinationBlendingFactor(BLENDING_FACTOR_ZERO), renderMode(RENDER_MODE_FILL) {}
+
+    bool                operator==(const RenderState_t& other) const {
+                            return depthTest == other.depthTest && depthWrite == other.depthWrite &&
+                                   colorWrite == other.colorWrite && blending == other.blending &&
+                                   depthFunc == other.depthFunc && cullingMethod == other.cullingMethod &&
+                                   blendingEquation == other.blendingEquation &&
+                                   sourceBlendingFactor == other.sourceBlendingFactor &&
+                                   destinationBlendingFactor == other.destinationBlendingFactor &&
+                                   renderMode == other.renderMode;
+                        }
+
+    bool                depthTest;                  /**< Is the depth test enabled? */
+    bool                depthWrite;                 /**< Is the depth buffer written? */
+    bool                colorWrite;                 /**< Is the color buffer written? */
+    bool                blending;                   /**< Is the blending enabled? */
+    DepthFunc_t         depthFunc;                  /**< Comparison function of the depth test */
+    CullingMethod_t     cullingMethod;              /**< Faces that are culled */
+    BlendingEquation_t  blendingEquation;           /**< Equation used to blend */
+    BlendingFactor_t    sourceBlendingFactor;       /**< Factor applied to the source color when blending */
+    BlendingFactor_t    destinationBlendingFactor;  /**< Factor applied to the destination color when blending */
+    RenderMode_t        renderMode;                 /**< How the polygons are filled */
+};
+
 }
 #endif
\ No newline at end of file
@@ -5,24 +5,59 @@
 
 #include "system/Platform.h"
 
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
 namespace Sketch3D {
 
+// Forward declaration
+struct FrameStats_t;
+class PipelineState;
+class Shader;
+
 /**
  * @class RenderStateCache
  * This class is used to state the render state. It doesn't immediately apply the states but instead
  * store the new value and apply it through the device when the actual rendering occurs.
+ *
+ * It also creates the pipeline states. When a pipeline state is applied, its render state replaces the one set through
+ * the setters until ApplyRenderStateChanges is called or a pipeline state without render state is applied
  */
 class SKETCH_3D_API RenderStateCache {
     public:
         /**
          * Constructor. Sets all the states to their default values
+         * @param frameStats The counters of the render system in which the applied state changes are counted
          */
-                            RenderStateCache();
+                            RenderStateCache(FrameStats_t* frameStats);
         virtual            ~RenderStateCache();
 
         void                ApplyRenderStateChanges();
         void                ApplyClearStateChanges();
 
+        /**
+         * Apply the render state of a pipeline state. Nothing is done if it's the render state that is already applied
+         * @param pipelineState The pipeline state. If null or without render state, the render state set through the
+         * setters is applied
+         */
+        void                ApplyPipelineState(const PipelineState* pipelineState);
+
+        /**
+         * Get the pipeline state drawing with a shader and the render state set through the setters, creating it if
+         * needed
+         * @param shader The shader used to draw
+         */
+        const PipelineState* GetPipelineState(Shader* shader);
+
+        /**
+         * Get the pipeline state drawing with a shader and a render state, creating it if needed
+         * @param shader The shader used to draw
+         * @param renderState The render state used to draw
+         */
+        const PipelineState* GetPipelineState(Shader* shader, const RenderState_t& renderState);
+
         void                EnableDepthTest(bool val);
         void                EnableDepthWrite(bool val);
         void                EnableColorWrite(bool val);
@@ -34,29 +69,14 @@ class SKETCH_3D_API RenderStateCache {
         void                SetRenderFillMode(RenderMode_t mode);
 
     protected:
-        // Current render state values
-        bool                isDepthTestEnabled_;
-        bool                isDepthWriteEnabled_;
-        bool                isColorWriteEnabled_;
-        bool                isBlendingEnabled_;
-        DepthFunc_t         depthComparisonFunction_;
-        CullingMethod_t     cullingMethod_;
-        BlendingEquation_t  blendingEquation_;
-        BlendingFactor_t    sourceBlendingFactor_;
-        BlendingFactor_t    destinationBlendingFactor_;
-        RenderMode_t        renderMode_;
-
-        // Old render state values
-        bool                oldIsDepthTestEnabled_;
-        bool                oldIsDepthWriteEnabled_;
-        bool                oldIsColorWriteEnabled_;
-        bool                oldIsBlendingEnabled_;
-        DepthFunc_t         oldDepthComparisonFunction_;
-        CullingMethod_t     oldCullingMethod_;
-        BlendingEquation_t  oldBlendingEquation_;
-        BlendingFactor_t    oldSourceBlendingFactor_;
-        BlendingFactor_t    oldDestinationBlendingFactor_;
-        RenderMode_t        oldRenderMode_;
+        FrameStats_t*       frameStats_;    /**< Counters of the render system that created this cache */
+
+        RenderState_t       renderState_;           /**< Render state set through the setters */
+        RenderState_t       appliedRenderState_;    /**< Render state applied through the device, read by the implementations */
+        uint32_t            appliedRenderStateId_;  /**< Id of the pipeline state whose render state is applied, 0 for renderState_ */
+
+        unordered_map<uint32_t, vector<PipelineState*>> pipelineStates_;   /**< Pipeline states created, by hash of their content */
+        uint32_t            nextPipelineStateId_;   /**< Id of the next pipeline state created */
 
         virtual void        EnableDepthTestImpl() = 0;
         virtual void        EnableDepthWriteImpl() = 0;
@@ -67,6 +87,17 @@ class SKETCH_3D_API RenderStateCache {
         virtual void        SetBlendingEquationImpl() = 0;
         virtual void        SetBlendingFactorImpl() = 0;
         virtual void        SetRenderFillModeImpl() = 0;
+
+    private:
+        /**
+         * Apply the states of a render state that differ from the applied ones
+         */
+        void                ApplyRenderState(const RenderState_t& renderState);
+
+        /**
+         * Get the pipeline state with the given content, creating it if needed
+         */
+        const PipelineState* FindOrCreatePipelineState(Shader* shader, bool hasRenderState, const RenderState_t& renderState);
 };
 
 }
@@ -1,6 +1,7 @@
 #ifndef SKETCH_3D_RENDER_SYSTEM_H
 #define SKETCH_3D_RENDER_SYSTEM_H
 
+#include "render/FrameStats.h"
 #include "render/Renderer.h"
 
 #include "math/Matrix4x4.h"
@@ -33,6 +34,19 @@ class Vector2;
 struct DeviceCapabilities_t {
     int     maxActiveTextures_; /**< Maximum number of active textures supported by the GPU */
     int     maxNumberRenderTargets_; /**< Maximum number of render targets that can be used at the same time */
+    bool    supportsIndirectDraws_; /**< Can several buffer objects be drawn with a single indirect draw call? */
+    unsigned int maxVertexIndex_;   /**< Largest vertex index that can be drawn. 32 bit indices are only used above 0xFFFF */
+};
+
+/**
+ * @struct CameraUniforms_t
+ * Content of the camera uniform block in the std140 layout. The matrices are stored in column-major order
+ */
+struct CameraUniforms_t {
+    float   view[16];           /**< The view matrix */
+    float   viewProjection[16]; /**< The view-projection matrix */
+    float   transInvView[16];   /**< The transposed inverse of the view matrix */
+    float   projection[16];     /**< The projection matrix */
 };
 
 /**
@@ -50,6 +64,13 @@ class SKETCH_3D_API RenderSystem {
 		 */
 										    RenderSystem(Window& window);
 
+        /**
+         * Constructor for render systems that don't draw in a window
+         * @param width The width of the virtual screen
+         * @param height The height of the virtual screen
+         */
+                                            RenderSystem(unsigned int width, unsigned int height);
+
 		/**
 		 * Destructor. Free the underlying API
 		 */
@@ -231,6 +252,15 @@ class SKETCH_3D_API RenderSystem {
          */
         virtual void                        BindShader(const Shader* shader) = 0;
 
+        /**
+         * Set the camera matrices shared by the shaders declaring the camera uniform block. The block's buffer is only
+         * updated when the matrices changed since the last call, so this can be called before drawing each render queue
+         * @param view The view matrix
+         * @param projection The projection matrix
+         * @param viewProjection The view-projection matrix
+         */
+        void                                SetCameraUniforms(const Matrix4x4& view, const Matrix4x4& projection, const Matrix4x4& viewProjection);
+
         /**
          * Extract the frustum planes from the view projection matrix
          * @param viewProjection The view projection matrix of the view frustum used to extract the planes
@@ -238,6 +268,21 @@ class SKETCH_3D_API RenderSystem {
          */
         virtual FrustumPlanes_t             ExtractViewFrustumPlanes(const Matrix4x4& viewProjection) const = 0;
 
+        /**
+         * Set the directory in which the render system stores the compiled shader programs, so that they don't have to
+         * be compiled again the next time the application starts. The render systems that can't retrieve the compiled
+         * programs ignore it
+         * @param directory An existing directory. If empty, the compiled programs aren't stored
+         */
+        virtual void                        SetShaderCacheDirectory(const string& directory) {}
+
+        /**
+         * Defer waiting for the compilation and link of the shaders created afterwards until they are first used, so
+         * that the driver can build them in parallel. The render systems building their shaders synchronously ignore it
+         * @param val Enabled if true, disabled otherwise
+         */
+        virtual void                        EnableDeferredShaderCompilation(bool val) {}
+
         /**
          * Draw the content of a buffer object using a shader made for drawing text
          * @param bufferObject The buffer object to draw
@@ -251,9 +296,11 @@ class SKETCH_3D_API RenderSystem {
         const DeviceCapabilities_t* const   GetDeviceCapabilities() const { return &deviceCapabilities_; }
         BufferObjectManager*                GetBufferObjectManager() const;
         RenderStateCache*                   GetRenderStateCache() const;
+        FrameStats_t&                       GetFrameStats() { return frameStats_; }
+        const FrameStats_t&                 GetFrameStats() const { return frameStats_; }
 
 	protected:
-        Window&							    window_;        /**< The window */
+        Window*							    window_;        /**< The window. Null if the render system doesn't draw in a window */
 		WindowHandle					    windowHandle_;	/**< The window's handle */
 		unsigned int					    width_;			/**< The width of the window */
 		unsigned int					    height_;		/**< The height of the window */
@@ -266,9 +313,15 @@ class SKETCH_3D_API RenderSystem {
         DeviceCapabilities_t                deviceCapabilities_;
         BufferObjectManager*                bufferObjectManager_;
         RenderStateCache*                   renderStateCache_;
+        FrameStats_t                        frameStats_;    /**< Counters of the current frame */
 
         Shader*                             textShader_;    /**< Shader used to draw text on screen */
 
+        CameraUniforms_t                    cameraUniforms_;    /**< Content of the camera uniform block */
+        Matrix4x4                           cameraView_;        /**< View matrix of the camera uniform block */
+        Matrix4x4                           cameraProjection_;  /**< Projection matrix of the camera uniform block */
+        bool                                hasCameraUniforms_; /**< Was the camera uniform block set at least once? */
+
 		/**
 		 * Query the device capabilities
 		 */
@@ -279,6 +332,12 @@ class SKETCH_3D_API RenderSystem {
          */
         virtual void                        CreateTextShader() = 0;
 
+        /**
+         * Send cameraUniforms_ to the buffer bound to the CAMERA_UNIFORM_BLOCK_BINDING binding point. The render
+         * systems without uniform buffers don't implement it, their shaders never declare the camera uniform block
+         */
+        virtual void                        UploadCameraUniforms() {}
+
         /**
          * Free the render system
          */
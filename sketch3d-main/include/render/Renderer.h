@@ -5,6 +5,7 @@
 #include "math/Plane.h"
 #include "math/Vector3.h"
 
+#include "render/FrameStats.h"
 #include "render/Renderer_Common.h"
 #include "render/RenderQueue.h"
 #include "render/RenderState.h"
@@ -55,6 +56,15 @@ class SKETCH_3D_API Renderer {
 		bool				    Initialize(RenderSystem_t renderSystem,
 									       Window& window, const RenderParameters_t& renderParameters);
 
+        /**
+         * Initialize the renderer without a window. Only RENDER_SYSTEM_NULL can be used this way, which
+         * makes it possible to run the CPU side of the rendering on machines without a graphics device
+         * @param renderSystem The render system to use
+         * @param renderParameters The rendering parameters. The width and height are used as the screen size
+         * @return true if the initialization went correctly
+         */
+        bool                    Initialize(RenderSystem_t renderSystem, const RenderParameters_t& renderParameters);
+
 		/**
 		 * Change the clear color
 		 * @param red The red component of the color
@@ -197,6 +207,20 @@ class SKETCH_3D_API Renderer {
          */
         Shader*                 CreateShader() const;
 
+        /**
+         * Set the directory in which the compiled shader programs are stored. The shaders created afterwards are loaded
+         * from it when they were already compiled by the same driver, instead of being compiled again
+         * @param directory An existing directory. If empty, the compiled programs aren't stored
+         */
+        void                    SetShaderCacheDirectory(const string& directory) const;
+
+        /**
+         * Create the shaders without waiting for their compilation and link, which are only completed when the shaders
+         * are first bound. All the shaders of a scene can then be submitted before the driver finishes building them
+         * @param val Enabled if true, disabled otherwise
+         */
+        void                    EnableDeferredShaderCompilation(bool val) const;
+
         /**
          * Create a 2D texture object. The user have to free the memory returned, the Renderer will not take
          * care of it.
@@ -285,6 +309,13 @@ class SKETCH_3D_API Renderer {
          */
         void                    EnableFrustumCulling(bool bal);
 
+        /**
+         * Put the render queues in retained mode. The nodes then keep their items in the render queues from frame to
+         * frame and only the nodes that changed are updated and sorted again
+         * @param val If true, the retained mode will be enabled and disabled if false
+         */
+        void                    EnableRetainedMode(bool val);
+
         /**
          * Draw the content of a buffer object using a shader made for drawing text
          * @param bufferObject The buffer object to draw
@@ -293,6 +324,12 @@ class SKETCH_3D_API Renderer {
          */
         void                    DrawTextBuffer(BufferObject* bufferObject, Texture2D* fontAtlas, const Vector3& textColor);
 
+        /**
+         * Returns the counters of the current frame. They are reset by StartRender, so once EndRender is called they
+         * describe the whole frame
+         */
+        const FrameStats_t&     GetFrameStats() const;
+
 		const Matrix4x4&	    GetProjectionMatrix() const;
 		const Matrix4x4&	    GetViewMatrix() const;
 		const Matrix4x4&	    GetViewProjectionMatrix() const;
@@ -302,6 +339,7 @@ class SKETCH_3D_API Renderer {
 		const SceneTree&	    GetSceneTree() const;
 		SceneTree&			    GetSceneTree();
 
+        RenderSystem*           GetRenderSystem() const;
         BufferObjectManager*    GetBufferObjectManager() const;
         RenderStateCache*       GetRenderStateCache() const;
 
@@ -337,6 +375,12 @@ class SKETCH_3D_API Renderer {
 
         CullingMethod_t         cullingMethod_;         /**< Current culling method */
 
+        /**
+         * Initializes the render system that was just created
+         * @return true if the initialization went correctly
+         */
+        bool                    InitializeRenderSystem();
+
         /**
          * Initializes some default values
          */
@@ -5,6 +5,11 @@
 
 #include "system/Platform.h"
 
+#include <stdint.h>
+#include <string>
+#include <vector>
+using namespace std;
+
 namespace Sketch3D {
 // Forward struct declaration
 class Sphere;
@@ -15,7 +20,8 @@ class Sphere;
  */
 enum RenderSystem_t {
 	RENDER_SYSTEM_OPENGL,
-	RENDER_SYSTEM_DIRECT3D9
+	RENDER_SYSTEM_DIRECT3D9,
+    RENDER_SYSTEM_NULL      // Doesn't draw anything, only counts the API calls
 };
 
 /**
@@ -34,6 +40,41 @@ struct SKETCH_3D_API FrustumPlanes_t {
      * Returns true if the specified sphere is completely outside the view frustum, false otherwise
      */
     bool IsSphereOutside(const Sphere& boundingSphere) const;
+
+    /**
+     * Cull several spheres stored as a structure of arrays. The results are the same as calling IsSphereOutside on
+     * each sphere, but 4 (SSE2) or 8 (AVX) spheres are tested against the planes at a time
+     * @param centersX The x components of the world space centers
+     * @param centersY The y components of the world space centers
+     * @param centersZ The z components of the world space centers
+     * @param radii The radii of the spheres
+     * @param count The number of spheres
+     * @param visibility Bit (i % 32) of visibility[i / 32] is set if the sphere i is at least partially inside the
+     * view frustum. It must hold (count + 31) / 32 elements
+     * @return The number of visible spheres
+     */
+    size_t CullSpheres(const float* centersX, const float* centersY, const float* centersZ, const float* radii,
+                       size_t count, uint32_t* visibility) const;
+};
+
+/**
+ * @struct BoundingSpheres_t
+ * Bounding spheres stored as a structure of arrays to be culled with FrustumPlanes_t::CullSpheres
+ */
+struct SKETCH_3D_API BoundingSpheres_t {
+    vector<float>   centersX;
+    vector<float>   centersY;
+    vector<float>   centersZ;
+    vector<float>   radii;
+
+    void    Add(const Vector3& center, float radius);
+
+    /**
+     * Remove all the spheres, but keep the memory around for the next ones
+     */
+    void    Clear();
+
+    size_t  Size() const;
 };
 
 /**
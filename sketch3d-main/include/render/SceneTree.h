@@ -2,6 +2,8 @@
 #define SKETCH_3D_SCENE_TREE_H
 
 #include "render/Node.h"
+#include "render/Renderer_Common.h"
+#include "render/RenderQueue.h"
 
 #include "system/Platform.h"
 
@@ -17,9 +19,22 @@ struct SurfaceTriangles_t;
 
 // Forward class declaration
 class BufferObject;
-class RenderQueue;
 class Shader;
 class Texture2D;
+class ThreadPool;
+
+/**
+ * @struct SceneTraversalBuffer_t
+ * Data used by a thread to gather the nodes to render. It is kept around to avoid reallocating it every frame
+ */
+struct SceneTraversalBuffer_t {
+    vector<Node*>       renderableNodes;        /**< Nodes that could be added to the render queues this frame */
+    BoundingSpheres_t   boundingSpheres;        /**< World space bounding spheres of the renderable nodes */
+    vector<uint32_t>    visibility;             /**< Visibility bitmask of the renderable nodes */
+    size_t              numCulledNodes;         /**< Number of renderable nodes rejected by the frustum culling */
+    RenderQueue         opaqueRenderQueue;      /**< Opaque items added by a worker thread, merged after the traversal */
+    RenderQueue         transparentRenderQueue; /**< Transparent items added by a worker thread, merged after the traversal */
+};
 
 /**
  * @class SceneTree
@@ -52,10 +67,25 @@ class SKETCH_3D_API SceneTree {
          * @param useFrustumCulling If set to true, the frustum planes will be used to cull objects
 		 * @param opaqueRenderQueue The render queue to populate with opaque objects
          * @param transparentRenderQueue The render queue to populate with transparent objects
+         * If the queues are in retained mode, only the nodes that changed since the last frame are culled and updated
+         * in them. When the camera moves, the other nodes are culled again and only their distance to the camera is refreshed
 		 */
 		void		                Render(const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling, RenderQueue& opaqueRenderQueue,
                                            RenderQueue& transparentRenderQueue);
 
+        /**
+         * Set the number of threads used to populate the render queues. When more than one thread is used, the top
+         * level nodes are split in groups that are culled and added to separate render queues in parallel. Those
+         * queues are then merged in the same order as if a single thread was used
+         * @param numberOfThreads The number of threads to use, including the one calling Render. 1 by default
+         */
+        void                        SetNumberOfThreads(size_t numberOfThreads);
+
+        /**
+         * Returns the number of threads used to populate the render queues
+         */
+        size_t                      GetNumberOfThreads() const;
+
         /**
          * Render the static batches
          */
@@ -100,6 +130,44 @@ class SKETCH_3D_API SceneTree {
         Node                        root_;          /**< The root node of the scene tree */
         StaticBatches_t             staticBatches_; /**< List of batches to draw */
         vector<SurfaceTriangles_t*> preTransformedSurfaces_;    /**< List of pretransformed surfaces used in static batches */
+
+        ThreadPool*                 threadPool_;    /**< Threads used to populate the render queues, null if a single thread is used */
+
+        // Per frame data kept around to avoid reallocating it every frame
+        vector<Node*>               topLevelNodes_;     /**< The children of the root node */
+        vector<SceneTraversalBuffer_t*> traversalBuffers_;  /**< Data used by each group of top level nodes */
+        vector<Node*>               updatedNodes_;      /**< Nodes that have to be culled and updated in the retained render queues */
+        vector<bool>                retainedNodes_;     /**< For each updated node, are its items kept and only refreshed for the new camera? */
+
+        // Camera used the last time the retained render queues were populated
+        Matrix4x4                   retainedViewMatrix_;
+        Matrix4x4                   retainedProjectionMatrix_;
+        bool                        retainedFrustumCulling_;
+
+        /**
+         * Cull some subtrees and add their visible nodes to the render queues
+         * @param nodes The root nodes of the subtrees
+         * @param numNodes The number of subtrees
+         * @param frustumPlanes The 6 view frustum planes to cull objects that are not visible by the camera
+         * @param useFrustumCulling If set to true, the frustum planes will be used to cull objects
+         * @param buffer Storage for the nodes and their bounding spheres
+         * @param opaqueRenderQueue The render queue to populate with opaque objects
+         * @param transparentRenderQueue The render queue to populate with transparent objects
+         */
+        void                        CollectVisibleNodes(Node* const* nodes, size_t numNodes, const FrustumPlanes_t& frustumPlanes,
+                                                        bool useFrustumCulling, SceneTraversalBuffer_t& buffer,
+                                                        RenderQueue& opaqueRenderQueue, RenderQueue& transparentRenderQueue);
+
+        /**
+         * Populate render queues that are in retained mode. The nodes that didn't change are kept as is in the queues,
+         * the other ones are culled and updated
+         * @param frustumPlanes The 6 view frustum planes to cull objects that are not visible by the camera
+         * @param useFrustumCulling If set to true, the frustum planes will be used to cull objects
+         * @param opaqueRenderQueue The render queue to populate with opaque objects
+         * @param transparentRenderQueue The render queue to populate with transparent objects
+         */
+        void                        RenderRetained(const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling,
+                                                   RenderQueue& opaqueRenderQueue, RenderQueue& transparentRenderQueue);
 };
 
 }
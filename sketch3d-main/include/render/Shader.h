@@ -44,6 +44,33 @@ enum BuiltinUniform_t {
     NUM_BUILTIN_UNIFORMS
 };
 
+/**
+ * Handle of a uniform of a shader, as returned by Shader::GetUniformHandle. Setting a uniform through its handle
+ * avoids looking up its name every time
+ */
+typedef int32_t UniformHandle_t;
+
+const UniformHandle_t INVALID_UNIFORM_HANDLE = -1;
+
+/**
+ * Id given to Shader::SetAppliedMaterial when the values of the uniforms of a shader are unknown
+ */
+const uint32_t NO_APPLIED_MATERIAL = 0;
+
+/**
+ * Name and binding point of the std140 uniform block holding the camera matrices of the frame. The shaders declaring it
+ * get the camera matrices from a buffer that is updated once per frame instead of from their own uniforms:
+ *
+ * layout (std140) uniform CameraUniforms {
+ *     mat4 view;
+ *     mat4 viewProjection;
+ *     mat4 transInvView;
+ *     mat4 projection;
+ * };
+ */
+#define CAMERA_UNIFORM_BLOCK_NAME "CameraUniforms"
+#define CAMERA_UNIFORM_BLOCK_BINDING 0
+
 /**
  * @enum ShaderType_t
  * Shows the possible shaders
@@ -90,26 +117,120 @@ class SKETCH_3D_API Shader {
          */
         virtual bool    SetSource(const string& vertexSource, const string& fragmentSource) = 0;
 
-		// UNIFORM SETTERS
-        virtual bool	SetUniformInt(const string& uniform, int value) = 0;
-        virtual bool	SetUniformFloat(const string& uniform, float value) = 0;
-        virtual bool	SetUniformVector2(const string& uniform, float value1, float value2) = 0;
-        virtual bool	SetUniformVector3(const string& uniform, const Vector3& value) = 0;
-        virtual bool    SetUniformVector3Array(const string& uniform, const Vector3* values, int arraySize) = 0;
-        virtual bool	SetUniformVector4(const string& uniform, const Vector4& value) = 0;
-        virtual bool	SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value) = 0;
-        virtual bool	SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value) = 0;
-        virtual bool    SetUniformMatrix4x4Array(const string& uniform, const Matrix4x4* values, int arraySize) = 0;
-        virtual bool	SetUniformTexture(const string& uniform, const Texture* texture) = 0;
+        /**
+         * Resolve the name of a uniform to a handle that can be used to set it
+         * @param uniform The name of the uniform
+         * @return The handle of the uniform, INVALID_UNIFORM_HANDLE if the shader doesn't have such a uniform
+         */
+        virtual UniformHandle_t GetUniformHandle(const string& uniform) const = 0;
+
+        /**
+         * Returns the handle of a builtin uniform, resolved when the shader was linked
+         * @param builtinUniform The builtin uniform
+         * @return The handle of the uniform, INVALID_UNIFORM_HANDLE if the shader doesn't use it
+         */
+        UniformHandle_t GetBuiltinUniformHandle(BuiltinUniform_t builtinUniform) const { return builtinUniformHandles_[builtinUniform]; }
+
+		// UNIFORM SETTERS. The name of the uniform is looked up every time, the handles should be used for the uniforms
+        // set every frame
+        bool	        SetUniformInt(const string& uniform, int value);
+        bool	        SetUniformFloat(const string& uniform, float value);
+        bool	        SetUniformVector2(const string& uniform, float value1, float value2);
+        bool	        SetUniformVector3(const string& uniform, const Vector3& value);
+        bool            SetUniformVector3Array(const string& uniform, const Vector3* values, int arraySize);
+        bool	        SetUniformVector4(const string& uniform, const Vector4& value);
+        bool	        SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value);
+        bool	        SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value);
+        bool            SetUniformMatrix4x4Array(const string& uniform, const Matrix4x4* values, int arraySize);
+        bool	        SetUniformTexture(const string& uniform, const Texture* texture);
+
+		// UNIFORM SETTERS BY HANDLE. They return false if the handle is INVALID_UNIFORM_HANDLE
+        bool	        SetUniformInt(UniformHandle_t uniform, int value);
+        bool	        SetUniformFloat(UniformHandle_t uniform, float value);
+        bool	        SetUniformVector2(UniformHandle_t uniform, float value1, float value2);
+        bool	        SetUniformVector3(UniformHandle_t uniform, const Vector3& value);
+        bool            SetUniformVector3Array(UniformHandle_t uniform, const Vector3* values, int arraySize);
+        bool	        SetUniformVector4(UniformHandle_t uniform, const Vector4& value);
+        bool	        SetUniformMatrix3x3(UniformHandle_t uniform, const Matrix3x3& value);
+        bool	        SetUniformMatrix4x4(UniformHandle_t uniform, const Matrix4x4& value);
+        bool            SetUniformMatrix4x4Array(UniformHandle_t uniform, const Matrix4x4* values, int arraySize);
+        bool	        SetUniformTexture(UniformHandle_t uniform, const Texture* texture);
+
+        /**
+         * Tell the render queues that the vertex shader reads the model matrix from the per instance vertex attributes
+         * set up by BufferObject::PrepareInstanceBuffers. The render queues can then draw the nodes using this shader
+         * with instanced rendering even if they didn't ask for it
+         * @param supportsInstancing Can the shader be used for instanced rendering?
+         */
+        void            SetSupportsInstancing(bool supportsInstancing);
+        bool            SupportsInstancing() const;
+
+        /**
+         * Does the shader read the camera matrices from the CAMERA_UNIFORM_BLOCK_NAME uniform block? If so, the view,
+         * projection, view-projection and transposed inverse view builtin uniforms don't have to be set on it
+         */
+        bool            UsesCameraUniformBlock() const { return usesCameraUniformBlock_; }
+
+        /**
+         * Remember which material's parameters were the last ones sent to the shader, so that applying the same
+         * material again doesn't send them again
+         * @param materialId The id of the material, NO_APPLIED_MATERIAL if the parameters of the shader are unknown
+         */
+        void            SetAppliedMaterial(uint32_t materialId) const { appliedMaterial_ = materialId; }
+        uint32_t        GetAppliedMaterial() const { return appliedMaterial_; }
+
+        /**
+         * Returns the number of times the shader was linked. The handles resolved before a link are invalid after it
+         */
+        uint32_t        GetLinkCount() const { return linkCount_; }
+
+        /**
+         * Returns true if the program was linked but the result wasn't waited for yet. Looking up a uniform handle of
+         * such a shader waits for the link
+         */
+        virtual bool    IsLinkPending() const { return false; }
 
         uint16_t        GetId() const { return id_; }
 
 	protected:
         uint16_t        id_;                /**< Id of the shader */
+        bool            supportsInstancing_;    /**< Does the vertex shader read the per instance model matrix? */
+        bool            usesCameraUniformBlock_;    /**< Does the shader declare the camera uniform block? */
+        UniformHandle_t builtinUniformHandles_[NUM_BUILTIN_UNIFORMS];   /**< Handles of the builtin uniforms */
+        uint32_t        linkCount_;         /**< Number of times the shader was linked */
+        mutable uint32_t appliedMaterial_;  /**< Id of the last material applied to the shader */
         static uint16_t nextAvailableId_;
+
+        /**
+         * Resolve the handles of the builtin uniforms. Has to be called by the implementations once the shader is linked,
+         * which also forgets the material applied to the shader
+         */
+        void            ResolveBuiltinUniforms();
+
+        // The uniform setters of the implementations. The handle is always valid
+        virtual void    SetUniformIntImpl(UniformHandle_t uniform, int value) = 0;
+        virtual void    SetUniformFloatImpl(UniformHandle_t uniform, float value) = 0;
+        virtual void    SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2) = 0;
+        virtual void    SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value) = 0;
+        virtual void    SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize) = 0;
+        virtual void    SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value) = 0;
+        virtual void    SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value) = 0;
+        virtual void    SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value) = 0;
+        virtual void    SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize) = 0;
+        virtual void    SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture) = 0;
+
+    private:
+        /**
+         * Resolve the name of a uniform, logging it if the shader doesn't have such a uniform
+         */
+        UniformHandle_t FindUniformHandle(const string& uniform) const;
 };
 
 extern "C" {
+    /**
+     * Change the name of a builtin uniform. The shaders resolve the builtin uniforms when they are linked, so the
+     * names have to be changed before the shaders are created
+     */
     SKETCH_3D_API void SetBuiltinUniformName(BuiltinUniform_t builtinUniform, const string& uniformName);
     SKETCH_3D_API const string& GetBuiltinUniformName(BuiltinUniform_t builtinUniform);
 }
@@ -94,7 +94,7 @@ class SKETCH_3D_API Text {
         Vector3                     textColor_;             /**< Color of the text */
         bool                        bufferText_;            /**< Used to determine if we are between a Begin and an End call */
         vector<float>               textVertices_;          /**< List of vertices */
-        vector<unsigned short>      textIndices_;           /**< List of indices */
+        vector<unsigned int>        textIndices_;           /**< List of indices */
 
         /**
          * Constructor
@@ -69,6 +69,15 @@ namespace Sketch3D
 #   define HAVE_SSE 0
 #endif
 
+// Allows a single function to use an instruction set that isn't enabled for
+// the whole build (i.e. AVX). Such a function must only be called after
+// checking PlatformInformation::HasCpuFeature
+#if COMPILER == COMPILER_GNUC
+#   define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#   define SIMD_TARGET(isa)
+#endif
+
 // DLL stuff
 #if !defined(SKETCH_3D_BUILD_STATIC)
 #   if PLATFORM == PLATFORM_WIN32
@@ -108,7 +117,9 @@ class PlatformInformation
         enum CpuFeatures {
             SSE         = 1 << 0,
             SSE2        = 1 << 1,
-            MMX         = 1 << 2
+            MMX         = 1 << 2,
+            AVX         = 1 << 3,
+            FMA         = 1 << 4
         };
 
         /**
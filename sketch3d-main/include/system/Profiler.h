@@ -0,0 +1,166 @@
+#ifndef SKETCH_3D_PROFILER_H
+#define SKETCH_3D_PROFILER_H
+
+#include "system/Platform.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+/**
+ * @struct ProfilerEvent_t
+ * A zone recorded by the profiler. The times are in microseconds since the profiler was created
+ */
+struct ProfilerEvent_t {
+    const char*         name;   /**< Name of the zone, must be a string literal */
+    long long           start;  /**< Time at which the zone was entered */
+    long long           end;    /**< Time at which the zone was exited */
+};
+
+/**
+ * @struct ProfilerThreadBuffer_t
+ * Events recorded by a single thread. Only the owning thread appends to it, the lock is only contended when the
+ * events are exported or cleared
+ */
+struct ProfilerThreadBuffer_t {
+    size_t                  threadIndex;    /**< Index of the thread, in the order in which they recorded their first zone */
+    mutex                   lock;           /**< Protects the events against an export happening at the same time */
+    vector<ProfilerEvent_t> events;         /**< The zones recorded by the thread */
+};
+
+/**
+ * @class Profiler
+ * This class is a singleton that records timed zones, usually through the PROFILE_ZONE macro, and exports them in the
+ * Chrome trace event format so that they can be inspected in chrome://tracing. Each thread records its zones in its
+ * own buffer. The profiler is disabled by default; when disabled, entering a zone costs a single flag check. When
+ * SKETCH_3D_PROFILING isn't defined, the PROFILE_ZONE macro expands to nothing.
+ */
+class SKETCH_3D_API Profiler {
+	public:
+		/**
+		 * Destructor
+		 */
+                           ~Profiler();
+
+        static Profiler*    GetInstance();
+
+        /**
+         * Start or stop recording zones
+         * @param enabled If set to true, the zones will be recorded
+         */
+        void                SetEnabled(bool enabled);
+
+        /**
+         * Discard all the zones recorded so far
+         */
+        void                Clear();
+
+        /**
+         * Record a zone for the calling thread
+         * @param name The name of the zone, must be a string literal
+         * @param start The time at which the zone was entered, as returned by GetTime
+         * @param end The time at which the zone was exited, as returned by GetTime
+         */
+        void                RecordZone(const char* name, long long start, long long end);
+
+        /**
+         * Export all the recorded zones in the Chrome trace event format
+         * @param filename The name of the json file to write
+         * @return true if the file could be written, false otherwise
+         */
+        bool                ExportChromeTrace(const string& filename);
+
+        /**
+         * Returns the number of zones recorded so far, across all threads
+         */
+        size_t              GetNumberOfEvents();
+
+        /**
+         * Returns the current time in microseconds since the profiler was created
+         */
+        long long           GetTime() const;
+
+        bool                IsEnabled() const { return enabled_.load(memory_order_relaxed); }
+
+	private:
+		static Profiler     instance_;	/**< Singleton's instance */
+
+        atomic<bool>                    enabled_;       /**< Are the zones being recorded? */
+        long long                       epoch_;         /**< Time at which the profiler was created */
+        mutex                           buffersLock_;   /**< Protects the list of thread buffers */
+        vector<ProfilerThreadBuffer_t*> threadBuffers_; /**< The buffers of all the threads that recorded a zone */
+
+		/**
+		 * Constructor
+		 */
+                            Profiler();
+
+		/**
+		 * Copy-constructor to disallow copy
+		 */
+                            Profiler(const Profiler& src);
+
+		/**
+		 * Assignment operator to disallow assignment
+		 */
+		Profiler&           operator= (const Profiler& rhs);
+
+        /**
+         * Returns the buffer of the calling thread, creating it the first time
+         */
+        ProfilerThreadBuffer_t* GetThreadBuffer();
+};
+
+/**
+ * @class ProfilerZone
+ * Records the time spent between its construction and its destruction as a zone of the profiler
+ */
+class SKETCH_3D_API ProfilerZone {
+    public:
+        /**
+         * Constructor. Nothing is recorded if the profiler is disabled
+         * @param name The name of the zone, must be a string literal
+         */
+        explicit            ProfilerZone(const char* name) : name_(nullptr) {
+                                Profiler* profiler = Profiler::GetInstance();
+                                if (profiler->IsEnabled()) {
+                                    name_ = name;
+                                    start_ = profiler->GetTime();
+                                }
+                            }
+
+        /**
+         * Destructor
+         */
+                           ~ProfilerZone() {
+                                if (name_ != nullptr) {
+                                    Profiler* profiler = Profiler::GetInstance();
+                                    profiler->RecordZone(name_, start_, profiler->GetTime());
+                                }
+                            }
+
+    private:
+        const char*         name_;  /**< Name of the zone, null if the profiler was disabled when it was entered */
+        long long           start_; /**< Time at which the zone was entered */
+
+                            ProfilerZone(const ProfilerZone& src);
+        ProfilerZone&       operator= (const ProfilerZone& rhs);
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// Time the rest of the enclosing scope. The name must be a string literal
+#if defined(SKETCH_3D_PROFILING)
+#   define PROFILE_ZONE(name) Sketch3D::ProfilerZone PROFILE_CONCAT(profilerZone_, __LINE__)(name)
+#else
+#   define PROFILE_ZONE(name)
+#endif
+
+}
+
+#endif
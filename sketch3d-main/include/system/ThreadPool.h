@@ -0,0 +1,76 @@
+#ifndef SKETCH_3D_THREAD_POOL_H
+#define SKETCH_3D_THREAD_POOL_H
+
+#include "system/Platform.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+/**
+ * @class ThreadPool
+ * A set of worker threads that are kept alive to execute tasks in parallel. The tasks are identified by an index and
+ * are distributed dynamically to the worker threads and to the thread that asked for them to be run
+ */
+class SKETCH_3D_API ThreadPool {
+    public:
+        /**
+         * Constructor
+         * @param numberOfThreads The total number of threads executing the tasks, including the calling thread. A value of 1
+         * means that the tasks are executed on the calling thread only
+         */
+        explicit            ThreadPool(size_t numberOfThreads);
+
+        /**
+         * Destructor. Waits for the worker threads to exit
+         */
+                           ~ThreadPool();
+
+        /**
+         * Execute the tasks and wait for all of them to complete
+         * @param numberOfTasks The number of tasks to execute
+         * @param task The function executing a task, called once with each index in [0, numberOfTasks)
+         */
+        void                Run(size_t numberOfTasks, const function<void(size_t)>& task);
+
+        /**
+         * Returns the total number of threads executing the tasks, including the calling thread
+         */
+        size_t              GetNumberOfThreads() const;
+
+    private:
+        vector<thread>      threads_;           /**< The worker threads */
+        mutex               lock_;              /**< Protects the state shared with the worker threads */
+        condition_variable  workAvailable_;     /**< Signaled when tasks are available or when the pool is destroyed */
+        condition_variable  workDone_;          /**< Signaled when the last worker thread is done with the tasks */
+
+        const function<void(size_t)>*   task_;  /**< The function executing the current tasks */
+        size_t              numberOfTasks_;     /**< Number of current tasks */
+        atomic<size_t>      nextTask_;          /**< Index of the next task to execute */
+        size_t              numberOfBusyThreads_;   /**< Number of worker threads that are still executing tasks */
+        unsigned int        generation_;        /**< Incremented every time new tasks are run */
+        bool                stop_;              /**< Set to true when the worker threads have to exit */
+
+        /**
+         * Main function of the worker threads
+         */
+        void                WorkerLoop();
+
+        /**
+         * Execute tasks until there is no more of them
+         */
+        void                ExecuteTasks();
+
+                            ThreadPool(const ThreadPool& src);
+        ThreadPool&         operator= (const ThreadPool& rhs);
+};
+
+}
+
+#endif
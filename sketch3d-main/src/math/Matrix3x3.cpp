@@ -210,6 +210,23 @@ Vector3 Matrix3x3::operator*(const Vector3& v) const
     return w;
 }
 
+void Matrix3x3::TransformVectors(const Vector3* vectors, Vector3* result, size_t count) const {
+    // The batch kernels are implemented once, for the 4x4 matrices
+    Matrix4x4 m(data_[0][0], data_[0][1], data_[0][2], 0.0f,
+                data_[1][0], data_[1][1], data_[1][2], 0.0f,
+                data_[2][0], data_[2][1], data_[2][2], 0.0f,
+                0.0f,        0.0f,        0.0f,        1.0f);
+    m.TransformDirections(vectors, result, count);
+}
+
+void Matrix3x3::TransformNormals(const Vector3* normals, Vector3* result, size_t count) const {
+    Matrix4x4 m(data_[0][0], data_[0][1], data_[0][2], 0.0f,
+                data_[1][0], data_[1][1], data_[1][2], 0.0f,
+                data_[2][0], data_[2][1], data_[2][2], 0.0f,
+                0.0f,        0.0f,        0.0f,        1.0f);
+    m.TransformNormals(normals, result, count);
+}
+
 Matrix3x3& Matrix3x3::operator=(const Matrix4x4& m)
 {
     for (int i = 0; i < 3; i++) {
@@ -5,11 +5,50 @@
 #include "math/Vector3.h"
 #include "math/Vector4.h"
 
+#include "system/Platform.h"
+
 #include <math.h>
 
 namespace Sketch3D
 {
 
+static bool IsKernelSupported(MatrixKernel_t kernel) {
+    switch (kernel) {
+        case MATRIX_KERNEL_SCALAR:
+            return true;
+
+#if HAVE_SSE
+        case MATRIX_KERNEL_SSE2:
+            return PlatformInformation::HasCpuFeature(PlatformInformation::SSE2);
+
+        case MATRIX_KERNEL_AVX_FMA:
+            return PlatformInformation::HasCpuFeature(PlatformInformation::SSE2) &&
+                   PlatformInformation::HasCpuFeature(PlatformInformation::AVX) &&
+                   PlatformInformation::HasCpuFeature(PlatformInformation::FMA);
+#endif
+
+        default:
+            return false;
+    }
+}
+
+static MatrixKernel_t SelectBestKernel() {
+    if (IsKernelSupported(MATRIX_KERNEL_AVX_FMA)) {
+        return MATRIX_KERNEL_AVX_FMA;
+    } else if (IsKernelSupported(MATRIX_KERNEL_SSE2)) {
+        return MATRIX_KERNEL_SSE2;
+    }
+
+    return MATRIX_KERNEL_SCALAR;
+}
+
+// The kernel is selected lazily rather than during the static initialization
+// because querying the CPU features goes through the logger
+static MatrixKernel_t& CurrentKernel() {
+    static MatrixKernel_t kernel = SelectBestKernel();
+    return kernel;
+}
+
 const Matrix4x4 Matrix4x4::IDENTITY(1.0f, 0.0f, 0.0f, 0.0f,
                                     0.0f, 1.0f, 0.0f, 0.0f,
                                     0.0f, 0.0f, 1.0f, 0.0f,
@@ -85,78 +124,68 @@ Matrix4x4::Matrix4x4(const Matrix3x3& src) {
 
 Matrix4x4 Matrix4x4::Transpose() const
 {
-    float data[16];
-    int cnt = 0;
-
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            data[cnt++] = data_[j][i];
-        }
+    Matrix4x4 mat;
+
+    switch (CurrentKernel()) {
+#if HAVE_SSE
+        case MATRIX_KERNEL_AVX_FMA:
+        case MATRIX_KERNEL_SSE2:
+            TransposeSSE2(*this, mat);
+            break;
+#endif
+
+        default:
+            TransposeScalar(*this, mat);
+            break;
     }
 
-    return Matrix4x4(data);
+    return mat;
 }
 
 Matrix4x4 Matrix4x4::Inverse() const {
-    // From OGRE source code
-    float m00 = data_[0][0], m01 = data_[0][1], m02 = data_[0][2], m03 = data_[0][3];
-    float m10 = data_[1][0], m11 = data_[1][1], m12 = data_[1][2], m13 = data_[1][3];
-    float m20 = data_[2][0], m21 = data_[2][1], m22 = data_[2][2], m23 = data_[2][3];
-    float m30 = data_[3][0], m31 = data_[3][1], m32 = data_[3][2], m33 = data_[3][3];
-
-    float v0 = m20 * m31 - m21 * m30;
-    float v1 = m20 * m32 - m22 * m30;
-    float v2 = m20 * m33 - m23 * m30;
-    float v3 = m21 * m32 - m22 * m31;
-    float v4 = m21 * m33 - m23 * m31;
-    float v5 = m22 * m33 - m23 * m32;
-
-    float t00 =  (v5 * m11 - v4 * m12 + v3 * m13);
-    float t10 = -(v5 * m10 - v2 * m12 + v1 * m13);
-    float t20 =  (v4 * m10 - v2 * m11 + v0 * m13);
-    float t30 = -(v3 * m10 - v1 * m11 + v0 * m12);
-
-    float invDet = 1.0f / (t00 * m00 + t10 * m01 + t20 * m02 + t30 * m03);
-
-    float d00 = t00 * invDet;
-    float d10 = t10 * invDet;
-    float d20 = t20 * invDet;
-    float d30 = t30 * invDet;
-
-    float d01 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
-    float d11 =  (v5 * m00 - v2 * m02 + v1 * m03) * invDet;
-    float d21 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
-    float d31 =  (v3 * m00 - v1 * m01 + v0 * m02) * invDet;
-
-    v0 = m10 * m31 - m11 * m30;
-    v1 = m10 * m32 - m12 * m30;
-    v2 = m10 * m33 - m13 * m30;
-    v3 = m11 * m32 - m12 * m31;
-    v4 = m11 * m33 - m13 * m31;
-    v5 = m12 * m33 - m13 * m32;
-
-    float d02 =  (v5 * m01 - v4 * m02 + v3 * m03) * invDet;
-    float d12 = -(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
-    float d22 =  (v4 * m00 - v2 * m01 + v0 * m03) * invDet;
-    float d32 = -(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
-
-    v0 = m21 * m10 - m20 * m11;
-    v1 = m22 * m10 - m20 * m12;
-    v2 = m23 * m10 - m20 * m13;
-    v3 = m22 * m11 - m21 * m12;
-    v4 = m23 * m11 - m21 * m13;
-    v5 = m23 * m12 - m22 * m13;
+    Matrix4x4 mat;
+
+    switch (CurrentKernel()) {
+#if HAVE_SSE
+        case MATRIX_KERNEL_AVX_FMA:
+        case MATRIX_KERNEL_SSE2:
+            InverseSSE2(*this, mat);
+            break;
+#endif
+
+        default:
+            InverseScalar(*this, mat);
+            break;
+    }
 
-    float d03 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
-    float d13 =  (v5 * m00 - v2 * m02 + v1 * m03) * invDet;
-    float d23 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
-    float d33 =  (v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+    return mat;
+}
 
-    return Matrix4x4(
-        d00, d01, d02, d03,
-        d10, d11, d12, d13,
-        d20, d21, d22, d23,
-        d30, d31, d32, d33);
+Matrix4x4 Matrix4x4::InverseAffine() const {
+    // The inverse of [A t] is [inv(A) -inv(A)t], where inv(A) is the inverse
+    // of the 3x3 rotation and scale part
+    float c00 = data_[1][1] * data_[2][2] - data_[1][2] * data_[2][1];
+    float c01 = data_[0][2] * data_[2][1] - data_[0][1] * data_[2][2];
+    float c02 = data_[0][1] * data_[1][2] - data_[0][2] * data_[1][1];
+    float c10 = data_[1][2] * data_[2][0] - data_[1][0] * data_[2][2];
+    float c11 = data_[0][0] * data_[2][2] - data_[0][2] * data_[2][0];
+    float c12 = data_[0][2] * data_[1][0] - data_[0][0] * data_[1][2];
+    float c20 = data_[1][0] * data_[2][1] - data_[1][1] * data_[2][0];
+    float c21 = data_[0][1] * data_[2][0] - data_[0][0] * data_[2][1];
+    float c22 = data_[0][0] * data_[1][1] - data_[0][1] * data_[1][0];
+
+    float invDet = 1.0f / (data_[0][0] * c00 + data_[0][1] * c10 + data_[0][2] * c20);
+
+    c00 *= invDet; c01 *= invDet; c02 *= invDet;
+    c10 *= invDet; c11 *= invDet; c12 *= invDet;
+    c20 *= invDet; c21 *= invDet; c22 *= invDet;
+
+    float tx = data_[0][3], ty = data_[1][3], tz = data_[2][3];
+
+    return Matrix4x4(c00, c01, c02, -(c00 * tx + c01 * ty + c02 * tz),
+                     c10, c11, c12, -(c10 * tx + c11 * ty + c12 * tz),
+                     c20, c21, c22, -(c20 * tx + c21 * ty + c22 * tz),
+                     0.0f, 0.0f, 0.0f, 1.0f);
 }
 
 void Matrix4x4::Translate(const Vector3& translation) {
@@ -248,14 +277,121 @@ Vector4 Matrix4x4::operator*(const Vector4& v) const
 {
     Vector4 w;
 
-    w.x = v.x * data_[0][0] + v.y * data_[0][1] + v.z * data_[0][2] + v.w * data_[0][3];
-    w.y = v.x * data_[1][0] + v.y * data_[1][1] + v.z * data_[1][2] + v.w * data_[1][3];
-    w.z = v.x * data_[2][0] + v.y * data_[2][1] + v.z * data_[2][2] + v.w * data_[2][3];
-    w.w = v.x * data_[3][0] + v.y * data_[3][1] + v.z * data_[3][2] + v.w * data_[3][3];
+    switch (CurrentKernel()) {
+#if HAVE_SSE
+        case MATRIX_KERNEL_AVX_FMA:
+            TransformAVX(*this, v, w);
+            break;
+
+        case MATRIX_KERNEL_SSE2:
+            TransformSSE2(*this, v, w);
+            break;
+#endif
+
+        default:
+            TransformScalar(*this, v, w);
+            break;
+    }
 
     return w;
 }
 
+Matrix4x4 Matrix4x4::operator*(const Matrix4x4& m) const
+{
+    Matrix4x4 mat;
+
+    switch (CurrentKernel()) {
+#if HAVE_SSE
+        case MATRIX_KERNEL_AVX_FMA:
+            MultiplyAVX(*this, m, mat);
+            break;
+
+        case MATRIX_KERNEL_SSE2:
+            MultiplySSE2(*this, m, mat);
+            break;
+#endif
+
+        default:
+            MultiplyScalar(*this, m, mat);
+            break;
+    }
+
+    return mat;
+}
+
+void Matrix4x4::operator*=(const Matrix4x4& m)
+{
+    switch (CurrentKernel()) {
+#if HAVE_SSE
+        case MATRIX_KERNEL_AVX_FMA:
+            MultiplyAVX(*this, m, *this);
+            break;
+
+        case MATRIX_KERNEL_SSE2:
+            MultiplySSE2(*this, m, *this);
+            break;
+#endif
+
+        default:
+            MultiplyScalar(*this, m, *this);
+            break;
+    }
+}
+
+void Matrix4x4::TransformPoints(const Vector3* points, Vector3* result, size_t count) const {
+    TransformVector3Batch(points, result, count, 1.0f, false);
+}
+
+void Matrix4x4::TransformDirections(const Vector3* directions, Vector3* result, size_t count) const {
+    TransformVector3Batch(directions, result, count, 0.0f, false);
+}
+
+void Matrix4x4::TransformNormals(const Vector3* normals, Vector3* result, size_t count) const {
+    TransformVector3Batch(normals, result, count, 0.0f, true);
+}
+
+void Matrix4x4::TransformVectors(const Vector4* vectors, Vector4* result, size_t count) const {
+    switch (CurrentKernel()) {
+#if HAVE_SSE
+        case MATRIX_KERNEL_AVX_FMA:
+            for (size_t i = 0; i < count; i++) {
+                TransformAVX(*this, vectors[i], result[i]);
+            }
+            break;
+
+        case MATRIX_KERNEL_SSE2:
+            for (size_t i = 0; i < count; i++) {
+                TransformSSE2(*this, vectors[i], result[i]);
+            }
+            break;
+#endif
+
+        default:
+            for (size_t i = 0; i < count; i++) {
+                TransformScalar(*this, vectors[i], result[i]);
+            }
+            break;
+    }
+}
+
+void Matrix4x4::TransformVector3Batch(const Vector3* v, Vector3* result, size_t count, float w, bool normalize) const {
+    switch (CurrentKernel()) {
+#if HAVE_SSE
+        case MATRIX_KERNEL_AVX_FMA:
+            TransformVector3AVX(*this, v, result, count, w, normalize);
+            break;
+
+        case MATRIX_KERNEL_SSE2:
+            TransformVector3SSE2(*this, v, result, count, w, normalize);
+            break;
+#endif
+
+        default:
+            TransformVector3Scalar(*this, v, result, count, w, normalize);
+            break;
+    }
+}
+
 Matrix4x4& Matrix4x4::operator=(const Matrix3x3& m)
 {
     for (int i = 0; i < 3; i++) {
@@ -267,5 +403,155 @@ Matrix4x4& Matrix4x4::operator=(const Matrix3x3& m)
     return *this;
 }
 
+bool Matrix4x4::SetKernel(MatrixKernel_t kernel) {
+    if (!IsKernelSupported(kernel)) {
+        return false;
+    }
+
+    CurrentKernel() = kernel;
+    return true;
+}
+
+MatrixKernel_t Matrix4x4::GetKernel() {
+    return CurrentKernel();
+}
+
+void Matrix4x4::MultiplyScalar(const Matrix4x4& lhs, const Matrix4x4& rhs, Matrix4x4& result) {
+    const float (*a)[4] = lhs.data_;
+    const float (*b)[4] = rhs.data_;
+    float data[4][4];
+
+    for (int i = 0; i < 4; i++) {
+        data[i][0] = a[i][0] * b[0][0] + a[i][1] * b[1][0] + a[i][2] * b[2][0] + a[i][3] * b[3][0];
+        data[i][1] = a[i][0] * b[0][1] + a[i][1] * b[1][1] + a[i][2] * b[2][1] + a[i][3] * b[3][1];
+        data[i][2] = a[i][0] * b[0][2] + a[i][1] * b[1][2] + a[i][2] * b[2][2] + a[i][3] * b[3][2];
+        data[i][3] = a[i][0] * b[0][3] + a[i][1] * b[1][3] + a[i][2] * b[2][3] + a[i][3] * b[3][3];
+    }
+
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            result.data_[i][j] = data[i][j];
+        }
+    }
 }
 
+void Matrix4x4::TransposeScalar(const Matrix4x4& m, Matrix4x4& result) {
+    float data[4][4];
+
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            data[i][j] = m.data_[j][i];
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            result.data_[i][j] = data[i][j];
+        }
+    }
+}
+
+void Matrix4x4::InverseScalar(const Matrix4x4& m, Matrix4x4& result) {
+    // From OGRE source code
+    float m00 = m.data_[0][0], m01 = m.data_[0][1], m02 = m.data_[0][2], m03 = m.data_[0][3];
+    float m10 = m.data_[1][0], m11 = m.data_[1][1], m12 = m.data_[1][2], m13 = m.data_[1][3];
+    float m20 = m.data_[2][0], m21 = m.data_[2][1], m22 = m.data_[2][2], m23 = m.data_[2][3];
+    float m30 = m.data_[3][0], m31 = m.data_[3][1], m32 = m.data_[3][2], m33 = m.data_[3][3];
+
+    float v0 = m20 * m31 - m21 * m30;
+    float v1 = m20 * m32 - m22 * m30;
+    float v2 = m20 * m33 - m23 * m30;
+    float v3 = m21 * m32 - m22 * m31;
+    float v4 = m21 * m33 - m23 * m31;
+    float v5 = m22 * m33 - m23 * m32;
+
+    float t00 =  (v5 * m11 - v4 * m12 + v3 * m13);
+    float t10 = -(v5 * m10 - v2 * m12 + v1 * m13);
+    float t20 =  (v4 * m10 - v2 * m11 + v0 * m13);
+    float t30 = -(v3 * m10 - v1 * m11 + v0 * m12);
+
+    float invDet = 1.0f / (t00 * m00 + t10 * m01 + t20 * m02 + t30 * m03);
+
+    float d00 = t00 * invDet;
+    float d10 = t10 * invDet;
+    float d20 = t20 * invDet;
+    float d30 = t30 * invDet;
+
+    float d01 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
+    float d11 =  (v5 * m00 - v2 * m02 + v1 * m03) * invDet;
+    float d21 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
+    float d31 =  (v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+
+    v0 = m10 * m31 - m11 * m30;
+    v1 = m10 * m32 - m12 * m30;
+    v2 = m10 * m33 - m13 * m30;
+    v3 = m11 * m32 - m12 * m31;
+    v4 = m11 * m33 - m13 * m31;
+    v5 = m12 * m33 - m13 * m32;
+
+    float d02 =  (v5 * m01 - v4 * m02 + v3 * m03) * invDet;
+    float d12 = -(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
+    float d22 =  (v4 * m00 - v2 * m01 + v0 * m03) * invDet;
+    float d32 = -(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+
+    v0 = m21 * m10 - m20 * m11;
+    v1 = m22 * m10 - m20 * m12;
+    v2 = m23 * m10 - m20 * m13;
+    v3 = m22 * m11 - m21 * m12;
+    v4 = m23 * m11 - m21 * m13;
+    v5 = m23 * m12 - m22 * m13;
+
+    float d03 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
+    float d13 =  (v5 * m00 - v2 * m02 + v1 * m03) * invDet;
+    float d23 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
+    float d33 =  (v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+
+    result = Matrix4x4(
+        d00, d01, d02, d03,
+        d10, d11, d12, d13,
+        d20, d21, d22, d23,
+        d30, d31, d32, d33);
+}
+
+void Matrix4x4::TransformScalar(const Matrix4x4& m, const Vector4& v, Vector4& result) {
+    float x = v.x * m.data_[0][0] + v.y * m.data_[0][1] + v.z * m.data_[0][2] + v.w * m.data_[0][3];
+    float y = v.x * m.data_[1][0] + v.y * m.data_[1][1] + v.z * m.data_[1][2] + v.w * m.data_[1][3];
+    float z = v.x * m.data_[2][0] + v.y * m.data_[2][1] + v.z * m.data_[2][2] + v.w * m.data_[2][3];
+    float w = v.x * m.data_[3][0] + v.y * m.data_[3][1] + v.z * m.data_[3][2] + v.w * m.data_[3][3];
+
+    result.x = x;
+    result.y = y;
+    result.z = z;
+    result.w = w;
+}
+
+void Matrix4x4::TransformVector3Scalar(const Matrix4x4& m, const Vector3* v, Vector3* result, size_t count, float w,
+                                       bool normalize)
+{
+    const float tx = w * m.data_[0][3];
+    const float ty = w * m.data_[1][3];
+    const float tz = w * m.data_[2][3];
+
+    for (size_t i = 0; i < count; i++) {
+        float x = v[i].x * m.data_[0][0] + v[i].y * m.data_[0][1] + v[i].z * m.data_[0][2] + tx;
+        float y = v[i].x * m.data_[1][0] + v[i].y * m.data_[1][1] + v[i].z * m.data_[1][2] + ty;
+        float z = v[i].x * m.data_[2][0] + v[i].y * m.data_[2][1] + v[i].z * m.data_[2][2] + tz;
+
+        if (normalize) {
+            float length = sqrtf(x*x + y*y + z*z);
+            if (length != 0.0f) {
+                x /= length;
+                y /= length;
+                z /= length;
+            } else {
+                x = y = z = 0.0f;
+            }
+        }
+
+        result[i].x = x;
+        result[i].y = y;
+        result[i].z = z;
+    }
+}
+
+}
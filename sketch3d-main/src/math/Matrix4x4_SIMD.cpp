@@ -0,0 +1,299 @@
+#include "math/Matrix4x4.h"
+
+#include "math/Vector4.h"
+
+#include "system/Platform.h"
+
+#if HAVE_SSE
+#   include <emmintrin.h>
+#   include <immintrin.h>
+#endif
+
+namespace Sketch3D
+{
+
+#if HAVE_SSE
+
+// The components are given in the order in which they end up in the result,
+// which is the reverse of _MM_SHUFFLE
+#define SHUFFLE_MASK(x, y, z, w)    ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define SWIZZLE(v, x, y, z, w)      _mm_shuffle_ps((v), (v), SHUFFLE_MASK(x, y, z, w))
+#define SHUFFLE(a, b, x, y, z, w)   _mm_shuffle_ps((a), (b), SHUFFLE_MASK(x, y, z, w))
+#define SHUFFLE256(a, b, x, y, z, w) _mm256_shuffle_ps((a), (b), SHUFFLE_MASK(x, y, z, w))
+
+// The inverse works on the 2x2 sub matrices of the 4x4 matrix, each one
+// stored row by row in a single register
+
+/**
+ * 2x2 matrix multiplication a * b
+ */
+SIMD_TARGET("sse2")
+static INLINE __m128 Matrix2x2Multiply(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+/**
+ * 2x2 matrix multiplication adj(a) * b
+ */
+SIMD_TARGET("sse2")
+static INLINE __m128 Matrix2x2AdjointMultiply(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+/**
+ * 2x2 matrix multiplication a * adj(b)
+ */
+SIMD_TARGET("sse2")
+static INLINE __m128 Matrix2x2MultiplyAdjoint(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+SIMD_TARGET("sse2")
+void Matrix4x4::MultiplySSE2(const Matrix4x4& lhs, const Matrix4x4& rhs, Matrix4x4& result) {
+    __m128 row0 = _mm_loadu_ps(rhs.data_[0]);
+    __m128 row1 = _mm_loadu_ps(rhs.data_[1]);
+    __m128 row2 = _mm_loadu_ps(rhs.data_[2]);
+    __m128 row3 = _mm_loadu_ps(rhs.data_[3]);
+
+    // Same order of operations as the scalar kernel, so the results are
+    // identical
+    for (int i = 0; i < 4; i++) {
+        const float* a = lhs.data_[i];
+        __m128 sum = _mm_mul_ps(_mm_set1_ps(a[0]), row0);
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[1]), row1));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[2]), row2));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[3]), row3));
+        _mm_storeu_ps(result.data_[i], sum);
+    }
+}
+
+SIMD_TARGET("sse2")
+void Matrix4x4::TransposeSSE2(const Matrix4x4& m, Matrix4x4& result) {
+    __m128 row0 = _mm_loadu_ps(m.data_[0]);
+    __m128 row1 = _mm_loadu_ps(m.data_[1]);
+    __m128 row2 = _mm_loadu_ps(m.data_[2]);
+    __m128 row3 = _mm_loadu_ps(m.data_[3]);
+
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+    _mm_storeu_ps(result.data_[0], row0);
+    _mm_storeu_ps(result.data_[1], row1);
+    _mm_storeu_ps(result.data_[2], row2);
+    _mm_storeu_ps(result.data_[3], row3);
+}
+
+SIMD_TARGET("sse2")
+void Matrix4x4::InverseSSE2(const Matrix4x4& m, Matrix4x4& result) {
+    // Block-wise inversion. With M = | A B |, the inverse is
+    //                                | C D |
+    // 1/|M| * | adj(X) adj(Y) | where X = |D|A - B adj(D)C, Y = |B|C - D adj(adj(A)B),
+    //         | adj(Z) adj(W) |       Z = |C|B - A adj(adj(D)C), W = |A|D - C adj(A)B
+    __m128 row0 = _mm_loadu_ps(m.data_[0]);
+    __m128 row1 = _mm_loadu_ps(m.data_[1]);
+    __m128 row2 = _mm_loadu_ps(m.data_[2]);
+    __m128 row3 = _mm_loadu_ps(m.data_[3]);
+
+    __m128 a = _mm_movelh_ps(row0, row1);
+    __m128 b = _mm_movehl_ps(row1, row0);
+    __m128 c = _mm_movelh_ps(row2, row3);
+    __m128 d = _mm_movehl_ps(row3, row2);
+
+    // (|A|, |B|, |C|, |D|)
+    __m128 determinants = _mm_sub_ps(_mm_mul_ps(SHUFFLE(row0, row2, 0, 2, 0, 2), SHUFFLE(row1, row3, 1, 3, 1, 3)),
+                                     _mm_mul_ps(SHUFFLE(row0, row2, 1, 3, 1, 3), SHUFFLE(row1, row3, 0, 2, 0, 2)));
+    __m128 detA = SWIZZLE(determinants, 0, 0, 0, 0);
+    __m128 detB = SWIZZLE(determinants, 1, 1, 1, 1);
+    __m128 detC = SWIZZLE(determinants, 2, 2, 2, 2);
+    __m128 detD = SWIZZLE(determinants, 3, 3, 3, 3);
+
+    __m128 adjDC = Matrix2x2AdjointMultiply(d, c);
+    __m128 adjAB = Matrix2x2AdjointMultiply(a, b);
+
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Matrix2x2Multiply(b, adjDC));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Matrix2x2Multiply(c, adjAB));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Matrix2x2MultiplyAdjoint(d, adjAB));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Matrix2x2MultiplyAdjoint(a, adjDC));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 trace = _mm_mul_ps(adjAB, SWIZZLE(adjDC, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, SWIZZLE(trace, 2, 3, 0, 1));
+    trace = _mm_add_ps(trace, SWIZZLE(trace, 1, 0, 3, 2));
+
+    __m128 det = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+    det = _mm_sub_ps(det, trace);
+
+    // The signs of the adjugate are folded in the reciprocal
+    __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    x = _mm_mul_ps(x, invDet);
+    y = _mm_mul_ps(y, invDet);
+    z = _mm_mul_ps(z, invDet);
+    w = _mm_mul_ps(w, invDet);
+
+    _mm_storeu_ps(result.data_[0], SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(result.data_[1], SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(result.data_[2], SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(result.data_[3], SHUFFLE(z, w, 2, 0, 2, 0));
+}
+
+SIMD_TARGET("sse2")
+void Matrix4x4::TransformSSE2(const Matrix4x4& m, const Vector4& v, Vector4& result) {
+    __m128 vec = _mm_loadu_ps(&v.x);
+    __m128 x = _mm_mul_ps(_mm_loadu_ps(m.data_[0]), vec);
+    __m128 y = _mm_mul_ps(_mm_loadu_ps(m.data_[1]), vec);
+    __m128 z = _mm_mul_ps(_mm_loadu_ps(m.data_[2]), vec);
+    __m128 w = _mm_mul_ps(_mm_loadu_ps(m.data_[3]), vec);
+
+    // Sum the products of each row in the same order as the scalar kernel
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(&result.x, _mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), w));
+}
+
+SIMD_TARGET("avx,fma")
+void Matrix4x4::MultiplyAVX(const Matrix4x4& lhs, const Matrix4x4& rhs, Matrix4x4& result) {
+    // Each rhs row is duplicated in both lanes so that two rows of the result
+    // are computed at once
+    __m128 row0 = _mm_loadu_ps(rhs.data_[0]);
+    __m128 row1 = _mm_loadu_ps(rhs.data_[1]);
+    __m128 row2 = _mm_loadu_ps(rhs.data_[2]);
+    __m128 row3 = _mm_loadu_ps(rhs.data_[3]);
+    __m256 rows0 = _mm256_insertf128_ps(_mm256_castps128_ps256(row0), row0, 1);
+    __m256 rows1 = _mm256_insertf128_ps(_mm256_castps128_ps256(row1), row1, 1);
+    __m256 rows2 = _mm256_insertf128_ps(_mm256_castps128_ps256(row2), row2, 1);
+    __m256 rows3 = _mm256_insertf128_ps(_mm256_castps128_ps256(row3), row3, 1);
+
+    for (int i = 0; i < 4; i += 2) {
+        __m256 a = _mm256_loadu_ps(lhs.data_[i]);
+        __m256 sum = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x00), rows0);
+        sum = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0x55), rows1, sum);
+        sum = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xAA), rows2, sum);
+        sum = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xFF), rows3, sum);
+        _mm256_storeu_ps(result.data_[i], sum);
+    }
+}
+
+SIMD_TARGET("avx,fma")
+void Matrix4x4::TransformAVX(const Matrix4x4& m, const Vector4& v, Vector4& result) {
+    __m128 col0 = _mm_loadu_ps(m.data_[0]);
+    __m128 col1 = _mm_loadu_ps(m.data_[1]);
+    __m128 col2 = _mm_loadu_ps(m.data_[2]);
+    __m128 col3 = _mm_loadu_ps(m.data_[3]);
+    _MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+
+    __m128 sum = _mm_mul_ps(col0, _mm_set1_ps(v.x));
+    sum = _mm_fmadd_ps(col1, _mm_set1_ps(v.y), sum);
+    sum = _mm_fmadd_ps(col2, _mm_set1_ps(v.z), sum);
+    sum = _mm_fmadd_ps(col3, _mm_set1_ps(v.w), sum);
+    _mm_storeu_ps(&result.x, sum);
+}
+
+SIMD_TARGET("sse2")
+void Matrix4x4::TransformVector3SSE2(const Matrix4x4& m, const Vector3* v, Vector3* result, size_t count, float w,
+                                     bool normalize)
+{
+    const __m128 m00 = _mm_set1_ps(m.data_[0][0]), m01 = _mm_set1_ps(m.data_[0][1]), m02 = _mm_set1_ps(m.data_[0][2]);
+    const __m128 m10 = _mm_set1_ps(m.data_[1][0]), m11 = _mm_set1_ps(m.data_[1][1]), m12 = _mm_set1_ps(m.data_[1][2]);
+    const __m128 m20 = _mm_set1_ps(m.data_[2][0]), m21 = _mm_set1_ps(m.data_[2][1]), m22 = _mm_set1_ps(m.data_[2][2]);
+    const __m128 tx = _mm_set1_ps(w * m.data_[0][3]);
+    const __m128 ty = _mm_set1_ps(w * m.data_[1][3]);
+    const __m128 tz = _mm_set1_ps(w * m.data_[2][3]);
+
+    const float* in = &v[0].x;
+    float* out = &result[0].x;
+    size_t i = 0;
+
+    // 4 vectors at a time. They are loaded as (x0 y0 z0 x1) (y1 z1 x2 y2)
+    // (z2 x3 y3 z3) and transposed to (x0 x1 x2 x3) (y0 y1 y2 y3) (z0 z1 z2 z3)
+    for (; i + 4 <= count; i += 4, in += 12, out += 12) {
+        __m128 a = _mm_loadu_ps(in);
+        __m128 b = _mm_loadu_ps(in + 4);
+        __m128 c = _mm_loadu_ps(in + 8);
+
+        __m128 x = SHUFFLE(a, SHUFFLE(b, c, 2, 2, 1, 1), 0, 3, 0, 2);
+        __m128 y = SHUFFLE(SHUFFLE(a, b, 1, 1, 0, 0), SHUFFLE(b, c, 3, 3, 2, 2), 0, 2, 0, 2);
+        __m128 z = SHUFFLE(SHUFFLE(a, b, 2, 2, 1, 1), c, 0, 2, 0, 3);
+
+        // Same order of operations as the scalar kernel
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m01)), _mm_mul_ps(z, m02)), tx);
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m10), _mm_mul_ps(y, m11)), _mm_mul_ps(z, m12)), ty);
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m20), _mm_mul_ps(y, m21)), _mm_mul_ps(z, m22)), tz);
+
+        if (normalize) {
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_mul_ps(rz, rz)));
+            __m128 nonZero = _mm_cmpneq_ps(length, _mm_setzero_ps());
+            rx = _mm_and_ps(_mm_div_ps(rx, length), nonZero);
+            ry = _mm_and_ps(_mm_div_ps(ry, length), nonZero);
+            rz = _mm_and_ps(_mm_div_ps(rz, length), nonZero);
+        }
+
+        _mm_storeu_ps(out,     SHUFFLE(SHUFFLE(rx, ry, 0, 0, 0, 0), SHUFFLE(rz, rx, 0, 0, 1, 1), 0, 2, 0, 2));
+        _mm_storeu_ps(out + 4, SHUFFLE(SHUFFLE(ry, rz, 1, 1, 1, 1), SHUFFLE(rx, ry, 2, 2, 2, 2), 0, 2, 0, 2));
+        _mm_storeu_ps(out + 8, SHUFFLE(SHUFFLE(rz, rx, 2, 2, 3, 3), SHUFFLE(ry, rz, 3, 3, 3, 3), 0, 2, 0, 2));
+    }
+
+    TransformVector3Scalar(m, v + i, result + i, count - i, w, normalize);
+}
+
+SIMD_TARGET("avx,fma")
+void Matrix4x4::TransformVector3AVX(const Matrix4x4& m, const Vector3* v, Vector3* result, size_t count, float w,
+                                    bool normalize)
+{
+    const __m256 m00 = _mm256_set1_ps(m.data_[0][0]), m01 = _mm256_set1_ps(m.data_[0][1]), m02 = _mm256_set1_ps(m.data_[0][2]);
+    const __m256 m10 = _mm256_set1_ps(m.data_[1][0]), m11 = _mm256_set1_ps(m.data_[1][1]), m12 = _mm256_set1_ps(m.data_[1][2]);
+    const __m256 m20 = _mm256_set1_ps(m.data_[2][0]), m21 = _mm256_set1_ps(m.data_[2][1]), m22 = _mm256_set1_ps(m.data_[2][2]);
+    const __m256 tx = _mm256_set1_ps(w * m.data_[0][3]);
+    const __m256 ty = _mm256_set1_ps(w * m.data_[1][3]);
+    const __m256 tz = _mm256_set1_ps(w * m.data_[2][3]);
+
+    const float* in = &v[0].x;
+    float* out = &result[0].x;
+    size_t i = 0;
+
+    // 8 vectors at a time, each 128 bits lane holding 4 of them so that the
+    // shuffles are the same as in the SSE2 kernel
+    for (; i + 8 <= count; i += 8, in += 24, out += 24) {
+        __m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in)),     _mm_loadu_ps(in + 12), 1);
+        __m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 4)), _mm_loadu_ps(in + 16), 1);
+        __m256 c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 8)), _mm_loadu_ps(in + 20), 1);
+
+        __m256 x = SHUFFLE256(a, SHUFFLE256(b, c, 2, 2, 1, 1), 0, 3, 0, 2);
+        __m256 y = SHUFFLE256(SHUFFLE256(a, b, 1, 1, 0, 0), SHUFFLE256(b, c, 3, 3, 2, 2), 0, 2, 0, 2);
+        __m256 z = SHUFFLE256(SHUFFLE256(a, b, 2, 2, 1, 1), c, 0, 2, 0, 3);
+
+        __m256 rx = _mm256_fmadd_ps(z, m02, _mm256_fmadd_ps(y, m01, _mm256_fmadd_ps(x, m00, tx)));
+        __m256 ry = _mm256_fmadd_ps(z, m12, _mm256_fmadd_ps(y, m11, _mm256_fmadd_ps(x, m10, ty)));
+        __m256 rz = _mm256_fmadd_ps(z, m22, _mm256_fmadd_ps(y, m21, _mm256_fmadd_ps(x, m20, tz)));
+
+        if (normalize) {
+            __m256 length = _mm256_sqrt_ps(_mm256_fmadd_ps(rz, rz, _mm256_fmadd_ps(ry, ry, _mm256_mul_ps(rx, rx))));
+            __m256 nonZero = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_NEQ_OQ);
+            rx = _mm256_and_ps(_mm256_div_ps(rx, length), nonZero);
+            ry = _mm256_and_ps(_mm256_div_ps(ry, length), nonZero);
+            rz = _mm256_and_ps(_mm256_div_ps(rz, length), nonZero);
+        }
+
+        a = SHUFFLE256(SHUFFLE256(rx, ry, 0, 0, 0, 0), SHUFFLE256(rz, rx, 0, 0, 1, 1), 0, 2, 0, 2);
+        b = SHUFFLE256(SHUFFLE256(ry, rz, 1, 1, 1, 1), SHUFFLE256(rx, ry, 2, 2, 2, 2), 0, 2, 0, 2);
+        c = SHUFFLE256(SHUFFLE256(rz, rx, 2, 2, 3, 3), SHUFFLE256(ry, rz, 3, 3, 3, 3), 0, 2, 0, 2);
+
+        _mm_storeu_ps(out,      _mm256_castps256_ps128(a));
+        _mm_storeu_ps(out + 4,  _mm256_castps256_ps128(b));
+        _mm_storeu_ps(out + 8,  _mm256_castps256_ps128(c));
+        _mm_storeu_ps(out + 12, _mm256_extractf128_ps(a, 1));
+        _mm_storeu_ps(out + 16, _mm256_extractf128_ps(b, 1));
+        _mm_storeu_ps(out + 20, _mm256_extractf128_ps(c, 1));
+    }
+
+    TransformVector3SSE2(m, v + i, result + i, count - i, w, normalize);
+}
+
+#undef SHUFFLE_MASK
+#undef SWIZZLE
+#undef SHUFFLE
+#undef SHUFFLE256
+
+#endif
+
+}
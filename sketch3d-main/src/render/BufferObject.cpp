@@ -7,7 +7,7 @@ namespace Sketch3D {
 size_t BufferObject::nextAvailableId_ = 0;
 
 BufferObject::BufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) : vertexAttributes_(vertexAttributes), usage_(usage),
-        vertexCount_(0), stride_(0), indexCount_(0)
+        vertexCount_(0), stride_(0), indexCount_(0), indexFormat_(INDEX_FORMAT_16), sharedStorageId_(0), firstIndex_(0), baseVertex_(0)
 {
     id_ = nextAvailableId_++;
 }
@@ -15,6 +15,22 @@ BufferObject::BufferObject(const VertexAttributesMap_t& vertexAttributes, Buffer
 BufferObject::~BufferObject() {
 }
 
+void BufferObject::FillDrawIndirectCommand(DrawIndirectCommand_t& command, uint32_t baseInstance) const {
+    command.indexCount = (uint32_t)indexCount_;
+    command.instanceCount = 1;
+    command.firstIndex = (uint32_t)firstIndex_;
+    command.baseVertex = (int32_t)baseVertex_;
+    command.baseInstance = baseInstance;
+}
+
+size_t BufferObject::GetSharedStorageId() const {
+    return sharedStorageId_;
+}
+
+IndexFormat_t BufferObject::GetIndexFormat() const {
+    return indexFormat_;
+}
+
 size_t BufferObject::GetVertexAttributesBitField() const {
     size_t vertexAttributes = 0;
     VertexAttributesMap_t::const_iterator it = vertexAttributes_.begin();
@@ -111,4 +127,35 @@ void PackSurfaceTriangleVertices(const SurfaceTriangles_t* surface, const map<si
     }
 }
 
+IndexFormat_t GetIndexFormatForIndices(const unsigned int* indexData, size_t numIndex) {
+    for (size_t i = 0; i < numIndex; i++) {
+        if (indexData[i] > 65535) {
+            return INDEX_FORMAT_32;
+        }
+    }
+
+    return INDEX_FORMAT_16;
+}
+
+IndexFormat_t GetIndexFormatForVertices(size_t numVertices) {
+    return (numVertices > 65536) ? INDEX_FORMAT_32 : INDEX_FORMAT_16;
+}
+
+size_t GetIndexSize(IndexFormat_t format) {
+    return (format == INDEX_FORMAT_16) ? sizeof(unsigned short) : sizeof(unsigned int);
+}
+
+const void* ConvertIndices(const unsigned int* indexData, size_t numIndex, IndexFormat_t format, vector<unsigned short>& shortIndices) {
+    if (format == INDEX_FORMAT_32) {
+        return indexData;
+    }
+
+    shortIndices.resize(numIndex);
+    for (size_t i = 0; i < numIndex; i++) {
+        shortIndices[i] = (unsigned short)indexData[i];
+    }
+
+    return (numIndex > 0) ? &shortIndices[0] : nullptr;
+}
+
 }
\ No newline at end of file
@@ -11,8 +11,8 @@ using namespace std;
 #include <d3d9.h>
 
 namespace Sketch3D {
-BufferObjectDirect3D9::BufferObjectDirect3D9(IDirect3DDevice9* device, const VertexAttributesMap_t& vertexAttributes,
-                                             BufferUsage_t usage) : BufferObject(vertexAttributes, usage), device_(device),
+BufferObjectDirect3D9::BufferObjectDirect3D9(IDirect3DDevice9* device, unsigned int maxVertexIndex, const VertexAttributesMap_t& vertexAttributes,
+                                             BufferUsage_t usage) : BufferObject(vertexAttributes, usage), device_(device), maxVertexIndex_(maxVertexIndex),
                                              vertexBuffer_(nullptr), indexBuffer_(nullptr), vertexDeclaration_(nullptr), primitivesCount_(0),
                                              instanceBuffer_(nullptr), instanceDataPrepared_(false)
 {
@@ -73,6 +73,14 @@ void BufferObjectDirect3D9::RenderInstances(const vector<Matrix4x4>& modelMatric
     device_->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, vertexCount_, 0, primitivesCount_);
 }
 
+void BufferObjectDirect3D9::RenderIndirect(const DrawIndirectCommand_t* commands, size_t numCommands,
+                                           const vector<Matrix4x4>& modelMatrices)
+{
+    // Direct3D 9 has no indirect draws, so the buffer objects never share their storage. All the commands can then only
+    // refer to this buffer object, one per model matrix, which is the same as drawing its instances
+    RenderInstances(modelMatrices);
+}
+
 BufferObjectError_t BufferObjectDirect3D9::SetVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
     bool hasNormals = ((presentVertexAttributes & VERTEX_ATTRIBUTES_NORMAL) > 0);
     bool hasTexCoords = ((presentVertexAttributes & VERTEX_ATTRIBUTES_TEX_COORDS) > 0);
@@ -87,7 +95,8 @@ BufferObjectError_t BufferObjectDirect3D9::SetVertexData(const vector<float>& ve
                 ((hasBones) ? sizeof(Vector4) : 0) +
                 ((hasWeights) ? sizeof(Vector4) : 0);
 
-    if ( (vertexData.size() / (stride_ / sizeof(float))) > 65535) {
+    size_t newVertexCount = vertexData.size() / (stride_ / sizeof(float));
+    if (newVertexCount > 0 && newVertexCount - 1 > maxVertexIndex_) {
         return BUFFER_OBJECT_ERROR_NOT_ENOUGH_SPACE;
     } else if (!AreVertexAttributesValid(presentVertexAttributes)) {
         return BUFFER_OBJECT_ERROR_INVALID_VERTEX_ATTRIBUTES;
@@ -95,16 +104,14 @@ BufferObjectError_t BufferObjectDirect3D9::SetVertexData(const vector<float>& ve
 
     CreateVertexDeclaration(hasNormals, hasTexCoords, hasTangents, hasBones, hasWeights);
 
-    size_t newVertexCount = vertexData.size() / (stride_ / sizeof(float));
-
     if (vertexBuffer_ != nullptr && newVertexCount != vertexCount_) {
         vertexBuffer_->Release();
         vertexBuffer_ = nullptr;
     }
 
     if (newVertexCount != vertexCount_) {
-        DWORD usage = (usage_ == BUFFER_USAGE_STATIC) ? D3DUSAGE_WRITEONLY : D3DUSAGE_DYNAMIC;
-        D3DPOOL pool = (usage_ == BUFFER_USAGE_STATIC) ? D3DPOOL_MANAGED : D3DPOOL_DEFAULT;
+        DWORD usage = (usage_ != BUFFER_USAGE_DYNAMIC) ? D3DUSAGE_WRITEONLY : D3DUSAGE_DYNAMIC;
+        D3DPOOL pool = (usage_ != BUFFER_USAGE_DYNAMIC) ? D3DPOOL_MANAGED : D3DPOOL_DEFAULT;
         device_->CreateVertexBuffer(newVertexCount * stride_, usage, 0, pool, &vertexBuffer_, nullptr);
     }
     vertexCount_ = newVertexCount;
@@ -125,7 +132,7 @@ BufferObjectError_t BufferObjectDirect3D9::SetVertexData(const vector<float>& ve
 BufferObjectError_t BufferObjectDirect3D9::AppendVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
     if (vertexCount_ == 0) {
         return SetVertexData(vertexData, presentVertexAttributes);
-    } else if ( (vertexCount_ + (vertexData.size() / (stride_ / sizeof(float))) ) > 65535) {
+    } else if (vertexCount_ + vertexData.size() / (stride_ / sizeof(float)) - 1 > maxVertexIndex_) {
         return BUFFER_OBJECT_ERROR_NOT_ENOUGH_SPACE;
     }
 
@@ -157,7 +164,7 @@ BufferObjectError_t BufferObjectDirect3D9::AppendVertexData(const vector<float>&
     // Create a new vertex buffer and assign the new vertex data
     vertexCount_ = newSize / (stride_ / sizeof(float));
     vertexBuffer_->Release();
-    DWORD usage = (usage_ == BUFFER_USAGE_STATIC) ? D3DUSAGE_WRITEONLY : D3DUSAGE_DYNAMIC;
+    DWORD usage = (usage_ != BUFFER_USAGE_DYNAMIC) ? D3DUSAGE_WRITEONLY : D3DUSAGE_DYNAMIC;
     device_->CreateVertexBuffer(newSize * sizeof(float), usage, 0, D3DPOOL_MANAGED, &vertexBuffer_, nullptr);
     vertexBuffer_->Lock(0, 0, &data, lockFlags);
 
@@ -168,20 +175,33 @@ BufferObjectError_t BufferObjectDirect3D9::AppendVertexData(const vector<float>&
     return BUFFER_OBJECT_ERROR_NONE;
 }
 
-BufferObjectError_t BufferObjectDirect3D9::SetIndexData(unsigned short* indexData, size_t numIndex) {
+BufferObjectError_t BufferObjectDirect3D9::SetIndexData(unsigned int* indexData, size_t numIndex) {
+    // The indices are only stored on 32 bits when needed since it requires a device with a MaxVertexIndex over 0xFFFF
+    IndexFormat_t indexFormat = GetIndexFormatForIndices(indexData, numIndex);
+    if (indexFormat == INDEX_FORMAT_32 && maxVertexIndex_ <= 0xFFFF) {
+        return BUFFER_OBJECT_ERROR_NOT_ENOUGH_SPACE;
+    }
+
     if (indexBuffer_ != nullptr) {
         indexBuffer_->Release();
         indexBuffer_ = nullptr;
     }
-    device_->CreateIndexBuffer(numIndex * sizeof(unsigned short), D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_MANAGED, &indexBuffer_, nullptr);
+
+    indexFormat_ = indexFormat;
+    size_t indexSize = GetIndexSize(indexFormat_);
+    D3DFORMAT format = (indexFormat_ == INDEX_FORMAT_16) ? D3DFMT_INDEX16 : D3DFMT_INDEX32;
+    device_->CreateIndexBuffer(numIndex * indexSize, D3DUSAGE_WRITEONLY, format, D3DPOOL_MANAGED, &indexBuffer_, nullptr);
 
     indexCount_ = numIndex;
 
+    vector<unsigned short> shortIndices;
+    const void* indices = ConvertIndices(indexData, numIndex, indexFormat_, shortIndices);
+
     void* data;
     DWORD lockFlags = 0;
-    indexBuffer_->Lock(0, indexCount_ * sizeof(unsigned short), &data, lockFlags);
+    indexBuffer_->Lock(0, indexCount_ * indexSize, &data, lockFlags);
 
-    memcpy(data, (void*)indexData, indexCount_ * sizeof(unsigned short));
+    memcpy(data, indices, indexCount_ * indexSize);
 
     indexBuffer_->Unlock();
 
@@ -190,9 +210,11 @@ BufferObjectError_t BufferObjectDirect3D9::SetIndexData(unsigned short* indexDat
     return BUFFER_OBJECT_ERROR_NONE;
 }
 
-BufferObjectError_t BufferObjectDirect3D9::AppendIndexData(unsigned short* indexData, size_t numIndex) {
+BufferObjectError_t BufferObjectDirect3D9::AppendIndexData(unsigned int* indexData, size_t numIndex) {
     if (indexCount_ == 0) {
         return SetIndexData(indexData, numIndex);
+    } else if (maxVertexIndex_ <= 0xFFFF && GetIndexFormatForIndices(indexData, numIndex) == INDEX_FORMAT_32) {
+        return BUFFER_OBJECT_ERROR_NOT_ENOUGH_SPACE;
     }
 
     // We have to copy the buffer that we have, reallocate the space for it, append the data and copy back the new array
@@ -205,7 +227,14 @@ BufferObjectError_t BufferObjectDirect3D9::AppendIndexData(unsigned short* index
     DWORD lockFlags = 0;
     indexBuffer_->Lock(0, 0, &data, lockFlags);
 
-    memcpy(&newIndexData[0], data, indexCount_* sizeof(unsigned short));
+    if (indexFormat_ == INDEX_FORMAT_16) {
+        unsigned short* oldIndexData = (unsigned short*)data;
+        for (size_t i = 0; i < indexCount_; i++) {
+            newIndexData[i] = oldIndexData[i];
+        }
+    } else {
+        memcpy(&newIndexData[0], data, indexCount_ * sizeof(unsigned int));
+    }
 
     indexBuffer_->Unlock();
 
@@ -216,14 +245,24 @@ BufferObjectError_t BufferObjectDirect3D9::AppendIndexData(unsigned short* index
     }
     indexCount_ = newSize;
 
+    // The indices are widened if the new ones don't fit in the current format
+    if (indexFormat_ == INDEX_FORMAT_16) {
+        indexFormat_ = GetIndexFormatForIndices(indexData, numIndex);
+    }
+
+    vector<unsigned short> shortIndices;
+    const void* indices = ConvertIndices(&newIndexData[0], indexCount_, indexFormat_, shortIndices);
+    size_t indexSize = GetIndexSize(indexFormat_);
+    D3DFORMAT format = (indexFormat_ == INDEX_FORMAT_16) ? D3DFMT_INDEX16 : D3DFMT_INDEX32;
+
     // Create a new vertex buffer and assign the new vertex data
     primitivesCount_ = indexCount_ / 3;
 
     indexBuffer_->Release();
-    device_->CreateIndexBuffer(numIndex * sizeof(unsigned short), D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_MANAGED, &indexBuffer_, nullptr);
-    indexBuffer_->Lock(0, indexCount_ * sizeof(unsigned short), &data, lockFlags);
+    device_->CreateIndexBuffer(indexCount_ * indexSize, D3DUSAGE_WRITEONLY, format, D3DPOOL_MANAGED, &indexBuffer_, nullptr);
+    indexBuffer_->Lock(0, indexCount_ * indexSize, &data, lockFlags);
 
-    memcpy(data, (void*)&newIndexData[0], indexCount_ * sizeof(unsigned short));
+    memcpy(data, indices, indexCount_ * indexSize);
 
     indexBuffer_->Unlock();
 
@@ -279,7 +318,7 @@ void BufferObjectDirect3D9::PrepareInstanceBuffers() {
 
 void BufferObjectDirect3D9::GenerateBuffers() {
     if (vertexBuffer_ == nullptr) {
-        DWORD usage = (usage_ == BUFFER_USAGE_STATIC) ? D3DUSAGE_WRITEONLY : D3DUSAGE_DYNAMIC;
+        DWORD usage = (usage_ != BUFFER_USAGE_DYNAMIC) ? D3DUSAGE_WRITEONLY : D3DUSAGE_DYNAMIC;
         device_->CreateVertexBuffer(0, usage, 0, D3DPOOL_MANAGED, &vertexBuffer_, nullptr);
     }
 
@@ -4,11 +4,13 @@
 
 namespace Sketch3D {
 
-BufferObjectManagerDirect3D9::BufferObjectManagerDirect3D9(IDirect3DDevice9* device) : BufferObjectManager(), device_(device) {
+BufferObjectManagerDirect3D9::BufferObjectManagerDirect3D9(IDirect3DDevice9* device, unsigned int maxVertexIndex) : BufferObjectManager(),
+        device_(device), maxVertexIndex_(maxVertexIndex)
+{
 }
 
 BufferObject* BufferObjectManagerDirect3D9::CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) {
-    BufferObject* buffer = new BufferObjectDirect3D9(device_, vertexAttributes, usage);
+    BufferObject* buffer = new BufferObjectDirect3D9(device_, maxVertexIndex_, vertexAttributes, usage);
     bufferObjects_.insert(buffer);
     return buffer;
 }
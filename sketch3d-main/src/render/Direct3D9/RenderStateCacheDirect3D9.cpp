@@ -3,7 +3,7 @@
 #include <d3d9.h>
 
 namespace Sketch3D {
-RenderStateCacheDirect3D9::RenderStateCacheDirect3D9(IDirect3DDevice9* device) {
+RenderStateCacheDirect3D9::RenderStateCacheDirect3D9(IDirect3DDevice9* device, FrameStats_t* frameStats) : RenderStateCache(frameStats) {
     device_ = device;
 
     EnableDepthTestImpl();
@@ -22,16 +22,16 @@ RenderStateCacheDirect3D9::~RenderStateCacheDirect3D9() {
 }
 
 void RenderStateCacheDirect3D9::EnableDepthTestImpl() {
-    device_->SetRenderState(D3DRS_ZENABLE, (isDepthTestEnabled_) ? D3DZB_TRUE : D3DZB_FALSE);
+    device_->SetRenderState(D3DRS_ZENABLE, (appliedRenderState_.depthTest) ? D3DZB_TRUE : D3DZB_FALSE);
 }
 
 void RenderStateCacheDirect3D9::EnableDepthWriteImpl() {
-    device_->SetRenderState(D3DRS_ZWRITEENABLE, (isDepthWriteEnabled_) ? TRUE : FALSE);
+    device_->SetRenderState(D3DRS_ZWRITEENABLE, (appliedRenderState_.depthWrite) ? TRUE : FALSE);
 }
 
 void RenderStateCacheDirect3D9::EnableColorWriteImpl() {
     DWORD colorWrite = 0;
-    if (isColorWriteEnabled_) {
+    if (appliedRenderState_.colorWrite) {
         colorWrite = D3DCOLORWRITEENABLE_ALPHA | D3DCOLORWRITEENABLE_RED | D3DCOLORWRITEENABLE_GREEN | D3DCOLORWRITEENABLE_BLUE;
     }
 
@@ -39,12 +39,12 @@ void RenderStateCacheDirect3D9::EnableColorWriteImpl() {
 }
 
 void RenderStateCacheDirect3D9::EnableBlendingImpl() {
-    device_->SetRenderState(D3DRS_ALPHABLENDENABLE, (isBlendingEnabled_) ? TRUE : FALSE);
+    device_->SetRenderState(D3DRS_ALPHABLENDENABLE, (appliedRenderState_.blending) ? TRUE : FALSE);
 }
 
 void RenderStateCacheDirect3D9::SetDepthComparisonFuncImpl() {
     DWORD func;
-    switch (depthComparisonFunction_) {
+    switch (appliedRenderState_.depthFunc) {
         case DEPTH_FUNC_NEVER:
             func = D3DCMP_NEVER;
             break;
@@ -83,9 +83,9 @@ void RenderStateCacheDirect3D9::SetDepthComparisonFuncImpl() {
 
 void RenderStateCacheDirect3D9::SetCullingMethodImpl() {
     DWORD cullMode;
-    if (cullingMethod_ == CULLING_METHOD_BACK_FACE) {
+    if (appliedRenderState_.cullingMethod == CULLING_METHOD_BACK_FACE) {
         cullMode = D3DCULL_CW;
-    } else if (cullingMethod_ == CULLING_METHOD_FRONT_FACE) {
+    } else if (appliedRenderState_.cullingMethod == CULLING_METHOD_FRONT_FACE) {
         cullMode = D3DCULL_CCW;
     }
 
@@ -94,7 +94,7 @@ void RenderStateCacheDirect3D9::SetCullingMethodImpl() {
 
 void RenderStateCacheDirect3D9::SetBlendingEquationImpl() {
     DWORD blendingEquation;
-    switch (blendingEquation_) {
+    switch (appliedRenderState_.blendingEquation) {
         case BLENDING_EQUATION_ADD:
             blendingEquation = D3DBLENDOP_ADD;
             break;
@@ -120,8 +120,8 @@ void RenderStateCacheDirect3D9::SetBlendingEquationImpl() {
 }
 
 void RenderStateCacheDirect3D9::SetBlendingFactorImpl() {
-    DWORD srcBlendFactor = GetBlendingFactor(sourceBlendingFactor_);
-    DWORD dstBlendFactor = GetBlendingFactor(destinationBlendingFactor_);
+    DWORD srcBlendFactor = GetBlendingFactor(appliedRenderState_.sourceBlendingFactor);
+    DWORD dstBlendFactor = GetBlendingFactor(appliedRenderState_.destinationBlendingFactor);
 
     device_->SetRenderState(D3DRS_SRCBLEND, srcBlendFactor);
     device_->SetRenderState(D3DRS_DESTBLEND, dstBlendFactor);
@@ -129,7 +129,7 @@ void RenderStateCacheDirect3D9::SetBlendingFactorImpl() {
 
 void RenderStateCacheDirect3D9::SetRenderFillModeImpl() {
     DWORD renderMode;
-    switch (renderMode_) {
+    switch (appliedRenderState_.renderMode) {
         case RENDER_MODE_FILL:
             renderMode = D3DFILL_SOLID;
             break;
@@ -31,7 +31,7 @@ bool RenderSystemDirect3D9::Initialize(const RenderParameters_t& renderParameter
     Logger::GetInstance()->Info("Initializing Direct3D9");
 
     renderContext_ = new RenderContextDirect3D9;
-    if (!renderContext_->Initialize(window_, renderParameters)) {
+    if (!renderContext_->Initialize(*window_, renderParameters)) {
         Logger::GetInstance()->Error("Couldn't create Direct3D9 context");
         return false;
     }
@@ -40,8 +40,8 @@ bool RenderSystemDirect3D9::Initialize(const RenderParameters_t& renderParameter
 
     QueryDeviceCapabilities();
 
-    bufferObjectManager_ = new BufferObjectManagerDirect3D9(device_);
-    renderStateCache_ = new RenderStateCacheDirect3D9(device_);
+    bufferObjectManager_ = new BufferObjectManagerDirect3D9(device_, deviceCapabilities_.maxVertexIndex_);
+    renderStateCache_ = new RenderStateCacheDirect3D9(device_, &frameStats_);
 
     // Retrieve the current depth buffer and render target
     device_->GetDepthStencilSurface(&depthBuffer_);
@@ -166,8 +166,13 @@ void RenderSystemDirect3D9::BindShader(const Shader* shader) {
             const ShaderDirect3D9* shaderDirect3D9 = static_cast<const ShaderDirect3D9*>(shader);
             device_->SetVertexShader(shaderDirect3D9->vertexShader_);
             device_->SetPixelShader(shaderDirect3D9->fragmentShader_);
+
+            // The constant registers are shared by all the shaders, the previous one might have overwritten them
+            shader->SetAppliedMaterial(NO_APPLIED_MATERIAL);
         }
 
+        frameStats_.shaderBinds++;
+
         boundShader_ = shader;
     }
 }
@@ -213,6 +218,8 @@ void RenderSystemDirect3D9::QueryDeviceCapabilities() {
     device_->GetDeviceCaps(&caps);
     deviceCapabilities_.maxActiveTextures_ = caps.MaxTextureBlendStages;
     deviceCapabilities_.maxNumberRenderTargets_ = caps.NumSimultaneousRTs;
+    deviceCapabilities_.supportsIndirectDraws_ = false;
+    deviceCapabilities_.maxVertexIndex_ = caps.MaxVertexIndex;
 }
 
 void RenderSystemDirect3D9::CreateTextShader() {
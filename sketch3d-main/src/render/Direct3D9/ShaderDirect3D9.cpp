@@ -110,6 +110,10 @@ bool ShaderDirect3D9::SetSourceFile(const string& vertexFilename, const string&
     shader->Release();
     shader = nullptr;
 
+    uniformConstants_.clear();
+    nameToUniforms_.clear();
+    ResolveBuiltinUniforms();
+
     return true;
 }
 
@@ -195,101 +199,62 @@ bool ShaderDirect3D9::SetSource(const string& vertexSource, const string& fragme
     shader->Release();
     shader = nullptr;
 
-    return true;
-}
-
-bool ShaderDirect3D9::SetUniformInt(const string& uniformName, int value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        fragmentConstants_->SetInt(device_, uniformHandle, value);
-    } else {
-        vertexConstants_->SetInt(device_, uniformHandle, value);
-    }
+    uniformConstants_.clear();
+    nameToUniforms_.clear();
+    ResolveBuiltinUniforms();
 
     return true;
 }
 
-bool ShaderDirect3D9::SetUniformFloat(const string& uniformName, float value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        fragmentConstants_->SetFloat(device_, uniformHandle, value);
-    } else {
-        vertexConstants_->SetFloat(device_, uniformHandle, value);
+UniformHandle_t ShaderDirect3D9::GetUniformHandle(const string& uniform) const {
+    unordered_map<string, UniformHandle_t>::iterator it = nameToUniforms_.find(uniform);
+    if (it != nameToUniforms_.end()) {
+        return it->second;
     }
 
-    return true;
-}
+    // The uniform is looked up in the vertex shader first, then in the fragment shader
+    UniformConstant_t uniformConstant;
+    uniformConstant.constantTable = vertexConstants_;
+    uniformConstant.handle = vertexConstants_->GetConstantByName(0, uniform.c_str());
+    if (uniformConstant.handle == 0) {
+        uniformConstant.constantTable = fragmentConstants_;
+        uniformConstant.handle = fragmentConstants_->GetConstantByName(0, uniform.c_str());
 
-bool ShaderDirect3D9::SetUniformVector2(const string& uniformName, float value1, float value2) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        float values[] = { value1, value2 };
-        fragmentConstants_->SetFloatArray(device_, uniformHandle, values, 2);
-    } else {
-        float values[] = { value1, value2 };
-        vertexConstants_->SetFloatArray(device_, uniformHandle, values, 2);
+        if (uniformConstant.handle == 0) {
+            return INVALID_UNIFORM_HANDLE;
+        }
     }
 
-    return true;
+    UniformHandle_t handle = (UniformHandle_t)uniformConstants_.size();
+    uniformConstants_.push_back(uniformConstant);
+    nameToUniforms_[uniform] = handle;
+    return handle;
 }
 
-bool ShaderDirect3D9::SetUniformVector3(const string& uniformName, const Vector3& value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        float values[] = { value.x, value.y, value.z };
-        fragmentConstants_->SetFloatArray(device_, uniformHandle, values, 3);
-    } else {
-        float values[] = { value.x, value.y, value.z };
-        vertexConstants_->SetFloatArray(device_, uniformHandle, values, 3);
-    }
-
-    return true;
+void ShaderDirect3D9::SetUniformIntImpl(UniformHandle_t uniform, int value) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
+    uniformConstant.constantTable->SetInt(device_, uniformConstant.handle, value);
 }
 
-bool ShaderDirect3D9::SetUniformVector3Array(const string& uniformName, const Vector3* values, int arraySize) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    ID3DXConstantTable* constantTable = nullptr;
+void ShaderDirect3D9::SetUniformFloatImpl(UniformHandle_t uniform, float value) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
+    uniformConstant.constantTable->SetFloat(device_, uniformConstant.handle, value);
+}
 
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
+void ShaderDirect3D9::SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
+    float values[] = { value1, value2 };
+    uniformConstant.constantTable->SetFloatArray(device_, uniformConstant.handle, values, 2);
+}
 
-        if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-        }
+void ShaderDirect3D9::SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
+    float values[] = { value.x, value.y, value.z };
+    uniformConstant.constantTable->SetFloatArray(device_, uniformConstant.handle, values, 3);
+}
 
-        constantTable = fragmentConstants_;
-    } else {
-        constantTable = vertexConstants_;
-    }
+void ShaderDirect3D9::SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
 
     vector<float> floatValues;
     floatValues.reserve(3 * arraySize);
@@ -299,95 +264,31 @@ bool ShaderDirect3D9::SetUniformVector3Array(const string& uniformName, const Ve
         floatValues.push_back(values[i].z);
     }
 
-    constantTable->SetFloatArray(device_, uniformHandle, &floatValues[0], floatValues.size());
-
-    return true;
+    uniformConstant.constantTable->SetFloatArray(device_, uniformConstant.handle, &floatValues[0], floatValues.size());
 }
 
-bool ShaderDirect3D9::SetUniformVector4(const string& uniformName, const Vector4& value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        float values[] = { value.x, value.y, value.z, value.w };
-        fragmentConstants_->SetFloatArray(device_, uniformHandle, values, 4);
-    } else {
-        float values[] = { value.x, value.y, value.z, value.w };
-        vertexConstants_->SetFloatArray(device_, uniformHandle, values, 4);
-    }
-
-    return true;
+void ShaderDirect3D9::SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
+    float values[] = { value.x, value.y, value.z, value.w };
+    uniformConstant.constantTable->SetFloatArray(device_, uniformConstant.handle, values, 4);
 }
 
-bool ShaderDirect3D9::SetUniformMatrix3x3(const string& uniformName, const Matrix3x3& value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    ID3DXConstantTable* constantTable = nullptr;
-
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        constantTable = fragmentConstants_;
-    } else {
-        constantTable = vertexConstants_;
-    }
-
+void ShaderDirect3D9::SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
     float mat[9];
     value.Transpose().GetData(mat);
-    constantTable->SetFloatArray(device_, uniformHandle, mat, 9);
-
-    return true;
+    uniformConstant.constantTable->SetFloatArray(device_, uniformConstant.handle, mat, 9);
 }
 
-bool ShaderDirect3D9::SetUniformMatrix4x4(const string& uniformName, const Matrix4x4& value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    ID3DXConstantTable* constantTable = nullptr;
-
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        constantTable = fragmentConstants_;
-    } else {
-        constantTable = vertexConstants_;
-    }
-
+void ShaderDirect3D9::SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
     float mat[16];
     value.Transpose().GetData(mat);
-    constantTable->SetFloatArray(device_, uniformHandle, mat, 16);
-
-    return true;
+    uniformConstant.constantTable->SetFloatArray(device_, uniformConstant.handle, mat, 16);
 }
 
-bool ShaderDirect3D9::SetUniformMatrix4x4Array(const string& uniformName, const Matrix4x4* values, int arraySize) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    ID3DXConstantTable* constantTable = nullptr;
-
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-        if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-        }
-
-        constantTable = fragmentConstants_;
-    } else {
-        constantTable = vertexConstants_;
-    }
+void ShaderDirect3D9::SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
 
     vector<float> floatValues;
     floatValues.reserve(16 * arraySize);
@@ -401,34 +302,12 @@ bool ShaderDirect3D9::SetUniformMatrix4x4Array(const string& uniformName, const
         }
     }
 
-    constantTable->SetFloatArray(device_, uniformHandle, &floatValues[0], floatValues.size());
-
-    return true;
+    uniformConstant.constantTable->SetFloatArray(device_, uniformConstant.handle, &floatValues[0], floatValues.size());
 }
 
-bool ShaderDirect3D9::SetUniformTexture(const string& uniform, const Texture* texture) {
-    bool fromVertexShader = true;
-    D3DXHANDLE uniformHandle = 0;
-
-    uniformHandle = vertexConstants_->GetConstantByName(0, uniform.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniform.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniform + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        fromVertexShader = false;
-    }
-
-    UINT samplerIndex = 10000;
-
-    if (fromVertexShader) {
-        samplerIndex = vertexConstants_->GetSamplerIndex(uniformHandle);
-    } else {
-        samplerIndex = fragmentConstants_->GetSamplerIndex(uniformHandle);
-    }
+void ShaderDirect3D9::SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture) {
+    const UniformConstant_t& uniformConstant = uniformConstants_[uniform];
+    UINT samplerIndex = uniformConstant.constantTable->GetSamplerIndex(uniformConstant.handle);
 
     if (samplerIndex != 10000) {
         const Texture2DDirect3D9* textureDirect3D9 = static_cast<const Texture2DDirect3D9*>(texture);
@@ -436,8 +315,6 @@ bool ShaderDirect3D9::SetUniformTexture(const string& uniform, const Texture* te
         device_->SetSamplerState( samplerIndex, D3DSAMP_MINFILTER, GetFilter(texture->GetFilterMode()) );
         device_->SetSamplerState( samplerIndex, D3DSAMP_MAGFILTER, GetFilter(texture->GetFilterMode()) );
     }
-
-    return true;
 }
 
 unsigned long ShaderDirect3D9::GetFilter(FilterMode_t filter) const {
@@ -1,61 +1,89 @@
 #include "render/Material.h"
 
 #include "render/Mesh.h"
+#include "render/PipelineState.h"
 #include "render/Renderer.h"
+#include "render/RenderStateCache.h"
+#include "render/RenderSystem.h"
 #include "render/Shader.h"
 
 #include "system/Logger.h"
 
+#include <string.h>
+
 namespace Sketch3D {
 
-Material::Material(Shader* shader) : shader_(shader), transluencyType_(TRANSLUENCY_TYPE_OPAQUE) {
-}
+uint32_t Material::nextAvailableId_ = NO_APPLIED_MATERIAL + 1;
 
-bool Material::ApplyMaterial() const {
-    if (shader_ == nullptr) {
-        return false;
+Material::Material(Shader* shader) : id_(nextAvailableId_++), shader_(shader), transluencyType_(TRANSLUENCY_TYPE_OPAQUE),
+        hasRenderState_(false), pipelineState_(nullptr), hasDirtyParameters_(false), shaderLinkCount_(0)
+{
+    if (shader_ != nullptr) {
+        shaderLinkCount_ = shader_->GetLinkCount();
     }
 
-    Renderer::GetInstance()->BindShader(shader_);
-
-    for (auto it = intUniforms_.begin(); it != intUniforms_.end(); ++it) {
-        shader_->SetUniformInt(it->first, it->second);
-    }
-
-    for (auto it = floatUniforms_.begin(); it != floatUniforms_.end(); ++it) {
-        shader_->SetUniformFloat(it->first, it->second);
-    }
+    ResolvePipelineState();
+}
 
-    for (auto it = vector2Uniforms_.begin(); it != vector2Uniforms_.end(); ++it) {
-        shader_->SetUniformVector2(it->first, it->second.x, it->second.y);
-    }
+Material::Material(const Material& src) : id_(nextAvailableId_++), shader_(src.shader_), transluencyType_(src.transluencyType_),
+        hasRenderState_(src.hasRenderState_), renderState_(src.renderState_), pipelineState_(src.pipelineState_),
+        parameters_(src.parameters_), parameterBlock_(src.parameterBlock_), textureParameters_(src.textureParameters_),
+        hasDirtyParameters_(src.hasDirtyParameters_), shaderLinkCount_(src.shaderLinkCount_)
+{
+}
 
-    for (auto it = vector3Uniforms_.begin(); it != vector3Uniforms_.end(); ++it) {
-        shader_->SetUniformVector3(it->first, it->second);
+Material& Material::operator=(const Material& rhs) {
+    if (this != &rhs) {
+        shader_ = rhs.shader_;
+        transluencyType_ = rhs.transluencyType_;
+        hasRenderState_ = rhs.hasRenderState_;
+        renderState_ = rhs.renderState_;
+        pipelineState_ = rhs.pipelineState_;
+        parameters_ = rhs.parameters_;
+        parameterBlock_ = rhs.parameterBlock_;
+        textureParameters_ = rhs.textureParameters_;
+        shaderLinkCount_ = rhs.shaderLinkCount_;
+
+        // The values of the shader don't match the new parameters anymore
+        for (size_t i = 0; i < parameters_.size(); i++) {
+            parameters_[i].dirty = true;
+        }
+        hasDirtyParameters_ = true;
     }
 
-    for (auto it = vector3ArrayUniforms_.begin(); it != vector3ArrayUniforms_.end(); ++it) {
-        shader_->SetUniformVector3Array(it->first, &(it->second[0]), it->second.size());
-    }
+    return *this;
+}
 
-    for (auto it = vector4Uniforms_.begin(); it != vector4Uniforms_.end(); ++it) {
-        shader_->SetUniformVector4(it->first, it->second);
+bool Material::ApplyMaterial() const {
+    if (shader_ == nullptr) {
+        return false;
     }
 
-    for (auto it = matrix3x3Uniforms_.begin(); it != matrix3x3Uniforms_.end(); ++it) {
-        shader_->SetUniformMatrix3x3(it->first, it->second);
-    }
+    // The render state only changes if the pipeline state has a different one than the applied pipeline state
+    Renderer::GetInstance()->GetRenderStateCache()->ApplyPipelineState(GetPipelineState());
+    Renderer::GetInstance()->BindShader(shader_);
 
-    for (auto it = matrix4x4Uniforms_.begin(); it != matrix4x4Uniforms_.end(); ++it) {
-        shader_->SetUniformMatrix4x4(it->first, it->second);
+    if (shaderLinkCount_ != shader_->GetLinkCount()) {
+        ResolveHandles();
     }
 
-    for (auto it = matrix4x4ArrayUniforms_.begin(); it != matrix4x4ArrayUniforms_.end(); ++it) {
-        shader_->SetUniformMatrix4x4Array(it->first, &(it->second[0]), it->second.size());
+    // If this material was the last one applied to the shader, only the parameters that changed since have to be sent
+    bool uploadAll = (shader_->GetAppliedMaterial() != id_);
+    if (uploadAll || hasDirtyParameters_) {
+        for (size_t i = 0; i < parameters_.size(); i++) {
+            MaterialParameter_t& parameter = parameters_[i];
+            if (uploadAll || parameter.dirty) {
+                UploadParameter(parameter);
+                parameter.dirty = false;
+            }
+        }
+
+        hasDirtyParameters_ = false;
+        shader_->SetAppliedMaterial(id_);
     }
 
-    for (auto it = textureUniforms_.begin(); it != textureUniforms_.end(); ++it) {
-        shader_->SetUniformTexture(it->first, it->second);
+    for (size_t i = 0; i < textureParameters_.size(); i++) {
+        shader_->SetUniformTexture(textureParameters_[i].handle, textureParameters_[i].texture);
     }
 
     return true;
@@ -63,6 +91,16 @@ bool Material::ApplyMaterial() const {
 
 void Material::SetShader(Shader* shader) {
 	shader_ = shader;
+    ResolvePipelineState();
+
+    if (shader_ != nullptr) {
+        // The shader might hold the values this material had when it was last applied to it
+        if (shader_->GetAppliedMaterial() == id_) {
+            shader_->SetAppliedMaterial(NO_APPLIED_MATERIAL);
+        }
+
+        ResolveHandles();
+    }
 }
 
 void Material::SetTransluencyType(TransluencyType_t type) {
@@ -70,51 +108,225 @@ void Material::SetTransluencyType(TransluencyType_t type) {
 }
 
 void Material::SetUniformInt(const string& uniform, int value) {
-    intUniforms_[uniform] = value;
+    float packedValue;
+    memcpy(&packedValue, &value, sizeof(float));
+    SetParameter(uniform, MATERIAL_PARAMETER_INT, &packedValue, 1);
 }
 
 void Material::SetUniformFloat(const string& uniform, float value) {
-    floatUniforms_[uniform] = value;
+    SetParameter(uniform, MATERIAL_PARAMETER_FLOAT, &value, 1);
 }
 
 void Material::SetUniformVector2(const string& uniform, float value1, float value2) {
-    vector2Uniforms_[uniform] = Vector2(value1, value2);
+    float values[2] = { value1, value2 };
+    SetParameter(uniform, MATERIAL_PARAMETER_VECTOR2, values, 2);
 }
 
 void Material::SetUniformVector3(const string& uniform, const Vector3& value) {
-    vector3Uniforms_[uniform] = value;
+    float values[3] = { value.x, value.y, value.z };
+    SetParameter(uniform, MATERIAL_PARAMETER_VECTOR3, values, 3);
 }
 
 void Material::SetUniformVector3Array(const string& uniform, const vector<Vector3>& values) {
-    vector3ArrayUniforms_[uniform] = values;
+    vector<float> packedValues;
+    packedValues.reserve(values.size() * 3);
+    for (size_t i = 0; i < values.size(); i++) {
+        packedValues.push_back(values[i].x);
+        packedValues.push_back(values[i].y);
+        packedValues.push_back(values[i].z);
+    }
+
+    SetParameter(uniform, MATERIAL_PARAMETER_VECTOR3_ARRAY, packedValues.data(), packedValues.size());
 }
 
 void Material::SetUniformVector4(const string& uniform, const Vector4& value) {
-    vector4Uniforms_[uniform] = value;
+    float values[4] = { value.x, value.y, value.z, value.w };
+    SetParameter(uniform, MATERIAL_PARAMETER_VECTOR4, values, 4);
 }
 
 void Material::SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value) {
-    matrix3x3Uniforms_[uniform] = value;
+    SetParameter(uniform, MATERIAL_PARAMETER_MATRIX3X3, value[0], 9);
 }
 
 void Material::SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value) {
-    matrix4x4Uniforms_[uniform] = value;
+    SetParameter(uniform, MATERIAL_PARAMETER_MATRIX4X4, value[0], 16);
 }
 
 void Material::SetUniformMatrix4x4Array(const string& uniform, const vector<Matrix4x4>& values) {
-    matrix4x4ArrayUniforms_[uniform] = values;
+    vector<float> packedValues(values.size() * 16);
+    for (size_t i = 0; i < values.size(); i++) {
+        memcpy(&packedValues[i * 16], values[i][0], 16 * sizeof(float));
+    }
+
+    SetParameter(uniform, MATERIAL_PARAMETER_MATRIX4X4_ARRAY, packedValues.data(), packedValues.size());
 }
 
 void Material::SetUniformTexture(const string& uniform, const Texture* texture) {
-    textureUniforms_[uniform] = texture;
+    for (size_t i = 0; i < textureParameters_.size(); i++) {
+        if (textureParameters_[i].name == uniform) {
+            textureParameters_[i].texture = texture;
+            return;
+        }
+    }
+
+    TextureParameter_t textureParameter;
+    textureParameter.name = uniform;
+    textureParameter.handle = FindHandle(uniform);
+    textureParameter.texture = texture;
+    textureParameters_.push_back(textureParameter);
 }
 
 Shader* Material::GetShader() const {
 	return shader_;
 }
 
+void Material::SetRenderState(const RenderState_t& renderState) {
+    hasRenderState_ = true;
+    renderState_ = renderState;
+    ResolvePipelineState();
+}
+
+const PipelineState* Material::GetPipelineState() const {
+    return pipelineState_;
+}
+
 TransluencyType_t Material::GetTransluencyType() const {
     return transluencyType_;
 }
 
-}
\ No newline at end of file
+void Material::SetParameter(const string& uniform, MaterialParameterType_t type, const float* values, size_t size) {
+    for (size_t i = 0; i < parameters_.size(); i++) {
+        MaterialParameter_t& parameter = parameters_[i];
+        if (parameter.name != uniform) {
+            continue;
+        }
+
+        if (parameter.size != size) {
+            // Repack the block around the new size of the value
+            vector<float>::iterator valueIt = parameterBlock_.begin() + parameter.offset;
+            valueIt = parameterBlock_.erase(valueIt, valueIt + parameter.size);
+            parameterBlock_.insert(valueIt, size, 0.0f);
+
+            for (size_t j = i + 1; j < parameters_.size(); j++) {
+                parameters_[j].offset = parameters_[j].offset - parameter.size + size;
+            }
+            parameter.size = size;
+        } else if (parameter.type == type && memcmp(parameterBlock_.data() + parameter.offset, values, size * sizeof(float)) == 0) {
+            return;
+        }
+
+        parameter.type = type;
+        memcpy(parameterBlock_.data() + parameter.offset, values, size * sizeof(float));
+        parameter.dirty = true;
+        hasDirtyParameters_ = true;
+        return;
+    }
+
+    MaterialParameter_t parameter;
+    parameter.name = uniform;
+    parameter.handle = FindHandle(uniform);
+    parameter.type = type;
+    parameter.offset = parameterBlock_.size();
+    parameter.size = size;
+    parameter.dirty = true;
+    parameters_.push_back(parameter);
+
+    parameterBlock_.insert(parameterBlock_.end(), values, values + size);
+    hasDirtyParameters_ = true;
+}
+
+void Material::ResolvePipelineState() {
+    RenderSystem* renderSystem = Renderer::GetInstance()->GetRenderSystem();
+    RenderStateCache* renderStateCache = (renderSystem != nullptr) ? renderSystem->GetRenderStateCache() : nullptr;
+    if (renderStateCache == nullptr) {
+        pipelineState_ = nullptr;
+        return;
+    }
+
+    pipelineState_ = (hasRenderState_) ? renderStateCache->GetPipelineState(shader_, renderState_) :
+                                         renderStateCache->GetPipelineState(shader_);
+}
+
+void Material::ResolveHandles() const {
+    shaderLinkCount_ = shader_->GetLinkCount();
+
+    for (size_t i = 0; i < parameters_.size(); i++) {
+        parameters_[i].handle = FindHandle(parameters_[i].name);
+    }
+
+    for (size_t i = 0; i < textureParameters_.size(); i++) {
+        textureParameters_[i].handle = FindHandle(textureParameters_[i].name);
+    }
+}
+
+UniformHandle_t Material::FindHandle(const string& uniform) const {
+    // Looking up a uniform would wait for the link. The link count of the shader goes up once it is done, which
+    // resolves the handles when the material is applied
+    if (shader_ == nullptr || shader_->IsLinkPending()) {
+        return INVALID_UNIFORM_HANDLE;
+    }
+
+    return shader_->GetUniformHandle(uniform);
+}
+
+void Material::UploadParameter(const MaterialParameter_t& parameter) const {
+    if (parameter.handle == INVALID_UNIFORM_HANDLE || parameter.size == 0) {
+        return;
+    }
+
+    const float* value = parameterBlock_.data() + parameter.offset;
+    switch (parameter.type) {
+        case MATERIAL_PARAMETER_INT: {
+            int intValue;
+            memcpy(&intValue, value, sizeof(int));
+            shader_->SetUniformInt(parameter.handle, intValue);
+            break;
+        }
+
+        case MATERIAL_PARAMETER_FLOAT:
+            shader_->SetUniformFloat(parameter.handle, value[0]);
+            break;
+
+        case MATERIAL_PARAMETER_VECTOR2:
+            shader_->SetUniformVector2(parameter.handle, value[0], value[1]);
+            break;
+
+        case MATERIAL_PARAMETER_VECTOR3:
+            shader_->SetUniformVector3(parameter.handle, Vector3(value[0], value[1], value[2]));
+            break;
+
+        case MATERIAL_PARAMETER_VECTOR3_ARRAY: {
+            vector<Vector3> values;
+            values.reserve(parameter.size / 3);
+            for (size_t i = 0; i < parameter.size; i += 3) {
+                values.push_back(Vector3(value[i], value[i + 1], value[i + 2]));
+            }
+            shader_->SetUniformVector3Array(parameter.handle, &values[0], (int)values.size());
+            break;
+        }
+
+        case MATERIAL_PARAMETER_VECTOR4:
+            shader_->SetUniformVector4(parameter.handle, Vector4(value[0], value[1], value[2], value[3]));
+            break;
+
+        case MATERIAL_PARAMETER_MATRIX3X3:
+            shader_->SetUniformMatrix3x3(parameter.handle, Matrix3x3(const_cast<float*>(value)));
+            break;
+
+        case MATERIAL_PARAMETER_MATRIX4X4:
+            shader_->SetUniformMatrix4x4(parameter.handle, Matrix4x4(const_cast<float*>(value)));
+            break;
+
+        case MATERIAL_PARAMETER_MATRIX4X4_ARRAY: {
+            vector<Matrix4x4> values;
+            values.reserve(parameter.size / 16);
+            for (size_t i = 0; i < parameter.size; i += 16) {
+                values.push_back(Matrix4x4(const_cast<float*>(value + i)));
+            }
+            shader_->SetUniformMatrix4x4Array(parameter.handle, &values[0], (int)values.size());
+            break;
+        }
+    }
+}
+
+}
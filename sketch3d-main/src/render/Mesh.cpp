@@ -10,6 +10,7 @@
 #include "render/TextureManager.h"
 
 #include "system/Logger.h"
+#include "system/Profiler.h"
 #include "system/Utils.h"
 
 #include "render/OpenGL/gl/glew.h"
@@ -70,6 +71,8 @@ Mesh& Mesh::operator= (const Mesh& rhs) {
 }
 
 void Mesh::Load(const string& filename, const VertexAttributesMap_t& vertexAttributes, bool counterClockWise) {
+    PROFILE_ZONE("Mesh::Load");
+
     if (filename == filename_) {
         return;
     }
@@ -213,7 +216,7 @@ void Mesh::Load(const string& filename, const VertexAttributesMap_t& vertexAttri
 
             if (mesh->HasFaces()) {
                 surface->numIndices = mesh->mNumFaces * 3;
-                surface->indices = new unsigned short[surface->numIndices];
+                surface->indices = new unsigned int[surface->numIndices];
                 size_t idx = 0;
 
                 for (size_t j = 0; j < mesh->mNumFaces; j++) {
@@ -332,7 +335,8 @@ void Mesh::Initialize(const VertexAttributesMap_t& vertexAttributes) {
     }
 
     bufferObjects_ = new BufferObject* [surfaces_.size()];
-    BufferUsage_t bufferUsage = (meshType_ == MESH_TYPE_STATIC) ? BUFFER_USAGE_STATIC : BUFFER_USAGE_DYNAMIC;
+    // The static surfaces share their storage so that they can be drawn together with indirect draws
+    BufferUsage_t bufferUsage = (meshType_ == MESH_TYPE_STATIC) ? BUFFER_USAGE_STATIC_SHARED : BUFFER_USAGE_DYNAMIC;
 
     for (size_t i = 0; i < surfaces_.size(); i++) {
         bufferObjects_[i] = Renderer::GetInstance()->GetBufferObjectManager()->CreateBufferObject(vertexAttributes_, bufferUsage);
@@ -389,6 +393,14 @@ void Mesh::GetRenderInfo(BufferObject**& bufferObjects, vector<SurfaceTriangles_
     surfaces = surfaces_;
 }
 
+BufferObject** Mesh::GetBufferObjects() const {
+    return bufferObjects_;
+}
+
+const vector<SurfaceTriangles_t*>& Mesh::GetSurfaces() const {
+    return surfaces_;
+}
+
 const Sphere& Mesh::GetBoundingSphere() const {
     return boundingSphere_;
 }
@@ -434,52 +446,59 @@ void Mesh::FreeMeshMemory() {
 }
 
 void Mesh::ConstructBoundingSphere() {
-    vector<Vector3> vertices;
-    size_t size = 0;
-    for (size_t i = 0; i < surfaces_.size(); i++) {
-        size += surfaces_[i]->numVertices;
+    // The vertices are read in place from the surfaces
+    size_t firstSurface = 0;
+    while (firstSurface < surfaces_.size() && surfaces_[firstSurface]->numVertices == 0) {
+        firstSurface += 1;
     }
-    vertices.reserve(size);
 
-    for (size_t i = 0; i < surfaces_.size(); i++) {
-        for (size_t j = 0; j < surfaces_[i]->numVertices; j++) {
-            vertices.push_back(surfaces_[i]->vertices[j]);
-        }
+    if (firstSurface == surfaces_.size()) {
+        return;
     }
 
     // From http://stackoverflow.com/questions/17331203/bouncing-bubble-algorithm-for-smallest-enclosing-sphere
     // Original algorithm is from Bo Tian
-    Vector3 center = vertices[0];
+    Vector3 center = surfaces_[firstSurface]->vertices[0];
     float radius = 0.0001f;
     Vector3 pos, diff;
     float length, alpha, alphaSq;
 
     for (size_t i = 0; i < 2; i++) {
-        for (size_t j = 0; j < vertices.size(); j++) {
+        for (size_t j = 0; j < surfaces_.size(); j++) {
+            const Vector3* vertices = surfaces_[j]->vertices;
+            size_t numVertices = surfaces_[j]->numVertices;
+
+            for (size_t k = 0; k < numVertices; k++) {
+                pos = vertices[k];
+                diff = pos - center;
+                length = diff.Length();
+
+                if (length > radius) {
+                    alpha = length / radius;
+                    alphaSq = alpha * alpha;
+                    radius = 0.5f * (alpha + 1.0f / alpha) * radius;
+                    center = 0.5f * ((1.0f + 1.0f / alphaSq) * center + (1.0f - 1.0f / alphaSq) * pos);
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < surfaces_.size(); i++) {
+        const Vector3* vertices = surfaces_[i]->vertices;
+        size_t numVertices = surfaces_[i]->numVertices;
+
+        for (size_t j = 0; j < numVertices; j++) {
             pos = vertices[j];
             diff = pos - center;
             length = diff.Length();
 
             if (length > radius) {
-                alpha = length / radius;
-                alphaSq = alpha * alpha;
-                radius = 0.5f * (alpha + 1.0f / alpha) * radius;
-                center = 0.5f * ((1.0f + 1.0f / alphaSq) * center + (1.0f - 1.0f / alphaSq) * pos);
+                radius = (radius + length) / 2.0f;
+                center = center + ((length - radius) / length * diff);
             }
         }
     }
 
-    for (size_t i = 0; i < vertices.size(); i++) {
-        pos = vertices[i];
-        diff = pos - center;
-        length = diff.Length();
-
-        if (length > radius) {
-            radius = (radius + length) / 2.0f;
-            center = center + ((length - radius) / length * diff);
-        }
-    }
-
     boundingSphere_.SetCenter(center);
     boundingSphere_.SetRadius(radius);
 }
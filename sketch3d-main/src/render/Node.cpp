@@ -7,6 +7,7 @@
 #include "render/Renderer.h"
 #include "render/RenderQueue.h"
 #include "render/RenderStateCache.h"
+#include "render/RenderSystem.h"
 #include "render/Shader.h"
 #include "render/SkinnedMesh.h"
 #include "render/Texture2D.h"
@@ -16,10 +17,13 @@
 namespace Sketch3D {
 
 long long Node::nextNameIndex_ = 0;
+const unsigned int Node::identityTransformationVersion_ = 0;
 
 Node::Node(Node* parent) : parent_(parent), mesh_(NULL), material_(NULL),
                            scale_(1.0f, 1.0f, 1.0), parentTransformation_(&Matrix4x4::IDENTITY),
-                           needTransformationUpdate_(true), useInstancing_(false), isStatic_(false)
+                           parentTransformationVersion_(&identityTransformationVersion_), transformationVersion_(0),
+                           needTransformationUpdate_(true), normalMatrixVersion_(0), normalMatrixParentVersion_(0),
+                           useInstancing_(false), isStatic_(false), stateVersion_(0), renderQueue_(nullptr), renderQueueEntry_(0)
 {
     ostringstream convert;
     convert << nextNameIndex_;
@@ -30,7 +34,9 @@ Node::Node(Node* parent) : parent_(parent), mesh_(NULL), material_(NULL),
 Node::Node(const string& name, Node* parent) : name_(name), parent_(parent),
 											   mesh_(NULL), material_(NULL),
 											   scale_(1.0f, 1.0f, 1.0f), parentTransformation_(&Matrix4x4::IDENTITY),
-                                               needTransformationUpdate_(true), useInstancing_(false), isStatic_(false)
+                                               parentTransformationVersion_(&identityTransformationVersion_), transformationVersion_(0),
+                                               needTransformationUpdate_(true), normalMatrixVersion_(0), normalMatrixParentVersion_(0),
+                                               useInstancing_(false), isStatic_(false), stateVersion_(0), renderQueue_(nullptr), renderQueueEntry_(0)
 {
 }
 
@@ -42,9 +48,16 @@ Node::Node(const Vector3& position, const Vector3& scale,
 														  mesh_(NULL),
 														  material_(NULL),
                                                           parentTransformation_(&Matrix4x4::IDENTITY),
+                                                          parentTransformationVersion_(&identityTransformationVersion_),
+                                                          transformationVersion_(0),
                                                           needTransformationUpdate_(true),
+                                                          normalMatrixVersion_(0),
+                                                          normalMatrixParentVersion_(0),
                                                           useInstancing_(false),
-                                                          isStatic_(false)
+                                                          isStatic_(false),
+                                                          stateVersion_(0),
+                                                          renderQueue_(nullptr),
+                                                          renderQueueEntry_(0)
 {
     ostringstream convert;
     convert << nextNameIndex_;
@@ -61,9 +74,16 @@ Node::Node(const string& name, const Vector3& position, const Vector3& scale,
 														  mesh_(NULL),
 														  material_(NULL),
                                                           parentTransformation_(&Matrix4x4::IDENTITY),
+                                                          parentTransformationVersion_(&identityTransformationVersion_),
+                                                          transformationVersion_(0),
                                                           needTransformationUpdate_(true),
+                                                          normalMatrixVersion_(0),
+                                                          normalMatrixParentVersion_(0),
                                                           useInstancing_(false),
-                                                          isStatic_(false)
+                                                          isStatic_(false),
+                                                          stateVersion_(0),
+                                                          renderQueue_(nullptr),
+                                                          renderQueueEntry_(0)
 {
 }
 
@@ -73,9 +93,16 @@ Node::Node(const Node& src) : parent_(src.parent_),
                               orientation_(src.orientation_),
                               material_(src.material_),
                               parentTransformation_(&Matrix4x4::IDENTITY),
+                              parentTransformationVersion_(&identityTransformationVersion_),
+                              transformationVersion_(0),
                               needTransformationUpdate_(true),
+                              normalMatrixVersion_(0),
+                              normalMatrixParentVersion_(0),
                               useInstancing_(false),
-                              isStatic_(false)
+                              isStatic_(false),
+                              stateVersion_(0),
+                              renderQueue_(nullptr),
+                              renderQueueEntry_(0)
 {
     // TODO
     // Better manage name copy
@@ -106,11 +133,15 @@ void Node::Render() {
 
     // Set the uniform matrices
     Renderer::GetInstance()->BindShader(shader);
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL_VIEW_PROJECTION), modelViewProjection );
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL_VIEW), modelView );
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL), model );
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::VIEW), view );
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::PROJECTION), projection );
+    shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL_VIEW_PROJECTION), modelViewProjection );
+    shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL_VIEW), modelView );
+    shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL), model );
+    if (shader->UsesCameraUniformBlock()) {
+        Renderer::GetInstance()->GetRenderSystem()->SetCameraUniforms(view, projection, viewProjection);
+    } else {
+        shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW), view );
+        shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::PROJECTION), projection );
+    }
 
     // Get the rendering data
     BufferObject** bufferObjects;
@@ -126,7 +157,7 @@ void Node::Render() {
             Texture2D* texture = surfaces[i]->textures[j];
             if (texture != nullptr) {
                 BuiltinUniform_t builtinUniformTexture = (BuiltinUniform_t)((size_t)BuiltinUniform_t::TEXTURE_0 + j);
-                shader->SetUniformTexture( GetBuiltinUniformName(builtinUniformTexture), texture );
+                shader->SetUniformTexture( shader->GetBuiltinUniformHandle(builtinUniformTexture), texture );
             }
         }
 
@@ -142,6 +173,12 @@ bool Node::AddChildren(Node* node) {
 	}
 
     node->parentTransformation_ = &cachedTransformation_;
+    node->parentTransformationVersion_ = &transformationVersion_;
+
+    // The versions of the old and new parents aren't comparable, so the cached matrices of the child are invalidated
+    // with a version that its transformation version can't reach anymore, and its retained entry is rebuilt
+    node->normalMatrixVersion_ = node->transformationVersion_ - 1;
+    node->stateVersion_ += 1;
 	children_[name] = node;
 	return true;
 }
@@ -233,11 +270,24 @@ Matrix4x4 Node::ConstructModelMatrix() {
 
         needTransformationUpdate_ = false;
         cachedTransformation_ = model;
+        transformationVersion_ += 1;
     }
 
     return (*parentTransformation_) * cachedTransformation_;
 }
 
+const Matrix4x4& Node::ConstructNormalMatrix() {
+    if (needTransformationUpdate_ || normalMatrixVersion_ != transformationVersion_ ||
+        normalMatrixParentVersion_ != *parentTransformationVersion_)
+    {
+        cachedNormalMatrix_ = ConstructModelMatrix().InverseAffine().Transpose();
+        normalMatrixVersion_ = transformationVersion_;
+        normalMatrixParentVersion_ = *parentTransformationVersion_;
+    }
+
+    return cachedNormalMatrix_;
+}
+
 void Node::SetParent(Node* parent) {
 	parent_ = parent;
 }
@@ -259,14 +309,17 @@ void Node::SetOrientation(const Quaternion& orientation) {
 
 void Node::SetMesh(Mesh* mesh) {
 	mesh_ = mesh;
+    stateVersion_ += 1;
 }
 
 void Node::SetMaterial(Material* material) {
 	material_ = material;
+    stateVersion_ += 1;
 }
 
 void Node::SetInstancing(bool val) {
     useInstancing_ = val;
+    stateVersion_ += 1;
     if (mesh_ != nullptr) {
         mesh_->PrepareInstancingData();
     }
@@ -274,6 +327,7 @@ void Node::SetInstancing(bool val) {
 
 void Node::SetStatic(bool val) {
     isStatic_ = val;
+    stateVersion_ += 1;
 }
 
 const string& Node::GetName() const {
@@ -312,36 +366,29 @@ bool Node::IsStatic() const {
     return isStatic_;
 }
 
-void Node::Render(const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling, RenderQueue& opaqueRenderQueue, RenderQueue& transparentRenderQueue) {
+void Node::CollectRenderableNodes(vector<Node*>& nodes, BoundingSpheres_t* boundingSpheres) {
     if (mesh_ != nullptr && !isStatic_) {
-        bool addMeshToRenderQueue = true;
-
-        if (useFrustumCulling) {
-            float maxScaleValue = max(scale_.x, max(scale_.y, scale_.z));
-            const Matrix4x4& model = ConstructModelMatrix();
-
-            const Sphere& meshBoundingSphere = mesh_->GetBoundingSphere();
-            Vector4 transformedCenter = model * meshBoundingSphere.GetCenter();
-            Sphere nodeBoundingSphere(Vector3(transformedCenter.x, transformedCenter.y, transformedCenter.z), meshBoundingSphere.GetRadius() * maxScaleValue);
+        nodes.push_back(this);
 
-            if (frustumPlanes.IsSphereOutside(nodeBoundingSphere)) {
-                addMeshToRenderQueue = false;
-            }
-        }
-
-        if (addMeshToRenderQueue) {
-            if (material_->GetTransluencyType() == TRANSLUENCY_TYPE_OPAQUE) {
-                opaqueRenderQueue.AddNode(this);
-            } else {
-                transparentRenderQueue.AddNode(this);
-            }
+        if (boundingSpheres != nullptr) {
+            AddBoundingSphere(*boundingSpheres);
         }
     }
 
 	map<string, Node*>::const_iterator it = children_.begin();
 	for (; it != children_.end(); ++it) {
-        it->second->Render(frustumPlanes, useFrustumCulling, opaqueRenderQueue, transparentRenderQueue);
+        it->second->CollectRenderableNodes(nodes, boundingSpheres);
 	}
 }
 
+void Node::AddBoundingSphere(BoundingSpheres_t& boundingSpheres) {
+    float maxScaleValue = max(scale_.x, max(scale_.y, scale_.z));
+    const Matrix4x4& model = ConstructModelMatrix();
+
+    const Sphere& meshBoundingSphere = mesh_->GetBoundingSphere();
+    Vector4 transformedCenter = model * meshBoundingSphere.GetCenter();
+    boundingSpheres.Add(Vector3(transformedCenter.x, transformedCenter.y, transformedCenter.z),
+                        meshBoundingSphere.GetRadius() * maxScaleValue);
+}
+
 }
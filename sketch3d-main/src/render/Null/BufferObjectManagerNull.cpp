@@ -0,0 +1,36 @@
+#include "render/Null/BufferObjectManagerNull.h"
+
+#include "render/Null/BufferObjectNull.h"
+
+namespace Sketch3D {
+
+BufferObjectManagerNull::BufferObjectManagerNull(ApiCallCounters_t* apiCallCounters, FrameStats_t* frameStats, bool useSharedStorage) :
+        apiCallCounters_(apiCallCounters), frameStats_(frameStats), useSharedStorage_(useSharedStorage)
+{
+}
+
+BufferObject* BufferObjectManagerNull::CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) {
+    BufferObject* buffer = new BufferObjectNull(this, apiCallCounters_, frameStats_, vertexAttributes, usage);
+    bufferObjects_.insert(buffer);
+    return buffer;
+}
+
+size_t BufferObjectManagerNull::GetSharedStorageId(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes,
+                                                   IndexFormat_t indexFormat)
+{
+    if (!useSharedStorage_) {
+        return 0;
+    }
+
+    SharedStorageKey_t sharedStorageKey(VertexLayout_t(vertexAttributes, presentVertexAttributes), indexFormat);
+    map<SharedStorageKey_t, size_t>::iterator it = sharedStorageIds_.find(sharedStorageKey);
+    if (it != sharedStorageIds_.end()) {
+        return it->second;
+    }
+
+    size_t sharedStorageId = sharedStorageIds_.size() + 1;
+    sharedStorageIds_[sharedStorageKey] = sharedStorageId;
+    return sharedStorageId;
+}
+
+}
@@ -0,0 +1,137 @@
+#include "render/Null/BufferObjectNull.h"
+
+#include "render/FrameStats.h"
+#include "render/Null/BufferObjectManagerNull.h"
+#include "render/Null/RenderSystemNull.h"
+
+#include "math/Matrix4x4.h"
+#include "math/Vector2.h"
+#include "math/Vector3.h"
+#include "math/Vector4.h"
+
+namespace Sketch3D {
+
+BufferObjectNull::BufferObjectNull(BufferObjectManagerNull* manager, ApiCallCounters_t* apiCallCounters, FrameStats_t* frameStats,
+                                   const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) : BufferObject(vertexAttributes, usage),
+        manager_(manager), apiCallCounters_(apiCallCounters), frameStats_(frameStats)
+{
+}
+
+BufferObjectNull::~BufferObjectNull() {
+}
+
+void BufferObjectNull::Render() {
+    apiCallCounters_->drawCalls++;
+    apiCallCounters_->drawnIndices += indexCount_;
+}
+
+void BufferObjectNull::RenderInstances(const vector<Matrix4x4>& modelMatrices) {
+    // The model matrices are uploaded to the instance buffer before every draw
+    apiCallCounters_->bufferUploads++;
+    frameStats_->bufferBytesUploaded += sizeof(Matrix4x4) * modelMatrices.size();
+    apiCallCounters_->instancedDrawCalls++;
+    apiCallCounters_->drawnInstances += modelMatrices.size();
+    apiCallCounters_->drawnIndices += indexCount_ * modelMatrices.size();
+}
+
+void BufferObjectNull::RenderIndirect(const DrawIndirectCommand_t* commands, size_t numCommands, const vector<Matrix4x4>& modelMatrices) {
+    // The model matrices and the commands are uploaded before every draw
+    apiCallCounters_->bufferUploads += 2;
+    frameStats_->bufferBytesUploaded += sizeof(Matrix4x4) * modelMatrices.size() + sizeof(DrawIndirectCommand_t) * numCommands;
+    apiCallCounters_->indirectDrawCalls++;
+    apiCallCounters_->indirectDraws += numCommands;
+
+    for (size_t i = 0; i < numCommands; i++) {
+        apiCallCounters_->drawnIndices += commands[i].indexCount * commands[i].instanceCount;
+    }
+}
+
+BufferObjectError_t BufferObjectNull::SetVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
+    stride_ = sizeof(Vector3) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_NORMAL) > 0) ? sizeof(Vector3) : 0) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_TEX_COORDS) > 0) ? sizeof(Vector2) : 0) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_TANGENT) > 0) ? sizeof(Vector3) : 0) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_BONES) > 0) ? sizeof(Vector4) : 0) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_WEIGHTS) > 0) ? sizeof(Vector4) : 0);
+
+    if (!AreVertexAttributesValid(presentVertexAttributes)) {
+        return BUFFER_OBJECT_ERROR_INVALID_VERTEX_ATTRIBUTES;
+    }
+
+    vertexCount_ = vertexData.size();
+    apiCallCounters_->bufferUploads++;
+    frameStats_->bufferBytesUploaded += vertexData.size() * sizeof(float);
+
+    // Like in the OpenGL implementation, the shared storages are separated by index format, which depends on the
+    // number of vertices
+    if (usage_ == BUFFER_USAGE_STATIC_SHARED) {
+        IndexFormat_t indexFormat = GetIndexFormatForVertices(vertexCount_ / (stride_ / sizeof(float)));
+        sharedStorageId_ = manager_->GetSharedStorageId(vertexAttributes_, presentVertexAttributes, indexFormat);
+        if (sharedStorageId_ != 0) {
+            indexFormat_ = indexFormat;
+        }
+    }
+
+    return BUFFER_OBJECT_ERROR_NONE;
+}
+
+BufferObjectError_t BufferObjectNull::AppendVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
+    if (vertexCount_ == 0) {
+        return SetVertexData(vertexData, presentVertexAttributes);
+    }
+
+    if (!AreVertexAttributesValid(presentVertexAttributes)) {
+        return BUFFER_OBJECT_ERROR_INVALID_VERTEX_ATTRIBUTES;
+    }
+
+    vertexCount_ += vertexData.size();
+    apiCallCounters_->bufferUploads++;
+    frameStats_->bufferBytesUploaded += vertexData.size() * sizeof(float);
+
+    // The data moves to the shared storage of the wider index format when the vertices don't fit in the current one
+    if (sharedStorageId_ != 0) {
+        IndexFormat_t indexFormat = GetIndexFormatForVertices(vertexCount_ / (stride_ / sizeof(float)));
+        if (indexFormat != indexFormat_) {
+            sharedStorageId_ = manager_->GetSharedStorageId(vertexAttributes_, presentVertexAttributes, indexFormat);
+            indexFormat_ = indexFormat;
+        }
+    }
+
+    return BUFFER_OBJECT_ERROR_NONE;
+}
+
+BufferObjectError_t BufferObjectNull::SetIndexData(unsigned int* indexData, size_t numIndex) {
+    indexCount_ = numIndex;
+    if (sharedStorageId_ == 0) {
+        indexFormat_ = GetIndexFormatForIndices(indexData, numIndex);
+    }
+
+    apiCallCounters_->bufferUploads++;
+    frameStats_->bufferBytesUploaded += numIndex * GetIndexSize(indexFormat_);
+
+    return BUFFER_OBJECT_ERROR_NONE;
+}
+
+BufferObjectError_t BufferObjectNull::AppendIndexData(unsigned int* indexData, size_t numIndex) {
+    if (indexCount_ == 0) {
+        return SetIndexData(indexData, numIndex);
+    }
+
+    // The whole index buffer is uploaded again when it has to be widened
+    size_t numUploadedIndices = numIndex;
+    if (sharedStorageId_ == 0 && indexFormat_ == INDEX_FORMAT_16 && GetIndexFormatForIndices(indexData, numIndex) == INDEX_FORMAT_32) {
+        indexFormat_ = INDEX_FORMAT_32;
+        numUploadedIndices += indexCount_;
+    }
+
+    indexCount_ += numIndex;
+    apiCallCounters_->bufferUploads++;
+    frameStats_->bufferBytesUploaded += numUploadedIndices * GetIndexSize(indexFormat_);
+
+    return BUFFER_OBJECT_ERROR_NONE;
+}
+
+void BufferObjectNull::PrepareInstanceBuffers() {
+}
+
+}
@@ -0,0 +1,51 @@
+#include "render/Null/RenderStateCacheNull.h"
+
+#include "render/Null/RenderSystemNull.h"
+
+namespace Sketch3D {
+
+RenderStateCacheNull::RenderStateCacheNull(ApiCallCounters_t* apiCallCounters, FrameStats_t* frameStats) : RenderStateCache(frameStats),
+        apiCallCounters_(apiCallCounters)
+{
+}
+
+RenderStateCacheNull::~RenderStateCacheNull() {
+}
+
+void RenderStateCacheNull::EnableDepthTestImpl() {
+    apiCallCounters_->stateChanges++;
+}
+
+void RenderStateCacheNull::EnableDepthWriteImpl() {
+    apiCallCounters_->stateChanges++;
+}
+
+void RenderStateCacheNull::EnableColorWriteImpl() {
+    apiCallCounters_->stateChanges++;
+}
+
+void RenderStateCacheNull::EnableBlendingImpl() {
+    apiCallCounters_->stateChanges++;
+}
+
+void RenderStateCacheNull::SetDepthComparisonFuncImpl() {
+    apiCallCounters_->stateChanges++;
+}
+
+void RenderStateCacheNull::SetCullingMethodImpl() {
+    apiCallCounters_->stateChanges++;
+}
+
+void RenderStateCacheNull::SetBlendingEquationImpl() {
+    apiCallCounters_->stateChanges++;
+}
+
+void RenderStateCacheNull::SetBlendingFactorImpl() {
+    apiCallCounters_->stateChanges++;
+}
+
+void RenderStateCacheNull::SetRenderFillModeImpl() {
+    apiCallCounters_->stateChanges++;
+}
+
+}
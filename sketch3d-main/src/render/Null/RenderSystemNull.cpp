@@ -0,0 +1,202 @@
+#include "render/Null/RenderSystemNull.h"
+
+#include "render/Null/BufferObjectManagerNull.h"
+#include "render/Null/RenderStateCacheNull.h"
+#include "render/Null/RenderTextureNull.h"
+#include "render/Null/ShaderNull.h"
+#include "render/Null/Texture2DNull.h"
+#include "render/Null/Texture3DNull.h"
+
+#include "system/Logger.h"
+
+namespace Sketch3D {
+
+void ApiCallCounters_t::Reset() {
+    clears = 0;
+    presentedFrames = 0;
+    viewportChanges = 0;
+    stateChanges = 0;
+    shaderCompilations = 0;
+    shaderLinks = 0;
+    shaderBinds = 0;
+    uniformUpdates = 0;
+    textureBinds = 0;
+    textureUploads = 0;
+    renderTargetBinds = 0;
+    bufferUploads = 0;
+    drawCalls = 0;
+    instancedDrawCalls = 0;
+    drawnInstances = 0;
+    indirectDrawCalls = 0;
+    indirectDraws = 0;
+    drawnIndices = 0;
+}
+
+RenderSystemNull::RenderSystemNull(unsigned int width, unsigned int height) : RenderSystem(width, height),
+        deferShaderLinks_(false)
+{
+	Logger::GetInstance()->Info("Current rendering API: Null");
+}
+
+RenderSystemNull::~RenderSystemNull() {
+	Logger::GetInstance()->Info("Shutdown Null render system");
+    FreeRenderSystem();
+}
+
+bool RenderSystemNull::Initialize(const RenderParameters_t& renderParameters) {
+	QueryDeviceCapabilities();
+
+    bufferObjectManager_ = new BufferObjectManagerNull(&apiCallCounters_, &frameStats_, deviceCapabilities_.supportsIndirectDraws_);
+    renderStateCache_ = new RenderStateCacheNull(&apiCallCounters_, &frameStats_);
+
+    CreateTextShader();
+
+	return true;
+}
+
+void RenderSystemNull::SetClearColor(float red, float green, float blue, float alpha) {
+}
+
+void RenderSystemNull::Clear(int buffer) const {
+    apiCallCounters_.clears++;
+}
+
+void RenderSystemNull::StartRender() {
+}
+
+void RenderSystemNull::EndRender() {
+}
+
+void RenderSystemNull::PresentFrame() {
+    apiCallCounters_.presentedFrames++;
+}
+
+// The projections follow the OpenGL conventions so that the same frustum planes are extracted
+Matrix4x4 RenderSystemNull::OrthoProjection(float left, float right, float bottom, float top,
+                                            float nearPlane, float farPlane) const
+{
+	float dx = right - left;
+	float dy = top - bottom;
+	float dz = farPlane - nearPlane;
+
+	Matrix4x4 projection;
+	projection[0][0] = 2.0f / dx;
+	projection[1][1] = 2.0f / dy;
+	projection[2][2] = -2.0f / dz;
+	projection[0][3] = -(right + left) / dx;
+	projection[1][3] = -(top + bottom) / dy;
+	projection[2][3] = -(farPlane + nearPlane) / dz;
+
+    return projection;
+}
+
+Matrix4x4 RenderSystemNull::PerspectiveProjection(float left, float right, float bottom, float top,
+                                                  float nearPlane, float farPlane) const
+{
+	float dx = right - left;
+	float dy = top - bottom;
+	float dz = nearPlane - farPlane;
+
+	Matrix4x4 projection;
+	projection[0][0] = 2.0f * nearPlane / dx;
+	projection[1][1] = 2.0f * nearPlane / dy;
+	projection[0][2] = (right + left) / dx;
+	projection[1][2] = (top + bottom) / dy;
+	projection[2][2] = (farPlane + nearPlane) / dz;
+	projection[3][2] = -1.0f;
+	projection[2][3] = 2.0f * nearPlane * farPlane / dz;
+	projection[3][3] = 0.0f;
+
+    return projection;
+}
+
+void RenderSystemNull::SetViewport(size_t x, size_t y, size_t width, size_t height) {
+    apiCallCounters_.viewportChanges++;
+}
+
+Shader* RenderSystemNull::CreateShader() {
+    shaders_.push_back(new ShaderNull(&apiCallCounters_, &frameStats_, deferShaderLinks_));
+    return shaders_.back();
+}
+
+Texture2D* RenderSystemNull::CreateTexture2D() const {
+    return new Texture2DNull(&apiCallCounters_);
+}
+
+Texture3D* RenderSystemNull::CreateTexture3D() const {
+    return new Texture3DNull(&apiCallCounters_);
+}
+
+RenderTexture* RenderSystemNull::CreateRenderTexture(unsigned int width, unsigned int height, TextureFormat_t format) {
+    renderTextures_.push_back(new RenderTextureNull(&apiCallCounters_, width, height, format));
+    return renderTextures_.back();
+}
+
+void RenderSystemNull::BindScreenBuffer() const {
+    apiCallCounters_.renderTargetBinds++;
+    Renderer::GetInstance()->SetViewport(0, 0, width_, height_);
+}
+
+size_t RenderSystemNull::BindTexture(const Texture* texture) {
+    apiCallCounters_.textureBinds++;
+    frameStats_.textureBinds++;
+    return 0;
+}
+
+void RenderSystemNull::BindShader(const Shader* shader) {
+    if (shader != nullptr && shader->IsLinkPending()) {
+        const_cast<ShaderNull*>(static_cast<const ShaderNull*>(shader))->FinishLink();
+    }
+
+    if (shader != boundShader_) {
+        apiCallCounters_.shaderBinds++;
+        frameStats_.shaderBinds++;
+        boundShader_ = shader;
+    }
+}
+
+FrustumPlanes_t RenderSystemNull::ExtractViewFrustumPlanes(const Matrix4x4& viewProjection) const {
+    FrustumPlanes_t frustumPlanes;
+    Plane* planes[] = {
+        &frustumPlanes.leftPlane, &frustumPlanes.rightPlane,
+        &frustumPlanes.bottomPlane, &frustumPlanes.topPlane,
+        &frustumPlanes.nearPlane, &frustumPlanes.farPlane
+    };
+
+    // Left and right planes come from the first row, bottom and top from the second and near and far from the third
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+
+        Vector3 normal(viewProjection[3][0] + sign * viewProjection[row][0],
+                       viewProjection[3][1] + sign * viewProjection[row][1],
+                       viewProjection[3][2] + sign * viewProjection[row][2]);
+        float length = normal.Length();
+        planes[i]->SetNormalizedNormal(normal / length);
+        planes[i]->SetDistance( (viewProjection[3][3] + sign * viewProjection[row][3]) / length );
+    }
+
+    return frustumPlanes;
+}
+
+void RenderSystemNull::EnableDeferredShaderCompilation(bool val) {
+    deferShaderLinks_ = val;
+}
+
+void RenderSystemNull::UploadCameraUniforms() {
+    apiCallCounters_.bufferUploads++;
+    frameStats_.bufferBytesUploaded += sizeof(CameraUniforms_t);
+}
+
+void RenderSystemNull::QueryDeviceCapabilities() {
+    deviceCapabilities_.maxActiveTextures_ = 32;
+    deviceCapabilities_.maxNumberRenderTargets_ = 8;
+    deviceCapabilities_.supportsIndirectDraws_ = true;
+    deviceCapabilities_.maxVertexIndex_ = 0xFFFFFFFF;
+}
+
+void RenderSystemNull::CreateTextShader() {
+    textShader_ = CreateShader();
+}
+
+}
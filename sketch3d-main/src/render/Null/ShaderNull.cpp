@@ -0,0 +1,116 @@
+#include "render/Null/ShaderNull.h"
+
+#include "render/FrameStats.h"
+#include "render/Null/RenderSystemNull.h"
+#include "render/Texture.h"
+
+namespace Sketch3D {
+
+ShaderNull::ShaderNull(ApiCallCounters_t* apiCallCounters, FrameStats_t* frameStats, bool deferLink) :
+        apiCallCounters_(apiCallCounters), frameStats_(frameStats), deferLink_(deferLink), linkPending_(false)
+{
+    ResolveBuiltinUniforms();
+}
+
+ShaderNull::~ShaderNull() {
+}
+
+bool ShaderNull::SetSourceFile(const string& vertexFilename, const string& fragmentFilename) {
+    apiCallCounters_->shaderCompilations++;
+    StartLink();
+    return true;
+}
+
+bool ShaderNull::SetSource(const string& vertexSource, const string& fragmentSource) {
+    apiCallCounters_->shaderCompilations++;
+    usesCameraUniformBlock_ = (vertexSource.find(CAMERA_UNIFORM_BLOCK_NAME) != string::npos ||
+                               fragmentSource.find(CAMERA_UNIFORM_BLOCK_NAME) != string::npos);
+    StartLink();
+    return true;
+}
+
+UniformHandle_t ShaderNull::GetUniformHandle(const string& uniform) const {
+    if (linkPending_) {
+        const_cast<ShaderNull*>(this)->FinishLink();
+    }
+
+    unordered_map<string, UniformHandle_t>::iterator it = nameToUniforms_.find(uniform);
+    if (it != nameToUniforms_.end()) {
+        return it->second;
+    }
+
+    UniformHandle_t handle = (UniformHandle_t)nameToUniforms_.size();
+    nameToUniforms_[uniform] = handle;
+    return handle;
+}
+
+bool ShaderNull::IsLinkPending() const {
+    return linkPending_;
+}
+
+void ShaderNull::SetUniformIntImpl(UniformHandle_t uniform, int value) {
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::SetUniformFloatImpl(UniformHandle_t uniform, float value) {
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2) {
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value) {
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize) {
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value) {
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value) {
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value) {
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize) {
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture) {
+    // Bind the texture to go through the same path as the other render systems
+    texture->Bind();
+    apiCallCounters_->uniformUpdates++;
+    frameStats_->uniformUploads++;
+}
+
+void ShaderNull::StartLink() {
+    linkPending_ = true;
+    if (!deferLink_) {
+        FinishLink();
+    }
+}
+
+void ShaderNull::FinishLink() {
+    linkPending_ = false;
+    apiCallCounters_->shaderLinks++;
+    ResolveBuiltinUniforms();
+}
+
+}
@@ -0,0 +1,40 @@
+#include "render/Null/Texture2DNull.h"
+
+#include "render/Null/RenderSystemNull.h"
+
+namespace Sketch3D {
+
+Texture2DNull::Texture2DNull(ApiCallCounters_t* apiCallCounters, bool generateMipmaps) : Texture2D(generateMipmaps),
+        apiCallCounters_(apiCallCounters)
+{
+}
+
+Texture2DNull::~Texture2DNull() {
+}
+
+bool Texture2DNull::Create() {
+    apiCallCounters_->textureUploads++;
+    return true;
+}
+
+const void* Texture2DNull::GetData() const {
+    return data_;
+}
+
+void Texture2DNull::SetFilterModeImpl() const {
+    apiCallCounters_->stateChanges++;
+}
+
+void Texture2DNull::SetWrapModeImpl() const {
+    apiCallCounters_->stateChanges++;
+}
+
+void Texture2DNull::SetPixelDataBytesImp(unsigned char* data) {
+    apiCallCounters_->textureUploads++;
+}
+
+void Texture2DNull::SetPixelDataFloatsImp(float* data) {
+    apiCallCounters_->textureUploads++;
+}
+
+}
@@ -0,0 +1,36 @@
+#include "render/Null/Texture3DNull.h"
+
+#include "render/Null/RenderSystemNull.h"
+
+namespace Sketch3D {
+
+Texture3DNull::Texture3DNull(ApiCallCounters_t* apiCallCounters, bool generateMipmaps) : Texture3D(generateMipmaps),
+        apiCallCounters_(apiCallCounters)
+{
+}
+
+Texture3DNull::~Texture3DNull() {
+}
+
+bool Texture3DNull::Create() {
+    apiCallCounters_->textureUploads++;
+    return true;
+}
+
+void Texture3DNull::SetFilterModeImpl() const {
+    apiCallCounters_->stateChanges++;
+}
+
+void Texture3DNull::SetWrapModeImpl() const {
+    apiCallCounters_->stateChanges++;
+}
+
+void Texture3DNull::SetPixelDataBytesImp(unsigned char* data) {
+    apiCallCounters_->textureUploads++;
+}
+
+void Texture3DNull::SetPixelDataFloatsImp(float* data) {
+    apiCallCounters_->textureUploads++;
+}
+
+}
@@ -1,13 +1,48 @@
 #include "render/OpenGL/BufferObjectManagerOpenGL.h"
 
 #include "render/OpenGL/BufferObjectOpenGL.h"
+#include "render/OpenGL/SharedBufferStorageOpenGL.h"
 
 namespace Sketch3D {
 
+BufferObjectManagerOpenGL::BufferObjectManagerOpenGL(bool useSharedStorage, FrameStats_t* frameStats,
+                                                     RenderStateCacheOpenGL* renderStateCache) : useSharedStorage_(useSharedStorage),
+        frameStats_(frameStats), renderStateCache_(renderStateCache)
+{
+}
+
+BufferObjectManagerOpenGL::~BufferObjectManagerOpenGL() {
+    map<SharedStorageKey_t, SharedBufferStorageOpenGL*>::iterator it = sharedStorages_.begin();
+    for (; it != sharedStorages_.end(); ++it) {
+        delete it->second;
+    }
+}
+
 BufferObject* BufferObjectManagerOpenGL::CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) {
-    BufferObject* buffer = new BufferObjectOpenGL(vertexAttributes, usage);
+    BufferObject* buffer = new BufferObjectOpenGL(this, vertexAttributes, usage);
     bufferObjects_.insert(buffer);
     return buffer;
 }
 
-}
\ No newline at end of file
+SharedBufferStorageOpenGL* BufferObjectManagerOpenGL::GetSharedStorage(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes,
+                                                                       size_t stride, IndexFormat_t indexFormat)
+{
+    if (!useSharedStorage_) {
+        return nullptr;
+    }
+
+    SharedStorageKey_t sharedStorageKey(VertexLayout_t(vertexAttributes, presentVertexAttributes), indexFormat);
+    map<SharedStorageKey_t, SharedBufferStorageOpenGL*>::iterator it = sharedStorages_.find(sharedStorageKey);
+    if (it != sharedStorages_.end()) {
+        return it->second;
+    }
+
+    // The ids start at 1 since 0 means that a buffer object has its own storage
+    SharedBufferStorageOpenGL* sharedStorage = new SharedBufferStorageOpenGL(sharedStorages_.size() + 1, vertexAttributes,
+                                                                             presentVertexAttributes, stride, indexFormat,
+                                                                             frameStats_, renderStateCache_);
+    sharedStorages_[sharedStorageKey] = sharedStorage;
+    return sharedStorage;
+}
+
+}
@@ -1,5 +1,10 @@
 #include "render/OpenGL/BufferObjectOpenGL.h"
 
+#include "render/FrameStats.h"
+#include "render/OpenGL/BufferObjectManagerOpenGL.h"
+#include "render/OpenGL/RenderStateCacheOpenGL.h"
+#include "render/OpenGL/SharedBufferStorageOpenGL.h"
+
 #include "math/Matrix4x4.h"
 #include "math/Vector2.h"
 #include "math/Vector3.h"
@@ -7,12 +12,118 @@
 
 namespace Sketch3D {
 
-BufferObjectOpenGL::BufferObjectOpenGL(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) : BufferObject(vertexAttributes, usage),
-        vao_(0), vbo_(0), ibo_(0), instanceBuffer_(0)
+void SetVertexAttributePointersOpenGL(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes, size_t stride) {
+    bool hasNormals = ((presentVertexAttributes & VERTEX_ATTRIBUTES_NORMAL) > 0);
+    bool hasTexCoords = ((presentVertexAttributes & VERTEX_ATTRIBUTES_TEX_COORDS) > 0);
+    bool hasTangents = ((presentVertexAttributes & VERTEX_ATTRIBUTES_TANGENT) > 0);
+    bool hasBones = ((presentVertexAttributes & VERTEX_ATTRIBUTES_BONES) > 0);
+    bool hasWeights = ((presentVertexAttributes & VERTEX_ATTRIBUTES_WEIGHTS) > 0);
+
+    // Calculate offset and array index depending on vertex attributes provided by the user
+    map<size_t, VertexAttributes_t> attributesFromIndex;
+    VertexAttributesMap_t::const_iterator it = vertexAttributes.begin();
+    for (; it != vertexAttributes.end(); ++it) {
+        attributesFromIndex[it->second] = it->first;
+    }
+
+    size_t cumulativeOffset = 0;
+    map<size_t, VertexAttributes_t>::iterator v_it = attributesFromIndex.begin();
+    for (; v_it != attributesFromIndex.end(); ++v_it) {
+        size_t size = 0;
+        size_t offset = 0;
+
+        switch (v_it->second) {
+            case VERTEX_ATTRIBUTES_POSITION:
+                size = 3;
+                offset = sizeof(Vector3);
+                break;
+
+            case VERTEX_ATTRIBUTES_NORMAL:
+                if (!hasNormals) {
+                    continue;
+                }
+
+                size = 3;
+                offset = sizeof(Vector3);
+                break;
+
+            case VERTEX_ATTRIBUTES_TEX_COORDS:
+                if (!hasTexCoords) {
+                    continue;
+                }
+
+                size = 2;
+                offset = sizeof(Vector2);
+                break;
+
+            case VERTEX_ATTRIBUTES_TANGENT:
+                if (!hasTangents) {
+                    continue;
+                }
+
+                size = 3;
+                offset = sizeof(Vector3);
+                break;
+
+            case VERTEX_ATTRIBUTES_BONES:
+                if (!hasBones) {
+                    continue;
+                }
+                
+                size = 4;
+                offset = sizeof(Vector4);
+                break;
+
+            case VERTEX_ATTRIBUTES_WEIGHTS:
+                if (!hasWeights) {
+                    continue;
+                }
+
+                size = 4;
+                offset = sizeof(Vector4);
+                break;
+        }
+
+        glEnableVertexAttribArray(v_it->first);
+        glVertexAttribPointer(v_it->first, size, GL_FLOAT, GL_FALSE, stride, (void*)cumulativeOffset);
+        cumulativeOffset += offset;
+    }
+}
+
+void SetInstanceAttributePointersOpenGL(const VertexAttributesMap_t& vertexAttributes) {
+    // The model matrix uses the 4 locations following the last vertex attribute
+    size_t attributeLocation = 0;
+    VertexAttributesMap_t::const_iterator it = vertexAttributes.begin();
+    for (; it != vertexAttributes.end(); ++it) {
+        if (it->second > attributeLocation) {
+            attributeLocation = it->second;
+        }
+    }
+    attributeLocation += 1;
+
+    for (size_t i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(attributeLocation + i);
+        glVertexAttribPointer(attributeLocation + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4x4), (const void*)(sizeof(GLfloat) * i * 4));
+        glVertexAttribDivisor(attributeLocation + i, 1);
+    }
+}
+
+GLenum GetIndexTypeOpenGL(IndexFormat_t format) {
+    return (format == INDEX_FORMAT_16) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+BufferObjectOpenGL::BufferObjectOpenGL(BufferObjectManagerOpenGL* manager, const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) :
+        BufferObject(vertexAttributes, usage), manager_(manager), frameStats_(manager->GetFrameStats()),
+        renderStateCache_(manager->GetRenderStateCache()), sharedStorage_(nullptr), vao_(0), vbo_(0), ibo_(0), instanceBuffer_(0)
 {
 }
 
 BufferObjectOpenGL::~BufferObjectOpenGL() {
+    renderStateCache_->OnVertexArrayDeleted(vao_);
+    renderStateCache_->OnBufferDeleted(vbo_);
+    renderStateCache_->OnBufferDeleted(ibo_);
+    renderStateCache_->OnBufferDeleted(instanceBuffer_);
+
     glDeleteVertexArrays(1, &vao_);
     glDeleteBuffers(1, &vbo_);
     glDeleteBuffers(1, &ibo_);
@@ -23,17 +134,45 @@ BufferObjectOpenGL::~BufferObjectOpenGL() {
 }
 
 void BufferObjectOpenGL::Render() {
-    glBindVertexArray(vao_);
-    glDrawElements(GL_TRIANGLES, indexCount_, GL_UNSIGNED_SHORT, 0);
+    if (sharedStorage_ != nullptr) {
+        sharedStorage_->Bind();
+        glDrawElementsBaseVertex(GL_TRIANGLES, indexCount_, GetIndexTypeOpenGL(indexFormat_),
+                                 (const void*)(firstIndex_ * GetIndexSize(indexFormat_)), baseVertex_);
+        return;
+    }
+
+    renderStateCache_->BindVertexArray(vao_);
+    glDrawElements(GL_TRIANGLES, indexCount_, GetIndexTypeOpenGL(indexFormat_), 0);
 }
 
 void BufferObjectOpenGL::RenderInstances(const vector<Matrix4x4>& modelMatrices) {
-    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+    if (sharedStorage_ != nullptr) {
+        sharedStorage_->SetInstances(modelMatrices);
+        sharedStorage_->Bind();
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, indexCount_, GetIndexTypeOpenGL(indexFormat_),
+                                          (const void*)(firstIndex_ * GetIndexSize(indexFormat_)), modelMatrices.size(), baseVertex_);
+        return;
+    }
+
+    renderStateCache_->BindArrayBuffer(instanceBuffer_);
     glBufferData(GL_ARRAY_BUFFER, sizeof(Matrix4x4) * modelMatrices.size(), &modelMatrices[0], GL_DYNAMIC_DRAW);
+    frameStats_->bufferBytesUploaded += sizeof(Matrix4x4) * modelMatrices.size();
 
-    glBindVertexArray(vao_);
+    renderStateCache_->BindVertexArray(vao_);
 
-    glDrawElementsInstanced(GL_TRIANGLES, indexCount_, GL_UNSIGNED_SHORT, 0, modelMatrices.size());
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount_, GetIndexTypeOpenGL(indexFormat_), 0, modelMatrices.size());
+}
+
+void BufferObjectOpenGL::RenderIndirect(const DrawIndirectCommand_t* commands, size_t numCommands, const vector<Matrix4x4>& modelMatrices) {
+    // Without shared storage, all the commands can only refer to this buffer object, one per model matrix, which is the
+    // same as drawing its instances
+    if (sharedStorage_ == nullptr) {
+        RenderInstances(modelMatrices);
+        return;
+    }
+
+    sharedStorage_->SetInstances(modelMatrices);
+    sharedStorage_->DrawIndirect(commands, numCommands);
 }
 
 BufferObjectError_t BufferObjectOpenGL::SetVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
@@ -50,12 +189,38 @@ BufferObjectError_t BufferObjectOpenGL::SetVertexData(const vector<float>& verte
                 ((hasBones) ? sizeof(Vector4) : 0) +
                 ((hasWeights) ? sizeof(Vector4) : 0);
 
-    if ( (vertexData.size() / (stride_ / sizeof(float))) > 65535) {
-        return BUFFER_OBJECT_ERROR_NOT_ENOUGH_SPACE;
-    } else if (!AreVertexAttributesValid(presentVertexAttributes)) {
+    if (!AreVertexAttributesValid(presentVertexAttributes)) {
         return BUFFER_OBJECT_ERROR_INVALID_VERTEX_ATTRIBUTES;
     }
 
+    size_t numVertices = vertexData.size() / (stride_ / sizeof(float));
+
+    // The static shared buffer objects are stored with the other ones having the same vertex layout, if supported. The
+    // index format of the storage is the narrowest one able to address all the vertices of the buffer object
+    if (usage_ == BUFFER_USAGE_STATIC_SHARED && sharedStorage_ == nullptr) {
+        sharedStorage_ = manager_->GetSharedStorage(vertexAttributes_, presentVertexAttributes, stride_,
+                                                    GetIndexFormatForVertices(numVertices));
+        if (sharedStorage_ != nullptr) {
+            sharedStorageId_ = sharedStorage_->GetId();
+            indexFormat_ = sharedStorage_->GetIndexFormat();
+        }
+    }
+
+    if (sharedStorage_ != nullptr) {
+        IndexFormat_t indexFormat = GetIndexFormatForVertices(numVertices);
+        if (indexFormat != indexFormat_) {
+            ChangeSharedStorage(indexFormat, presentVertexAttributes, false);
+        }
+
+        if (vertexData.size() != vertexCount_) {
+            baseVertex_ = sharedStorage_->AllocateVertices(numVertices);
+            vertexCount_ = vertexData.size();
+        }
+
+        sharedStorage_->SetVertices(baseVertex_, &vertexData[0], numVertices);
+        return BUFFER_OBJECT_ERROR_NONE;
+    }
+
     GenerateBuffers();
 
     // We want to allocate data for a new buffer if there's nothing in there or if the new data that we want to put in
@@ -64,110 +229,62 @@ BufferObjectError_t BufferObjectOpenGL::SetVertexData(const vector<float>& verte
         vertexCount_ = vertexData.size();
 
         // We first bind the vertex array object nad then bind the two other buffers
-        glBindVertexArray(vao_);
+        renderStateCache_->BindVertexArray(vao_);
 
         // Vertex buffer object
-        int type = (usage_ == BUFFER_USAGE_STATIC) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
-	    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+        int type = (usage_ != BUFFER_USAGE_DYNAMIC) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
+	    renderStateCache_->BindArrayBuffer(vbo_);
 	    glBufferData(GL_ARRAY_BUFFER, vertexCount_ * sizeof(float), &vertexData[0], type);
 
-        // Calculate offset and array index depending on vertex attributes provided by the user
-        map<size_t, VertexAttributes_t> attributesFromIndex;
-        VertexAttributesMap_t::iterator it = vertexAttributes_.begin();
-        for (; it != vertexAttributes_.end(); ++it) {
-            attributesFromIndex[it->second] = it->first;
-        }
-
-        size_t cumulativeOffset = 0;
-        map<size_t, VertexAttributes_t>::iterator v_it = attributesFromIndex.begin();
-        for (; v_it != attributesFromIndex.end(); ++v_it) {
-            size_t size = 0;
-            size_t offset = 0;
-
-            switch (v_it->second) {
-                case VERTEX_ATTRIBUTES_POSITION:
-                    size = 3;
-                    offset = sizeof(Vector3);
-                    break;
-
-                case VERTEX_ATTRIBUTES_NORMAL:
-                    if (!hasNormals) {
-                        continue;
-                    }
-
-                    size = 3;
-                    offset = sizeof(Vector3);
-                    break;
-
-                case VERTEX_ATTRIBUTES_TEX_COORDS:
-                    if (!hasTexCoords) {
-                        continue;
-                    }
-
-                    size = 2;
-                    offset = sizeof(Vector2);
-                    break;
-
-                case VERTEX_ATTRIBUTES_TANGENT:
-                    if (!hasTangents) {
-                        continue;
-                    }
-
-                    size = 3;
-                    offset = sizeof(Vector3);
-                    break;
-
-                case VERTEX_ATTRIBUTES_BONES:
-                    if (!hasBones) {
-                        continue;
-                    }
-                    
-                    size = 4;
-                    offset = sizeof(Vector4);
-                    break;
-
-                case VERTEX_ATTRIBUTES_WEIGHTS:
-                    if (!hasWeights) {
-                        continue;
-                    }
-
-                    size = 4;
-                    offset = sizeof(Vector4);
-                    break;
-            }
-
-            glEnableVertexAttribArray(v_it->first);
-            glVertexAttribPointer(v_it->first, size, GL_FLOAT, GL_FALSE, stride_, (void*)cumulativeOffset);
-            cumulativeOffset += offset;
-        }
+        SetVertexAttributePointersOpenGL(vertexAttributes_, presentVertexAttributes, stride_);
     }
 
     // Otherwise, we want to simple change the data without reallocating everything
     else {
-	    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+	    renderStateCache_->BindArrayBuffer(vbo_);
         glBufferSubData(GL_ARRAY_BUFFER, 0, vertexData.size() * sizeof(float), &vertexData[0]);
     }
 
+    frameStats_->bufferBytesUploaded += vertexData.size() * sizeof(float);
+
     return BUFFER_OBJECT_ERROR_NONE;
 }
 
 BufferObjectError_t BufferObjectOpenGL::AppendVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
     if (vertexCount_ == 0) {
         return SetVertexData(vertexData, presentVertexAttributes);
-    } else if ( ((vertexCount_ + vertexData.size()) / (stride_ / sizeof(float))) > 65535) {
-        return BUFFER_OBJECT_ERROR_NOT_ENOUGH_SPACE;
     }
 
     if (!AreVertexAttributesValid(presentVertexAttributes)) {
         return BUFFER_OBJECT_ERROR_INVALID_VERTEX_ATTRIBUTES;
     }
 
+    // In a shared storage, the vertices are moved at the end of the buffer, followed by the new ones
+    if (sharedStorage_ != nullptr) {
+        size_t floatsPerVertex = stride_ / sizeof(float);
+        size_t numVertices = vertexCount_ / floatsPerVertex;
+        size_t numNewVertices = vertexData.size() / floatsPerVertex;
+
+        IndexFormat_t indexFormat = GetIndexFormatForVertices(numVertices + numNewVertices);
+        if (indexFormat != indexFormat_) {
+            ChangeSharedStorage(indexFormat, presentVertexAttributes, true);
+        }
+
+        size_t baseVertex = sharedStorage_->AllocateVertices(numVertices + numNewVertices);
+        sharedStorage_->CopyVertices(baseVertex_, baseVertex, numVertices);
+        sharedStorage_->SetVertices(baseVertex + numVertices, &vertexData[0], numNewVertices);
+
+        baseVertex_ = baseVertex;
+        vertexCount_ += vertexData.size();
+        return BUFFER_OBJECT_ERROR_NONE;
+    }
+
     // We have to copy the buffer that we have, reallocate the space for it, append the data and copy back the new array
     size_t newSize = vertexCount_ + vertexData.size();
     vector<float> newVertexData;
     newVertexData.resize(newSize);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    renderStateCache_->BindArrayBuffer(vbo_);
     glGetBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount_ * sizeof(float), &newVertexData[0]);
 
     size_t idx = 0;
@@ -176,75 +293,112 @@ BufferObjectError_t BufferObjectOpenGL::AppendVertexData(const vector<float>& ve
     }
 
     vertexCount_ = newSize;
-    int type = (usage_ == BUFFER_USAGE_STATIC) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
+    int type = (usage_ != BUFFER_USAGE_DYNAMIC) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
     glBufferData(GL_ARRAY_BUFFER, vertexCount_ * sizeof(float), &newVertexData[0], type);
+    frameStats_->bufferBytesUploaded += vertexCount_ * sizeof(float);
 
     return BUFFER_OBJECT_ERROR_NONE;
 }
 
-BufferObjectError_t BufferObjectOpenGL::SetIndexData(unsigned short* indexData, size_t numIndex) {
+BufferObjectError_t BufferObjectOpenGL::SetIndexData(unsigned int* indexData, size_t numIndex) {
+    if (sharedStorage_ != nullptr) {
+        if (numIndex != indexCount_) {
+            firstIndex_ = sharedStorage_->AllocateIndices(numIndex);
+            indexCount_ = numIndex;
+        }
+
+        sharedStorage_->SetIndices(firstIndex_, indexData, numIndex);
+        return BUFFER_OBJECT_ERROR_NONE;
+    }
+
     GenerateBuffers();
 
     indexCount_ = numIndex;
+    indexFormat_ = GetIndexFormatForIndices(indexData, numIndex);
+
+    vector<unsigned short> shortIndices;
+    const void* data = ConvertIndices(indexData, numIndex, indexFormat_, shortIndices);
 
-    glBindVertexArray(vao_);
+    renderStateCache_->BindVertexArray(vao_);
 
     // Index buffer object
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount_ * sizeof(unsigned short), indexData, GL_STATIC_DRAW);
+	renderStateCache_->BindElementArrayBuffer(ibo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount_ * GetIndexSize(indexFormat_), data, GL_STATIC_DRAW);
+    frameStats_->bufferBytesUploaded += indexCount_ * GetIndexSize(indexFormat_);
 
     return BUFFER_OBJECT_ERROR_NONE;
 }
 
-BufferObjectError_t BufferObjectOpenGL::AppendIndexData(unsigned short* indexData, size_t numIndex) {
+BufferObjectError_t BufferObjectOpenGL::AppendIndexData(unsigned int* indexData, size_t numIndex) {
     if (indexCount_ == 0) {
         return SetIndexData(indexData, numIndex);
     }
 
+    // In a shared storage, the indices are moved at the end of the buffer, followed by the new ones
+    if (sharedStorage_ != nullptr) {
+        size_t firstIndex = sharedStorage_->AllocateIndices(indexCount_ + numIndex);
+        sharedStorage_->CopyIndices(firstIndex_, firstIndex, indexCount_);
+        sharedStorage_->SetIndices(firstIndex + indexCount_, indexData, numIndex);
+
+        firstIndex_ = firstIndex;
+        indexCount_ += numIndex;
+        return BUFFER_OBJECT_ERROR_NONE;
+    }
+
     // We have to copy the buffer that we have, reallocate the space for it, append the data and copy back the new array
     size_t newSize = indexCount_ + numIndex;
     vector<unsigned int> newIndexData;
     newIndexData.resize(newSize);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
-    glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount_ * sizeof(unsigned short), &newIndexData[0]);
+    // The index buffer binding is part of the vertex array object
+    renderStateCache_->BindVertexArray(vao_);
+    renderStateCache_->BindElementArrayBuffer(ibo_);
+
+    vector<unsigned short> shortIndices;
+    if (indexFormat_ == INDEX_FORMAT_16) {
+        shortIndices.resize(indexCount_);
+        glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount_ * sizeof(unsigned short), &shortIndices[0]);
+        for (size_t i = 0; i < indexCount_; i++) {
+            newIndexData[i] = shortIndices[i];
+        }
+    } else {
+        glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount_ * sizeof(unsigned int), &newIndexData[0]);
+    }
 
     size_t idx = 0;
     for (size_t i = indexCount_; i < newSize; i++) {
         newIndexData[i] = indexData[idx++];
     }
 
+    // The indices are widened if the new ones don't fit in the current format
+    if (indexFormat_ == INDEX_FORMAT_16) {
+        indexFormat_ = GetIndexFormatForIndices(indexData, numIndex);
+    }
+
     indexCount_ = newSize;
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount_ * sizeof(unsigned short), &newIndexData[0], GL_STATIC_DRAW);
+    const void* data = ConvertIndices(&newIndexData[0], indexCount_, indexFormat_, shortIndices);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount_ * GetIndexSize(indexFormat_), data, GL_STATIC_DRAW);
+    frameStats_->bufferBytesUploaded += indexCount_ * GetIndexSize(indexFormat_);
     
     return BUFFER_OBJECT_ERROR_NONE;
 }
 
 void BufferObjectOpenGL::PrepareInstanceBuffers() {
+    if (sharedStorage_ != nullptr) {
+        sharedStorage_->PrepareInstanceBuffers();
+        return;
+    }
+
     if (instanceBuffer_ != 0) {
         return;
     }
 
     glGenBuffers(1, &instanceBuffer_);
 
-    glBindVertexArray(vao_);
-    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+    renderStateCache_->BindVertexArray(vao_);
+    renderStateCache_->BindArrayBuffer(instanceBuffer_);
 
-    // Populate the buffer with the model matrices
-    size_t attributeLocation = 0;
-    VertexAttributesMap_t::iterator it = vertexAttributes_.begin();
-    for (; it != vertexAttributes_.end(); ++it) {
-        if (it->second > attributeLocation) {
-            attributeLocation = it->second;
-        }
-    }
-    attributeLocation += 1;
-
-    for (size_t i = 0; i < 4; i++) {
-        glEnableVertexAttribArray(attributeLocation + i);
-        glVertexAttribPointer(attributeLocation + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4x4), (const void*)(sizeof(GLfloat) * i * 4));
-        glVertexAttribDivisor(attributeLocation + i, 1);
-    }
+    SetInstanceAttributePointersOpenGL(vertexAttributes_);
 }
 
 void BufferObjectOpenGL::GenerateBuffers() {
@@ -261,4 +415,33 @@ void BufferObjectOpenGL::GenerateBuffers() {
     }
 }
 
+void BufferObjectOpenGL::ChangeSharedStorage(IndexFormat_t indexFormat, int presentVertexAttributes, bool moveVertices) {
+    SharedBufferStorageOpenGL* sharedStorage = manager_->GetSharedStorage(vertexAttributes_, presentVertexAttributes, stride_, indexFormat);
+
+    // The indices are relative to the first vertex of the buffer object, so they don't change
+    if (indexCount_ > 0) {
+        vector<unsigned int> indexData(indexCount_);
+        sharedStorage_->GetIndices(firstIndex_, indexCount_, &indexData[0]);
+
+        firstIndex_ = sharedStorage->AllocateIndices(indexCount_);
+        sharedStorage->SetIndices(firstIndex_, &indexData[0], indexCount_);
+    }
+
+    size_t numVertices = vertexCount_ / (stride_ / sizeof(float));
+    if (moveVertices && numVertices > 0) {
+        vector<float> vertexData(vertexCount_);
+        sharedStorage_->GetVertices(baseVertex_, numVertices, &vertexData[0]);
+
+        baseVertex_ = sharedStorage->AllocateVertices(numVertices);
+        sharedStorage->SetVertices(baseVertex_, &vertexData[0], numVertices);
+    } else {
+        // Forces the allocation of the vertices in the new storage
+        vertexCount_ = 0;
+    }
+
+    sharedStorage_ = sharedStorage;
+    sharedStorageId_ = sharedStorage_->GetId();
+    indexFormat_ = indexFormat;
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "render/OpenGL/ProgramBinaryCacheOpenGL.h"
+
+#include "system/Logger.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace Sketch3D {
+
+/**
+ * @struct ProgramBinaryHeader_t
+ * Header written before the binary of a program, used to validate the file when it is loaded
+ */
+struct ProgramBinaryHeader_t {
+    uint32_t    magic;      /**< PROGRAM_BINARY_MAGIC */
+    uint32_t    format;     /**< Format of the binary, as returned by glGetProgramBinary */
+    uint64_t    key;        /**< Key of the program */
+    uint32_t    length;     /**< Length of the binary in bytes */
+};
+
+const uint32_t PROGRAM_BINARY_MAGIC = 0x53334450;   // "S3DP"
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+/**
+ * Hash a string with the 64 bits FNV-1a hash
+ */
+static uint64_t HashString(const char* str, size_t length, uint64_t hash) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+ProgramBinaryCacheOpenGL::ProgramBinaryCacheOpenGL() : driverHash_(0) {
+}
+
+void ProgramBinaryCacheOpenGL::SetDirectory(const string& directory) {
+    directory_ = directory;
+}
+
+bool ProgramBinaryCacheOpenGL::IsEnabled() const {
+    if (directory_.empty() || !GLEW_ARB_get_program_binary) {
+        return false;
+    }
+
+    GLint numBinaryFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+    return numBinaryFormats > 0;
+}
+
+uint64_t ProgramBinaryCacheOpenGL::ComputeKey(const string& vertexSource, const string& fragmentSource) const {
+    if (driverHash_ == 0) {
+        const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        driverHash_ = FNV_OFFSET_BASIS;
+        for (size_t i = 0; i < 3; i++) {
+            const char* driverString = (const char*)glGetString(driverStrings[i]);
+            if (driverString != nullptr) {
+                driverHash_ = HashString(driverString, strlen(driverString), driverHash_);
+            }
+        }
+    }
+
+    // The length of the vertex source separates the two sources, so that moving code between them changes the key
+    uint32_t vertexLength = (uint32_t)vertexSource.size();
+    uint64_t key = HashString((const char*)&vertexLength, sizeof(vertexLength), driverHash_);
+    key = HashString(vertexSource.c_str(), vertexSource.size(), key);
+    return HashString(fragmentSource.c_str(), fragmentSource.size(), key);
+}
+
+bool ProgramBinaryCacheOpenGL::LoadProgram(GLuint program, uint64_t key) const {
+    FILE* fp = fopen(GetFilename(key).c_str(), "rb");
+    if (fp == nullptr) {
+        return false;
+    }
+
+    ProgramBinaryHeader_t header;
+    vector<char> binary;
+    bool valid = fread(&header, sizeof(header), 1, fp) == 1 && header.magic == PROGRAM_BINARY_MAGIC && header.key == key &&
+                 header.length > 0;
+    if (valid) {
+        binary.resize(header.length);
+        valid = fread(&binary[0], 1, header.length, fp) == header.length;
+    }
+    fclose(fp);
+
+    if (!valid) {
+        Logger::GetInstance()->Warning("Invalid program binary " + GetFilename(key));
+        return false;
+    }
+
+    // The driver refuses the binaries it can't use anymore, after an update for instance
+    glProgramBinary(program, header.format, &binary[0], header.length);
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    return linkStatus == GL_TRUE;
+}
+
+void ProgramBinaryCacheOpenGL::SaveProgram(GLuint program, uint64_t key) const {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    ProgramBinaryHeader_t header;
+    vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, &binary[0]);
+
+    header.magic = PROGRAM_BINARY_MAGIC;
+    header.format = format;
+    header.key = key;
+    header.length = (uint32_t)length;
+
+    FILE* fp = fopen(GetFilename(key).c_str(), "wb");
+    if (fp == nullptr) {
+        Logger::GetInstance()->Warning("Couldn't write program binary " + GetFilename(key));
+        return;
+    }
+
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(&binary[0], 1, length, fp);
+    fclose(fp);
+}
+
+string ProgramBinaryCacheOpenGL::GetFilename(uint64_t key) const {
+    char filename[32];
+    sprintf(filename, "%016llx.bin", (unsigned long long)key);
+    return directory_ + "/" + filename;
+}
+
+}
@@ -1,10 +1,17 @@
 #include "render/OpenGL/RenderStateCacheOpenGL.h"
 
+#include "render/FrameStats.h"
+
 #include "render/OpenGL/gl/glew.h"
 #include "render/OpenGL/gl/gl.h"
 
 namespace Sketch3D {
-RenderStateCacheOpenGL::RenderStateCacheOpenGL() {
+RenderStateCacheOpenGL::RenderStateCacheOpenGL(FrameStats_t* frameStats) : RenderStateCache(frameStats), vertexArray_(0),
+        arrayBuffer_(0), elementArrayBuffer_(0), activeTextureUnit_(0), drawFramebuffer_(0), readFramebuffer_(0)
+{
+    viewport_[0] = viewport_[1] = 0;
+    viewport_[2] = viewport_[3] = -1;
+
     EnableDepthTestImpl();
     EnableDepthWriteImpl();
     EnableColorWriteImpl();
@@ -20,8 +27,106 @@ RenderStateCacheOpenGL::~RenderStateCacheOpenGL() {
 
 }
 
+void RenderStateCacheOpenGL::BindVertexArray(GLuint vertexArray) {
+    if (vertexArray_ != vertexArray) {
+        glBindVertexArray(vertexArray);
+        vertexArray_ = vertexArray;
+        frameStats_->stateChanges++;
+
+        // The index buffer binding comes from the vertex array object
+        elementArrayBuffer_ = UNKNOWN_BINDING;
+    }
+}
+
+void RenderStateCacheOpenGL::BindArrayBuffer(GLuint buffer) {
+    if (arrayBuffer_ != buffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        arrayBuffer_ = buffer;
+        frameStats_->stateChanges++;
+    }
+}
+
+void RenderStateCacheOpenGL::BindElementArrayBuffer(GLuint buffer) {
+    if (elementArrayBuffer_ != buffer) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+        elementArrayBuffer_ = buffer;
+        frameStats_->stateChanges++;
+    }
+}
+
+void RenderStateCacheOpenGL::SetActiveTextureUnit(GLuint unit) {
+    if (activeTextureUnit_ != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeTextureUnit_ = unit;
+        frameStats_->stateChanges++;
+    }
+}
+
+void RenderStateCacheOpenGL::BindFramebuffer(GLenum target, GLuint framebuffer) {
+    bool bindDraw = (target != GL_READ_FRAMEBUFFER && drawFramebuffer_ != framebuffer);
+    bool bindRead = (target != GL_DRAW_FRAMEBUFFER && readFramebuffer_ != framebuffer);
+
+    if (bindDraw && bindRead) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    } else if (bindDraw) {
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    } else if (bindRead) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    } else {
+        return;
+    }
+
+    if (bindDraw) {
+        drawFramebuffer_ = framebuffer;
+    }
+
+    if (bindRead) {
+        readFramebuffer_ = framebuffer;
+    }
+
+    frameStats_->stateChanges++;
+}
+
+void RenderStateCacheOpenGL::SetViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (viewport_[0] != x || viewport_[1] != y || viewport_[2] != width || viewport_[3] != height) {
+        glViewport(x, y, width, height);
+        viewport_[0] = x;
+        viewport_[1] = y;
+        viewport_[2] = width;
+        viewport_[3] = height;
+        frameStats_->stateChanges++;
+    }
+}
+
+void RenderStateCacheOpenGL::OnVertexArrayDeleted(GLuint vertexArray) {
+    if (vertexArray_ == vertexArray) {
+        vertexArray_ = 0;
+        elementArrayBuffer_ = UNKNOWN_BINDING;
+    }
+}
+
+void RenderStateCacheOpenGL::OnBufferDeleted(GLuint buffer) {
+    if (arrayBuffer_ == buffer) {
+        arrayBuffer_ = 0;
+    }
+
+    if (elementArrayBuffer_ == buffer) {
+        elementArrayBuffer_ = 0;
+    }
+}
+
+void RenderStateCacheOpenGL::OnFramebufferDeleted(GLuint framebuffer) {
+    if (drawFramebuffer_ == framebuffer) {
+        drawFramebuffer_ = 0;
+    }
+
+    if (readFramebuffer_ == framebuffer) {
+        readFramebuffer_ = 0;
+    }
+}
+
 void RenderStateCacheOpenGL::EnableDepthTestImpl() {
-    if (isDepthTestEnabled_) {
+    if (appliedRenderState_.depthTest) {
         glEnable(GL_DEPTH_TEST);
     } else {
         glDisable(GL_DEPTH_TEST);
@@ -29,11 +134,11 @@ void RenderStateCacheOpenGL::EnableDepthTestImpl() {
 }
 
 void RenderStateCacheOpenGL::EnableDepthWriteImpl() {
-    glDepthMask( (isDepthWriteEnabled_) ? GL_TRUE : GL_FALSE );
+    glDepthMask( (appliedRenderState_.depthWrite) ? GL_TRUE : GL_FALSE );
 }
 
 void RenderStateCacheOpenGL::EnableColorWriteImpl() {
-    if (isColorWriteEnabled_) {
+    if (appliedRenderState_.colorWrite) {
         glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     } else {
         glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
@@ -41,7 +146,7 @@ void RenderStateCacheOpenGL::EnableColorWriteImpl() {
 }
 
 void RenderStateCacheOpenGL::EnableBlendingImpl() {
-    if (isBlendingEnabled_) {
+    if (appliedRenderState_.blending) {
         glEnable(GL_BLEND);
     } else {
         glDisable(GL_BLEND);
@@ -50,7 +155,7 @@ void RenderStateCacheOpenGL::EnableBlendingImpl() {
 
 void RenderStateCacheOpenGL::SetDepthComparisonFuncImpl() {
     GLenum depthFunc;
-    switch (depthComparisonFunction_) {
+    switch (appliedRenderState_.depthFunc) {
         case DEPTH_FUNC_NEVER:
             depthFunc = GL_NEVER;
             break;
@@ -81,7 +186,7 @@ void RenderStateCacheOpenGL::SetDepthComparisonFuncImpl() {
 }
 
 void RenderStateCacheOpenGL::SetCullingMethodImpl() {
-    switch (cullingMethod_) {
+    switch (appliedRenderState_.cullingMethod) {
         case CULLING_METHOD_FRONT_FACE:
             glCullFace(GL_FRONT);
             break;
@@ -93,7 +198,7 @@ void RenderStateCacheOpenGL::SetCullingMethodImpl() {
 
 void RenderStateCacheOpenGL::SetBlendingEquationImpl() {
     GLenum blendingEquation;
-    switch (blendingEquation_) {
+    switch (appliedRenderState_.blendingEquation) {
         case BLENDING_EQUATION_ADD:
             blendingEquation = GL_FUNC_ADD;
             break;
@@ -115,11 +220,11 @@ void RenderStateCacheOpenGL::SetBlendingEquationImpl() {
 }
 
 void RenderStateCacheOpenGL::SetBlendingFactorImpl() {
-    glBlendFunc(GetBlendingFactor(sourceBlendingFactor_), GetBlendingFactor(destinationBlendingFactor_));
+    glBlendFunc(GetBlendingFactor(appliedRenderState_.sourceBlendingFactor), GetBlendingFactor(appliedRenderState_.destinationBlendingFactor));
 }
 
 void RenderStateCacheOpenGL::SetRenderFillModeImpl() {
-    switch (renderMode_) {
+    switch (appliedRenderState_.renderMode) {
         case RENDER_MODE_FILL:
             glPolygonMode(GL_FRONT, GL_FILL);
             break;
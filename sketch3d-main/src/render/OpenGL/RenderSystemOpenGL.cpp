@@ -5,6 +5,7 @@
 
 #include "render/OpenGL/BufferObjectManagerOpenGL.h"
 #include "render/OpenGL/BufferObjectOpenGL.h"
+#include "render/OpenGL/ProgramBinaryCacheOpenGL.h"
 #include "render/OpenGL/RenderStateCacheOpenGL.h"
 #include "render/OpenGL/RenderTextureOpenGL.h"
 #include "render/OpenGL/ShaderOpenGL.h"
@@ -14,6 +15,8 @@
 #include "system/Logger.h"
 #include "system/Window.h"
 
+#include <string.h>
+
 #if PLATFORM == PLATFORM_WIN32
 #include "render/OpenGL/Win32/RenderContextOpenGLWin32.h"
 #elif PLATFORM == PLATFORM_LINUX
@@ -22,21 +25,25 @@
 
 namespace Sketch3D {
 
-RenderSystemOpenGL::RenderSystemOpenGL(Window& window) : RenderSystem(window), renderContext_(NULL) {
+typedef void (APIENTRY *MaxShaderCompilerThreadsFunc_t)(GLuint count);
+
+RenderSystemOpenGL::RenderSystemOpenGL(Window& window) : RenderSystem(window), renderContext_(NULL),
+        renderStateCacheOpenGL_(nullptr), leastRecentlyUsedUnit_(NO_TEXTURE_UNIT), mostRecentlyUsedUnit_(NO_TEXTURE_UNIT),
+        cameraUniformBuffer_(0), programCache_(new ProgramBinaryCacheOpenGL), deferShaderLinks_(false),
+        maxShaderCompilerThreads_(nullptr)
+{
+    memset(samplers_, 0, sizeof(samplers_));
 	Logger::GetInstance()->Info("Current rendering API: OpenGL");
 }
 
 RenderSystemOpenGL::~RenderSystemOpenGL() {
-    TextureUnitNode_t* node = head_;
-    TextureUnitNode_t* toDelete = nullptr;
-    while (node != nullptr) {
-        toDelete = node;
-        node = node->next;
-        delete toDelete;
-    }
-
 	Logger::GetInstance()->Info("Shutdown OpenGL");
+    glDeleteBuffers(1, &cameraUniformBuffer_);
+    if (samplers_[0] != 0) {
+        glDeleteSamplers(NUM_SAMPLERS, samplers_);
+    }
     FreeRenderSystem();
+    delete programCache_;
 	delete renderContext_;
 }
 
@@ -49,7 +56,7 @@ bool RenderSystemOpenGL::Initialize(const RenderParameters_t& renderParameters)
     renderContext_ = new RenderContextOpenGLUnix();
 #endif
 
-    if (!renderContext_->Initialize(window_, renderParameters)) {
+    if (!renderContext_->Initialize(*window_, renderParameters)) {
 		Logger::GetInstance()->Error("Couldn't create OpenGL context");
 		return false;
 	}
@@ -59,22 +66,30 @@ bool RenderSystemOpenGL::Initialize(const RenderParameters_t& renderParameters)
     glEnable(GL_CULL_FACE);
     glEnable(GL_TEXTURE_2D);
 
-    bufferObjectManager_ = new BufferObjectManagerOpenGL;
-    renderStateCache_ = new RenderStateCacheOpenGL;
+    renderStateCacheOpenGL_ = new RenderStateCacheOpenGL(&frameStats_);
+    renderStateCache_ = renderStateCacheOpenGL_;
+    bufferObjectManager_ = new BufferObjectManagerOpenGL(deviceCapabilities_.supportsIndirectDraws_, &frameStats_,
+                                                         renderStateCacheOpenGL_);
+
+    // Construct the texture unit cache, ordering the units from the first one to the last one
+    uint32_t numTextureUnits = (uint32_t)deviceCapabilities_.maxActiveTextures_;
+    textureUnits_.resize(numTextureUnits);
+    for (uint32_t i = 0; i < numTextureUnits; i++) {
+        textureUnits_[i].generation = 0;
+        textureUnits_[i].sampler = 0;
+        textureUnits_[i].prev = (i > 0) ? i - 1 : NO_TEXTURE_UNIT;
+        textureUnits_[i].next = (i + 1 < numTextureUnits) ? i + 1 : NO_TEXTURE_UNIT;
+    }
+    leastRecentlyUsedUnit_ = 0;
+    mostRecentlyUsedUnit_ = numTextureUnits - 1;
 
-    // Construct the texture cache
-    head_ = new TextureUnitNode_t;
-    head_->textureUnit = 0;
-    head_->prev = nullptr;
-    tail_ = head_;
+    CreateSamplers();
 
-    for (int i = 1; i < deviceCapabilities_.maxActiveTextures_ + 1; i++) {
-        tail_->next = new TextureUnitNode_t;
-        tail_->next->prev = tail_;
-        tail_ = tail_->next;
-        tail_->textureUnit = i;
-    }
-    tail_->next = nullptr;
+    // Create the buffer of the camera uniform block, shared by all the shaders
+    glGenBuffers(1, &cameraUniformBuffer_);
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUniformBuffer_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraUniforms_t), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
     CreateTextShader();
 
@@ -99,6 +114,7 @@ void RenderSystemOpenGL::Clear(int buffer) const {
 }
 
 void RenderSystemOpenGL::StartRender() {
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BLOCK_BINDING, cameraUniformBuffer_);
 }
 
 void RenderSystemOpenGL::EndRender() {
@@ -147,11 +163,11 @@ Matrix4x4 RenderSystemOpenGL::PerspectiveProjection(float left, float right, flo
 }
 
 void RenderSystemOpenGL::SetViewport(size_t x, size_t y, size_t width, size_t height) {
-    glViewport(x, y, width, height);
+    renderStateCacheOpenGL_->SetViewport(x, y, width, height);
 }
 
 Shader* RenderSystemOpenGL::CreateShader() {
-    shaders_.push_back(new ShaderOpenGL);
+    shaders_.push_back(new ShaderOpenGL(&frameStats_, programCache_, deferShaderLinks_));
     return shaders_[shaders_.size() - 1];
 }
 
@@ -164,76 +180,142 @@ Texture3D* RenderSystemOpenGL::CreateTexture3D() const {
 }
 
 RenderTexture* RenderSystemOpenGL::CreateRenderTexture(unsigned int width, unsigned int height, TextureFormat_t format) {
-    renderTextures_.push_back(new RenderTextureOpenGL(width, height, format));
+    renderTextures_.push_back(new RenderTextureOpenGL(width, height, format, renderStateCacheOpenGL_));
     return renderTextures_.back();
 }
 
 void RenderSystemOpenGL::BindScreenBuffer() const {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    renderStateCacheOpenGL_->BindFramebuffer(GL_FRAMEBUFFER, 0);
     Renderer::GetInstance()->SetViewport(0, 0, width_, height_);
 }
 
 size_t RenderSystemOpenGL::BindTexture(const Texture* texture) {
-    size_t textureName;
-    GLint textureType;
-    if (texture->GetType() == TEXTURE_TYPE_2D) {
-        textureName = static_cast<const Texture2DOpenGL*>(texture)->textureName_;
-        textureType = GL_TEXTURE_2D;
-    } else {
-        textureName = static_cast<const Texture3DOpenGL*>(texture)->textureName_;
-        textureType = GL_TEXTURE_3D;
+    uint32_t id = texture->GetId();
+    if (id >= textureSlots_.size()) {
+        TextureUnitSlot_t unboundSlot = { NO_TEXTURE_UNIT, 0 };
+        textureSlots_.resize(id + 1, unboundSlot);
     }
 
-    // Verify if the node is already bound
-    size_t textureUnit = 0;
-    TextureUnitNode_t* nodeToUse = head_;
-    TextureCache_t::iterator it = textureCache_.find(textureName);
+    // The texture is still bound if no other texture replaced it on its unit since then
+    TextureUnitSlot_t& slot = textureSlots_[id];
+    uint32_t textureUnit = slot.unit;
+    if (textureUnit == NO_TEXTURE_UNIT || textureUnits_[textureUnit].generation != slot.generation) {
+        GLuint textureName;
+        GLenum textureType;
+        if (texture->GetType() == TEXTURE_TYPE_2D) {
+            textureName = static_cast<const Texture2DOpenGL*>(texture)->textureName_;
+            textureType = GL_TEXTURE_2D;
+        } else {
+            textureName = static_cast<const Texture3DOpenGL*>(texture)->textureName_;
+            textureType = GL_TEXTURE_3D;
+        }
 
-    if (it != textureCache_.end()) {
-        nodeToUse = it->second;
-    } else {
-        glActiveTexture(GL_TEXTURE0 + nodeToUse->textureUnit);
+        textureUnit = leastRecentlyUsedUnit_;
+        renderStateCacheOpenGL_->SetActiveTextureUnit(textureUnit);
         glBindTexture(textureType, textureName);
+        frameStats_.textureBinds++;
 
-        textureCache_[textureName] = nodeToUse;
+        slot.unit = textureUnit;
+        slot.generation = ++textureUnits_[textureUnit].generation;
+    } else {
+        // Keep the unit of the texture active so that its parameters can be changed right after binding it
+        renderStateCacheOpenGL_->SetActiveTextureUnit(textureUnit);
     }
-    textureUnit = nodeToUse->textureUnit;
 
-    // Put the node to use at the end of the list if it isn't there yet
-    if (tail_ != nodeToUse) {
-        tail_->next = nodeToUse;
+    GLuint sampler = GetSampler(texture);
+    if (textureUnits_[textureUnit].sampler != sampler) {
+        glBindSampler(textureUnit, sampler);
+        textureUnits_[textureUnit].sampler = sampler;
+    }
 
-        // Remove that node from the list since its now a duplicate
-        if (nodeToUse->prev) {
-            nodeToUse->prev->next = nodeToUse->next;
-        }
+    TouchTextureUnit(textureUnit);
+
+    return textureUnit;
+}
+
+void RenderSystemOpenGL::CreateSamplers() {
+    if (!GLEW_ARB_sampler_objects) {
+        Logger::GetInstance()->Info("Sampler objects not supported, the textures keep their own sampling state");
+        return;
+    }
+
+    static const GLint wrapModes[] = { GL_CLAMP, GL_REPEAT, GL_CLAMP_TO_BORDER };
+
+    glGenSamplers(NUM_SAMPLERS, samplers_);
+    for (size_t i = 0; i < NUM_SAMPLERS; i++) {
+        // The index is laid out like in GetSampler
+        bool depthComparison = (i % 2) == 1;
+        bool mipmaps = (i / 2) % 2 == 1;
+        GLint wrap = wrapModes[(i / 4) % 3];
+        bool linear = (i / 12) == FILTER_MODE_LINEAR;
 
-        if (nodeToUse->next) {
-            nodeToUse->next->prev = nodeToUse->prev;
+        // Same filters as the ones set on the textures
+        GLint minFilter;
+        if (mipmaps) {
+            minFilter = (linear) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST;
+        } else {
+            minFilter = (linear) ? GL_LINEAR : GL_NEAREST;
         }
 
-        // Advance head if needed
-        if (nodeToUse == head_) {
-            head_ = head_->next;
+        glSamplerParameteri(samplers_[i], GL_TEXTURE_MIN_FILTER, minFilter);
+        glSamplerParameteri(samplers_[i], GL_TEXTURE_MAG_FILTER, (linear) ? GL_LINEAR : GL_NEAREST);
+        glSamplerParameteri(samplers_[i], GL_TEXTURE_WRAP_S, wrap);
+        glSamplerParameteri(samplers_[i], GL_TEXTURE_WRAP_T, wrap);
+        glSamplerParameteri(samplers_[i], GL_TEXTURE_WRAP_R, wrap);
+
+        if (depthComparison) {
+            glSamplerParameteri(samplers_[i], GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glSamplerParameteri(samplers_[i], GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
         }
+    }
+}
+
+GLuint RenderSystemOpenGL::GetSampler(const Texture* texture) const {
+    size_t filter = (texture->GetFilterMode() == FILTER_MODE_LINEAR) ? 1 : 0;
+    size_t wrap = (size_t)texture->GetWrapMode();
+    size_t mipmaps = (texture->GetGenerateMipmaps()) ? 1 : 0;
+    size_t depthComparison = (texture->GetType() == TEXTURE_TYPE_2D &&
+                              texture->GetTextureFormat() == TEXTURE_FORMAT_DEPTH) ? 1 : 0;
+
+    return samplers_[((filter * 3 + wrap) * 2 + mipmaps) * 2 + depthComparison];
+}
 
-        tail_->next->prev = tail_;
-        tail_ = tail_->next;
-        tail_->next = nullptr;
+void RenderSystemOpenGL::TouchTextureUnit(uint32_t unit) {
+    if (unit == mostRecentlyUsedUnit_) {
+        return;
     }
 
-    return textureUnit;
+    // Unlink the unit. It isn't the tail, so it has a next unit
+    TextureUnit_t& textureUnit = textureUnits_[unit];
+    if (textureUnit.prev != NO_TEXTURE_UNIT) {
+        textureUnits_[textureUnit.prev].next = textureUnit.next;
+    } else {
+        leastRecentlyUsedUnit_ = textureUnit.next;
+    }
+    textureUnits_[textureUnit.next].prev = textureUnit.prev;
+
+    // Append it at the end of the list
+    textureUnit.prev = mostRecentlyUsedUnit_;
+    textureUnit.next = NO_TEXTURE_UNIT;
+    textureUnits_[mostRecentlyUsedUnit_].next = unit;
+    mostRecentlyUsedUnit_ = unit;
 }
 
 void RenderSystemOpenGL::BindShader(const Shader* shader) {
+    // The bound shader might have been linked again since it was bound, which also has to be waited for
+    if (shader != nullptr && shader->IsLinkPending()) {
+        const_cast<ShaderOpenGL*>(static_cast<const ShaderOpenGL*>(shader))->FinishLink();
+    }
+
     if (shader != boundShader_) {
         if (shader == nullptr) {
             glUseProgram(0);
         } else {
-            const ShaderOpenGL* shaderOpengl = static_cast<const ShaderOpenGL*>(shader);
-            glUseProgram(shaderOpengl->program_);
+            glUseProgram(static_cast<const ShaderOpenGL*>(shader)->program_);
         }
 
+        frameStats_.shaderBinds++;
+
         boundShader_ = shader;
     }
 }
@@ -274,8 +356,45 @@ FrustumPlanes_t RenderSystemOpenGL::ExtractViewFrustumPlanes(const Matrix4x4& vi
     return frustumPlanes;
 }
 
+void RenderSystemOpenGL::SetShaderCacheDirectory(const string& directory) {
+    programCache_->SetDirectory(directory);
+}
+
+void RenderSystemOpenGL::EnableDeferredShaderCompilation(bool val) {
+    deferShaderLinks_ = val;
+
+    // Let the driver compile on as many threads as it wants
+    if (deferShaderLinks_ && maxShaderCompilerThreads_ != nullptr) {
+        ((MaxShaderCompilerThreadsFunc_t)maxShaderCompilerThreads_)(0xFFFFFFFF);
+    }
+}
+
+void RenderSystemOpenGL::UploadCameraUniforms() {
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUniformBuffer_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraUniforms_t), &cameraUniforms_);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    frameStats_.bufferBytesUploaded += sizeof(CameraUniforms_t);
+}
+
 void RenderSystemOpenGL::QueryDeviceCapabilities() {
     glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &deviceCapabilities_.maxActiveTextures_);
+
+    // The base instance is used to find the model matrix of each draw of an indirect draw call
+    deviceCapabilities_.supportsIndirectDraws_ = GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance;
+
+    // GL_UNSIGNED_INT indices are always supported, GL_MAX_ELEMENTS_INDICES is only a performance hint
+    deviceCapabilities_.maxVertexIndex_ = 0xFFFFFFFF;
+
+    // GLEW doesn't know the parallel shader compilation extension
+    GLint numExtensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+    for (GLint i = 0; i < numExtensions; i++) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension != nullptr && strcmp(extension, "GL_KHR_parallel_shader_compile") == 0) {
+            maxShaderCompilerThreads_ = renderContext_->GetFunctionAddress("glMaxShaderCompilerThreadsKHR");
+            break;
+        }
+    }
 }
 
 void RenderSystemOpenGL::CreateTextShader() {
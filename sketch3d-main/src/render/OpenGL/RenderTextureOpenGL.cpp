@@ -2,6 +2,7 @@
 
 #include "render/Renderer.h"
 #include "render/TextureManager.h"
+#include "render/OpenGL/RenderStateCacheOpenGL.h"
 #include "render/OpenGL/Texture2DOpenGL.h"
 
 #include "system/Logger.h"
@@ -12,8 +13,9 @@ namespace Sketch3D {
 
 int RenderTextureOpenGL::numGeneratedTextures_ = 0;
 
-RenderTextureOpenGL::RenderTextureOpenGL(unsigned int width, unsigned int height, TextureFormat_t format) :
-        RenderTexture(width, height, format), framebuffer_(0), renderbuffer_(0)
+RenderTextureOpenGL::RenderTextureOpenGL(unsigned int width, unsigned int height, TextureFormat_t format,
+                                         RenderStateCacheOpenGL* renderStateCache) : RenderTexture(width, height, format),
+        renderStateCache_(renderStateCache), framebuffer_(0), renderbuffer_(0)
 {
 }
 
@@ -23,6 +25,7 @@ RenderTextureOpenGL::~RenderTextureOpenGL() {
     }
 
     if (framebuffer_ != 0) {
+        renderStateCache_->OnFramebufferDeleted(framebuffer_);
         glDeleteFramebuffers(1, (const GLuint*) &framebuffer_);
     }
 }
@@ -38,13 +41,18 @@ bool RenderTextureOpenGL::AddDepthBuffer() {
         glGenFramebuffers(1, (GLuint*) &framebuffer_);
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    renderStateCache_->BindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    if (!texturesAttached_) {
+        // Only a depth buffer is written until color textures are attached
+        glDrawBuffer(GL_NONE);
+    }
+
     glGenRenderbuffers(1, (GLuint*) &renderbuffer_);
     glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer_);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width_, height_);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffer_);
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    renderStateCache_->BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     return true;
 }
@@ -89,16 +97,21 @@ bool RenderTextureOpenGL::AttachTextureToDepthBuffer(Texture2D* texture) {
         glGenFramebuffers(1, (GLuint*) &framebuffer_);
     }
     
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    renderStateCache_->BindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    if (!texturesAttached_) {
+        // Only a depth buffer is written until color textures are attached
+        glDrawBuffer(GL_NONE);
+    }
+
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, dynamic_cast<Texture2DOpenGL*>(texture)->textureName_, 0);
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         Logger::GetInstance()->Info("Couldn't attach texture to depth buffer");
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        renderStateCache_->BindFramebuffer(GL_FRAMEBUFFER, 0);
         return false;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    renderStateCache_->BindFramebuffer(GL_FRAMEBUFFER, 0);
     depthBufferBound_ = true;
     Logger::GetInstance()->Info("Texture successfully attached to depth buffer");
 
@@ -142,20 +155,26 @@ bool RenderTextureOpenGL::AttachTextures(const vector<Texture2D*>& textures) {
         glGenFramebuffers(1, (GLuint*) &framebuffer_);
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    renderStateCache_->BindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
 
+    // The draw buffers are part of the framebuffer, so they don't have to be set each time it is bound
+    vector<GLenum> buffers;
     for (size_t i = 0; i < textureNames.size(); i++) {
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, textureNames[i], 0);
+        buffers.push_back(GL_COLOR_ATTACHMENT0 + i);
     }
 
+    glDrawBuffers(buffers.size(), (buffers.empty()) ? nullptr : &buffers[0]);
+
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
         texturesAttached_ = true;
         Logger::GetInstance()->Info("Render texture #" + to_string(framebuffer_) + " was succesfully created");
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        renderStateCache_->BindFramebuffer(GL_FRAMEBUFFER, 0);
         return true;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    renderStateCache_->BindFramebuffer(GL_FRAMEBUFFER, 0);
+    renderStateCache_->OnFramebufferDeleted(framebuffer_);
     glDeleteFramebuffers(1, (const GLuint*) &framebuffer_);
     framebuffer_ = 0;
 
@@ -170,17 +189,7 @@ void RenderTextureOpenGL::Bind() const {
     }
 
     if (framebuffer_ != 0) {
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
-
-        size_t numBuffers = textures_.size();
-        GLenum* buffers = new GLenum[numBuffers];
-
-        for (size_t i = 0; i < numBuffers; i++) {
-            buffers[i] = GL_COLOR_ATTACHMENT0 + i;
-        }
-        glDrawBuffers(numBuffers, buffers);
-        delete[] buffers;
-
+        renderStateCache_->BindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
         Renderer::GetInstance()->SetViewport(0, 0, width_, height_);
     }
 }
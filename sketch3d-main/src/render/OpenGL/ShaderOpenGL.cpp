@@ -1,10 +1,13 @@
 #include "render/OpenGL/ShaderOpenGL.h"
 
+#include "render/OpenGL/ProgramBinaryCacheOpenGL.h"
+
 #include "math/Matrix3x3.h"
 #include "math/Matrix4x4.h"
 #include "math/Vector3.h"
 #include "math/Vector4.h"
 
+#include "render/FrameStats.h"
 #include "render/Renderer.h"
 #include "render/RenderSystem.h"
 #include "render/Texture.h"
@@ -12,11 +15,49 @@
 #include "system/Logger.h"
 
 #include <fstream>
+#include <string.h>
 using namespace std;
 
 namespace Sketch3D {
 
-ShaderOpenGL::ShaderOpenGL() : vertex_(0), fragment_(0) {
+/**
+ * Returns the size in bytes of a uniform of the given type, 0 for the types whose uploads aren't shadowed
+ */
+static size_t GetUniformTypeSize(GLenum type) {
+    switch (type) {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_FLOAT:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_SHADOW:
+            return 4;
+
+        case GL_FLOAT_VEC2:
+            return 8;
+
+        case GL_FLOAT_VEC3:
+            return 12;
+
+        case GL_FLOAT_VEC4:
+            return 16;
+
+        case GL_FLOAT_MAT3:
+            return 36;
+
+        case GL_FLOAT_MAT4:
+            return 64;
+
+        default:
+            return 0;
+    }
+}
+
+ShaderOpenGL::ShaderOpenGL(FrameStats_t* frameStats, const ProgramBinaryCacheOpenGL* programCache, bool deferLink) :
+        frameStats_(frameStats), programCache_(programCache), deferLink_(deferLink), linkPending_(false), programKey_(0),
+        saveToProgramCache_(false), vertex_(0), fragment_(0)
+{
     Logger::GetInstance()->Debug("OpenGL Shader creation");
     program_ = glCreateProgram();
 }
@@ -34,51 +75,168 @@ ShaderOpenGL::~ShaderOpenGL() {
 }
 
 bool ShaderOpenGL::SetSourceFile(const string& vertexFilename, const string& fragmentFilename) {
-	vertex_ = glCreateShader(GL_VERTEX_SHADER);
-	if (!vertex_) {
-		Logger::GetInstance()->Error("Couldn't create vertex shader");
-		return false;
-	}
-
-	fragment_ = glCreateShader(GL_FRAGMENT_SHADER);
-	if (!fragment_) {
-		Logger::GetInstance()->Error("Couldn't create fragment shader");
-		return false;
-	}
-
-	// Create the vertex shader
-	Logger::GetInstance()->Debug("Vertex shader creation");
-	const char* vertexFile = ReadShader(vertexFilename + ".glsl");
+	char* vertexFile = ReadShader(vertexFilename + ".glsl");
     if (vertexFile == nullptr) {
         Logger::GetInstance()->Error("Couldn't read vertex shader file " + vertexFilename + ".glsl");
         return false;
     }
 
-	glShaderSource(vertex_, 1, &vertexFile, NULL);
-	glCompileShader(vertex_);
-	glAttachShader(program_, vertex_);
-	LogShaderErrors(vertex_, vertexFilename + ".glsl");
-
-	// Create the fragment shader
-	Logger::GetInstance()->Debug("Fragment shader creation");
-	const char* fragmentFile = ReadShader(fragmentFilename + ".glsl");
+	char* fragmentFile = ReadShader(fragmentFilename + ".glsl");
     if (fragmentFile == nullptr) {
         Logger::GetInstance()->Error("Couldn't read fragment shader file " + fragmentFilename + ".glsl");
+        delete[] vertexFile;
         return false;
     }
 
-	glShaderSource(fragment_, 1, &fragmentFile, NULL);
-	glCompileShader(fragment_);
-	glAttachShader(program_, fragment_);
-	LogShaderErrors(fragment_, fragmentFilename + ".glsl");
+    string vertexSource(vertexFile);
+    string fragmentSource(fragmentFile);
+    delete[] vertexFile;
+    delete[] fragmentFile;
 
-	Logger::GetInstance()->Debug("Shader program linking");
-	glLinkProgram(program_);
-	LogProgramErrors();
+    return BuildProgram(vertexSource, vertexFilename + ".glsl", fragmentSource, fragmentFilename + ".glsl");
+}
+
+bool ShaderOpenGL::SetSource(const string& vertexSource, const string& fragmentSource) {
+    return BuildProgram(vertexSource, "Vertex source", fragmentSource, "Fragment source");
+}
+
+UniformHandle_t ShaderOpenGL::GetUniformHandle(const string& uniform) const {
+    if (linkPending_) {
+        const_cast<ShaderOpenGL*>(this)->FinishLink();
+    }
+
+    unordered_map<string, GLint>::const_iterator it = nameToUniforms_.find(uniform);
+    if (it == nameToUniforms_.end()) {
+        return INVALID_UNIFORM_HANDLE;
+    }
+
+    return it->second;
+}
+
+bool ShaderOpenGL::IsLinkPending() const {
+    return linkPending_;
+}
+
+void ShaderOpenGL::SetUniformIntImpl(UniformHandle_t uniform, int value) {
+    if (IsUploadRedundant(uniform, &value, sizeof(int))) {
+        return;
+    }
+
+    glUniform1i(uniform, value);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::SetUniformFloatImpl(UniformHandle_t uniform, float value) {
+    if (IsUploadRedundant(uniform, &value, sizeof(float))) {
+        return;
+    }
+
+    glUniform1f(uniform, value);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2) {
+    float values[2] = { value1, value2 };
+    if (IsUploadRedundant(uniform, values, sizeof(values))) {
+        return;
+    }
+
+    glUniform2f(uniform, value1, value2);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value) {
+    float values[3] = { value.x, value.y, value.z };
+    if (IsUploadRedundant(uniform, values, sizeof(values))) {
+        return;
+    }
 
+    glUniform3f(uniform, value.x, value.y, value.z);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize) {
+    if (IsUploadRedundant(uniform, values, arraySize * 3 * sizeof(float))) {
+        return;
+    }
+
+    glUniform3fv(uniform, arraySize, (const GLfloat*) values);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value) {
+    float values[4] = { value.x, value.y, value.z, value.w };
+    if (IsUploadRedundant(uniform, values, sizeof(values))) {
+        return;
+    }
+
+    glUniform4f(uniform, value.x, value.y, value.z, value.w);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value) {
+    float mat[9];
+    value.GetData(mat);
+    if (IsUploadRedundant(uniform, mat, sizeof(mat))) {
+        return;
+    }
+
+    glUniformMatrix3fv(uniform, 1, false, mat);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value) {
+    float mat[16];
+    value.GetData(mat);
+    if (IsUploadRedundant(uniform, mat, sizeof(mat))) {
+        return;
+    }
+
+    glUniformMatrix4fv(uniform, 1, false, mat);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize) {
+    // Convert the matrices to an array of floats
+    vector<float> matrices;
+    matrices.reserve(arraySize * 16);
+    for (int i = 0; i < arraySize; i++) {
+        float mat[16];
+        values[i].GetData(mat);
+        
+        for (size_t j = 0; j < 16; j++) {
+            matrices.push_back(mat[j]);
+        }
+    }
+
+    if (IsUploadRedundant(uniform, &matrices[0], matrices.size() * sizeof(float))) {
+        return;
+    }
+
+    glUniformMatrix4fv(uniform, arraySize, false, &matrices[0]);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture) {
+    // Bind the texture and send its texture unit to the shader
+    GLint textureUnit = (GLint)texture->Bind();
+    if (IsUploadRedundant(uniform, &textureUnit, sizeof(GLint))) {
+        return;
+    }
+
+    glUniform1i(uniform, textureUnit);
+    frameStats_->uniformUploads++;
+}
+
+void ShaderOpenGL::QueryUniforms() {
     GLint numActiveUniforms;
     char uniformName[256];
     glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &numActiveUniforms);
+
+    // The values of the previous program are gone
+    nameToUniforms_.clear();
+    uniformShadows_.clear();
+    shadowValues_.clear();
     for (int i = 0; i < numActiveUniforms; i++) {
         GLint arraySize = 0;
         GLenum type = 0;
@@ -93,13 +251,73 @@ bool ShaderOpenGL::SetSourceFile(const string& vertexFilename, const string& fra
             name.pop_back();
         }
 
-        nameToUniforms_[name] = glGetUniformLocation(program_, name.c_str());
+        // The members of the uniform blocks are active uniforms without a location, they are set through the block's buffer
+        GLint location = glGetUniformLocation(program_, name.c_str());
+        if (location != -1) {
+            nameToUniforms_[name] = location;
+
+            // Reserve room for the last value of the uniform
+            if (location >= (GLint)uniformShadows_.size()) {
+                UniformShadow_t unshadowed = { 0, 0, 0 };
+                uniformShadows_.resize(location + 1, unshadowed);
+            }
+
+            UniformShadow_t& shadow = uniformShadows_[location];
+            shadow.offset = shadowValues_.size();
+            shadow.capacity = GetUniformTypeSize(type) * arraySize;
+            shadow.size = 0;
+            shadowValues_.resize(shadow.offset + shadow.capacity);
+        }
     }
 
-    return true;
+    // Attach the camera uniform block to the binding point of the render system's camera buffer
+    GLuint cameraBlockIndex = glGetUniformBlockIndex(program_, CAMERA_UNIFORM_BLOCK_NAME);
+    usesCameraUniformBlock_ = (cameraBlockIndex != GL_INVALID_INDEX);
+    if (usesCameraUniformBlock_) {
+        glUniformBlockBinding(program_, cameraBlockIndex, CAMERA_UNIFORM_BLOCK_BINDING);
+    }
+
+    ResolveBuiltinUniforms();
 }
 
-bool ShaderOpenGL::SetSource(const string& vertexSource, const string& fragmentSource) {
+bool ShaderOpenGL::IsUploadRedundant(GLint location, const void* value, size_t size) {
+    if (location >= (GLint)uniformShadows_.size() || size > uniformShadows_[location].capacity) {
+        return false;
+    }
+
+    UniformShadow_t& shadow = uniformShadows_[location];
+    char* shadowValue = &shadowValues_[shadow.offset];
+    if (size <= shadow.size && memcmp(shadowValue, value, size) == 0) {
+        frameStats_->skippedUniformUploads++;
+        return true;
+    }
+
+    // The elements of an array that are not part of the upload keep their value
+    memcpy(shadowValue, value, size);
+    if (size > shadow.size) {
+        shadow.size = size;
+    }
+
+    return false;
+}
+
+bool ShaderOpenGL::BuildProgram(const string& vertexSource, const string& vertexName, const string& fragmentSource,
+                                const string& fragmentName)
+{
+    // Load the program from the binary cache if it was already built by this driver
+    saveToProgramCache_ = programCache_->IsEnabled();
+    if (saveToProgramCache_) {
+        programKey_ = programCache_->ComputeKey(vertexSource, fragmentSource);
+        if (programCache_->LoadProgram(program_, programKey_)) {
+            Logger::GetInstance()->Debug("Shader program loaded from the cache");
+            saveToProgramCache_ = false;
+            QueryUniforms();
+            return true;
+        }
+
+        glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
 	vertex_ = glCreateShader(GL_VERTEX_SHADER);
 	if (!vertex_) {
 		Logger::GetInstance()->Error("Couldn't create vertex shader");
@@ -112,13 +330,15 @@ bool ShaderOpenGL::SetSource(const string& vertexSource, const string& fragmentS
 		return false;
 	}
 
+    vertexName_ = vertexName;
+    fragmentName_ = fragmentName;
+
 	// Create the vertex shader
 	Logger::GetInstance()->Debug("Vertex shader creation");
     const char* vertexSourceCode = vertexSource.c_str();
     glShaderSource(vertex_, 1, &vertexSourceCode, NULL);
 	glCompileShader(vertex_);
 	glAttachShader(program_, vertex_);
-	LogShaderErrors(vertex_, "Vertex source");
 
 	// Create the fragment shader
 	Logger::GetInstance()->Debug("Fragment shader creation");
@@ -126,163 +346,35 @@ bool ShaderOpenGL::SetSource(const string& vertexSource, const string& fragmentS
     glShaderSource(fragment_, 1, &fragmentSourceCode, NULL);
 	glCompileShader(fragment_);
 	glAttachShader(program_, fragment_);
-	LogShaderErrors(fragment_, "Fragment source");
 
 	Logger::GetInstance()->Debug("Shader program linking");
 	glLinkProgram(program_);
-	LogProgramErrors();
-
-    GLint numActiveUniforms;
-    char uniformName[256];
-    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &numActiveUniforms);
-    for (int i = 0; i < numActiveUniforms; i++) {
-        GLint arraySize = 0;
-        GLenum type = 0;
-        GLsizei actualLength = 0;
-        glGetActiveUniform(program_, i, 256, &actualLength, &arraySize, &type, uniformName);
-        string name = uniformName;
-        
-        // Arrays' name are messed up
-        if (name.back() == ']') {
-            name.pop_back();
-            name.pop_back();
-            name.pop_back();
-        }
 
-        nameToUniforms_[name] = glGetUniformLocation(program_, name.c_str());
+    // Querying the result of the link waits for it, let the driver build the program while the other ones are submitted
+    linkPending_ = true;
+    if (!deferLink_) {
+        FinishLink();
     }
 
     return true;
 }
 
-bool ShaderOpenGL::SetUniformInt(const string& uniformName, int value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform1i(it->second, value);
-    return true;
-}
-
-bool ShaderOpenGL::SetUniformFloat(const string& uniformName, float value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform1f(it->second, value);
-    return true;
-}
+void ShaderOpenGL::FinishLink() {
+    linkPending_ = false;
 
-bool ShaderOpenGL::SetUniformVector2(const string& uniformName, float value1, float value2) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform2f(it->second, value1, value2);
-    return true;
-}
-
-bool ShaderOpenGL::SetUniformVector3(const string& uniformName, const Vector3& value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform3f(it->second, value.x, value.y, value.z);
-    return true;
-}
-
-bool ShaderOpenGL::SetUniformVector3Array(const string& uniformName, const Vector3* values, int arraySize) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform3fv(it->second, arraySize, (const GLfloat*) values);
-    return true;
-}
-
-bool ShaderOpenGL::SetUniformVector4(const string& uniformName, const Vector4& value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform4f(it->second, value.x, value.y, value.z, value.w);
-    return true;
-}
-
-bool ShaderOpenGL::SetUniformMatrix3x3(const string& uniformName, const Matrix3x3& value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    float mat[9];
-    value.GetData(mat);
-    glUniformMatrix3fv(it->second, 1, false, mat);
-    return true;
-}
-
-bool ShaderOpenGL::SetUniformMatrix4x4(const string& uniformName, const Matrix4x4& value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    float mat[16];
-    value.GetData(mat);
-    glUniformMatrix4fv(it->second, 1, false, mat);
-    return true;
-}
+	LogShaderErrors(vertex_, vertexName_);
+	LogShaderErrors(fragment_, fragmentName_);
+	LogProgramErrors();
 
-bool ShaderOpenGL::SetUniformMatrix4x4Array(const string& uniformName, const Matrix4x4* values, int arraySize) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
+    QueryUniforms();
 
-    // Convert the matrices to an array of floats
-    vector<float> matrices;
-    matrices.reserve(arraySize * 16);
-    for (int i = 0; i < arraySize; i++) {
-        float mat[16];
-        values[i].GetData(mat);
-        
-        for (size_t j = 0; j < 16; j++) {
-            matrices.push_back(mat[j]);
+    if (saveToProgramCache_) {
+        GLint linkStatus = GL_FALSE;
+        glGetProgramiv(program_, GL_LINK_STATUS, &linkStatus);
+        if (linkStatus == GL_TRUE) {
+            programCache_->SaveProgram(program_, programKey_);
         }
     }
-
-    glUniformMatrix4fv(it->second, arraySize, false, &matrices[0]);
-
-    return true;
-}
-
-bool ShaderOpenGL::SetUniformTexture(const string& uniformName, const Texture* texture) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    // Bind the texture and send its texture unit to the shader
-    size_t textureUnit = texture->Bind();
-    glUniform1i(it->second, textureUnit);
-
-    return true;
 }
 
 char* ShaderOpenGL::ReadShader(const string& filename) {
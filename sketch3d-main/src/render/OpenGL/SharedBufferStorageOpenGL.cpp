@@ -0,0 +1,197 @@
+#include "render/OpenGL/SharedBufferStorageOpenGL.h"
+
+#include "render/FrameStats.h"
+#include "render/OpenGL/BufferObjectOpenGL.h"
+#include "render/OpenGL/RenderStateCacheOpenGL.h"
+
+#include "math/Matrix4x4.h"
+
+#include <algorithm>
+using namespace std;
+
+namespace Sketch3D {
+
+// Initial number of vertices and indices that fit in the buffers. They double in size when they are full
+const size_t MIN_SHARED_STORAGE_CAPACITY = 65536;
+
+SharedBufferStorageOpenGL::SharedBufferStorageOpenGL(size_t id, const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes,
+                                                     size_t stride, IndexFormat_t indexFormat, FrameStats_t* frameStats,
+                                                     RenderStateCacheOpenGL* renderStateCache) :
+        id_(id), vertexAttributes_(vertexAttributes), presentVertexAttributes_(presentVertexAttributes), stride_(stride),
+        indexFormat_(indexFormat), indexSize_(GetIndexSize(indexFormat)), frameStats_(frameStats), renderStateCache_(renderStateCache), vao_(0), vbo_(0), ibo_(0), instanceBuffer_(0), indirectBuffer_(0),
+        numVertices_(0), vertexCapacity_(MIN_SHARED_STORAGE_CAPACITY), numIndices_(0), indexCapacity_(MIN_SHARED_STORAGE_CAPACITY)
+{
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glGenBuffers(1, &ibo_);
+    glGenBuffers(1, &indirectBuffer_);
+
+    renderStateCache_->BindVertexArray(vao_);
+
+    renderStateCache_->BindArrayBuffer(vbo_);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity_ * stride_, nullptr, GL_STATIC_DRAW);
+    SetVertexAttributePointersOpenGL(vertexAttributes_, presentVertexAttributes_, stride_);
+
+    renderStateCache_->BindElementArrayBuffer(ibo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity_ * indexSize_, nullptr, GL_STATIC_DRAW);
+}
+
+SharedBufferStorageOpenGL::~SharedBufferStorageOpenGL() {
+    renderStateCache_->OnVertexArrayDeleted(vao_);
+    renderStateCache_->OnBufferDeleted(vbo_);
+    renderStateCache_->OnBufferDeleted(ibo_);
+    renderStateCache_->OnBufferDeleted(instanceBuffer_);
+
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &vbo_);
+    glDeleteBuffers(1, &ibo_);
+    glDeleteBuffers(1, &indirectBuffer_);
+
+    if (instanceBuffer_ != 0) {
+        glDeleteBuffers(1, &instanceBuffer_);
+    }
+}
+
+size_t SharedBufferStorageOpenGL::AllocateVertices(size_t numVertices) {
+    if (numVertices_ + numVertices > vertexCapacity_) {
+        size_t newCapacity = max(vertexCapacity_ * 2, numVertices_ + numVertices);
+        GrowBuffer(vbo_, numVertices_ * stride_, newCapacity * stride_);
+        vertexCapacity_ = newCapacity;
+
+        // The vertex attributes refer to the old buffer
+        renderStateCache_->BindVertexArray(vao_);
+        renderStateCache_->BindArrayBuffer(vbo_);
+        SetVertexAttributePointersOpenGL(vertexAttributes_, presentVertexAttributes_, stride_);
+    }
+
+    size_t firstVertex = numVertices_;
+    numVertices_ += numVertices;
+    return firstVertex;
+}
+
+size_t SharedBufferStorageOpenGL::AllocateIndices(size_t numIndices) {
+    if (numIndices_ + numIndices > indexCapacity_) {
+        size_t newCapacity = max(indexCapacity_ * 2, numIndices_ + numIndices);
+        GrowBuffer(ibo_, numIndices_ * indexSize_, newCapacity * indexSize_);
+        indexCapacity_ = newCapacity;
+
+        // The index buffer binding is part of the vertex array object
+        renderStateCache_->BindVertexArray(vao_);
+        renderStateCache_->BindElementArrayBuffer(ibo_);
+    }
+
+    size_t firstIndex = numIndices_;
+    numIndices_ += numIndices;
+    return firstIndex;
+}
+
+void SharedBufferStorageOpenGL::SetVertices(size_t firstVertex, const float* vertexData, size_t numVertices) {
+    renderStateCache_->BindArrayBuffer(vbo_);
+    glBufferSubData(GL_ARRAY_BUFFER, firstVertex * stride_, numVertices * stride_, vertexData);
+    frameStats_->bufferBytesUploaded += numVertices * stride_;
+}
+
+void SharedBufferStorageOpenGL::SetIndices(size_t firstIndex, const unsigned int* indexData, size_t numIndices) {
+    vector<unsigned short> shortIndices;
+    const void* data = ConvertIndices(indexData, numIndices, indexFormat_, shortIndices);
+
+    // The element array binding belongs to the vertex array object, so the indices are sent through another target
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ibo_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, firstIndex * indexSize_, numIndices * indexSize_, data);
+    frameStats_->bufferBytesUploaded += numIndices * indexSize_;
+}
+
+void SharedBufferStorageOpenGL::GetVertices(size_t firstVertex, size_t numVertices, float* vertexData) const {
+    glBindBuffer(GL_COPY_READ_BUFFER, vbo_);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, firstVertex * stride_, numVertices * stride_, vertexData);
+}
+
+void SharedBufferStorageOpenGL::GetIndices(size_t firstIndex, size_t numIndices, unsigned int* indexData) const {
+    glBindBuffer(GL_COPY_READ_BUFFER, ibo_);
+
+    if (indexFormat_ == INDEX_FORMAT_32) {
+        glGetBufferSubData(GL_COPY_READ_BUFFER, firstIndex * indexSize_, numIndices * indexSize_, indexData);
+        return;
+    }
+
+    vector<unsigned short> shortIndices(numIndices);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, firstIndex * indexSize_, numIndices * indexSize_, &shortIndices[0]);
+    for (size_t i = 0; i < numIndices; i++) {
+        indexData[i] = shortIndices[i];
+    }
+}
+
+void SharedBufferStorageOpenGL::CopyVertices(size_t sourceFirstVertex, size_t destinationFirstVertex, size_t numVertices) {
+    glBindBuffer(GL_COPY_READ_BUFFER, vbo_);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo_);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceFirstVertex * stride_, destinationFirstVertex * stride_,
+                        numVertices * stride_);
+}
+
+void SharedBufferStorageOpenGL::CopyIndices(size_t sourceFirstIndex, size_t destinationFirstIndex, size_t numIndices) {
+    glBindBuffer(GL_COPY_READ_BUFFER, ibo_);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ibo_);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceFirstIndex * indexSize_,
+                        destinationFirstIndex * indexSize_, numIndices * indexSize_);
+}
+
+void SharedBufferStorageOpenGL::Bind() const {
+    renderStateCache_->BindVertexArray(vao_);
+}
+
+void SharedBufferStorageOpenGL::PrepareInstanceBuffers() {
+    if (instanceBuffer_ != 0) {
+        return;
+    }
+
+    glGenBuffers(1, &instanceBuffer_);
+
+    renderStateCache_->BindVertexArray(vao_);
+    renderStateCache_->BindArrayBuffer(instanceBuffer_);
+
+    SetInstanceAttributePointersOpenGL(vertexAttributes_);
+}
+
+void SharedBufferStorageOpenGL::SetInstances(const vector<Matrix4x4>& modelMatrices) {
+    PrepareInstanceBuffers();
+
+    renderStateCache_->BindArrayBuffer(instanceBuffer_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Matrix4x4) * modelMatrices.size(), &modelMatrices[0], GL_DYNAMIC_DRAW);
+    frameStats_->bufferBytesUploaded += sizeof(Matrix4x4) * modelMatrices.size();
+}
+
+void SharedBufferStorageOpenGL::DrawIndirect(const DrawIndirectCommand_t* commands, size_t numCommands) {
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer_);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawIndirectCommand_t) * numCommands, commands, GL_DYNAMIC_DRAW);
+    frameStats_->bufferBytesUploaded += sizeof(DrawIndirectCommand_t) * numCommands;
+
+    renderStateCache_->BindVertexArray(vao_);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GetIndexTypeOpenGL(indexFormat_), nullptr, numCommands, 0);
+}
+
+size_t SharedBufferStorageOpenGL::GetId() const {
+    return id_;
+}
+
+IndexFormat_t SharedBufferStorageOpenGL::GetIndexFormat() const {
+    return indexFormat_;
+}
+
+void SharedBufferStorageOpenGL::GrowBuffer(GLuint& buffer, size_t usedSize, size_t newSize) {
+    GLuint newBuffer;
+    glGenBuffers(1, &newBuffer);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+
+    if (usedSize > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedSize);
+    }
+
+    renderStateCache_->OnBufferDeleted(buffer);
+    glDeleteBuffers(1, &buffer);
+    buffer = newBuffer;
+}
+
+}
@@ -157,6 +157,10 @@ void RenderContextOpenGLUnix::SwapBuffers() {
     glXSwapBuffers(display_, xWindow_);
 }
 
+void* RenderContextOpenGLUnix::GetFunctionAddress(const char* name) const {
+    return (void*)glXGetProcAddressARB((const GLubyte*)name);
+}
+
 void RenderContextOpenGLUnix::QueryAdapterSupportedDisplayFormats() {
 }
                                                                        
@@ -195,6 +195,10 @@ void RenderContextOpenGLWin32::SwapBuffers() {
 	::SwapBuffers(deviceContext_);
 }
 
+void* RenderContextOpenGLWin32::GetFunctionAddress(const char* name) const {
+	return (void*)wglGetProcAddress(name);
+}
+
 void RenderContextOpenGLWin32::QueryAdapterSupportedDisplayFormats() {
 
 }
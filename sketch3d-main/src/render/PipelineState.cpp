@@ -0,0 +1,10 @@
+#include "render/PipelineState.h"
+
+namespace Sketch3D {
+
+PipelineState::PipelineState(uint32_t id, Shader* shader, bool hasRenderState, const RenderState_t& renderState) : id_(id),
+        shader_(shader), hasRenderState_(hasRenderState), renderState_(renderState)
+{
+}
+
+}
@@ -5,306 +5,829 @@
 #include "render/Mesh.h"
 #include "render/Node.h"
 #include "render/Renderer.h"
+#include "render/RenderSystem.h"
 #include "render/Shader.h"
 #include "render/SkinnedMesh.h"
 #include "render/Texture2D.h"
 
+#include "system/Profiler.h"
+
 #include <algorithm>
-#include <memory>
-#include <set>
-#include <utility>
 using namespace std;
 
 namespace Sketch3D {
 
-/**
- * @enum RenderCommand_t
- * This enum defines the different rendering command used by the render queue to actually draw
- * on the screen. The commands are used in an array of commands to sequentially make API calls.
- */
-enum RenderCommand_t {
-    RENDER_COMMAND_USE_MATERIAL,
-    RENDER_COMMAND_BIND_TEXTURES,
-    RENDER_COMMAND_SET_MODEL_MATRIX,
-    RENDER_COMMAND_RENDER_BUFFER_OBJECTS,
-    RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX,
-    RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES,
-
-    NUMBER_RENDER_COMMANDS
-};
-
-/**
- * @struct BindTextures_t
- * Little struct used to pack information required textures that we have to bind
- */
-struct BindTextures_t {
-    size_t      numTextures;
-    Texture2D** textures;
-
-    // Required to be used in a set
-    bool operator<(const BindTextures_t& rhs) const {
-        return textures < rhs.textures;
-    }
-};
-
-RenderQueue::RenderQueue() {
+// In retained mode, the items are compacted when more than half of them belong to removed nodes
+const size_t MIN_DEAD_ITEMS_BEFORE_COMPACTION = 64;
+
+// Below this number of keys, an insertion sort is faster than the radix sort
+const size_t RADIX_SORT_MIN_KEYS = 64;
+
+// When reusing the order of the last frame, the insertion sort can move each key by this many positions on average
+// before it gives up. Past that point, the radix sort is faster
+const size_t INSERTION_SORT_MOVES_PER_KEY = 4;
+
+// Below this number of items, an indirect draw call isn't worth uploading the draw commands
+const size_t MIN_INDIRECT_DRAWS = 2;
+
+// Default minimum number of identical items that are drawn automatically with instanced rendering
+const size_t DEFAULT_AUTOMATIC_INSTANCING_THRESHOLD = 4;
+
+void RadixSortKeys(vector<RenderQueueSortKey_t>& keys, vector<RenderQueueSortKey_t>& scratch) {
+    size_t numKeys = keys.size();
+    if (numKeys < RADIX_SORT_MIN_KEYS) {
+        InsertionSortKeys(keys, numKeys * numKeys);
+        return;
+    }
+
+    // Build the histograms of the 8 bytes in a single pass
+    size_t histograms[8][256];
+    for (size_t i = 0; i < 8; i++) {
+        for (size_t j = 0; j < 256; j++) {
+            histograms[i][j] = 0;
+        }
+    }
+
+    for (size_t i = 0; i < numKeys; i++) {
+        uint64_t key = keys[i].key;
+        for (size_t j = 0; j < 8; j++) {
+            histograms[j][(key >> (j * 8)) & 0xFF] += 1;
+        }
+    }
+
+    scratch.resize(numKeys);
+    for (size_t pass = 0; pass < 8; pass++) {
+        size_t* histogram = histograms[pass];
+        size_t shift = pass * 8;
+
+        // Skip the bytes that are the same in all the keys, such as the layer for most queues
+        if (histogram[(keys[0].key >> shift) & 0xFF] == numKeys) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t i = 0; i < 256; i++) {
+            size_t count = histogram[i];
+            histogram[i] = offset;
+            offset += count;
+        }
+
+        for (size_t i = 0; i < numKeys; i++) {
+            const RenderQueueSortKey_t& sortKey = keys[i];
+            scratch[histogram[(sortKey.key >> shift) & 0xFF]++] = sortKey;
+        }
+
+        keys.swap(scratch);
+    }
+}
+
+bool InsertionSortKeys(vector<RenderQueueSortKey_t>& keys, size_t maxMoves) {
+    size_t numMoves = 0;
+    for (size_t i = 1; i < keys.size(); i++) {
+        RenderQueueSortKey_t sortKey = keys[i];
+
+        size_t j = i;
+        for (; j > 0; j--) {
+            const RenderQueueSortKey_t& previous = keys[j - 1];
+            if (previous.key < sortKey.key || (previous.key == sortKey.key && previous.index < sortKey.index)) {
+                break;
+            }
+
+            keys[j] = previous;
+        }
+        keys[j] = sortKey;
+
+        numMoves += i - j;
+        if (numMoves > maxMoves) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Distance of a node from the camera, normalized between the near and far planes
+static uint32_t ComputeDistanceToCamera(const Matrix4x4& model) {
+    const Matrix4x4& modelView = Renderer::GetInstance()->GetViewMatrix() * model;
+    float dist = -(modelView[2][3] + Renderer::GetInstance()->GetNearFrustumPlane()) / (Renderer::GetInstance()->GetFarFrustumPlane() - Renderer::GetInstance()->GetNearFrustumPlane());
+
+    // The nodes outside of the frustum aren't always culled, they are sorted as if they were on its planes
+    if (dist <= 0.0f) {
+        return 0;
+    } else if (dist >= 1.0f) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)(dist * (float)UINT32_MAX);
+}
+
+// Order the candidates by buffer object and textures, then by position so that each group keeps the order of the keys
+static bool CompareInstanceCandidates(const RenderQueueInstanceCandidate_t& a, const RenderQueueInstanceCandidate_t& b) {
+    if (a.bufferObject != b.bufferObject) {
+        return a.bufferObject < b.bufferObject;
+    } else if (a.textures != b.textures) {
+        return a.textures < b.textures;
+    }
+
+    return a.position < b.position;
+}
+
+RenderQueue::RenderQueue() : useTemporalCoherence_(true), automaticInstancingThreshold_(DEFAULT_AUTOMATIC_INSTANCING_THRESHOLD), useIndirectDraws_(true),
+        retainedMode_(false), frame_(1), numDeadItems_(0), numUpdatedNodes_(0),
+        numUpdatedNodesLastFrame_(0), keysChanged_(false), commandsChanged_(false), numVisibleItems_(0)
+{
 }
 
 void RenderQueue::AddNode(Node* node, Layer_t layer) {
     // TODO
     // Got to change the distance from the camera
-    BufferObject** bufferObjects;
-    vector<SurfaceTriangles_t*> surfaces;
-    node->GetMesh()->GetRenderInfo(bufferObjects, surfaces);
-    shared_ptr<Matrix4x4> model(new Matrix4x4(node->ConstructModelMatrix()));
+    BufferObject** bufferObjects = node->GetMesh()->GetBufferObjects();
+    const vector<SurfaceTriangles_t*>& surfaces = node->GetMesh()->GetSurfaces();
 
-    const Matrix4x4& modelView = Renderer::GetInstance()->GetViewMatrix() * *(model.get());
-    float dist = -(modelView[2][3] + Renderer::GetInstance()->GetNearFrustumPlane()) / (Renderer::GetInstance()->GetFarFrustumPlane() - Renderer::GetInstance()->GetNearFrustumPlane());
-    uint32_t distanceToCamera = (uint32_t)(dist * (float)UINT32_MAX);
+    // The model matrices are stored contiguously for the whole frame, the items only refer to them by index
+    uint32_t modelMatrixIndex = (uint32_t)modelMatrices_.size();
+    modelMatrices_.push_back(node->ConstructModelMatrix());
+    const Matrix4x4* normalMatrix = &node->ConstructNormalMatrix();
+    uint32_t distanceToCamera = ComputeDistanceToCamera(modelMatrices_.back());
 
     for (size_t i = 0; i < surfaces.size(); i++) {
-        items_.push_back(RenderQueueItem(model, node->GetMaterial(), surfaces[i]->textures,
+        items_.push_back(RenderQueueItem(modelMatrixIndex, normalMatrix, node->GetMaterial(), surfaces[i]->textures,
                          surfaces[i]->numTextures, bufferObjects[i], node->UseInstancing(), distanceToCamera, layer));
+    }
+}
+
+void RenderQueue::SetRetainedMode(bool retainedMode) {
+    if (retainedMode == retainedMode_) {
+        return;
+    }
+
+    // The nodes still refer to their old entries, but FindEntry won't match them anymore
+    items_.clear();
+    modelMatrices_.clear();
+    entries_.clear();
+    freeEntries_.clear();
+    sortKeys_.clear();
+    renderCommands_.clear();
+    numDeadItems_ = 0;
+    numUpdatedNodes_ = 0;
+    numUpdatedNodesLastFrame_ = 0;
+    keysChanged_ = false;
+    commandsChanged_ = false;
+
+    retainedMode_ = retainedMode;
+}
+
+bool RenderQueue::IsRetainedMode() const {
+    return retainedMode_;
+}
+
+bool RenderQueue::RetainNode(Node* node) {
+    uint32_t entryIndex = FindEntry(node);
+    if (entryIndex == UINT32_MAX) {
+        return false;
+    }
+
+    RenderQueueEntry_t& entry = entries_[entryIndex];
+    if (node->needTransformationUpdate_ || entry.stateVersion != node->stateVersion_ ||
+        entry.transformationVersion != node->transformationVersion_ ||
+        entry.parentTransformationVersion != *node->parentTransformationVersion_)
+    {
+        return false;
+    }
+
+    entry.frame = frame_;
+    return true;
+}
+
+void RenderQueue::UpdateRetainedNode(Node* node, bool isVisible, Layer_t layer) {
+    uint32_t entryIndex = FindEntry(node);
+    if (entryIndex == UINT32_MAX) {
+        if (node->renderQueue_ != nullptr) {
+            node->renderQueue_->RemoveRetainedNode(node);
+        }
 
-        if (items_.size() > itemsIndex_.size()) {
-            itemsIndex_.push_back(itemsIndex_.size());
+        if (!freeEntries_.empty()) {
+            entryIndex = freeEntries_.back();
+            freeEntries_.pop_back();
+        } else {
+            entryIndex = (uint32_t)entries_.size();
+            entries_.push_back(RenderQueueEntry_t());
+            modelMatrices_.push_back(Matrix4x4());
         }
+
+        RenderQueueEntry_t& entry = entries_[entryIndex];
+        entry.node = node;
+        entry.firstItem = 0;
+        entry.numItems = 0;
+
+        node->renderQueue_ = this;
+        node->renderQueueEntry_ = entryIndex;
     }
+
+    // The model matrix of an entry is stored at the same index as the entry itself
+    RenderQueueEntry_t& entry = entries_[entryIndex];
+    modelMatrices_[entryIndex] = node->ConstructModelMatrix();
+    const Matrix4x4* normalMatrix = &node->ConstructNormalMatrix();
+    uint32_t distanceToCamera = ComputeDistanceToCamera(modelMatrices_[entryIndex]);
+
+    entry.stateVersion = node->stateVersion_;
+    entry.transformationVersion = node->transformationVersion_;
+    entry.parentTransformationVersion = *node->parentTransformationVersion_;
+    entry.frame = frame_;
+
+    BufferObject** bufferObjects = node->GetMesh()->GetBufferObjects();
+    const vector<SurfaceTriangles_t*>& surfaces = node->GetMesh()->GetSurfaces();
+
+    // The items are reconstructed in place unless the number of surfaces changed. In that case, the old items are left
+    // dead until the next compaction
+    if (surfaces.size() != entry.numItems) {
+        for (size_t i = 0; i < entry.numItems; i++) {
+            items_[entry.firstItem + i].isVisible_ = false;
+        }
+        numDeadItems_ += entry.numItems;
+
+        entry.firstItem = (uint32_t)items_.size();
+        entry.numItems = (uint32_t)surfaces.size();
+        items_.resize(items_.size() + surfaces.size(), RenderQueueItem(entryIndex, normalMatrix, nullptr, nullptr, 0, nullptr,
+                                                                       false, distanceToCamera, layer));
+    }
+
+    for (size_t i = 0; i < surfaces.size(); i++) {
+        RenderQueueItem& item = items_[entry.firstItem + i];
+        item = RenderQueueItem(entryIndex, normalMatrix, node->GetMaterial(), surfaces[i]->textures, surfaces[i]->numTextures,
+                               bufferObjects[i], node->UseInstancing(), distanceToCamera, layer);
+        item.isVisible_ = isVisible;
+    }
+
+    numUpdatedNodes_ += 1;
+    keysChanged_ = true;
+    commandsChanged_ = true;
 }
 
-void RenderQueue::Render() {
-    // Do we have less index this frame?
-    if (items_.size() < itemsIndex_.size()) {
-        itemsIndex_.resize(items_.size());
+void RenderQueue::RefreshRetainedNode(Node* node, bool isVisible) {
+    uint32_t entryIndex = FindEntry(node);
+    if (entryIndex == UINT32_MAX) {
+        return;
+    }
 
-        for (size_t i = 0; i < itemsIndex_.size(); i++) {
-            itemsIndex_[i] = i;
+    // The transformation of the node didn't change, so the model matrix of the entry is still valid
+    const RenderQueueEntry_t& entry = entries_[entryIndex];
+    uint32_t distanceToCamera = ComputeDistanceToCamera(modelMatrices_[entryIndex]);
+
+    for (size_t i = 0; i < entry.numItems; i++) {
+        RenderQueueItem& item = items_[entry.firstItem + i];
+        uint64_t key = item.key_;
+        item.SetDistanceFromCamera(distanceToCamera);
+        if (item.key_ != key) {
+            keysChanged_ = true;
+        }
+
+        if (item.isVisible_ != isVisible) {
+            item.isVisible_ = isVisible;
+            commandsChanged_ = true;
         }
     }
+}
+
+void RenderQueue::RemoveRetainedNode(Node* node) {
+    uint32_t entryIndex = FindEntry(node);
+    if (entryIndex == UINT32_MAX) {
+        return;
+    }
 
-    // Sort the indices
-    stable_sort(itemsIndex_.begin(), itemsIndex_.end(), RenderQueueItemKeyComparator(items_));
+    FreeEntry(entryIndex);
+    node->renderQueue_ = nullptr;
+}
 
-    vector<pair<RenderCommand_t, void*>> renderCommands;
-    set<BindTextures_t> bindTexturesSet;
-    set<void*> instancedBufferObjects;
+size_t RenderQueue::GetNumberOfUpdatedNodes() const {
+    return numUpdatedNodesLastFrame_;
+}
 
-    // This array is used to determine when to insert a new render command in the list of render commands
-    void* previousRenderCommands[NUMBER_RENDER_COMMANDS];
-    for (size_t i = 0; i < NUMBER_RENDER_COMMANDS; i++) {
-        previousRenderCommands[i] = nullptr;
+void RenderQueue::Merge(RenderQueue& renderQueue) {
+    uint32_t modelMatrixOffset = (uint32_t)modelMatrices_.size();
+    modelMatrices_.insert(modelMatrices_.end(), renderQueue.modelMatrices_.begin(), renderQueue.modelMatrices_.end());
+
+    size_t firstItem = items_.size();
+    items_.insert(items_.end(), renderQueue.items_.begin(), renderQueue.items_.end());
+    for (size_t i = firstItem; i < items_.size(); i++) {
+        items_[i].modelMatrixIndex_ += modelMatrixOffset;
     }
+
+    renderQueue.items_.clear();
+    renderQueue.modelMatrices_.clear();
+}
+
+void RenderQueue::Render() {
+    PROFILE_ZONE("RenderQueue::Render");
+
+    FrameStats_t& frameStats = Renderer::GetInstance()->GetRenderSystem()->GetFrameStats();
+    Profiler* profiler = Profiler::GetInstance();
+
+    if (retainedMode_) {
+        RemoveUnsubmittedNodes();
+
+        // The items are only sorted again and the commands rebuilt when some nodes changed since the last frame
+        if (keysChanged_) {
+            long long sortStart = profiler->GetTime();
+            SortItems();
+            frameStats.sortTime += profiler->GetTime() - sortStart;
+        }
+
+        if (keysChanged_ || commandsChanged_) {
+            BuildRenderCommands();
+        }
+
+        ExecuteRenderCommands();
+        frameStats.queueItems += numVisibleItems_;
+
+        keysChanged_ = false;
+        commandsChanged_ = false;
+        numUpdatedNodesLastFrame_ = numUpdatedNodes_;
+        numUpdatedNodes_ = 0;
+        frame_ += 1;
+        return;
+    }
+
+    long long sortStart = profiler->GetTime();
+    SortItems();
+    frameStats.sortTime += profiler->GetTime() - sortStart;
+
+    BuildRenderCommands();
+    ExecuteRenderCommands();
+    frameStats.queueItems += numVisibleItems_;
+
+    // Invalidate the render queue. The memory is kept around so that the next frame doesn't have to allocate it again
+    items_.clear();
+    modelMatrices_.clear();
+}
+
+bool RenderQueue::IsEmpty() const {
+    return items_.empty();
+}
+
+void RenderQueue::SetUseTemporalCoherence(bool useTemporalCoherence) {
+    useTemporalCoherence_ = useTemporalCoherence;
+}
+
+void RenderQueue::SetAutomaticInstancingThreshold(size_t threshold) {
+    automaticInstancingThreshold_ = threshold;
+    commandsChanged_ = true;
+}
+
+void RenderQueue::SetUseIndirectDraws(bool useIndirectDraws) {
+    useIndirectDraws_ = useIndirectDraws;
+    commandsChanged_ = true;
+}
+
+void RenderQueue::BuildRenderCommands() {
+    PROFILE_ZONE("RenderQueue::BuildRenderCommands");
+
+    renderCommands_.clear();
+    numVisibleItems_ = 0;
+    instancedBufferObjects_.clear();
+    instanceGroups_.assign(sortKeys_.size(), UINT32_MAX);
+    indirectCommands_.clear();
+
+    // Used to determine when to insert a new render command in the list of render commands
+    const Material* previousMaterial = nullptr;
+    Texture2D** previousTextures = nullptr;
+    uint32_t previousModelMatrixIndex = UINT32_MAX;
+    const BufferObject* previousBufferObject = nullptr;
     bool modelViewMatrixChanged = false;
-    bool nextRenderIsInstanced = false;
-
-    // Construct the list of render commands
-    for (size_t i = 0; i < itemsIndex_.size(); i++) {
-        size_t idx = itemsIndex_[i];
-        const RenderQueueItem& item = items_[idx];
-
-        // Set the material to bind for the next render commands
-        void* material = static_cast<void*>(item.material_);
-        if (previousRenderCommands[RENDER_COMMAND_USE_MATERIAL] != material) {
-
-            // Flush the current batch of instanced buffers before we switch material
-            if (nextRenderIsInstanced) {
-                set<void*>::iterator it = instancedBufferObjects.begin();
-                for (; it != instancedBufferObjects.end(); ++it) {
-                    renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
-                }
-                instancedBufferObjects.clear();
 
-                nextRenderIsInstanced = item.useInstancing_;
-            }
+    for (size_t i = 0; i < sortKeys_.size(); i++) {
+        const RenderQueueItem& item = items_[sortKeys_[i].index];
+        if (!item.isVisible_) {
+            continue;
+        }
+
+        numVisibleItems_ += 1;
+        RenderCommandRecord_t record;
 
-            renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_USE_MATERIAL, material));
-            previousRenderCommands[RENDER_COMMAND_USE_MATERIAL] = material;
+        // Set the material to bind for the next render commands. The current batch of instanced buffers is flushed first
+        if (previousMaterial != item.material_) {
+            FlushInstancedBufferObjects();
+
+            record.command = RENDER_COMMAND_USE_MATERIAL;
+            record.material = item.material_;
+            renderCommands_.push_back(record);
+            previousMaterial = item.material_;
+
+            FindInstanceGroups(i);
+        }
+
+        // The items drawn with automatic instancing are all drawn at the position of the first item of their group
+        uint32_t instanceGroup = instanceGroups_[i];
+        if (instanceGroup != UINT32_MAX && instanceCandidates_[instanceGroup].position != i) {
+            continue;
         }
 
         // If any, set the textures to bind for the next render commands
-        if (item.numTextures_ > 0) {
-            BindTextures_t bindTextures;
-            bindTextures.numTextures = item.numTextures_;
-            bindTextures.textures = item.textures_;
-            pair<set<BindTextures_t>::iterator, bool> ret = bindTexturesSet.insert(bindTextures);
-        
-            void* textures = static_cast<void*>(const_cast<BindTextures_t*>(&(*(ret.first)))); // Evil stuff to make it work :/
-            if (previousRenderCommands[RENDER_COMMAND_BIND_TEXTURES] != textures) {
-
-                // Flush the current batch of instanced buffers before we switch textures
-                if (nextRenderIsInstanced) {
-                    set<void*>::iterator it = instancedBufferObjects.begin();
-                    for (; it != instancedBufferObjects.end(); ++it) {
-                        renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
-                    }
-                    instancedBufferObjects.clear();
+        if (item.numTextures_ > 0 && previousTextures != item.textures_) {
+            FlushInstancedBufferObjects();
+
+            record.command = RENDER_COMMAND_BIND_TEXTURES;
+            record.textures.textures = item.textures_;
+            record.textures.numTextures = item.numTextures_;
+            renderCommands_.push_back(record);
+            previousTextures = item.textures_;
+        }
 
-                    nextRenderIsInstanced = item.useInstancing_;
-                }
+        if (instanceGroup != UINT32_MAX) {
+            FlushInstancedBufferObjects();
+            AddInstanceGroupCommands(instanceGroup);
 
-                renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_BIND_TEXTURES, textures));
-                previousRenderCommands[RENDER_COMMAND_BIND_TEXTURES] = textures;
-            }
+            // The next item has to set its model matrix and buffer object again
+            previousModelMatrixIndex = UINT32_MAX;
+            previousBufferObject = nullptr;
+            continue;
         }
 
-        // Set the model matrix for the next render commands. If we are using instanced rendering, we want to accumulate them, instead
-        void* modelMatrix = static_cast<void*>(item.modelMatrix_.get());
-        if (previousRenderCommands[RENDER_COMMAND_SET_MODEL_MATRIX] != modelMatrix) {
+        if (AddIndirectDrawCommands(i)) {
+            previousModelMatrixIndex = UINT32_MAX;
+            previousBufferObject = nullptr;
+            continue;
+        }
 
+        // Set the model matrix for the next render commands. If we are using instanced rendering, we want to accumulate them, instead
+        if (previousModelMatrixIndex != item.modelMatrixIndex_) {
             if (item.useInstancing_) {
-                renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX, modelMatrix));
-                nextRenderIsInstanced = true;
+                record.command = RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX;
             } else {
-
-                // Flush the current batch of instanced buffers
-                if (nextRenderIsInstanced) {
-                    set<void*>::iterator it = instancedBufferObjects.begin();
-                    for (; it != instancedBufferObjects.end(); ++it) {
-                        renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
-                    }
-                    instancedBufferObjects.clear();
-
-                    nextRenderIsInstanced = false;
-                }
-
-                renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_SET_MODEL_MATRIX, modelMatrix));
+                FlushInstancedBufferObjects();
+                record.command = RENDER_COMMAND_SET_MODEL_MATRIX;
             }
 
+            // The whole item is given since the normal matrix is also required
+            record.item = &item;
+            renderCommands_.push_back(record);
+
             modelViewMatrixChanged = true;
-            previousRenderCommands[RENDER_COMMAND_SET_MODEL_MATRIX] = modelMatrix;
+            previousModelMatrixIndex = item.modelMatrixIndex_;
         }
 
         // Set the buffer objects to draw. If we are using instanced rendering, we want to delay their insertion in the list of
         // render commands to after we accumulated all the model matrices
-        void* bufferObject = static_cast<void*>(item.bufferObject_);
-        if (modelViewMatrixChanged || previousRenderCommands[RENDER_COMMAND_RENDER_BUFFER_OBJECTS] != bufferObject) {
-
+        if (modelViewMatrixChanged || previousBufferObject != item.bufferObject_) {
             if (item.useInstancing_) {
-                instancedBufferObjects.insert(bufferObject);
-                nextRenderIsInstanced = true;
-            } else {
-
-                // Flush the current batch of instanced buffers
-                if (nextRenderIsInstanced) {
-                    set<void*>::iterator it = instancedBufferObjects.begin();
-                    for (; it != instancedBufferObjects.end(); ++it) {
-                        renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
-                    }
-                    instancedBufferObjects.clear();
-
-                    nextRenderIsInstanced = false;
+                if (find(instancedBufferObjects_.begin(), instancedBufferObjects_.end(), item.bufferObject_) == instancedBufferObjects_.end()) {
+                    instancedBufferObjects_.push_back(item.bufferObject_);
                 }
+            } else {
+                FlushInstancedBufferObjects();
 
-                renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_RENDER_BUFFER_OBJECTS, bufferObject));
+                record.command = RENDER_COMMAND_RENDER_BUFFER_OBJECTS;
+                record.bufferObject = item.bufferObject_;
+                renderCommands_.push_back(record);
             }
 
-            previousRenderCommands[RENDER_COMMAND_RENDER_BUFFER_OBJECTS] = bufferObject;
+            previousBufferObject = item.bufferObject_;
             modelViewMatrixChanged = false;
         }
     }
 
     // Render the last batch of instanced buffer objects if we didn't have the chance to flush them out
-    if (nextRenderIsInstanced) {
-        set<void*>::iterator it = instancedBufferObjects.begin();
-        for (; it != instancedBufferObjects.end(); ++it) {
-            renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
+    FlushInstancedBufferObjects();
+}
+
+void RenderQueue::FindInstanceGroups(size_t firstPosition) {
+    instanceCandidates_.clear();
+
+    // Only the shader knows if it reads the model matrix from the instance buffer. The transparent items aren't
+    // instanced since drawing them out of order would break the blending
+    const Material* material = items_[sortKeys_[firstPosition].index].material_;
+    if (automaticInstancingThreshold_ == 0 || material->GetTransluencyType() != TRANSLUENCY_TYPE_OPAQUE ||
+        !material->GetShader()->SupportsInstancing())
+    {
+        return;
+    }
+
+    for (size_t i = firstPosition; i < sortKeys_.size(); i++) {
+        const RenderQueueItem& item = items_[sortKeys_[i].index];
+        if (!item.isVisible_) {
+            continue;
+        } else if (item.material_ != material) {
+            break;
+        }
+
+        // The items that asked for instancing are already accumulated with the other instances of their buffer object
+        if (!item.useInstancing_) {
+            RenderQueueInstanceCandidate_t candidate;
+            candidate.bufferObject = item.bufferObject_;
+            candidate.textures = item.textures_;
+            candidate.position = (uint32_t)i;
+            instanceCandidates_.push_back(candidate);
+        }
+    }
+
+    if (instanceCandidates_.size() < automaticInstancingThreshold_) {
+        return;
+    }
+
+    sort(instanceCandidates_.begin(), instanceCandidates_.end(), CompareInstanceCandidates);
+
+    size_t groupStart = 0;
+    for (size_t i = 1; i <= instanceCandidates_.size(); i++) {
+        if (i < instanceCandidates_.size() && instanceCandidates_[i].bufferObject == instanceCandidates_[groupStart].bufferObject &&
+            instanceCandidates_[i].textures == instanceCandidates_[groupStart].textures)
+        {
+            continue;
+        }
+
+        if (i - groupStart >= automaticInstancingThreshold_) {
+            for (size_t j = groupStart; j < i; j++) {
+                instanceGroups_[instanceCandidates_[j].position] = (uint32_t)groupStart;
+            }
+        }
+
+        groupStart = i;
+    }
+}
+
+void RenderQueue::AddInstanceGroupCommands(uint32_t firstCandidate) {
+    BufferObject* bufferObject = instanceCandidates_[firstCandidate].bufferObject;
+    Texture2D** textures = instanceCandidates_[firstCandidate].textures;
+
+    RenderCommandRecord_t record;
+    record.command = RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX;
+
+    for (size_t i = firstCandidate; i < instanceCandidates_.size(); i++) {
+        const RenderQueueInstanceCandidate_t& candidate = instanceCandidates_[i];
+        if (candidate.bufferObject != bufferObject || candidate.textures != textures) {
+            break;
+        }
+
+        record.item = &items_[sortKeys_[candidate.position].index];
+        renderCommands_.push_back(record);
+    }
+
+    // The nodes never asked for instancing, so the instance buffers might not exist yet
+    bufferObject->PrepareInstanceBuffers();
+
+    record.command = RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES;
+    record.bufferObject = bufferObject;
+    renderCommands_.push_back(record);
+}
+
+bool RenderQueue::AddIndirectDrawCommands(size_t& position) {
+    const RenderQueueItem& firstItem = items_[sortKeys_[position].index];
+    size_t sharedStorageId = firstItem.bufferObject_->GetSharedStorageId();
+    if (!useIndirectDraws_ || firstItem.useInstancing_ || sharedStorageId == 0 ||
+        firstItem.material_->GetTransluencyType() != TRANSLUENCY_TYPE_OPAQUE || !firstItem.material_->GetShader()->SupportsInstancing())
+    {
+        return false;
+    }
+
+    // Find the last item that can be drawn along with the first one
+    size_t numDraws = 1;
+    size_t lastPosition = position;
+    for (size_t i = position + 1; i < sortKeys_.size(); i++) {
+        const RenderQueueItem& item = items_[sortKeys_[i].index];
+        if (!item.isVisible_) {
+            continue;
+        }
+
+        bool sameTextures = (item.numTextures_ == 0 && firstItem.numTextures_ == 0) || item.textures_ == firstItem.textures_;
+        if (instanceGroups_[i] != UINT32_MAX || item.material_ != firstItem.material_ || !sameTextures || item.useInstancing_ ||
+            item.bufferObject_->GetSharedStorageId() != sharedStorageId)
+        {
+            break;
+        }
+
+        numDraws += 1;
+        lastPosition = i;
+    }
+
+    if (numDraws < MIN_INDIRECT_DRAWS) {
+        return false;
+    }
+
+    FlushInstancedBufferObjects();
+
+    // The model matrices are accumulated like instances, the base instance of each draw is the index of its matrix
+    RenderCommandRecord_t record;
+    record.command = RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX;
+
+    DrawIndirectCommand_t command;
+    uint32_t firstCommand = (uint32_t)indirectCommands_.size();
+
+    for (size_t i = position; i <= lastPosition; i++) {
+        const RenderQueueItem& item = items_[sortKeys_[i].index];
+        if (!item.isVisible_) {
+            continue;
         }
+
+        item.bufferObject_->FillDrawIndirectCommand(command, (uint32_t)indirectCommands_.size() - firstCommand);
+        indirectCommands_.push_back(command);
+
+        record.item = &item;
+        renderCommands_.push_back(record);
+    }
+
+    firstItem.bufferObject_->PrepareInstanceBuffers();
+
+    record.command = RENDER_COMMAND_DRAW_INDIRECT;
+    record.indirectDraws.bufferObject = firstItem.bufferObject_;
+    record.indirectDraws.firstCommand = firstCommand;
+    record.indirectDraws.numCommands = (uint32_t)numDraws;
+    renderCommands_.push_back(record);
+
+    // The first item was already counted by BuildRenderCommands, the other ones are skipped by moving the position
+    numVisibleItems_ += numDraws - 1;
+    position = lastPosition;
+    return true;
+}
+
+void RenderQueue::FlushInstancedBufferObjects() {
+    RenderCommandRecord_t record;
+    record.command = RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES;
+
+    for (size_t i = 0; i < instancedBufferObjects_.size(); i++) {
+        record.bufferObject = instancedBufferObjects_[i];
+        renderCommands_.push_back(record);
     }
 
-    // Execute the commands sequentially
+    instancedBufferObjects_.clear();
+}
+
+void RenderQueue::ExecuteRenderCommands() {
+    PROFILE_ZONE("RenderQueue::ExecuteRenderCommands");
+
+    FrameStats_t& frameStats = Renderer::GetInstance()->GetRenderSystem()->GetFrameStats();
     const Material* currentMaterial = nullptr;
-    const BindTextures_t* currentTextures = nullptr;
-    const Matrix4x4* currentModelMatrix;
-    BufferObject* currentBufferObject = nullptr;
     Shader* currentShader = nullptr;
-    const map<string, Texture*>* currentMaterialTextures = nullptr;
-    map<string, Texture*>::const_iterator mt_it;
-    vector<Matrix4x4> accumulatedInstances;
     bool flushAccumulatedInstances = false;
+    accumulatedInstances_.clear();
 
     const Matrix4x4& projection = Renderer::GetInstance()->GetProjectionMatrix();
     const Matrix4x4& viewProjection = Renderer::GetInstance()->GetViewProjectionMatrix();
     const Matrix4x4& view = Renderer::GetInstance()->GetViewMatrix();
-    const Matrix4x4& transposedInverseViewMatrix = view.Inverse().Transpose();
+    const Matrix4x4& transposedInverseViewMatrix = view.InverseAffine().Transpose();
+    Renderer::GetInstance()->GetRenderSystem()->SetCameraUniforms(view, projection, viewProjection);
 
-    for (size_t i = 0; i < renderCommands.size(); i++) {
-        RenderCommand_t renderCommand = renderCommands[i].first;
+    for (size_t i = 0; i < renderCommands_.size(); i++) {
+        const RenderCommandRecord_t& record = renderCommands_[i];
 
-        switch (renderCommand) {
+        switch (record.command) {
             case RENDER_COMMAND_USE_MATERIAL:
-                currentMaterial = static_cast<Material*>(renderCommands[i].second);
+                currentMaterial = record.material;
                 currentShader = currentMaterial->GetShader();
 
                 // Bind the current shader for all the following draw calls
                 Renderer::GetInstance()->BindShader(currentShader);
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::VIEW), view );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::VIEW_PROJECTION), viewProjection );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::TRANS_INV_VIEW), transposedInverseViewMatrix );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::PROJECTION), projection );
+
+                // The shaders declaring the camera uniform block already have the camera matrices
+                if (!currentShader->UsesCameraUniformBlock()) {
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW), view );
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW_PROJECTION), viewProjection );
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::TRANS_INV_VIEW), transposedInverseViewMatrix );
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::PROJECTION), projection );
+                }
 
                 break;
 
             case RENDER_COMMAND_BIND_TEXTURES:
                 // Bind the textures for the next sets of buffer objects
-                currentTextures = static_cast<BindTextures_t*>(renderCommands[i].second);
-
-                for (size_t j = 0; j < currentTextures->numTextures; j++) {
-                    Texture2D* texture = currentTextures->textures[j];
+                for (size_t j = 0; j < record.textures.numTextures; j++) {
+                    Texture2D* texture = record.textures.textures[j];
                     if (texture != nullptr) {
                         BuiltinUniform_t builtinUniformTexture = (BuiltinUniform_t)((size_t)BuiltinUniform_t::TEXTURE_0 + j);
-                        currentShader->SetUniformTexture( GetBuiltinUniformName(builtinUniformTexture), texture );
+                        currentShader->SetUniformTexture( currentShader->GetBuiltinUniformHandle(builtinUniformTexture), texture );
                     }
                 }
                 break;
 
-            case RENDER_COMMAND_SET_MODEL_MATRIX:
+            case RENDER_COMMAND_SET_MODEL_MATRIX: {
                 // Setup the transformation matrix for the next sets of buffer objects
-                currentModelMatrix = static_cast<Matrix4x4*>(renderCommands[i].second);
+                const Matrix4x4& modelMatrix = modelMatrices_[record.item->modelMatrixIndex_];
 
                 // Set the uniform matrices
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL_VIEW_PROJECTION), viewProjection * (*currentModelMatrix) );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL_VIEW), view * (*currentModelMatrix) );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL), (*currentModelMatrix) );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::TRANS_INV_MODEL_VIEW),
-                                                    transposedInverseViewMatrix * currentModelMatrix->Inverse().Transpose() );
+                currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL_VIEW_PROJECTION), viewProjection * modelMatrix );
+                currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL_VIEW), view * modelMatrix );
+                currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL), modelMatrix );
+                currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::TRANS_INV_MODEL_VIEW),
+                                                    transposedInverseViewMatrix * (*record.item->normalMatrix_) );
                 break;
+            }
 
             case RENDER_COMMAND_RENDER_BUFFER_OBJECTS:
                 // Draw a buffer object
                 currentMaterial->ApplyMaterial();
-                currentBufferObject = static_cast<BufferObject*>(renderCommands[i].second);
-                currentBufferObject->Render();
+                record.bufferObject->Render();
+                frameStats.drawCalls++;
                 break;
 
             case RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX:
                 // Accumulate the model matrices
                 if (flushAccumulatedInstances) {
-                    accumulatedInstances.clear();
+                    accumulatedInstances_.clear();
                     flushAccumulatedInstances = false;
                 }
 
-                currentModelMatrix = static_cast<Matrix4x4*>(renderCommands[i].second);
-                accumulatedInstances.push_back(currentModelMatrix->Transpose());
+                accumulatedInstances_.push_back(modelMatrices_[record.item->modelMatrixIndex_].Transpose());
                 break;
 
             case RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES:
                 // Draw several instances of the same buffer object
                 currentMaterial->ApplyMaterial();
-                currentBufferObject = static_cast<BufferObject*>(renderCommands[i].second);
-                currentBufferObject->RenderInstances(accumulatedInstances);
+                record.bufferObject->RenderInstances(accumulatedInstances_);
+                frameStats.instancedDrawCalls++;
+                frameStats.drawnInstances += accumulatedInstances_.size();
                 flushAccumulatedInstances = true;
 
                 break;
+
+            case RENDER_COMMAND_DRAW_INDIRECT: {
+                // Draw several buffer objects sharing the same storage, each with its accumulated model matrix
+                const IndirectDraws_t& indirectDraws = record.indirectDraws;
+                currentMaterial->ApplyMaterial();
+                indirectDraws.bufferObject->RenderIndirect(&indirectCommands_[indirectDraws.firstCommand], indirectDraws.numCommands,
+                                                           accumulatedInstances_);
+                frameStats.indirectDrawCalls++;
+                frameStats.indirectDraws += indirectDraws.numCommands;
+                flushAccumulatedInstances = true;
+
+                break;
+            }
         }
     }
+}
 
-    // Invalidate the render queue and approximate the next batch's size
-    items_.clear();
-    items_.reserve(itemsIndex_.size());
+uint32_t RenderQueue::FindEntry(const Node* node) const {
+    uint32_t entryIndex = node->renderQueueEntry_;
+    if (node->renderQueue_ != this || entryIndex >= entries_.size() || entries_[entryIndex].node != node) {
+        return UINT32_MAX;
+    }
+
+    return entryIndex;
 }
 
-bool RenderQueue::IsEmpty() const {
-    return items_.empty();
+void RenderQueue::FreeEntry(uint32_t entryIndex) {
+    RenderQueueEntry_t& entry = entries_[entryIndex];
+    for (size_t i = 0; i < entry.numItems; i++) {
+        items_[entry.firstItem + i].isVisible_ = false;
+    }
+    numDeadItems_ += entry.numItems;
+
+    entry.node = nullptr;
+    entry.numItems = 0;
+    freeEntries_.push_back(entryIndex);
+    commandsChanged_ = true;
+}
+
+void RenderQueue::RemoveUnsubmittedNodes() {
+    // The nodes themselves aren't touched since they might have been deleted
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (entries_[i].node != nullptr && entries_[i].frame != frame_) {
+            FreeEntry((uint32_t)i);
+        }
+    }
+
+    if (numDeadItems_ < MIN_DEAD_ITEMS_BEFORE_COMPACTION || numDeadItems_ * 2 < items_.size()) {
+        return;
+    }
+
+    vector<RenderQueueItem> liveItems;
+    liveItems.reserve(items_.size() - numDeadItems_);
+    for (size_t i = 0; i < entries_.size(); i++) {
+        RenderQueueEntry_t& entry = entries_[i];
+        if (entry.node == nullptr) {
+            continue;
+        }
+
+        uint32_t firstItem = (uint32_t)liveItems.size();
+        liveItems.insert(liveItems.end(), items_.begin() + entry.firstItem, items_.begin() + entry.firstItem + entry.numItems);
+        entry.firstItem = firstItem;
+    }
+
+    items_.swap(liveItems);
+    numDeadItems_ = 0;
+    keysChanged_ = true;
+}
+
+void RenderQueue::SortItems() {
+    PROFILE_ZONE("RenderQueue::SortItems");
+
+    size_t numItems = items_.size();
+
+    // The items are added in the same order every frame, so if their number didn't change, last frame's order is
+    // most likely almost right
+    if (useTemporalCoherence_ && sortKeys_.size() == numItems) {
+        for (size_t i = 0; i < numItems; i++) {
+            sortKeys_[i].key = items_[sortKeys_[i].index].key_;
+        }
+
+        if (InsertionSortKeys(sortKeys_, numItems * INSERTION_SORT_MOVES_PER_KEY)) {
+            return;
+        }
+    }
+
+    sortKeys_.resize(numItems);
+    for (size_t i = 0; i < numItems; i++) {
+        sortKeys_[i].key = items_[i].key_;
+        sortKeys_[i].index = (uint32_t)i;
+    }
+
+    RadixSortKeys(sortKeys_, sortScratch_);
 }
 
 }
@@ -2,7 +2,7 @@
 
 #include "render/Material.h"
 #include "render/Node.h"
-#include "render/Shader.h"
+#include "render/PipelineState.h"
 #include "render/Texture2D.h"
 
 #include "math/Matrix3x3.h"
@@ -12,74 +12,84 @@
 
 namespace Sketch3D {
 
-// Constants for bitshifts
+// Size and position of the fields of the key
 const int LAYER_SHIFT = 62;
-const int DEPTH_SHIFT = 30;
-const int MATERIAL_SHIFT = 32;
+const int TRANSLUENCY_SHIFT = 60;
 
-const uint32_t DISTANCE_TRUNCATION = 0xFFFFFFFC;
+const int STATE_FIELD_BITS = 12;
+const uint64_t STATE_FIELD_MASK = (1 << STATE_FIELD_BITS) - 1;
+const int DEPTH_BITS = 24;
+const uint64_t DEPTH_MASK = (1 << DEPTH_BITS) - 1;
 
-RenderQueueItem::RenderQueueItem(shared_ptr<Matrix4x4> modelMatrix, Material* material, Texture2D** textures,
+// Opaque items : pipeline state, material, texture set then depth
+const int OPAQUE_PIPELINE_STATE_SHIFT = 48;
+const int OPAQUE_MATERIAL_SHIFT = 36;
+const int OPAQUE_TEXTURE_SET_SHIFT = 24;
+const int OPAQUE_DEPTH_SHIFT = 0;
+
+// Transparent items : depth then pipeline state, material and texture set
+const int TRANSPARENT_DEPTH_SHIFT = 36;
+const int TRANSPARENT_PIPELINE_STATE_SHIFT = 24;
+const int TRANSPARENT_MATERIAL_SHIFT = 12;
+const int TRANSPARENT_TEXTURE_SET_SHIFT = 0;
+
+RenderQueueItem::RenderQueueItem(uint32_t modelMatrixIndex, const Matrix4x4* normalMatrix, Material* material, Texture2D** textures,
                                  size_t numTextures, BufferObject* bufferObject, bool useInstancing, uint32_t distanceFromCamera, Layer_t layer) : key_(0),
-        layer_(layer), transluencyType_(TRANSLUENCY_TYPE_OPAQUE), distanceFromCamera_(distanceFromCamera), materialId_(0), modelMatrix_(modelMatrix),
-        material_(material), textures_(textures), numTextures_(numTextures), bufferObject_(bufferObject), useInstancing_(useInstancing)
+        modelMatrixIndex_(modelMatrixIndex), normalMatrix_(normalMatrix), material_(material), textures_(textures), numTextures_(numTextures),
+        bufferObject_(bufferObject), useInstancing_(useInstancing), isVisible_(true)
 {
-    TransluencyType_t transluencyType = material_->GetTransluencyType();
-    key_ |= ((uint64_t)layer_) << LAYER_SHIFT;
-    key_ |= ((uint64_t)(distanceFromCamera  & DISTANCE_TRUNCATION) << ((transluencyType == TRANSLUENCY_TYPE_OPAQUE) ? 0 : DEPTH_SHIFT));
-    key_ |= ((uint64_t)ConstructMaterialId() << ((transluencyType == TRANSLUENCY_TYPE_OPAQUE) ? MATERIAL_SHIFT : 0));
+    // The render queues create placeholder items without material before filling them
+    if (material_ != nullptr) {
+        ConstructKey(distanceFromCamera, layer);
+    }
 }
 
 RenderQueueItem::~RenderQueueItem() {
 }
 
-uint32_t RenderQueueItem::ConstructMaterialId() const {
-    uint16_t shaderId = material_->GetShader()->GetId();
-    return shaderId;
+void RenderQueueItem::ConstructKey(uint32_t distanceFromCamera, Layer_t layer) {
+    TransluencyType_t transluencyType = material_->GetTransluencyType();
+    const PipelineState* pipelineState = material_->GetPipelineState();
+    uint64_t pipelineStateId = (pipelineState != nullptr) ? pipelineState->GetId() & STATE_FIELD_MASK : 0;
+    uint64_t materialId = material_->GetId() & STATE_FIELD_MASK;
+    uint64_t textureSetId = ConstructTextureSetId();
+    uint64_t depth = distanceFromCamera >> (32 - DEPTH_BITS);
+
+    key_ = ((uint64_t)layer << LAYER_SHIFT) | ((uint64_t)transluencyType << TRANSLUENCY_SHIFT);
+    if (transluencyType == TRANSLUENCY_TYPE_OPAQUE) {
+        key_ |= (pipelineStateId << OPAQUE_PIPELINE_STATE_SHIFT) | (materialId << OPAQUE_MATERIAL_SHIFT) |
+                (textureSetId << OPAQUE_TEXTURE_SET_SHIFT) | (depth << OPAQUE_DEPTH_SHIFT);
+    } else {
+        // The farthest items come first
+        key_ |= ((DEPTH_MASK - depth) << TRANSPARENT_DEPTH_SHIFT) | (pipelineStateId << TRANSPARENT_PIPELINE_STATE_SHIFT) |
+                (materialId << TRANSPARENT_MATERIAL_SHIFT) | (textureSetId << TRANSPARENT_TEXTURE_SET_SHIFT);
+    }
 }
 
-bool RenderQueueItemKeyComparator::operator() (size_t lhs, size_t rhs) const {
-    // For opaque objects, we sort by material first to minimize state changes. Otherwise,
-    // we sort by depth first, and back-to-front.
-    const RenderQueueItem& x = items_[lhs];
-    const RenderQueueItem& y = items_[rhs];
-
-    return x.key_ < y.key_;
-    /*
-    if (x.layer_ > y.layer_) {
-        return false;
-    } else if (x.layer_ == y.layer_) {
-        if (x.transluencyType_ > y.transluencyType_) {
-            return false;
-        } else if (x.transluencyType_ == y.transluencyType_) {
-            TransluencyType_t transluency = x.transluencyType_;
-
-            switch (transluency) {
-                case TRANSLUENCY_TYPE_OPAQUE:
-                    if (x.materialId_ > y.materialId_) {
-                        return false;
-                    } else if (x.materialId_ == y.materialId_) {
-                        if (x.distanceFromCamera_ >= y.distanceFromCamera_) {
-                            return false;
-                        }
-                    }
-                    break;
-                case TRANSLUENCY_TYPE_ADDITIVE:
-                case TRANSLUENCY_TYPE_SUBTRACTIVE:
-                    if (x.distanceFromCamera_ < y.distanceFromCamera_) {
-                        return false;
-                    } else if (x.distanceFromCamera_ == y.distanceFromCamera_) {
-                        if (x.materialId_ >= y.materialId_) {
-                            return false;
-                        }
-                    }
-                    break;
-            }
-        }
+void RenderQueueItem::SetDistanceFromCamera(uint32_t distanceFromCamera) {
+    uint64_t depth = distanceFromCamera >> (32 - DEPTH_BITS);
+    TransluencyType_t transluencyType = (TransluencyType_t)((key_ >> TRANSLUENCY_SHIFT) & 3);
+
+    if (transluencyType == TRANSLUENCY_TYPE_OPAQUE) {
+        key_ = (key_ & ~(DEPTH_MASK << OPAQUE_DEPTH_SHIFT)) | (depth << OPAQUE_DEPTH_SHIFT);
+    } else {
+        key_ = (key_ & ~(DEPTH_MASK << TRANSPARENT_DEPTH_SHIFT)) | ((DEPTH_MASK - depth) << TRANSPARENT_DEPTH_SHIFT);
+    }
+}
+
+uint32_t RenderQueueItem::ConstructTextureSetId() const {
+    if (numTextures_ == 0) {
+        return 0;
+    }
+
+    // FNV-1a hash of the texture ids, folded to the size of the field
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < numTextures_; i++) {
+        uint32_t textureId = (textures_[i] != nullptr) ? textures_[i]->GetId() : 0;
+        hash = (hash ^ textureId) * 16777619U;
     }
 
-    return true;
-    */
+    return (hash ^ (hash >> STATE_FIELD_BITS) ^ (hash >> (2 * STATE_FIELD_BITS))) & STATE_FIELD_MASK;
 }
 
 }
@@ -1,112 +1,209 @@
 #include "render/RenderStateCache.h"
 
+#include "render/FrameStats.h"
+#include "render/PipelineState.h"
+#include "render/Shader.h"
+
 namespace Sketch3D {
-RenderStateCache::RenderStateCache() {
-    oldCullingMethod_ = cullingMethod_ = CULLING_METHOD_BACK_FACE;
-    oldIsDepthTestEnabled_ = isDepthTestEnabled_ = true;
-    oldDepthComparisonFunction_ = depthComparisonFunction_ = DEPTH_FUNC_LESS;
-    oldRenderMode_ = renderMode_ = RENDER_MODE_FILL;
 
-    oldIsDepthWriteEnabled_ = isDepthWriteEnabled_ = true;
-    oldIsColorWriteEnabled_ = isColorWriteEnabled_ = true;
-    oldIsBlendingEnabled_ = isBlendingEnabled_ = false;
+// Id of the applied render state when it's the one set through the setters
+const uint32_t SETTERS_RENDER_STATE_ID = 0;
+
+// Id of the applied render state when it doesn't match any render state anymore
+const uint32_t INVALID_RENDER_STATE_ID = 0xFFFFFFFF;
 
-    oldBlendingEquation_ = blendingEquation_ = BLENDING_EQUATION_ADD;
-    oldSourceBlendingFactor_ = sourceBlendingFactor_ = BLENDING_FACTOR_ONE;
-    oldDestinationBlendingFactor_ = destinationBlendingFactor_ = BLENDING_FACTOR_ZERO;
+RenderStateCache::RenderStateCache(FrameStats_t* frameStats) : frameStats_(frameStats), appliedRenderStateId_(INVALID_RENDER_STATE_ID),
+        nextPipelineStateId_(1)
+{
 }
 
 RenderStateCache::~RenderStateCache() {
-
+    unordered_map<uint32_t, vector<PipelineState*>>::iterator it = pipelineStates_.begin();
+    for (; it != pipelineStates_.end(); ++it) {
+        for (size_t i = 0; i < it->second.size(); i++) {
+            delete it->second[i];
+        }
+    }
 }
 
 void RenderStateCache::ApplyRenderStateChanges() {
-    ApplyClearStateChanges();
-
-    if (oldIsDepthTestEnabled_ != isDepthTestEnabled_) {
-        oldIsDepthTestEnabled_ = isDepthTestEnabled_;
-        EnableDepthTestImpl();
-    }
+    ApplyPipelineState(nullptr);
+}
 
-    if (oldIsBlendingEnabled_ != isBlendingEnabled_) {
-        oldIsBlendingEnabled_ = isBlendingEnabled_;
-        EnableBlendingImpl();
-    }
+void RenderStateCache::ApplyClearStateChanges() {
+    bool changed = false;
 
-    if (oldDepthComparisonFunction_ != depthComparisonFunction_) {
-        oldDepthComparisonFunction_ = depthComparisonFunction_;
-        SetDepthComparisonFuncImpl();
+    if (appliedRenderState_.depthWrite != renderState_.depthWrite) {
+        appliedRenderState_.depthWrite = renderState_.depthWrite;
+        frameStats_->stateChanges++;
+        EnableDepthWriteImpl();
+        changed = true;
     }
 
-    if (oldCullingMethod_ != cullingMethod_) {
-        oldCullingMethod_ = cullingMethod_;
-        SetCullingMethodImpl();
+    if (appliedRenderState_.colorWrite != renderState_.colorWrite) {
+        appliedRenderState_.colorWrite = renderState_.colorWrite;
+        frameStats_->stateChanges++;
+        EnableColorWriteImpl();
+        changed = true;
     }
 
-    if (oldBlendingEquation_ != blendingEquation_) {
-        oldBlendingEquation_ = blendingEquation_;
-        SetBlendingEquationImpl();
+    // The write masks of the applied pipeline state were replaced
+    if (changed) {
+        appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
     }
+}
 
-    if (oldSourceBlendingFactor_ != sourceBlendingFactor_ || oldDestinationBlendingFactor_ != destinationBlendingFactor_) {
-        oldSourceBlendingFactor_ = sourceBlendingFactor_;
-        oldDestinationBlendingFactor_ = destinationBlendingFactor_;
-        SetBlendingFactorImpl();
+void RenderStateCache::ApplyPipelineState(const PipelineState* pipelineState) {
+    bool useSettersRenderState = (pipelineState == nullptr || !pipelineState->HasRenderState());
+    uint32_t renderStateId = (useSettersRenderState) ? SETTERS_RENDER_STATE_ID : pipelineState->GetId();
+    if (renderStateId == appliedRenderStateId_) {
+        return;
     }
 
-    if (oldRenderMode_ != renderMode_) {
-        oldRenderMode_ = renderMode_;
-        SetRenderFillModeImpl();
-    }
+    ApplyRenderState((useSettersRenderState) ? renderState_ : pipelineState->GetRenderState());
+    appliedRenderStateId_ = renderStateId;
 }
 
-void RenderStateCache::ApplyClearStateChanges() {
-    if (oldIsDepthWriteEnabled_ != isDepthWriteEnabled_) {
-        oldIsDepthWriteEnabled_ = isDepthWriteEnabled_;
-        EnableDepthWriteImpl();
-    }
+const PipelineState* RenderStateCache::GetPipelineState(Shader* shader) {
+    return FindOrCreatePipelineState(shader, false, RenderState_t());
+}
 
-    if (oldIsColorWriteEnabled_ != isColorWriteEnabled_) {
-        oldIsColorWriteEnabled_ = isColorWriteEnabled_;
-        EnableColorWriteImpl();
-    }
+const PipelineState* RenderStateCache::GetPipelineState(Shader* shader, const RenderState_t& renderState) {
+    return FindOrCreatePipelineState(shader, true, renderState);
 }
 
 void RenderStateCache::EnableDepthTest(bool val) {
-    isDepthTestEnabled_ = val;
+    renderState_.depthTest = val;
+    appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
 }
 
 void RenderStateCache::EnableDepthWrite(bool val) {
-    isDepthWriteEnabled_ = val;
+    renderState_.depthWrite = val;
+    appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
 }
 
 void RenderStateCache::EnableColorWrite(bool val) {
-    isColorWriteEnabled_ = val;
+    renderState_.colorWrite = val;
+    appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
 }
 
 void RenderStateCache::EnableBlending(bool val) {
-    isBlendingEnabled_ = val;
+    renderState_.blending = val;
+    appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
 }
 
 void RenderStateCache::SetDepthComparisonFunc(DepthFunc_t comparison) {
-    depthComparisonFunction_ = comparison;
+    renderState_.depthFunc = comparison;
+    appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
 }
 
 void RenderStateCache::SetCullingMethod(CullingMethod_t cullingMethod) {
-    cullingMethod_ = cullingMethod;
+    renderState_.cullingMethod = cullingMethod;
+    appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
 }
 
 void RenderStateCache::SetBlendingEquation(BlendingEquation_t equation) {
-    blendingEquation_ = equation;
+    renderState_.blendingEquation = equation;
+    appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
 }
 
 void RenderStateCache::SetBlendingFactor(BlendingFactor_t srcFactor, BlendingFactor_t dstFactor) {
-    sourceBlendingFactor_ = srcFactor;
-    destinationBlendingFactor_ = dstFactor;
+    renderState_.sourceBlendingFactor = srcFactor;
+    renderState_.destinationBlendingFactor = dstFactor;
+    appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
 }
 
 void RenderStateCache::SetRenderFillMode(RenderMode_t mode) {
-    renderMode_ = mode;
+    renderState_.renderMode = mode;
+    appliedRenderStateId_ = INVALID_RENDER_STATE_ID;
 }
 
-}
\ No newline at end of file
+void RenderStateCache::ApplyRenderState(const RenderState_t& renderState) {
+    if (appliedRenderState_.depthWrite != renderState.depthWrite) {
+        appliedRenderState_.depthWrite = renderState.depthWrite;
+        frameStats_->stateChanges++;
+        EnableDepthWriteImpl();
+    }
+
+    if (appliedRenderState_.colorWrite != renderState.colorWrite) {
+        appliedRenderState_.colorWrite = renderState.colorWrite;
+        frameStats_->stateChanges++;
+        EnableColorWriteImpl();
+    }
+
+    if (appliedRenderState_.depthTest != renderState.depthTest) {
+        appliedRenderState_.depthTest = renderState.depthTest;
+        frameStats_->stateChanges++;
+        EnableDepthTestImpl();
+    }
+
+    if (appliedRenderState_.blending != renderState.blending) {
+        appliedRenderState_.blending = renderState.blending;
+        frameStats_->stateChanges++;
+        EnableBlendingImpl();
+    }
+
+    if (appliedRenderState_.depthFunc != renderState.depthFunc) {
+        appliedRenderState_.depthFunc = renderState.depthFunc;
+        frameStats_->stateChanges++;
+        SetDepthComparisonFuncImpl();
+    }
+
+    if (appliedRenderState_.cullingMethod != renderState.cullingMethod) {
+        appliedRenderState_.cullingMethod = renderState.cullingMethod;
+        frameStats_->stateChanges++;
+        SetCullingMethodImpl();
+    }
+
+    if (appliedRenderState_.blendingEquation != renderState.blendingEquation) {
+        appliedRenderState_.blendingEquation = renderState.blendingEquation;
+        frameStats_->stateChanges++;
+        SetBlendingEquationImpl();
+    }
+
+    if (appliedRenderState_.sourceBlendingFactor != renderState.sourceBlendingFactor ||
+        appliedRenderState_.destinationBlendingFactor != renderState.destinationBlendingFactor)
+    {
+        appliedRenderState_.sourceBlendingFactor = renderState.sourceBlendingFactor;
+        appliedRenderState_.destinationBlendingFactor = renderState.destinationBlendingFactor;
+        frameStats_->stateChanges++;
+        SetBlendingFactorImpl();
+    }
+
+    if (appliedRenderState_.renderMode != renderState.renderMode) {
+        appliedRenderState_.renderMode = renderState.renderMode;
+        frameStats_->stateChanges++;
+        SetRenderFillModeImpl();
+    }
+}
+
+const PipelineState* RenderStateCache::FindOrCreatePipelineState(Shader* shader, bool hasRenderState, const RenderState_t& renderState) {
+    // FNV-1a hash of the content of the pipeline state
+    uint32_t values[] = {
+        (uint32_t)((shader != nullptr) ? shader->GetId() : 0), (uint32_t)hasRenderState,
+        renderState.depthTest, renderState.depthWrite, renderState.colorWrite, renderState.blending,
+        (uint32_t)renderState.depthFunc, (uint32_t)renderState.cullingMethod, (uint32_t)renderState.blendingEquation,
+        (uint32_t)renderState.sourceBlendingFactor, (uint32_t)renderState.destinationBlendingFactor, (uint32_t)renderState.renderMode
+    };
+
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        hash = (hash ^ values[i]) * 16777619U;
+    }
+
+    vector<PipelineState*>& bucket = pipelineStates_[hash];
+    for (size_t i = 0; i < bucket.size(); i++) {
+        PipelineState* pipelineState = bucket[i];
+        if (pipelineState->GetShader() == shader && pipelineState->HasRenderState() == hasRenderState &&
+            (!hasRenderState || pipelineState->GetRenderState() == renderState))
+        {
+            return pipelineState;
+        }
+    }
+
+    PipelineState* pipelineState = new PipelineState(nextPipelineStateId_++, shader, hasRenderState, renderState);
+    bucket.push_back(pipelineState);
+    return pipelineState;
+}
+
+}
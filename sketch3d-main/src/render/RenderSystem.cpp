@@ -14,11 +14,36 @@
 
 namespace Sketch3D {
 
-RenderSystem::RenderSystem(Window& window) : window_(window), boundShader_(nullptr), bufferObjectManager_(nullptr), textShader_(nullptr) {
-    windowHandle_ = window_.GetHandle();
-    width_ = window_.GetWidth();
-    height_ = window_.GetHeight();
-    windowed_ = window_.IsWindowed();
+void FrameStats_t::Reset() {
+    nodesVisited = 0;
+    nodesCulled = 0;
+    queueItems = 0;
+    sortTime = 0;
+    drawCalls = 0;
+    instancedDrawCalls = 0;
+    drawnInstances = 0;
+    indirectDrawCalls = 0;
+    indirectDraws = 0;
+    shaderBinds = 0;
+    textureBinds = 0;
+    uniformUploads = 0;
+    skippedUniformUploads = 0;
+    bufferBytesUploaded = 0;
+    stateChanges = 0;
+}
+
+RenderSystem::RenderSystem(Window& window) : window_(&window), boundShader_(nullptr), bufferObjectManager_(nullptr), renderStateCache_(nullptr), textShader_(nullptr),
+        hasCameraUniforms_(false)
+{
+    windowHandle_ = window_->GetHandle();
+    width_ = window_->GetWidth();
+    height_ = window_->GetHeight();
+    windowed_ = window_->IsWindowed();
+}
+
+RenderSystem::RenderSystem(unsigned int width, unsigned int height) : window_(nullptr), windowHandle_(0), width_(width), height_(height),
+        windowed_(true), boundShader_(nullptr), bufferObjectManager_(nullptr), renderStateCache_(nullptr), textShader_(nullptr), hasCameraUniforms_(false)
+{
 }
 
 RenderSystem::~RenderSystem() {
@@ -70,6 +95,23 @@ size_t RenderSystem::BindTexture(const Texture* texture) {
     return 0;
 }
 
+void RenderSystem::SetCameraUniforms(const Matrix4x4& view, const Matrix4x4& projection, const Matrix4x4& viewProjection) {
+    if (hasCameraUniforms_ && view == cameraView_ && projection == cameraProjection_) {
+        return;
+    }
+
+    cameraView_ = view;
+    cameraProjection_ = projection;
+    hasCameraUniforms_ = true;
+
+    view.GetData(cameraUniforms_.view);
+    viewProjection.GetData(cameraUniforms_.viewProjection);
+    view.InverseAffine().Transpose().GetData(cameraUniforms_.transInvView);
+    projection.GetData(cameraUniforms_.projection);
+
+    UploadCameraUniforms();
+}
+
 void RenderSystem::DrawTextBuffer(BufferObject* bufferObject, Texture2D* fontAtlas, const Vector3& textColor) {
     Renderer::GetInstance()->BindShader(textShader_);
     textShader_->SetUniformTexture("fontAtlas", fontAtlas);
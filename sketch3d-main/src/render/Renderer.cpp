@@ -3,6 +3,7 @@
 #include "math/Constants.h"
 #include "math/Sphere.h"
 
+#include "render/Null/RenderSystemNull.h"
 #include "render/OpenGL/RenderSystemOpenGL.h"
 
 #include "system/Platform.h"
@@ -17,6 +18,7 @@
 #include "render/TextureManager.h"
 
 #include "system/Logger.h"
+#include "system/Profiler.h"
 #include "system/Window.h"
 
 #include <math.h>
@@ -55,19 +57,29 @@ bool Renderer::Initialize(RenderSystem_t renderSystem,
             renderSystem_ = new RenderSystemDirect3D9(window);			
 			break;
 #endif
+
+        case RENDER_SYSTEM_NULL:
+            renderSystem_ = new RenderSystemNull(window.GetWidth(), window.GetHeight());
+            break;
+
 		default:
 			Logger::GetInstance()->Error("Unknown render system");
-			break;
+			return false;
 	}
 
-	if (!renderSystem_->Initialize(renderParamters_)) {
-        Logger::GetInstance()->Error("Couldn't initialize render system properly");
+    return InitializeRenderSystem();
+}
+
+bool Renderer::Initialize(RenderSystem_t renderSystem, const RenderParameters_t& renderParameters) {
+    if (renderSystem != RENDER_SYSTEM_NULL) {
+        Logger::GetInstance()->Error("Only the null render system can be used without a window");
         return false;
     }
 
-    SetDefaultRenderingValues();
+    renderParamters_ = renderParameters;
+    renderSystem_ = new RenderSystemNull(renderParameters.width, renderParameters.height);
 
-    return true;
+    return InitializeRenderSystem();
 }
 
 void Renderer::SetClearColor(float red, float green, float blue, float alpha) const {
@@ -80,6 +92,7 @@ void Renderer::Clear(int buffer) const {
 }
 
 void Renderer::StartRender() {
+    renderSystem_->GetFrameStats().Reset();
     renderSystem_->StartRender();
 }
 
@@ -88,6 +101,8 @@ void Renderer::EndRender() {
 }
 
 void Renderer::Render() {
+    PROFILE_ZONE("Renderer::Render");
+
     // Commit the state changes
     RenderStateCache* renderStateCache = renderSystem_->GetRenderStateCache();
     renderStateCache->ApplyRenderStateChanges();
@@ -106,6 +121,8 @@ void Renderer::Render() {
 	// Draw the render queue contents
     opaqueRenderQueue_.Render();
 
+    // The materials with a render state of their own set their blending through their pipeline state, the other ones
+    // use the render state set through the renderer
     if (!transparentRenderQueue_.IsEmpty()) {
         renderStateCache->SetBlendingEquation(BLENDING_EQUATION_ADD);
         renderStateCache->EnableBlending(true);
@@ -226,6 +243,14 @@ Shader* Renderer::CreateShader() const {
     return renderSystem_->CreateShader();
 }
 
+void Renderer::SetShaderCacheDirectory(const string& directory) const {
+    renderSystem_->SetShaderCacheDirectory(directory);
+}
+
+void Renderer::EnableDeferredShaderCompilation(bool val) const {
+    renderSystem_->EnableDeferredShaderCompilation(val);
+}
+
 Texture2D* Renderer::CreateTexture2D() const {
     return renderSystem_->CreateTexture2D();
 }
@@ -291,6 +316,11 @@ void Renderer::EnableFrustumCulling(bool val) {
     useFrustumCulling_ = val;
 }
 
+void Renderer::EnableRetainedMode(bool val) {
+    opaqueRenderQueue_.SetRetainedMode(val);
+    transparentRenderQueue_.SetRetainedMode(val);
+}
+
 void Renderer::DrawTextBuffer(BufferObject* bufferObject, Texture2D* fontAtlas, const Vector3& textColor) {
     RenderStateCache* renderStateCache = renderSystem_->GetRenderStateCache();
     renderStateCache->EnableDepthTest(false);
@@ -329,6 +359,14 @@ SceneTree& Renderer::GetSceneTree() {
 	return sceneTree_;
 }
 
+const FrameStats_t& Renderer::GetFrameStats() const {
+    return renderSystem_->GetFrameStats();
+}
+
+RenderSystem* Renderer::GetRenderSystem() const {
+    return renderSystem_;
+}
+
 BufferObjectManager* Renderer::GetBufferObjectManager() const {
     return renderSystem_->GetBufferObjectManager();
 }
@@ -349,6 +387,17 @@ CullingMethod_t Renderer::GetCullingMethod() const {
     return cullingMethod_;
 }
 
+bool Renderer::InitializeRenderSystem() {
+	if (!renderSystem_->Initialize(renderParamters_)) {
+        Logger::GetInstance()->Error("Couldn't initialize render system properly");
+        return false;
+    }
+
+    SetDefaultRenderingValues();
+
+    return true;
+}
+
 void Renderer::SetDefaultRenderingValues() {
     // Some initial values
     PerspectiveProjection(45.0f, (float)renderParamters_.width / (float)renderParamters_.height, 1.0f, 1000.0f);
@@ -357,13 +406,4 @@ void Renderer::SetDefaultRenderingValues() {
     SetCullingMethod(CULLING_METHOD_BACK_FACE);
 }
 
-bool FrustumPlanes_t::IsSphereOutside(const Sphere& sphere) const {
-    return sphere.IntersectsPlane(nearPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
-           sphere.IntersectsPlane(farPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
-           sphere.IntersectsPlane(leftPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
-           sphere.IntersectsPlane(rightPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
-           sphere.IntersectsPlane(bottomPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
-           sphere.IntersectsPlane(topPlane) == RELATIVE_PLANE_POSITION_OUTSIDE;
-}
-
 }
@@ -1,5 +1,7 @@
 #include "render/Renderer_Common.h"
 
+#include "math/Sphere.h"
+
 #include "system/Logger.h"
 #include "system/Utils.h"
 
@@ -8,8 +10,163 @@
 #include <vector>
 using namespace std;
 
+#if HAVE_SSE
+#   include <emmintrin.h>
+#   include <immintrin.h>
+#endif
+
 namespace Sketch3D {
 
+/**
+ * @struct PackedPlanes_t
+ * The 6 frustum planes stored as a structure of arrays for the culling kernels
+ */
+struct PackedPlanes_t {
+    float nx[6];
+    float ny[6];
+    float nz[6];
+    float d[6];
+};
+
+#if HAVE_SSE
+// The culling kernels return the number of spheres that they processed, the remaining ones are left to the scalar
+// loop. The distances are computed in the same order as Sphere::IntersectsPlane so that the results are identical
+SIMD_TARGET("sse2")
+static size_t CullSpheresSSE2(const PackedPlanes_t& planes, const float* centersX, const float* centersY,
+                              const float* centersZ, const float* radii, size_t count, uint32_t* visibility,
+                              size_t& numVisible)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(centersX + i);
+        __m128 y = _mm_loadu_ps(centersY + i);
+        __m128 z = _mm_loadu_ps(centersZ + i);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radii + i));
+        __m128 outside = _mm_setzero_ps();
+
+        for (size_t j = 0; j < 6; j++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.nx[j]), x),
+                                                               _mm_mul_ps(_mm_set1_ps(planes.ny[j]), y)),
+                                                    _mm_mul_ps(_mm_set1_ps(planes.nz[j]), z)),
+                                         _mm_set1_ps(planes.d[j]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negRadius));
+        }
+
+        uint32_t visible = ~_mm_movemask_ps(outside) & 0xF;
+        visibility[i / 32] |= visible << (i % 32);
+        for (uint32_t bits = visible; bits != 0; bits &= bits - 1) {
+            numVisible += 1;
+        }
+    }
+
+    return i;
+}
+
+SIMD_TARGET("avx")
+static size_t CullSpheresAVX(const PackedPlanes_t& planes, const float* centersX, const float* centersY,
+                             const float* centersZ, const float* radii, size_t count, uint32_t* visibility,
+                             size_t& numVisible)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(centersX + i);
+        __m256 y = _mm256_loadu_ps(centersY + i);
+        __m256 z = _mm256_loadu_ps(centersZ + i);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radii + i));
+        __m256 outside = _mm256_setzero_ps();
+
+        // No FMA, it would round differently than the scalar test
+        for (size_t j = 0; j < 6; j++) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.nx[j]), x),
+                                                                        _mm256_mul_ps(_mm256_set1_ps(planes.ny[j]), y)),
+                                                          _mm256_mul_ps(_mm256_set1_ps(planes.nz[j]), z)),
+                                            _mm256_set1_ps(planes.d[j]));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negRadius, _CMP_LT_OQ));
+        }
+
+        uint32_t visible = ~_mm256_movemask_ps(outside) & 0xFF;
+        visibility[i / 32] |= visible << (i % 32);
+        for (uint32_t bits = visible; bits != 0; bits &= bits - 1) {
+            numVisible += 1;
+        }
+    }
+
+    return i;
+}
+#endif
+
+bool FrustumPlanes_t::IsSphereOutside(const Sphere& sphere) const {
+    return sphere.IntersectsPlane(nearPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
+           sphere.IntersectsPlane(farPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
+           sphere.IntersectsPlane(leftPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
+           sphere.IntersectsPlane(rightPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
+           sphere.IntersectsPlane(bottomPlane) == RELATIVE_PLANE_POSITION_OUTSIDE ||
+           sphere.IntersectsPlane(topPlane) == RELATIVE_PLANE_POSITION_OUTSIDE;
+}
+
+size_t FrustumPlanes_t::CullSpheres(const float* centersX, const float* centersY, const float* centersZ,
+                                    const float* radii, size_t count, uint32_t* visibility) const
+{
+    const Plane* frustumPlanes[6] = { &nearPlane, &farPlane, &leftPlane, &rightPlane, &bottomPlane, &topPlane };
+    PackedPlanes_t planes;
+    for (size_t i = 0; i < 6; i++) {
+        const Vector3& normal = frustumPlanes[i]->GetNormal();
+        planes.nx[i] = normal.x;
+        planes.ny[i] = normal.y;
+        planes.nz[i] = normal.z;
+        planes.d[i] = frustumPlanes[i]->GetDistance();
+    }
+
+    for (size_t i = 0; i < (count + 31) / 32; i++) {
+        visibility[i] = 0;
+    }
+
+    size_t numVisible = 0;
+    size_t i = 0;
+
+#if HAVE_SSE
+    if (PlatformInformation::HasCpuFeature(PlatformInformation::AVX)) {
+        i = CullSpheresAVX(planes, centersX, centersY, centersZ, radii, count, visibility, numVisible);
+    } else if (PlatformInformation::HasCpuFeature(PlatformInformation::SSE2)) {
+        i = CullSpheresSSE2(planes, centersX, centersY, centersZ, radii, count, visibility, numVisible);
+    }
+#endif
+
+    for (; i < count; i++) {
+        bool outside = false;
+        for (size_t j = 0; j < 6; j++) {
+            float distance = planes.nx[j] * centersX[i] + planes.ny[j] * centersY[i] + planes.nz[j] * centersZ[i] +
+                             planes.d[j];
+            outside = outside || distance < -radii[i];
+        }
+
+        if (!outside) {
+            visibility[i / 32] |= 1u << (i % 32);
+            numVisible += 1;
+        }
+    }
+
+    return numVisible;
+}
+
+void BoundingSpheres_t::Add(const Vector3& center, float radius) {
+    centersX.push_back(center.x);
+    centersY.push_back(center.y);
+    centersZ.push_back(center.z);
+    radii.push_back(radius);
+}
+
+void BoundingSpheres_t::Clear() {
+    centersX.clear();
+    centersY.clear();
+    centersZ.clear();
+    radii.clear();
+}
+
+size_t BoundingSpheres_t::Size() const {
+    return radii.size();
+}
+
 bool ParseConfigFile(const string& filename, ConfigFileAttributes_t& configFileAttributes) {
     // Default values
     configFileAttributes.renderSystem = RENDER_SYSTEM_OPENGL;
@@ -49,6 +206,8 @@ bool ParseConfigFile(const string& filename, ConfigFileAttributes_t& configFileA
                 configFileAttributes.renderSystem = RENDER_SYSTEM_OPENGL;
             } else if (value == "Direct3D9") {
                 configFileAttributes.renderSystem = RENDER_SYSTEM_DIRECT3D9;
+            } else if (value == "Null") {
+                configFileAttributes.renderSystem = RENDER_SYSTEM_NULL;
             } else {
                 Logger::GetInstance()->Warning("Unsupported render system: " + value);
             }
@@ -6,9 +6,14 @@
 #include "render/Node.h"
 #include "render/Renderer.h"
 #include "render/RenderQueue.h"
+#include "render/RenderSystem.h"
 #include "render/Shader.h"
 #include "render/Texture2D.h"
 
+#include "system/Profiler.h"
+#include "system/ThreadPool.h"
+
+#include <algorithm>
 #include <queue>
 #include <vector>
 using namespace std;
@@ -18,10 +23,21 @@ using namespace std;
 
 namespace Sketch3D {
 
-SceneTree::SceneTree() {
+// Each thread gets this many groups of top level nodes on average, so that the work stays balanced when the subtrees
+// don't have the same size
+const size_t TRAVERSAL_TASKS_PER_THREAD = 4;
+
+SceneTree::SceneTree() : threadPool_(nullptr), retainedFrustumCulling_(false) {
+    traversalBuffers_.push_back(new SceneTraversalBuffer_t);
 }
 
 SceneTree::~SceneTree() {
+    delete threadPool_;
+
+    for (size_t i = 0; i < traversalBuffers_.size(); i++) {
+        delete traversalBuffers_[i];
+    }
+
     // Free the static batches
     StaticBatches_t::iterator it = staticBatches_.begin();
     for (; it != staticBatches_.end(); ++it) {
@@ -47,16 +63,196 @@ SceneTree::~SceneTree() {
 }
 
 void SceneTree::Render(const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling, RenderQueue& opaqueRenderQueue, RenderQueue& transparentRenderQueue) {
+    PROFILE_ZONE("SceneTree::Render");
+
+    if (opaqueRenderQueue.IsRetainedMode()) {
+        RenderRetained(frustumPlanes, useFrustumCulling, opaqueRenderQueue, transparentRenderQueue);
+        return;
+    }
+
+    topLevelNodes_.clear();
     map<string, Node*>::iterator it = root_.children_.begin();
     for (; it != root_.children_.end(); ++it) {
-        it->second->Render(frustumPlanes, useFrustumCulling, opaqueRenderQueue, transparentRenderQueue);
+        topLevelNodes_.push_back(it->second);
+    }
+
+    FrameStats_t& frameStats = Renderer::GetInstance()->GetRenderSystem()->GetFrameStats();
+
+    if (threadPool_ == nullptr || topLevelNodes_.size() < 2) {
+        CollectVisibleNodes(topLevelNodes_.data(), topLevelNodes_.size(), frustumPlanes, useFrustumCulling, *traversalBuffers_[0],
+                            opaqueRenderQueue, transparentRenderQueue);
+        frameStats.nodesVisited += traversalBuffers_[0]->renderableNodes.size();
+        frameStats.nodesCulled += traversalBuffers_[0]->numCulledNodes;
+        return;
+    }
+
+    // Split the top level nodes in contiguous groups, each one with its own render queues
+    size_t numberOfTasks = min(topLevelNodes_.size(), threadPool_->GetNumberOfThreads() * TRAVERSAL_TASKS_PER_THREAD);
+    while (traversalBuffers_.size() < numberOfTasks) {
+        traversalBuffers_.push_back(new SceneTraversalBuffer_t);
+    }
+
+    threadPool_->Run(numberOfTasks, [&](size_t task) {
+        size_t first = topLevelNodes_.size() * task / numberOfTasks;
+        size_t last = topLevelNodes_.size() * (task + 1) / numberOfTasks;
+        SceneTraversalBuffer_t& buffer = *traversalBuffers_[task];
+
+        CollectVisibleNodes(&topLevelNodes_[first], last - first, frustumPlanes, useFrustumCulling, buffer,
+                            buffer.opaqueRenderQueue, buffer.transparentRenderQueue);
+    });
+
+    // Merging the groups in order gives the same items as if they were added by a single thread
+    {
+        PROFILE_ZONE("SceneTree::MergeRenderQueues");
+        for (size_t i = 0; i < numberOfTasks; i++) {
+            opaqueRenderQueue.Merge(traversalBuffers_[i]->opaqueRenderQueue);
+            transparentRenderQueue.Merge(traversalBuffers_[i]->transparentRenderQueue);
+            frameStats.nodesVisited += traversalBuffers_[i]->renderableNodes.size();
+            frameStats.nodesCulled += traversalBuffers_[i]->numCulledNodes;
+        }
     }
 }
 
+void SceneTree::CollectVisibleNodes(Node* const* nodes, size_t numNodes, const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling,
+                                    SceneTraversalBuffer_t& buffer, RenderQueue& opaqueRenderQueue, RenderQueue& transparentRenderQueue)
+{
+    PROFILE_ZONE("SceneTree::CollectVisibleNodes");
+
+    vector<Node*>& renderableNodes = buffer.renderableNodes;
+    vector<uint32_t>& visibility = buffer.visibility;
+    BoundingSpheres_t& boundingSpheres = buffer.boundingSpheres;
+
+    renderableNodes.clear();
+    boundingSpheres.Clear();
+    buffer.numCulledNodes = 0;
+
+    for (size_t i = 0; i < numNodes; i++) {
+        nodes[i]->CollectRenderableNodes(renderableNodes, (useFrustumCulling) ? &boundingSpheres : nullptr);
+    }
+
+    // Cull all the nodes at once
+    if (useFrustumCulling && !renderableNodes.empty()) {
+        visibility.resize((renderableNodes.size() + 31) / 32);
+        frustumPlanes.CullSpheres(&boundingSpheres.centersX[0], &boundingSpheres.centersY[0], &boundingSpheres.centersZ[0],
+                                  &boundingSpheres.radii[0], boundingSpheres.Size(), &visibility[0]);
+    }
+
+    for (size_t i = 0; i < renderableNodes.size(); i++) {
+        if (useFrustumCulling && (visibility[i / 32] & (1u << (i % 32))) == 0) {
+            buffer.numCulledNodes += 1;
+            continue;
+        }
+
+        Node* node = renderableNodes[i];
+        if (node->GetMaterial()->GetTransluencyType() == TRANSLUENCY_TYPE_OPAQUE) {
+            opaqueRenderQueue.AddNode(node);
+        } else {
+            transparentRenderQueue.AddNode(node);
+        }
+    }
+}
+
+void SceneTree::RenderRetained(const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling, RenderQueue& opaqueRenderQueue,
+                               RenderQueue& transparentRenderQueue)
+{
+    PROFILE_ZONE("SceneTree::RenderRetained");
+
+    // The distance of all the nodes to the camera and their visibility have to be computed again when the camera moves,
+    // but the items of the nodes that didn't change are kept
+    const Matrix4x4& view = Renderer::GetInstance()->GetViewMatrix();
+    const Matrix4x4& projection = Renderer::GetInstance()->GetProjectionMatrix();
+    bool cameraChanged = view != retainedViewMatrix_ || projection != retainedProjectionMatrix_ ||
+                         useFrustumCulling != retainedFrustumCulling_;
+    retainedViewMatrix_ = view;
+    retainedProjectionMatrix_ = projection;
+    retainedFrustumCulling_ = useFrustumCulling;
+
+    SceneTraversalBuffer_t& buffer = *traversalBuffers_[0];
+    vector<Node*>& renderableNodes = buffer.renderableNodes;
+    vector<uint32_t>& visibility = buffer.visibility;
+    BoundingSpheres_t& boundingSpheres = buffer.boundingSpheres;
+
+    renderableNodes.clear();
+    boundingSpheres.Clear();
+    updatedNodes_.clear();
+    retainedNodes_.clear();
+
+    map<string, Node*>::iterator it = root_.children_.begin();
+    for (; it != root_.children_.end(); ++it) {
+        it->second->CollectRenderableNodes(renderableNodes, nullptr);
+    }
+
+    // The parents come before their children, so the transformation of a parent is updated before its children check it
+    for (size_t i = 0; i < renderableNodes.size(); i++) {
+        Node* node = renderableNodes[i];
+        RenderQueue& renderQueue = (node->GetMaterial()->GetTransluencyType() == TRANSLUENCY_TYPE_OPAQUE) ? opaqueRenderQueue :
+                                                                                                            transparentRenderQueue;
+        bool isRetained = renderQueue.RetainNode(node);
+        if (isRetained && !cameraChanged) {
+            continue;
+        }
+
+        updatedNodes_.push_back(node);
+        retainedNodes_.push_back(isRetained);
+        if (useFrustumCulling) {
+            node->AddBoundingSphere(boundingSpheres);
+        } else {
+            node->ConstructModelMatrix();
+        }
+    }
+
+    // Cull the updated nodes at once
+    if (useFrustumCulling && !updatedNodes_.empty()) {
+        visibility.resize((updatedNodes_.size() + 31) / 32);
+        frustumPlanes.CullSpheres(&boundingSpheres.centersX[0], &boundingSpheres.centersY[0], &boundingSpheres.centersZ[0],
+                                  &boundingSpheres.radii[0], boundingSpheres.Size(), &visibility[0]);
+    }
+
+    // Only the nodes that were updated or refreshed go through the culling, the other ones keep their visibility of the
+    // last frame
+    FrameStats_t& frameStats = Renderer::GetInstance()->GetRenderSystem()->GetFrameStats();
+    frameStats.nodesVisited += renderableNodes.size();
+
+    for (size_t i = 0; i < updatedNodes_.size(); i++) {
+        Node* node = updatedNodes_[i];
+        bool isVisible = !useFrustumCulling || (visibility[i / 32] & (1u << (i % 32))) != 0;
+        if (!isVisible) {
+            frameStats.nodesCulled += 1;
+        }
+
+        RenderQueue& renderQueue = (node->GetMaterial()->GetTransluencyType() == TRANSLUENCY_TYPE_OPAQUE) ? opaqueRenderQueue :
+                                                                                                            transparentRenderQueue;
+        if (retainedNodes_[i]) {
+            renderQueue.RefreshRetainedNode(node, isVisible);
+        } else {
+            renderQueue.UpdateRetainedNode(node, isVisible);
+        }
+    }
+}
+
+void SceneTree::SetNumberOfThreads(size_t numberOfThreads) {
+    if (numberOfThreads == 0) {
+        numberOfThreads = 1;
+    }
+
+    if (numberOfThreads == GetNumberOfThreads()) {
+        return;
+    }
+
+    delete threadPool_;
+    threadPool_ = (numberOfThreads > 1) ? new ThreadPool(numberOfThreads) : nullptr;
+}
+
+size_t SceneTree::GetNumberOfThreads() const {
+    return (threadPool_ != nullptr) ? threadPool_->GetNumberOfThreads() : 1;
+}
+
 void SceneTree::RenderStaticBatches() const {
     const Matrix4x4& viewProjectionMatrix = Renderer::GetInstance()->GetViewProjectionMatrix();
     const Matrix4x4& viewMatrix = Renderer::GetInstance()->GetViewMatrix();
-    const Matrix4x4& transposedInverseViewMatrix = viewMatrix.Inverse().Transpose();
+    const Matrix4x4& transposedInverseViewMatrix = viewMatrix.InverseAffine().Transpose();
+    Renderer::GetInstance()->GetRenderSystem()->SetCameraUniforms(viewMatrix, Renderer::GetInstance()->GetProjectionMatrix(),
+                                                                  viewProjectionMatrix);
 
     StaticBatches_t::const_iterator it = staticBatches_.begin();
     for (; it != staticBatches_.end(); ++it) {
@@ -65,9 +261,11 @@ void SceneTree::RenderStaticBatches() const {
         // Bind the shader for the following render
         Shader* shader = it->first;
         Renderer::GetInstance()->BindShader(shader);
-        shader->SetUniformMatrix4x4("viewProjection", viewProjectionMatrix);
-        shader->SetUniformMatrix4x4("view", viewMatrix);
-        shader->SetUniformMatrix4x4("transInvView", transposedInverseViewMatrix);
+        if (!shader->UsesCameraUniformBlock()) {
+            shader->SetUniformMatrix4x4(shader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW_PROJECTION), viewProjectionMatrix);
+            shader->SetUniformMatrix4x4(shader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW), viewMatrix);
+            shader->SetUniformMatrix4x4(shader->GetBuiltinUniformHandle(BuiltinUniform_t::TRANS_INV_VIEW), transposedInverseViewMatrix);
+        }
 
         for (; ttb_it != it->second.end(); ++ttb_it) {
             const TexturesBuffersPair_t& texturesToBuffers = ttb_it->second;
@@ -79,7 +277,8 @@ void SceneTree::RenderStaticBatches() const {
             size_t numTextures = texturesToBind.first;
             Texture2D** textures = texturesToBind.second;
             for (size_t i = 0; i < numTextures; i++) {
-                shader->SetUniformTexture("texture" + to_string(i), textures[i]);
+                BuiltinUniform_t builtinUniformTexture = (BuiltinUniform_t)((size_t)BuiltinUniform_t::TEXTURE_0 + i);
+                shader->SetUniformTexture(shader->GetBuiltinUniformHandle(builtinUniformTexture), textures[i]);
             }
 
             // Render the actual buffer contents
@@ -153,13 +352,16 @@ void SceneTree::PerformStaticBatching() {
     // Construct the actual static batches.
     // Because there can be more than one texture per surface, we sort by textures now and
     // attribute a unique id which depends of the combination of textures used
-    typedef pair<vector<float>, vector<unsigned short>> BufferObjectData_t;
+    typedef pair<vector<float>, vector<unsigned int>> BufferObjectData_t;
     typedef pair<VertexAttributesMap_t, BufferObjectData_t> AttributesDataPair_t;
     typedef pair<size_t, AttributesDataPair_t> VertexAttributesPair_t;
     typedef map<size_t, vector<VertexAttributesPair_t>> TexturesToBufferDataMap_t;
 
     map<size_t, size_t> texturesId;
 
+    // A batch can't hold more vertices than the device is able to index
+    size_t maxVertexIndex = Renderer::GetInstance()->GetRenderSystem()->GetDeviceCapabilities()->maxVertexIndex_;
+
     // Shaders
     map<Shader*, map<size_t, vector<Node*>>>::iterator it = staticBatches.begin();
     for (; it != staticBatches.end(); ++it) {
@@ -173,7 +375,7 @@ void SceneTree::PerformStaticBatching() {
             TexturesToBufferDataMap_t texturesToBufferData;
             for (size_t i = 0; i < n_it->second.size(); i++) {
                 const Matrix4x4& modelMatrix = n_it->second[i]->ConstructModelMatrix();
-                const Matrix3x3& transposedInverseModelMatrix = modelMatrix.Inverse().Transpose();
+                const Matrix3x3& transposedInverseModelMatrix = modelMatrix.InverseAffine().Transpose();
 
                 Mesh* mesh = n_it->second[i]->GetMesh();
 
@@ -248,15 +450,12 @@ void SceneTree::PerformStaticBatching() {
                     bool hasTangents = transformedSurface->numTangents > 0;
 
                     transformedSurface->vertices = new Vector3[transformedSurface->numVertices];
-                    for (size_t k = 0; k < transformedSurface->numVertices; k++) {
-                        transformedSurface->vertices[k] = modelMatrix * surface->vertices[k];
-                    }
+                    modelMatrix.TransformPoints(surface->vertices, transformedSurface->vertices, transformedSurface->numVertices);
 
                     if (hasNormals) {
                         transformedSurface->normals = new Vector3[transformedSurface->numNormals];
-                        for (size_t k = 0; k < transformedSurface->numNormals; k++) {
-                            transformedSurface->normals[k] = (transposedInverseModelMatrix * surface->normals[k]).Normalized();
-                        }
+                        transposedInverseModelMatrix.TransformNormals(surface->normals, transformedSurface->normals,
+                                                                      transformedSurface->numNormals);
                     }
 
                     if (hasTexCoords) {
@@ -268,9 +467,8 @@ void SceneTree::PerformStaticBatching() {
 
                     if (hasTangents) {
                         transformedSurface->tangents = new Vector3[transformedSurface->numTangents];
-                        for (size_t k = 0; k < transformedSurface->numTangents; k++) {
-                            transformedSurface->tangents[k] = (modelMatrix * surface->tangents[k]).Normalized();
-                        }
+                        modelMatrix.TransformNormals(surface->tangents, transformedSurface->tangents,
+                                                     transformedSurface->numTangents);
                     }
                     preTransformedSurfaces_.push_back(transformedSurface);
 
@@ -284,20 +482,21 @@ void SceneTree::PerformStaticBatching() {
                         VertexAttributesPair_t& bufferObjectData = bufferData[k];
                         AttributesDataPair_t& attributesPair = bufferObjectData.second;
                         vector<float>& bufferVertices = attributesPair.second.first;
-                        vector<unsigned short>& bufferIndices = attributesPair.second.second;
+                        vector<unsigned int>& bufferIndices = attributesPair.second.second;
 
                         // Buffer object must have the same vertex attributes as the node being processed
                         if (bufferObjectData.first != n_it->first) {
                             continue;
                         }
 
-                        // There must be enough space to append the vertices
-                        if ( ((bufferVertices.size() + vertexData.size()) / (stride / sizeof(float))) > 65535) {
+                        // There must be enough space to append the vertices. The buffer object switches to 32 bit
+                        // indices by itself once the batch has more than 65536 vertices, if the device supports them
+                        if ((bufferVertices.size() + vertexData.size()) / (stride / sizeof(float)) - 1 > maxVertexIndex) {
                             continue;
                         }
 
                         // We have to start at the next index in the buffer
-                        unsigned short startIdx = bufferVertices.size() / (stride / sizeof(float));
+                        unsigned int startIdx = bufferVertices.size() / (stride / sizeof(float));
 
                         bufferVertices.reserve(bufferVertices.size() + vertexData.size());
                         for (size_t l = 0; l < vertexData.size(); l++) {
@@ -315,7 +514,7 @@ void SceneTree::PerformStaticBatching() {
 
                     if (!foundValidBuffer) {
                         vector<float> newVertexData;
-                        vector<unsigned short> newIndexData;
+                        vector<unsigned int> newIndexData;
                         newVertexData.reserve(vertexData.size());
                         newIndexData.reserve(surface->numIndices);
 
@@ -354,7 +553,7 @@ void SceneTree::PerformStaticBatching() {
                     BufferObjectData_t& bufferData = attributesPair.second;
 
                     vector<float>& vertexData = bufferData.first;
-                    vector<unsigned short>& indexData = bufferData.second;
+                    vector<unsigned int>& indexData = bufferData.second;
 
                     BufferObject* bufferObject = Renderer::GetInstance()->GetBufferObjectManager()->CreateBufferObject(vertexAttributes);
                     bufferObject->SetVertexData(vertexData, presentVertexAttributes);
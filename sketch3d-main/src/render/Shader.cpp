@@ -23,7 +23,13 @@ string builtUniformNames[] = {
 
 uint16_t Shader::nextAvailableId_ = 0;
 
-Shader::Shader() : id_(MAX_SHADER_ID) {
+Shader::Shader() : id_(MAX_SHADER_ID), supportsInstancing_(false), usesCameraUniformBlock_(false), linkCount_(0),
+        appliedMaterial_(NO_APPLIED_MATERIAL)
+{
+    for (size_t i = 0; i < NUM_BUILTIN_UNIFORMS; i++) {
+        builtinUniformHandles_[i] = INVALID_UNIFORM_HANDLE;
+    }
+
     if (nextAvailableId_ == MAX_SHADER_ID) {
         Logger::GetInstance()->Error("Maximum number of shaders created (" + to_string(MAX_SHADER_ID) + ")");
     } else {
@@ -34,6 +40,162 @@ Shader::Shader() : id_(MAX_SHADER_ID) {
 Shader::~Shader() {
 }
 
+void Shader::SetSupportsInstancing(bool supportsInstancing) {
+    supportsInstancing_ = supportsInstancing;
+}
+
+bool Shader::SupportsInstancing() const {
+    return supportsInstancing_;
+}
+
+bool Shader::SetUniformInt(const string& uniform, int value) {
+    return SetUniformInt(FindUniformHandle(uniform), value);
+}
+
+bool Shader::SetUniformFloat(const string& uniform, float value) {
+    return SetUniformFloat(FindUniformHandle(uniform), value);
+}
+
+bool Shader::SetUniformVector2(const string& uniform, float value1, float value2) {
+    return SetUniformVector2(FindUniformHandle(uniform), value1, value2);
+}
+
+bool Shader::SetUniformVector3(const string& uniform, const Vector3& value) {
+    return SetUniformVector3(FindUniformHandle(uniform), value);
+}
+
+bool Shader::SetUniformVector3Array(const string& uniform, const Vector3* values, int arraySize) {
+    return SetUniformVector3Array(FindUniformHandle(uniform), values, arraySize);
+}
+
+bool Shader::SetUniformVector4(const string& uniform, const Vector4& value) {
+    return SetUniformVector4(FindUniformHandle(uniform), value);
+}
+
+bool Shader::SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value) {
+    return SetUniformMatrix3x3(FindUniformHandle(uniform), value);
+}
+
+bool Shader::SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value) {
+    return SetUniformMatrix4x4(FindUniformHandle(uniform), value);
+}
+
+bool Shader::SetUniformMatrix4x4Array(const string& uniform, const Matrix4x4* values, int arraySize) {
+    return SetUniformMatrix4x4Array(FindUniformHandle(uniform), values, arraySize);
+}
+
+bool Shader::SetUniformTexture(const string& uniform, const Texture* texture) {
+    return SetUniformTexture(FindUniformHandle(uniform), texture);
+}
+
+bool Shader::SetUniformInt(UniformHandle_t uniform, int value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformIntImpl(uniform, value);
+    return true;
+}
+
+bool Shader::SetUniformFloat(UniformHandle_t uniform, float value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformFloatImpl(uniform, value);
+    return true;
+}
+
+bool Shader::SetUniformVector2(UniformHandle_t uniform, float value1, float value2) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformVector2Impl(uniform, value1, value2);
+    return true;
+}
+
+bool Shader::SetUniformVector3(UniformHandle_t uniform, const Vector3& value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformVector3Impl(uniform, value);
+    return true;
+}
+
+bool Shader::SetUniformVector3Array(UniformHandle_t uniform, const Vector3* values, int arraySize) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformVector3ArrayImpl(uniform, values, arraySize);
+    return true;
+}
+
+bool Shader::SetUniformVector4(UniformHandle_t uniform, const Vector4& value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformVector4Impl(uniform, value);
+    return true;
+}
+
+bool Shader::SetUniformMatrix3x3(UniformHandle_t uniform, const Matrix3x3& value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformMatrix3x3Impl(uniform, value);
+    return true;
+}
+
+bool Shader::SetUniformMatrix4x4(UniformHandle_t uniform, const Matrix4x4& value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformMatrix4x4Impl(uniform, value);
+    return true;
+}
+
+bool Shader::SetUniformMatrix4x4Array(UniformHandle_t uniform, const Matrix4x4* values, int arraySize) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformMatrix4x4ArrayImpl(uniform, values, arraySize);
+    return true;
+}
+
+bool Shader::SetUniformTexture(UniformHandle_t uniform, const Texture* texture) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    SetUniformTextureImpl(uniform, texture);
+    return true;
+}
+
+void Shader::ResolveBuiltinUniforms() {
+    for (size_t i = 0; i < NUM_BUILTIN_UNIFORMS; i++) {
+        builtinUniformHandles_[i] = GetUniformHandle(builtUniformNames[i]);
+    }
+
+    linkCount_++;
+    appliedMaterial_ = NO_APPLIED_MATERIAL;
+}
+
+UniformHandle_t Shader::FindUniformHandle(const string& uniform) const {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniform + " in shader #" + to_string(id_));
+    }
+
+    return handle;
+}
+
 void SetBuiltinUniformName(BuiltinUniform_t builtinUniform, const string& uniformName) {
     builtUniformNames[builtinUniform] = uniformName;
 }
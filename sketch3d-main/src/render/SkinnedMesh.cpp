@@ -11,6 +11,7 @@
 #include "render/TextureManager.h"
 
 #include "system/Logger.h"
+#include "system/Profiler.h"
 #include "system/Utils.h"
 
 #include <assimp/Importer.hpp>
@@ -435,6 +436,8 @@ void SkinnedMesh::Initialize(const VertexAttributesMap_t& vertexAttributes) {
 }
 
 bool SkinnedMesh::Animate(double deltaTime, vector<Matrix4x4>& boneTransformationMatrices) {
+    PROFILE_ZONE("SkinnedMesh::Animate");
+
     if (currentAnimationState_ == nullptr) {
         return false;
     }
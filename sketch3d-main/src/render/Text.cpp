@@ -191,7 +191,7 @@ void Text::Write(const string& text, size_t x, size_t y) {
         textVertices_.push_back((xPos + slot->bitmap.width * yScale) / halfScreenWidth - 1.0f); textVertices_.push_back(yPos / halfScreenHeight - 1.0f); textVertices_.push_back(0.0f);
         textVertices_.push_back(u + uWidth); textVertices_.push_back(0.0f);
 
-        unsigned short idx = 0;
+        unsigned int idx = 0;
         if (!textIndices_.empty()) {
             idx = textIndices_.back() + ((Renderer::GetInstance()->GetCullingMethod() == CULLING_METHOD_BACK_FACE) ? 2 : 1);
         }
@@ -190,11 +190,30 @@ namespace Sketch3D
 #endif
     }
 
+    static bool CheckOperatingSystemSupportAVX()
+    {
+        // The OS must save the upper halves of the ymm registers on context
+        // switches, which is reported by the XCR0 register
+        unsigned int xcr0 = 0;
+#if COMPILER == COMPILER_MSVC
+#   if _MSC_VER >= 1600
+        xcr0 = (unsigned int)_xgetbv(0);
+#   endif
+#elif COMPILER == COMPILER_GNUC
+        unsigned int edx;
+        __asm__ __volatile__ ("xgetbv" : "=a" (xcr0), "=d" (edx) : "c" (0));
+#endif
+        return (xcr0 & 0x6) == 0x6;
+    }
+
     static unsigned int QueryCpuFeatures()
     {
 #define CPUID_STD_MMX       (1 << 23)
 #define CPUID_STD_SSE       (1 << 25)
 #define CPUID_STD_SSE2      (1 << 26)
+#define CPUID_FEAT_FMA      (1 << 12)
+#define CPUID_FEAT_OSXSAVE  (1 << 27)
+#define CPUID_FEAT_AVX      (1 << 28)
 
         unsigned int features = 0;
         if (SupportCpuid()) {
@@ -232,6 +251,16 @@ namespace Sketch3D
                         features |= PlatformInformation::SSE2;
 						Logger::GetInstance()->Info("SSE2 supported");
                     }
+
+                    if ((result._ecx & CPUID_FEAT_AVX) && (result._ecx & CPUID_FEAT_OSXSAVE)) {
+                        features |= PlatformInformation::AVX;
+						Logger::GetInstance()->Info("AVX supported");
+                    }
+
+                    if (result._ecx & CPUID_FEAT_FMA) {
+                        features |= PlatformInformation::FMA;
+						Logger::GetInstance()->Info("FMA supported");
+                    }
 				}
             }
         } else {
@@ -252,6 +281,14 @@ namespace Sketch3D
             features &= ~sse_features;
         }
 
+        // FMA uses the ymm registers as well, so it is unusable without AVX
+        const unsigned int avx_features = PlatformInformation::AVX |
+            PlatformInformation::FMA;
+        if ((features & avx_features) && (!(features & PlatformInformation::AVX) ||
+                                          !CheckOperatingSystemSupportAVX())) {
+            features &= ~avx_features;
+        }
+
         return features;
     }
 
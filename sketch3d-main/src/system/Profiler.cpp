@@ -0,0 +1,139 @@
+#include "system/Profiler.h"
+
+#include "system/Logger.h"
+
+#include <chrono>
+#include <fstream>
+
+#if COMPILER == COMPILER_MSVC
+#   define THREAD_LOCAL __declspec(thread)
+#else
+#   define THREAD_LOCAL thread_local
+#endif
+
+namespace Sketch3D {
+
+// Buffer of the calling thread. The buffers are owned by the profiler since their events must outlive the thread
+static THREAD_LOCAL ProfilerThreadBuffer_t* threadBuffer = nullptr;
+
+static long long GetMicroseconds() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void WriteJsonString(ofstream& file, const char* str) {
+    file << '"';
+    for (; *str != '\0'; str++) {
+        switch (*str) {
+            case '"':  file << "\\\""; break;
+            case '\\': file << "\\\\"; break;
+            case '\n': file << "\\n"; break;
+            case '\t': file << "\\t"; break;
+            default:   file << *str; break;
+        }
+    }
+    file << '"';
+}
+
+Profiler Profiler::instance_;
+
+Profiler::Profiler() : enabled_(false), epoch_(GetMicroseconds()) {
+}
+
+Profiler::~Profiler() {
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        delete threadBuffers_[i];
+    }
+}
+
+Profiler* Profiler::GetInstance() {
+    return &instance_;
+}
+
+void Profiler::SetEnabled(bool enabled) {
+    enabled_.store(enabled, memory_order_relaxed);
+}
+
+void Profiler::Clear() {
+    lock_guard<mutex> buffersLock(buffersLock_);
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        lock_guard<mutex> lock(threadBuffers_[i]->lock);
+        threadBuffers_[i]->events.clear();
+    }
+}
+
+void Profiler::RecordZone(const char* name, long long start, long long end) {
+    ProfilerThreadBuffer_t* buffer = GetThreadBuffer();
+    ProfilerEvent_t event = { name, start, end };
+
+    lock_guard<mutex> lock(buffer->lock);
+    buffer->events.push_back(event);
+}
+
+bool Profiler::ExportChromeTrace(const string& filename) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        Logger::GetInstance()->Error("Couldn't open profiler trace file: " + filename);
+        return false;
+    }
+
+    file << "{\"traceEvents\":[";
+
+    bool first = true;
+    lock_guard<mutex> buffersLock(buffersLock_);
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        ProfilerThreadBuffer_t* buffer = threadBuffers_[i];
+        lock_guard<mutex> lock(buffer->lock);
+
+        file << (first ? "\n" : ",\n");
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->threadIndex <<
+                ",\"args\":{\"name\":\"Thread " << buffer->threadIndex << "\"}}";
+        first = false;
+
+        for (size_t j = 0; j < buffer->events.size(); j++) {
+            const ProfilerEvent_t& event = buffer->events[j];
+            file << ",\n{\"name\":";
+            WriteJsonString(file, event.name);
+            file << ",\"cat\":\"sketch-3d\",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" <<
+                    event.end - event.start << ",\"pid\":0,\"tid\":" << buffer->threadIndex << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    if (!file.good()) {
+        Logger::GetInstance()->Error("Couldn't write profiler trace file: " + filename);
+        return false;
+    }
+
+    Logger::GetInstance()->Info("Profiler trace written to: " + filename);
+    return true;
+}
+
+size_t Profiler::GetNumberOfEvents() {
+    size_t numberOfEvents = 0;
+
+    lock_guard<mutex> buffersLock(buffersLock_);
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        lock_guard<mutex> lock(threadBuffers_[i]->lock);
+        numberOfEvents += threadBuffers_[i]->events.size();
+    }
+
+    return numberOfEvents;
+}
+
+long long Profiler::GetTime() const {
+    return GetMicroseconds() - epoch_;
+}
+
+ProfilerThreadBuffer_t* Profiler::GetThreadBuffer() {
+    if (threadBuffer == nullptr) {
+        lock_guard<mutex> buffersLock(buffersLock_);
+        threadBuffer = new ProfilerThreadBuffer_t;
+        threadBuffer->threadIndex = threadBuffers_.size();
+        threadBuffers_.push_back(threadBuffer);
+    }
+
+    return threadBuffer;
+}
+
+}
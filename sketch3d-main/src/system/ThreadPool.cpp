@@ -0,0 +1,88 @@
+#include "system/ThreadPool.h"
+
+namespace Sketch3D {
+
+ThreadPool::ThreadPool(size_t numberOfThreads) : task_(nullptr), numberOfTasks_(0), nextTask_(0), numberOfBusyThreads_(0),
+        generation_(0), stop_(false)
+{
+    for (size_t i = 1; i < numberOfThreads; i++) {
+        threads_.push_back(thread(&ThreadPool::WorkerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(lock_);
+        stop_ = true;
+    }
+    workAvailable_.notify_all();
+
+    for (size_t i = 0; i < threads_.size(); i++) {
+        threads_[i].join();
+    }
+}
+
+void ThreadPool::Run(size_t numberOfTasks, const function<void(size_t)>& task) {
+    if (threads_.empty() || numberOfTasks <= 1) {
+        for (size_t i = 0; i < numberOfTasks; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(lock_);
+        task_ = &task;
+        numberOfTasks_ = numberOfTasks;
+        nextTask_.store(0);
+        numberOfBusyThreads_ = threads_.size();
+        generation_ += 1;
+    }
+    workAvailable_.notify_all();
+
+    ExecuteTasks();
+
+    // The worker threads may still be executing their last task
+    unique_lock<mutex> lock(lock_);
+    while (numberOfBusyThreads_ > 0) {
+        workDone_.wait(lock);
+    }
+    task_ = nullptr;
+}
+
+size_t ThreadPool::GetNumberOfThreads() const {
+    return threads_.size() + 1;
+}
+
+void ThreadPool::WorkerLoop() {
+    unsigned int generation = 0;
+
+    unique_lock<mutex> lock(lock_);
+    while (true) {
+        while (!stop_ && generation == generation_) {
+            workAvailable_.wait(lock);
+        }
+
+        if (stop_) {
+            return;
+        }
+
+        generation = generation_;
+        lock.unlock();
+        ExecuteTasks();
+        lock.lock();
+
+        numberOfBusyThreads_ -= 1;
+        if (numberOfBusyThreads_ == 0) {
+            workDone_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::ExecuteTasks() {
+    for (size_t i = nextTask_.fetch_add(1); i < numberOfTasks_; i = nextTask_.fetch_add(1)) {
+        (*task_)(i);
+    }
+}
+
+}
@@ -147,3 +147,26 @@ BOOST_AUTO_TEST_CASE(test_3x3_matrix_matrix_multiply)
     BOOST_REQUIRE(n == r2);
 
 }   
+
+BOOST_AUTO_TEST_CASE(test_3x3_batch_transform)
+{
+    Matrix3x3 m(1.0f, 2.0f, 3.0f,
+                0.5f, 1.0f, 0.0f,
+                4.0f, 0.0f, 2.0f);
+
+    const size_t count = 11;
+    Vector3 vectors[count];
+    for (size_t i = 0; i < count; i++) {
+        vectors[i] = Vector3((float)i, 1.0f - (float)i * 0.5f, 2.0f);
+    }
+
+    Vector3 transformed[count];
+    Vector3 normals[count];
+    m.TransformVectors(vectors, transformed, count);
+    m.TransformNormals(vectors, normals, count);
+
+    for (size_t i = 0; i < count; i++) {
+        BOOST_REQUIRE(transformed[i] == m * vectors[i]);
+        BOOST_REQUIRE(normals[i] == (m * vectors[i]).Normalized());
+    }
+}
@@ -47,6 +47,20 @@ BOOST_AUTO_TEST_CASE(test_4x4_inverse)
     BOOST_REQUIRE(inverse.Transpose() == m.Transpose().Inverse());
 }
 
+BOOST_AUTO_TEST_CASE(test_4x4_inverse_affine)
+{
+    BOOST_REQUIRE(Matrix4x4::IDENTITY.InverseAffine() == Matrix4x4::IDENTITY);
+
+    Matrix4x4 rotation, scale, translation;
+    rotation.RotateAroundAxis(Vector3(0.0f, 0.6f, 0.8f), 35.0f * DEG_2_RAD);
+    scale.Scale(Vector3(2.0f, 0.5f, 3.0f));
+    translation.Translate(Vector3(5.0f, -10.0f, 15.0f));
+
+    Matrix4x4 m = translation * rotation * scale;
+    BOOST_REQUIRE(m.InverseAffine() == m.Inverse());
+    BOOST_REQUIRE(m * m.InverseAffine() == Matrix4x4::IDENTITY);
+}
+
 BOOST_AUTO_TEST_CASE(test_4x4_translation)
 {
     Matrix4x4 m;
@@ -156,3 +170,192 @@ BOOST_AUTO_TEST_CASE(test_4x4_matrix_matrix_multiply)
 
 }   
 
+
+// Deterministic pseudo-random matrices with values in [-10, 10] for the kernel
+// comparisons
+static Matrix4x4 RandomMatrix(unsigned int& seed)
+{
+    float data[16];
+    for (int i = 0; i < 16; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = (float)(seed >> 8) / (float)(1 << 24) * 20.0f - 10.0f;
+    }
+
+    return Matrix4x4(data);
+}
+
+static bool CompareKernelResults(const Matrix4x4& m, const Matrix4x4& reference, float tolerance)
+{
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            float diff = fabs(m[i][j] - reference[i][j]);
+            if (diff > tolerance * max(1.0f, fabs(reference[i][j]))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static const MatrixKernel_t SIMD_KERNELS[] = { MATRIX_KERNEL_SSE2, MATRIX_KERNEL_AVX_FMA };
+
+BOOST_AUTO_TEST_CASE(test_4x4_kernels_multiply)
+{
+    MatrixKernel_t previousKernel = Matrix4x4::GetKernel();
+
+    for (size_t k = 0; k < sizeof(SIMD_KERNELS) / sizeof(SIMD_KERNELS[0]); k++) {
+        unsigned int seed = 1;
+        for (int i = 0; i < 100; i++) {
+            Matrix4x4 a = RandomMatrix(seed);
+            Matrix4x4 b = RandomMatrix(seed);
+
+            BOOST_REQUIRE(Matrix4x4::SetKernel(MATRIX_KERNEL_SCALAR));
+            Matrix4x4 reference = a * b;
+
+            if (!Matrix4x4::SetKernel(SIMD_KERNELS[k])) {
+                break;
+            }
+
+            Matrix4x4 c = a * b;
+            a *= b;
+
+            // The SSE2 kernel does the same operations as the scalar one, FMA
+            // rounds differently
+            float tolerance = (SIMD_KERNELS[k] == MATRIX_KERNEL_SSE2) ? 0.0f : 0.00001f;
+            BOOST_REQUIRE(CompareKernelResults(c, reference, tolerance));
+            BOOST_REQUIRE(CompareKernelResults(a, reference, tolerance));
+        }
+    }
+
+    Matrix4x4::SetKernel(previousKernel);
+}
+
+BOOST_AUTO_TEST_CASE(test_4x4_kernels_transpose)
+{
+    MatrixKernel_t previousKernel = Matrix4x4::GetKernel();
+
+    for (size_t k = 0; k < sizeof(SIMD_KERNELS) / sizeof(SIMD_KERNELS[0]); k++) {
+        unsigned int seed = 2;
+        for (int i = 0; i < 100; i++) {
+            Matrix4x4 m = RandomMatrix(seed);
+
+            BOOST_REQUIRE(Matrix4x4::SetKernel(MATRIX_KERNEL_SCALAR));
+            Matrix4x4 reference = m.Transpose();
+
+            if (!Matrix4x4::SetKernel(SIMD_KERNELS[k])) {
+                break;
+            }
+
+            BOOST_REQUIRE(CompareKernelResults(m.Transpose(), reference, 0.0f));
+        }
+    }
+
+    Matrix4x4::SetKernel(previousKernel);
+}
+
+BOOST_AUTO_TEST_CASE(test_4x4_kernels_inverse)
+{
+    MatrixKernel_t previousKernel = Matrix4x4::GetKernel();
+
+    for (size_t k = 0; k < sizeof(SIMD_KERNELS) / sizeof(SIMD_KERNELS[0]); k++) {
+        unsigned int seed = 3;
+        for (int i = 0; i < 100; i++) {
+            // Keep the matrices well conditioned, otherwise the two algorithms
+            // legitimately diverge
+            Matrix4x4 m = RandomMatrix(seed) * 0.1f;
+            for (int j = 0; j < 4; j++) {
+                m[j][j] += 4.0f;
+            }
+
+            BOOST_REQUIRE(Matrix4x4::SetKernel(MATRIX_KERNEL_SCALAR));
+            Matrix4x4 reference = m.Inverse();
+
+            if (!Matrix4x4::SetKernel(SIMD_KERNELS[k])) {
+                break;
+            }
+
+            BOOST_REQUIRE(CompareKernelResults(m.Inverse(), reference, 0.0001f));
+        }
+    }
+
+    Matrix4x4::SetKernel(previousKernel);
+}
+
+BOOST_AUTO_TEST_CASE(test_4x4_kernels_matrix_vector_multiply)
+{
+    MatrixKernel_t previousKernel = Matrix4x4::GetKernel();
+
+    for (size_t k = 0; k < sizeof(SIMD_KERNELS) / sizeof(SIMD_KERNELS[0]); k++) {
+        unsigned int seed = 4;
+        for (int i = 0; i < 100; i++) {
+            Matrix4x4 m = RandomMatrix(seed);
+            Matrix4x4 n = RandomMatrix(seed);
+            Vector4 vec(n[0][0], n[0][1], n[0][2], n[0][3]);
+
+            BOOST_REQUIRE(Matrix4x4::SetKernel(MATRIX_KERNEL_SCALAR));
+            Vector4 reference = m * vec;
+
+            if (!Matrix4x4::SetKernel(SIMD_KERNELS[k])) {
+                break;
+            }
+
+            Vector4 w = m * vec;
+
+            if (SIMD_KERNELS[k] == MATRIX_KERNEL_SSE2) {
+                BOOST_REQUIRE(w.x == reference.x && w.y == reference.y && w.z == reference.z && w.w == reference.w);
+            } else {
+                BOOST_REQUIRE(w == reference);
+            }
+        }
+    }
+
+    Matrix4x4::SetKernel(previousKernel);
+}
+
+BOOST_AUTO_TEST_CASE(test_4x4_batch_transform)
+{
+    MatrixKernel_t previousKernel = Matrix4x4::GetKernel();
+    const MatrixKernel_t kernels[] = { MATRIX_KERNEL_SCALAR, MATRIX_KERNEL_SSE2, MATRIX_KERNEL_AVX_FMA };
+
+    // Not a multiple of the SIMD widths to also go through the remainders
+    const size_t count = 37;
+    unsigned int seed = 5;
+    Matrix4x4 m = RandomMatrix(seed) * 0.1f;
+
+    Vector3 vectors[count];
+    for (size_t i = 0; i < count; i++) {
+        Matrix4x4 n = RandomMatrix(seed) * 0.1f;
+        vectors[i] = Vector3(n[0][0], n[0][1], n[0][2]);
+    }
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (!Matrix4x4::SetKernel(kernels[k])) {
+            continue;
+        }
+
+        Vector3 points[count];
+        Vector3 directions[count];
+        Vector3 normals[count];
+        m.TransformPoints(vectors, points, count);
+        m.TransformDirections(vectors, directions, count);
+
+        // In place
+        for (size_t i = 0; i < count; i++) {
+            normals[i] = vectors[i];
+        }
+        m.TransformNormals(normals, normals, count);
+
+        for (size_t i = 0; i < count; i++) {
+            Vector4 point = m * Vector4(vectors[i].x, vectors[i].y, vectors[i].z, 1.0f);
+            Vector4 direction = m * Vector4(vectors[i].x, vectors[i].y, vectors[i].z, 0.0f);
+            Vector3 normal = Vector3(direction.x, direction.y, direction.z).Normalized();
+
+            BOOST_REQUIRE(points[i] == Vector3(point.x, point.y, point.z));
+            BOOST_REQUIRE(directions[i] == Vector3(direction.x, direction.y, direction.z));
+            BOOST_REQUIRE(normals[i] == normal);
+        }
+    }
+
+    Matrix4x4::SetKernel(previousKernel);
+}
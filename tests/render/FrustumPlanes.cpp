@@ -0,0 +1,62 @@
+#include <boost/test/unit_test.hpp>
+
+#include "render/Renderer_Common.h"
+
+#include "math/Sphere.h"
+#include "math/Vector3.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace Sketch3D;
+
+// Frustum of a camera at the origin looking down -z, with a 90 degrees field of view
+static FrustumPlanes_t CreateFrustum()
+{
+    FrustumPlanes_t frustumPlanes;
+    frustumPlanes.nearPlane = Plane(0.0f, 0.0f, -1.0f, -1.0f);
+    frustumPlanes.farPlane = Plane(0.0f, 0.0f, 1.0f, 100.0f);
+    frustumPlanes.leftPlane = Plane(0.707107f, 0.0f, -0.707107f, 0.0f);
+    frustumPlanes.rightPlane = Plane(-0.707107f, 0.0f, -0.707107f, 0.0f);
+    frustumPlanes.bottomPlane = Plane(0.0f, 0.707107f, -0.707107f, 0.0f);
+    frustumPlanes.topPlane = Plane(0.0f, -0.707107f, -0.707107f, 0.0f);
+    return frustumPlanes;
+}
+
+BOOST_AUTO_TEST_CASE(test_frustum_cull_spheres)
+{
+    FrustumPlanes_t frustumPlanes = CreateFrustum();
+
+    // Not a multiple of the SIMD widths to also go through the remainders
+    const size_t count = 1003;
+    BoundingSpheres_t spheres;
+    srand(42);
+    for (size_t i = 0; i < count; i++) {
+        Vector3 center(rand() / (float)RAND_MAX * 200.0f - 100.0f,
+                       rand() / (float)RAND_MAX * 200.0f - 100.0f,
+                       rand() / (float)RAND_MAX * -120.0f + 10.0f);
+        spheres.Add(center, rand() / (float)RAND_MAX * 10.0f);
+    }
+
+    vector<uint32_t> visibility((count + 31) / 32, 0xFFFFFFFF);
+    size_t numVisible = frustumPlanes.CullSpheres(&spheres.centersX[0], &spheres.centersY[0], &spheres.centersZ[0],
+                                                  &spheres.radii[0], spheres.Size(), &visibility[0]);
+
+    size_t expectedNumVisible = 0;
+    for (size_t i = 0; i < count; i++) {
+        Sphere sphere(Vector3(spheres.centersX[i], spheres.centersY[i], spheres.centersZ[i]), spheres.radii[i]);
+        bool visible = !frustumPlanes.IsSphereOutside(sphere);
+        if (visible) {
+            expectedNumVisible += 1;
+        }
+
+        BOOST_REQUIRE(((visibility[i / 32] >> (i % 32)) & 1) == (visible ? 1u : 0u));
+    }
+
+    BOOST_REQUIRE(numVisible == expectedNumVisible);
+    BOOST_REQUIRE(numVisible > 0 && numVisible < count);
+
+    // The bits past the last sphere are cleared
+    BOOST_REQUIRE((visibility.back() >> (count % 32)) == 0);
+}
@@ -0,0 +1,80 @@
+#include <boost/test/unit_test.hpp>
+
+#include "render/RenderQueue.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace Sketch3D;
+
+static bool KeyIndexLess(const RenderQueueSortKey_t& lhs, const RenderQueueSortKey_t& rhs)
+{
+    return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.index < rhs.index);
+}
+
+// Keys with few distinct values so that there are a lot of ties, spread over all the bytes
+static vector<RenderQueueSortKey_t> CreateKeys(size_t count, uint64_t mask)
+{
+    vector<RenderQueueSortKey_t> keys(count);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = ((uint64_t)(rand() % 16) << 60) | ((uint64_t)(rand() % 64) << 32) | (uint64_t)(rand() % 1024);
+        keys[i].key = key & mask;
+        keys[i].index = (uint32_t)i;
+    }
+    return keys;
+}
+
+static void CheckSorted(const vector<RenderQueueSortKey_t>& keys, const vector<RenderQueueSortKey_t>& expected)
+{
+    BOOST_REQUIRE_EQUAL(keys.size(), expected.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        BOOST_CHECK_EQUAL(keys[i].key, expected[i].key);
+        BOOST_CHECK_EQUAL(keys[i].index, expected[i].index);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_render_queue_radix_sort)
+{
+    srand(11);
+    const size_t counts[] = { 0, 1, 5, 63, 64, 1000, 20000 };
+    const uint64_t masks[] = { ~0ULL, 0xFFFFFFFFULL, 0xF000000000000000ULL, 0 };
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        for (size_t j = 0; j < sizeof(masks) / sizeof(masks[0]); j++) {
+            vector<RenderQueueSortKey_t> keys = CreateKeys(counts[i], masks[j]);
+            vector<RenderQueueSortKey_t> expected = keys;
+            stable_sort(expected.begin(), expected.end(), KeyIndexLess);
+
+            vector<RenderQueueSortKey_t> scratch;
+            RadixSortKeys(keys, scratch);
+            CheckSorted(keys, expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_render_queue_insertion_sort)
+{
+    srand(17);
+    vector<RenderQueueSortKey_t> keys = CreateKeys(1000, ~0ULL);
+    vector<RenderQueueSortKey_t> expected = keys;
+    stable_sort(expected.begin(), expected.end(), KeyIndexLess);
+
+    // Last frame's order with a few keys that changed
+    vector<RenderQueueSortKey_t> nearlySorted = expected;
+    for (size_t i = 0; i < 10; i++) {
+        swap(nearlySorted[i * 97].key, nearlySorted[i * 97 + 1].key);
+    }
+    vector<RenderQueueSortKey_t> nearlySortedExpected = nearlySorted;
+    stable_sort(nearlySortedExpected.begin(), nearlySortedExpected.end(), KeyIndexLess);
+
+    BOOST_CHECK(InsertionSortKeys(nearlySorted, nearlySorted.size()));
+    CheckSorted(nearlySorted, nearlySortedExpected);
+
+    // Random keys need way too many moves, the sort must give up
+    BOOST_CHECK(!InsertionSortKeys(keys, keys.size()));
+
+    BOOST_CHECK(InsertionSortKeys(keys, keys.size() * keys.size()));
+    CheckSorted(keys, expected);
+}
@@ -0,0 +1,764 @@
+#include <boost/test/unit_test.hpp>
+
+#include "render/BufferObject.h"
+#include "render/BufferObjectManager.h"
+#include "render/FrameStats.h"
+#include "render/Material.h"
+#include "render/Mesh.h"
+#include "render/Node.h"
+#include "render/Null/RenderSystemNull.h"
+#include "render/PipelineState.h"
+#include "render/Renderer.h"
+#include "render/RenderQueue.h"
+#include "render/RenderStateCache.h"
+#include "render/SceneTree.h"
+#include "render/Shader.h"
+#include "render/Texture2D.h"
+
+#include "math/Vector3.h"
+#include "math/Vector4.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include <vector>
+
+using namespace Sketch3D;
+
+// Count the heap allocations made by the whole test program
+static atomic<size_t> numberOfAllocations(0);
+
+void* operator new(size_t size)
+{
+    numberOfAllocations.fetch_add(1, memory_order_relaxed);
+    void* ptr = malloc((size > 0) ? size : 1);
+    if (ptr == nullptr) {
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+// The renderer is a singleton, so the null render system is only created once for all the tests
+static RenderSystemNull* GetNullRenderSystem()
+{
+    static bool initialized = false;
+    if (!initialized) {
+        RenderParameters_t renderParameters;
+        renderParameters.width = 1024;
+        renderParameters.height = 768;
+        BOOST_REQUIRE(Renderer::GetInstance()->Initialize(RENDER_SYSTEM_NULL, renderParameters));
+        initialized = true;
+    }
+
+    return static_cast<RenderSystemNull*>(Renderer::GetInstance()->GetRenderSystem());
+}
+
+static Mesh* CreateTriangleMesh()
+{
+    SurfaceTriangles_t* surface = new SurfaceTriangles_t;
+    surface->numVertices = 3;
+    surface->vertices = new Vector3[3];
+    surface->vertices[0] = Vector3(-1.0f, -1.0f, 0.0f);
+    surface->vertices[1] = Vector3(1.0f, -1.0f, 0.0f);
+    surface->vertices[2] = Vector3(0.0f, 1.0f, 0.0f);
+    surface->numIndices = 3;
+    surface->indices = new unsigned int[3];
+    surface->indices[0] = 0;
+    surface->indices[1] = 1;
+    surface->indices[2] = 2;
+
+    VertexAttributesMap_t vertexAttributes;
+    vertexAttributes[VERTEX_ATTRIBUTES_POSITION] = 0;
+
+    Mesh* mesh = new Mesh;
+    mesh->AddSurface(surface);
+    mesh->Initialize(vertexAttributes);
+    return mesh;
+}
+
+// Every test starts and ends with the camera looking down the -z axis and the frustum culling enabled
+struct RenderSystemNullFixture {
+    RenderSystemNull*   renderSystem;
+    Renderer*           renderer;
+
+    RenderSystemNullFixture() : renderSystem(GetNullRenderSystem()), renderer(Renderer::GetInstance())
+    {
+        BOOST_REQUIRE(renderSystem != nullptr);
+        renderer->CameraLookAt(Vector3::ZERO, Vector3(0.0f, 0.0f, -1.0f));
+    }
+
+    ~RenderSystemNullFixture()
+    {
+        renderer->EnableFrustumCulling(true);
+        renderer->CameraLookAt(Vector3::ZERO, Vector3(0.0f, 0.0f, -1.0f));
+    }
+};
+
+// Nodes drawing a triangle mesh. The nodes are removed from the scene tree and deleted along with the mesh at the end
+// of the test
+struct SceneFixture : public RenderSystemNullFixture {
+    Mesh*               mesh;
+    vector<Node*>       nodes;
+
+    SceneFixture() : mesh(CreateTriangleMesh())
+    {
+    }
+
+    ~SceneFixture()
+    {
+        renderer->GetSceneTree().SetNumberOfThreads(1);
+        for (size_t i = 0; i < nodes.size(); i++) {
+            renderer->GetSceneTree().RemoveNode(nodes[i]);
+        }
+        for (size_t i = 0; i < nodes.size(); i++) {
+            delete nodes[i];
+        }
+        delete mesh;
+    }
+
+    // Create a node that isn't in the scene tree
+    Node* CreateNode(const Vector3& position, Material* material)
+    {
+        Node* node = new Node(position, Vector3(1.0f, 1.0f, 1.0f), Quaternion::IDENTITY);
+        node->SetMesh(mesh);
+        node->SetMaterial(material);
+        nodes.push_back(node);
+        return node;
+    }
+
+    // Create a node at the top of the scene tree
+    Node* AddNode(const Vector3& position, Material* material)
+    {
+        Node* node = CreateNode(position, material);
+        renderer->GetSceneTree().AddNode(node);
+        return node;
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_counts_draw_calls, SceneFixture)
+{
+    Material material(renderer->CreateShader());
+
+    // Half of the nodes are in front of the camera, the other half behind it
+    const size_t numNodes = 8;
+    for (size_t i = 0; i < numNodes; i++) {
+        float z = (i % 2 == 0) ? -10.0f : 10.0f;
+        AddNode(Vector3((float)i - 4.0f, 0.0f, z), &material);
+    }
+
+    renderer->EnableFrustumCulling(true);
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    BOOST_CHECK_EQUAL(counters.drawCalls, numNodes / 2);
+    BOOST_CHECK_EQUAL(counters.drawnIndices, 3 * numNodes / 2);
+    BOOST_CHECK_EQUAL(counters.shaderBinds, 1);
+    BOOST_CHECK_EQUAL(counters.instancedDrawCalls, 0);
+
+    // Everything is drawn without culling and the shader stays bound from the previous frame
+    renderer->EnableFrustumCulling(false);
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+
+    BOOST_CHECK_EQUAL(counters.drawCalls, numNodes);
+    BOOST_CHECK_EQUAL(counters.drawnIndices, 3 * numNodes);
+    BOOST_CHECK_EQUAL(counters.shaderBinds, 0);
+    BOOST_CHECK(counters.uniformUpdates > 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_queue_add_node_steady_state_allocations, SceneFixture)
+{
+    Material material(renderer->CreateShader());
+
+    const size_t numNodes = 64;
+    for (size_t i = 0; i < numNodes; i++) {
+        CreateNode(Vector3((float)i, 0.0f, -10.0f), &material);
+    }
+
+    // The first frame grows the queue's storage, the following ones must reuse it
+    RenderQueue renderQueue;
+    for (size_t frame = 0; frame < 3; frame++) {
+        size_t allocationsBefore = numberOfAllocations.load();
+        for (size_t i = 0; i < numNodes; i++) {
+            nodes[i]->Translate(Vector3(0.0f, 0.1f, 0.0f));
+            renderQueue.AddNode(nodes[i]);
+        }
+        size_t allocations = numberOfAllocations.load() - allocationsBefore;
+
+        if (frame > 0) {
+            BOOST_CHECK_EQUAL(allocations, 0);
+        }
+
+        renderQueue.Render();
+        BOOST_CHECK(renderQueue.IsEmpty());
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_parallel_scene_traversal, SceneFixture)
+{
+    Material firstMaterial(renderer->CreateShader());
+    Material secondMaterial(renderer->CreateShader());
+
+    // Top level nodes with a few children each, some of them behind the camera
+    const size_t numTopLevelNodes = 37;
+    const size_t numChildren = 3;
+    for (size_t i = 0; i < numTopLevelNodes; i++) {
+        float z = (i % 3 == 0) ? 10.0f : -10.0f;
+        Node* node = AddNode(Vector3((float)i - 18.0f, 0.0f, z), (i % 2 == 0) ? &firstMaterial : &secondMaterial);
+
+        for (size_t j = 0; j < numChildren; j++) {
+            node->AddChildren(CreateNode(Vector3(0.0f, (float)j, 0.0f), (j % 2 == 0) ? &firstMaterial : &secondMaterial));
+        }
+    }
+
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    const bool useFrustumCulling[] = { true, false };
+    for (size_t i = 0; i < 2; i++) {
+        renderer->EnableFrustumCulling(useFrustumCulling[i]);
+
+        renderer->GetSceneTree().SetNumberOfThreads(1);
+        renderSystem->ResetApiCallCounters();
+        renderer->Render();
+        ApiCallCounters_t singleThreadCounters = counters;
+
+        // The merged render queues must give exactly the same frame, every frame
+        renderer->GetSceneTree().SetNumberOfThreads(4);
+        BOOST_CHECK_EQUAL(renderer->GetSceneTree().GetNumberOfThreads(), 4);
+        for (size_t frame = 0; frame < 3; frame++) {
+            renderSystem->ResetApiCallCounters();
+            renderer->Render();
+
+            BOOST_CHECK(counters.drawCalls > 0);
+            BOOST_CHECK_EQUAL(counters.drawCalls, singleThreadCounters.drawCalls);
+            BOOST_CHECK_EQUAL(counters.drawnIndices, singleThreadCounters.drawnIndices);
+            BOOST_CHECK_EQUAL(counters.uniformUpdates, singleThreadCounters.uniformUpdates);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_retained_mode, SceneFixture)
+{
+    Material firstMaterial(renderer->CreateShader());
+    Material secondMaterial(renderer->CreateShader());
+
+    // A parent with a child and some nodes behind the camera
+    const size_t numNodes = 20;
+    for (size_t i = 0; i < numNodes; i++) {
+        float z = (i % 4 == 0) ? 10.0f : -10.0f;
+        Vector3 position((float)i - 10.0f, 0.0f, z);
+        Material* material = (i % 2 == 0) ? &firstMaterial : &secondMaterial;
+        if (i == 1) {
+            nodes[0]->AddChildren(CreateNode(position, material));
+        } else {
+            AddNode(position, material);
+        }
+    }
+
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+    ApiCallCounters_t immediateCounters = counters;
+
+    renderer->CameraLookAt(Vector3::ZERO, Vector3(0.0f, 0.0f, 1.0f));
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+    ApiCallCounters_t turnedCounters = counters;
+    renderer->CameraLookAt(Vector3::ZERO, Vector3(0.0f, 0.0f, -1.0f));
+
+    // The retained queues must give the same frames, without updating the nodes that didn't change
+    renderer->EnableRetainedMode(true);
+    for (size_t frame = 0; frame < 3; frame++) {
+        renderSystem->ResetApiCallCounters();
+        renderer->Render();
+
+        BOOST_CHECK(counters.drawCalls > 0);
+        BOOST_CHECK_EQUAL(counters.drawCalls, immediateCounters.drawCalls);
+        BOOST_CHECK_EQUAL(counters.drawnIndices, immediateCounters.drawnIndices);
+        BOOST_CHECK_EQUAL(counters.uniformUpdates, immediateCounters.uniformUpdates);
+    }
+
+    // Turning the camera around culls the kept nodes again
+    renderer->CameraLookAt(Vector3::ZERO, Vector3(0.0f, 0.0f, 1.0f));
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+    BOOST_CHECK_EQUAL(counters.drawCalls, turnedCounters.drawCalls);
+    BOOST_CHECK_EQUAL(counters.drawnIndices, turnedCounters.drawnIndices);
+
+    renderer->CameraLookAt(Vector3::ZERO, Vector3(0.0f, 0.0f, -1.0f));
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+    BOOST_CHECK_EQUAL(counters.drawCalls, immediateCounters.drawCalls);
+
+    // Moving a visible node behind the camera removes it from the frame
+    nodes[6]->Translate(Vector3(0.0f, 0.0f, 20.0f));
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+    BOOST_CHECK_EQUAL(counters.drawCalls, immediateCounters.drawCalls - 1);
+
+    // Removing a node from the scene tree removes it from the queues
+    renderer->GetSceneTree().RemoveNode(nodes[7]);
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+    BOOST_CHECK_EQUAL(counters.drawCalls, immediateCounters.drawCalls - 2);
+
+    renderer->EnableRetainedMode(false);
+
+    // Only the nodes that changed are updated in a retained queue, the children follow their parent
+    RenderQueue renderQueue;
+    renderQueue.SetRetainedMode(true);
+    BOOST_CHECK(renderQueue.IsRetainedMode());
+
+    for (size_t frame = 0; frame < 4; frame++) {
+        if (frame == 2) {
+            nodes[5]->Translate(Vector3(1.0f, 0.0f, 0.0f));
+        } else if (frame == 3) {
+            nodes[0]->Translate(Vector3(1.0f, 0.0f, 0.0f));
+        }
+
+        for (size_t i = 0; i < 3; i++) {
+            if (!renderQueue.RetainNode(nodes[i * 5])) {
+                renderQueue.UpdateRetainedNode(nodes[i * 5], true);
+            }
+            if (i == 0 && !renderQueue.RetainNode(nodes[1])) {
+                renderQueue.UpdateRetainedNode(nodes[1], true);
+            }
+        }
+
+        renderSystem->ResetApiCallCounters();
+        renderQueue.Render();
+        BOOST_CHECK_EQUAL(counters.drawCalls, 4);
+
+        const size_t expectedUpdatedNodes[] = { 4, 0, 1, 2 };
+        BOOST_CHECK_EQUAL(renderQueue.GetNumberOfUpdatedNodes(), expectedUpdatedNodes[frame]);
+    }
+
+    renderQueue.RemoveRetainedNode(nodes[5]);
+    BOOST_CHECK(!renderQueue.RetainNode(nodes[5]));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_automatic_instancing, SceneFixture)
+{
+    Mesh* otherMesh = CreateTriangleMesh();
+    Shader* instancingShader = renderer->CreateShader();
+    instancingShader->SetSupportsInstancing(true);
+    Material instancingMaterial(instancingShader);
+    Material material(renderer->CreateShader());
+
+    // Most nodes share the same mesh, a few use another one so that the groups are interleaved after sorting
+    const size_t numNodes = 12;
+    for (size_t i = 0; i < numNodes; i++) {
+        Node* node = CreateNode(Vector3((float)i - 6.0f, 0.0f, -10.0f - (float)i), &instancingMaterial);
+        if (i % 4 == 3) {
+            node->SetMesh(otherMesh);
+        }
+    }
+
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    RenderQueue renderQueue;
+
+    // The 9 nodes using the first mesh are drawn at once, the 3 other ones are below the default threshold
+    for (size_t i = 0; i < numNodes; i++) {
+        renderQueue.AddNode(nodes[i]);
+    }
+    renderSystem->ResetApiCallCounters();
+    renderQueue.Render();
+
+    BOOST_CHECK_EQUAL(counters.instancedDrawCalls, 1);
+    BOOST_CHECK_EQUAL(counters.drawnInstances, 9);
+    BOOST_CHECK_EQUAL(counters.drawCalls, 3);
+    BOOST_CHECK_EQUAL(counters.drawnIndices, 3 * numNodes);
+
+    // Lowering the threshold instances the second mesh too
+    renderQueue.SetAutomaticInstancingThreshold(3);
+    for (size_t i = 0; i < numNodes; i++) {
+        renderQueue.AddNode(nodes[i]);
+    }
+    renderSystem->ResetApiCallCounters();
+    renderQueue.Render();
+
+    BOOST_CHECK_EQUAL(counters.instancedDrawCalls, 2);
+    BOOST_CHECK_EQUAL(counters.drawnInstances, numNodes);
+    BOOST_CHECK_EQUAL(counters.drawCalls, 0);
+
+    // Nothing is instanced when disabled or when the shader doesn't support it
+    renderQueue.SetAutomaticInstancingThreshold(0);
+    renderQueue.SetUseIndirectDraws(false);
+    for (size_t i = 0; i < numNodes; i++) {
+        renderQueue.AddNode(nodes[i]);
+    }
+    renderSystem->ResetApiCallCounters();
+    renderQueue.Render();
+
+    BOOST_CHECK_EQUAL(counters.instancedDrawCalls, 0);
+    BOOST_CHECK_EQUAL(counters.drawCalls, numNodes);
+    renderQueue.SetUseIndirectDraws(true);
+
+    renderQueue.SetAutomaticInstancingThreshold(3);
+    for (size_t i = 0; i < numNodes; i++) {
+        nodes[i]->SetMaterial(&material);
+        renderQueue.AddNode(nodes[i]);
+    }
+    renderSystem->ResetApiCallCounters();
+    renderQueue.Render();
+
+    BOOST_CHECK_EQUAL(counters.instancedDrawCalls, 0);
+    BOOST_CHECK_EQUAL(counters.drawCalls, numNodes);
+
+    delete otherMesh;
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_indirect_draws, SceneFixture)
+{
+    // The static meshes with the same vertex layout share their storage
+    const size_t numMeshes = 4;
+    vector<Mesh*> meshes;
+    for (size_t i = 0; i < numMeshes; i++) {
+        meshes.push_back(CreateTriangleMesh());
+    }
+    BOOST_CHECK(meshes[0]->GetBufferObjects()[0]->GetSharedStorageId() != 0);
+    BOOST_CHECK_EQUAL(meshes[0]->GetBufferObjects()[0]->GetSharedStorageId(), meshes[3]->GetBufferObjects()[0]->GetSharedStorageId());
+
+    Shader* instancingShader = renderer->CreateShader();
+    instancingShader->SetSupportsInstancing(true);
+    Material instancingMaterial(instancingShader);
+    Material material(renderer->CreateShader());
+
+    const size_t numNodes = 8;
+    for (size_t i = 0; i < numNodes; i++) {
+        CreateNode(Vector3((float)i - 4.0f, 0.0f, -10.0f - (float)i), &instancingMaterial)->SetMesh(meshes[i % numMeshes]);
+    }
+
+    // Each mesh is used twice, which is below the automatic instancing threshold, so every node is a draw of the same
+    // indirect draw call
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    FrameStats_t& frameStats = renderSystem->GetFrameStats();
+    RenderQueue renderQueue;
+    for (size_t i = 0; i < numNodes; i++) {
+        renderQueue.AddNode(nodes[i]);
+    }
+    renderSystem->ResetApiCallCounters();
+    frameStats.Reset();
+    renderQueue.Render();
+
+    BOOST_CHECK_EQUAL(counters.indirectDrawCalls, 1);
+    BOOST_CHECK_EQUAL(counters.indirectDraws, numNodes);
+    BOOST_CHECK_EQUAL(counters.drawCalls, 0);
+    BOOST_CHECK_EQUAL(counters.drawnIndices, 3 * numNodes);
+    BOOST_CHECK_EQUAL(frameStats.queueItems, numNodes);
+
+    // A node with another material splits the indirect draw call
+    nodes[numNodes - 1]->SetMaterial(&material);
+    for (size_t i = 0; i < numNodes; i++) {
+        renderQueue.AddNode(nodes[i]);
+    }
+    renderSystem->ResetApiCallCounters();
+    renderQueue.Render();
+
+    BOOST_CHECK_EQUAL(counters.indirectDrawCalls, 1);
+    BOOST_CHECK_EQUAL(counters.indirectDraws, numNodes - 1);
+    BOOST_CHECK_EQUAL(counters.drawCalls, 1);
+
+    // Without indirect draws, every node has its own draw call
+    renderQueue.SetUseIndirectDraws(false);
+    for (size_t i = 0; i < numNodes; i++) {
+        renderQueue.AddNode(nodes[i]);
+    }
+    renderSystem->ResetApiCallCounters();
+    renderQueue.Render();
+
+    BOOST_CHECK_EQUAL(counters.indirectDrawCalls, 0);
+    BOOST_CHECK_EQUAL(counters.drawCalls, numNodes);
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        delete meshes[i];
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_frame_stats, SceneFixture)
+{
+    Material material(renderer->CreateShader());
+
+    // Half of the nodes are in front of the camera, the other half behind it
+    const size_t numNodes = 8;
+    for (size_t i = 0; i < numNodes; i++) {
+        float z = (i % 2 == 0) ? -10.0f : 10.0f;
+        AddNode(Vector3((float)i - 4.0f, 0.0f, z), &material);
+    }
+
+    renderer->SetRenderFillMode(RENDER_MODE_WIREFRAME);
+
+    renderer->StartRender();
+    renderer->Render();
+    renderer->EndRender();
+
+    const FrameStats_t& frameStats = renderer->GetFrameStats();
+    BOOST_CHECK_EQUAL(frameStats.nodesVisited, numNodes);
+    BOOST_CHECK_EQUAL(frameStats.nodesCulled, numNodes / 2);
+    BOOST_CHECK_EQUAL(frameStats.queueItems, numNodes / 2);
+    BOOST_CHECK_EQUAL(frameStats.drawCalls, numNodes / 2);
+    BOOST_CHECK_EQUAL(frameStats.instancedDrawCalls, 0);
+    BOOST_CHECK_EQUAL(frameStats.indirectDrawCalls, 0);
+    BOOST_CHECK_EQUAL(frameStats.shaderBinds, 1);
+    BOOST_CHECK_EQUAL(frameStats.stateChanges, 1);
+    // Only the camera uniform block is uploaded, and only if the camera moved since the last frame
+    BOOST_CHECK(frameStats.bufferBytesUploaded <= sizeof(CameraUniforms_t));
+    BOOST_CHECK(frameStats.uniformUploads > 0);
+
+    // The counters only describe the frame being rendered
+    renderer->SetRenderFillMode(RENDER_MODE_FILL);
+    renderer->StartRender();
+    BOOST_CHECK_EQUAL(frameStats.nodesVisited, 0);
+    BOOST_CHECK_EQUAL(frameStats.queueItems, 0);
+    BOOST_CHECK_EQUAL(frameStats.sortTime, 0);
+    BOOST_CHECK_EQUAL(frameStats.drawCalls, 0);
+    BOOST_CHECK_EQUAL(frameStats.uniformUploads, 0);
+
+    renderer->Render();
+    renderer->EndRender();
+    BOOST_CHECK_EQUAL(frameStats.shaderBinds, 0);
+    BOOST_CHECK_EQUAL(frameStats.stateChanges, 1);
+    BOOST_CHECK_EQUAL(frameStats.bufferBytesUploaded, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_uniform_handles, RenderSystemNullFixture)
+{
+    Shader* shader = renderer->CreateShader();
+
+    // The builtin uniforms are resolved when the shader is created
+    for (size_t i = 0; i < NUM_BUILTIN_UNIFORMS; i++) {
+        BuiltinUniform_t builtinUniform = (BuiltinUniform_t)i;
+        BOOST_CHECK(shader->GetBuiltinUniformHandle(builtinUniform) != INVALID_UNIFORM_HANDLE);
+        BOOST_CHECK_EQUAL(shader->GetBuiltinUniformHandle(builtinUniform), shader->GetUniformHandle(GetBuiltinUniformName(builtinUniform)));
+    }
+
+    // A handle stays the same and sets the same uniform as its name
+    UniformHandle_t handle = shader->GetUniformHandle("lightColor");
+    BOOST_CHECK(handle != INVALID_UNIFORM_HANDLE);
+    BOOST_CHECK_EQUAL(handle, shader->GetUniformHandle("lightColor"));
+
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    renderSystem->ResetApiCallCounters();
+    BOOST_CHECK(shader->SetUniformVector4(handle, Vector4(1.0f, 1.0f, 1.0f, 1.0f)));
+    BOOST_CHECK(shader->SetUniformVector4("lightColor", Vector4(1.0f, 1.0f, 1.0f, 1.0f)));
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, 2);
+
+    // Nothing is sent for an invalid handle
+    BOOST_CHECK(!shader->SetUniformFloat(INVALID_UNIFORM_HANDLE, 1.0f));
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_camera_uniform_block, SceneFixture)
+{
+    renderer->CameraLookAt(Vector3(0.0f, 0.0f, 5.0f), Vector3::ZERO);
+
+    Shader* blockShader = renderer->CreateShader();
+    BOOST_REQUIRE(blockShader->SetSource("layout (std140) uniform " CAMERA_UNIFORM_BLOCK_NAME " { mat4 view; };", ""));
+    BOOST_CHECK(blockShader->UsesCameraUniformBlock());
+
+    Shader* plainShader = renderer->CreateShader();
+    BOOST_REQUIRE(plainShader->SetSource("uniform mat4 view;", ""));
+    BOOST_CHECK(!plainShader->UsesCameraUniformBlock());
+
+    Material blockMaterial(blockShader);
+    Material plainMaterial(plainShader);
+    Node* node = AddNode(Vector3(0.0f, 0.0f, -10.0f), &blockMaterial);
+
+    // The camera moved, so its uniform block is uploaded once for the whole frame
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+    BOOST_CHECK_EQUAL(counters.bufferUploads, 1);
+    size_t blockUniformUpdates = counters.uniformUpdates;
+
+    // The camera didn't move, nothing is uploaded
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+    BOOST_CHECK_EQUAL(counters.bufferUploads, 0);
+
+    // The shader without the block is sent the 4 camera matrices when it is bound
+    node->SetMaterial(&plainMaterial);
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+    BOOST_CHECK_EQUAL(counters.bufferUploads, 0);
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, blockUniformUpdates + 4);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_material_parameters, RenderSystemNullFixture)
+{
+    Shader* shader = renderer->CreateShader();
+    Material material(shader);
+    material.SetUniformFloat("shininess", 8.0f);
+    material.SetUniformVector4("diffuseColor", Vector4(1.0f, 0.0f, 0.0f, 1.0f));
+
+    // The parameters are only sent the first time the material is applied
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    renderSystem->ResetApiCallCounters();
+    BOOST_CHECK(material.ApplyMaterial());
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, 2);
+    BOOST_CHECK(material.ApplyMaterial());
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, 2);
+
+    // Only the parameters whose value changed are sent again
+    material.SetUniformFloat("shininess", 8.0f);
+    material.SetUniformVector4("diffuseColor", Vector4(0.0f, 1.0f, 0.0f, 1.0f));
+    BOOST_CHECK(material.ApplyMaterial());
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, 3);
+
+    // Another material applied to the same shader overwrites the values, they all have to be sent again
+    Material otherMaterial(material);
+    otherMaterial.SetUniformFloat("shininess", 32.0f);
+    renderSystem->ResetApiCallCounters();
+    BOOST_CHECK(otherMaterial.ApplyMaterial());
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, 2);
+    BOOST_CHECK(material.ApplyMaterial());
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, 4);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_deferred_shader_links, RenderSystemNullFixture)
+{
+    renderer->EnableDeferredShaderCompilation(true);
+    Shader* shader = renderer->CreateShader();
+    renderer->EnableDeferredShaderCompilation(false);
+    Texture2D* texture = renderer->CreateTexture2D();
+
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    renderSystem->ResetApiCallCounters();
+    BOOST_REQUIRE(shader->SetSource("uniform float shininess; uniform sampler2D diffuseTexture;", ""));
+    BOOST_CHECK(shader->IsLinkPending());
+
+    // Setting up a material doesn't wait for the link of its shader
+    Material material(shader);
+    material.SetUniformFloat("shininess", 8.0f);
+    material.SetUniformTexture("diffuseTexture", texture);
+    BOOST_CHECK(shader->IsLinkPending());
+    BOOST_CHECK_EQUAL(counters.shaderLinks, 0);
+
+    // The link is finished when the material is first applied, which resolves the handles of its parameters
+    BOOST_CHECK(material.ApplyMaterial());
+    BOOST_CHECK(!shader->IsLinkPending());
+    BOOST_CHECK_EQUAL(counters.shaderLinks, 1);
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, 2);
+
+    delete texture;
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_queue_sorts_by_material, SceneFixture)
+{
+    Shader* shader = renderer->CreateShader();
+    Material firstMaterial(shader);
+    firstMaterial.SetUniformFloat("shininess", 8.0f);
+    Material secondMaterial(shader);
+    secondMaterial.SetUniformFloat("shininess", 32.0f);
+
+    // The materials alternate from front to back, the items must still be grouped by material
+    const size_t numNodes = 8;
+    for (size_t i = 0; i < numNodes; i++) {
+        AddNode(Vector3(0.0f, 0.0f, -5.0f - (float)i), (i % 2 == 0) ? &firstMaterial : &secondMaterial);
+    }
+
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+
+    // 4 camera matrices for each of the 2 material switches, 4 model matrices per draw and each material's parameter once
+    BOOST_CHECK_EQUAL(counters.drawCalls, numNodes);
+    BOOST_CHECK_EQUAL(counters.uniformUpdates, 4 * 2 + 4 * numNodes + 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_pipeline_states, SceneFixture)
+{
+    RenderStateCache* renderStateCache = renderer->GetRenderStateCache();
+    Shader* shader = renderer->CreateShader();
+    RenderState_t wireframe;
+    wireframe.renderMode = RENDER_MODE_WIREFRAME;
+
+    // The pipeline states with the same content are shared
+    const PipelineState* pipelineState = renderStateCache->GetPipelineState(shader, wireframe);
+    BOOST_CHECK_EQUAL(renderStateCache->GetPipelineState(shader, wireframe), pipelineState);
+    BOOST_CHECK(renderStateCache->GetPipelineState(shader) != pipelineState);
+    BOOST_CHECK(renderStateCache->GetPipelineState(shader, RenderState_t()) != pipelineState);
+
+    Material firstMaterial(shader);
+    firstMaterial.SetRenderState(wireframe);
+    Material secondMaterial(shader);
+    secondMaterial.SetRenderState(wireframe);
+    BOOST_CHECK_EQUAL(firstMaterial.GetPipelineState(), pipelineState);
+    BOOST_CHECK_EQUAL(secondMaterial.GetPipelineState(), pipelineState);
+
+    const size_t numNodes = 8;
+    for (size_t i = 0; i < numNodes; i++) {
+        AddNode(Vector3(0.0f, 0.0f, -5.0f - (float)i), (i % 2 == 0) ? &firstMaterial : &secondMaterial);
+    }
+
+    renderStateCache->ApplyRenderStateChanges();
+    const ApiCallCounters_t& counters = renderSystem->GetApiCallCounters();
+    renderSystem->ResetApiCallCounters();
+    renderer->Render();
+
+    // Both materials share the pipeline state, so the fill mode is only changed once
+    BOOST_CHECK_EQUAL(counters.drawCalls, numNodes);
+    BOOST_CHECK_EQUAL(counters.stateChanges, 1);
+
+    // Going back to the render state set through the renderer restores the fill mode
+    renderSystem->ResetApiCallCounters();
+    renderStateCache->ApplyRenderStateChanges();
+    BOOST_CHECK_EQUAL(counters.stateChanges, 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_render_system_null_index_formats, RenderSystemNullFixture)
+{
+    BufferObjectManager* bufferObjectManager = renderer->GetBufferObjectManager();
+    VertexAttributesMap_t vertexAttributes;
+    vertexAttributes[VERTEX_ATTRIBUTES_POSITION] = 0;
+
+    const size_t numSmallVertices = 3;
+    const unsigned int numLargeVertices = 70000;
+    vector<float> smallVertexData(numSmallVertices * 3, 0.0f);
+    vector<float> largeVertexData(numLargeVertices * 3, 0.0f);
+    unsigned int smallIndices[] = { 0, 1, 2 };
+    unsigned int largeIndices[] = { 0, 1, numLargeVertices - 1 };
+
+    // The indices are stored on 16 bits when they fit, and the buffer objects aren't limited to 65535 vertices anymore
+    BufferObject* smallBufferObject = bufferObjectManager->CreateBufferObject(vertexAttributes);
+    BOOST_CHECK_EQUAL(smallBufferObject->SetVertexData(smallVertexData, 0), BUFFER_OBJECT_ERROR_NONE);
+    BOOST_CHECK_EQUAL(smallBufferObject->SetIndexData(smallIndices, 3), BUFFER_OBJECT_ERROR_NONE);
+    BOOST_CHECK_EQUAL(smallBufferObject->GetIndexFormat(), INDEX_FORMAT_16);
+
+    BufferObject* largeBufferObject = bufferObjectManager->CreateBufferObject(vertexAttributes);
+    BOOST_CHECK_EQUAL(largeBufferObject->SetVertexData(largeVertexData, 0), BUFFER_OBJECT_ERROR_NONE);
+    BOOST_CHECK_EQUAL(largeBufferObject->SetIndexData(largeIndices, 3), BUFFER_OBJECT_ERROR_NONE);
+    BOOST_CHECK_EQUAL(largeBufferObject->GetIndexFormat(), INDEX_FORMAT_32);
+
+    // Appending indices that don't fit widens the whole index buffer
+    FrameStats_t& frameStats = renderSystem->GetFrameStats();
+    size_t uploadedBytes = frameStats.bufferBytesUploaded;
+    BOOST_CHECK_EQUAL(smallBufferObject->AppendVertexData(largeVertexData, 0), BUFFER_OBJECT_ERROR_NONE);
+    BOOST_CHECK_EQUAL(smallBufferObject->AppendIndexData(largeIndices, 3), BUFFER_OBJECT_ERROR_NONE);
+    BOOST_CHECK_EQUAL(smallBufferObject->GetIndexFormat(), INDEX_FORMAT_32);
+    BOOST_CHECK_EQUAL(frameStats.bufferBytesUploaded - uploadedBytes, largeVertexData.size() * sizeof(float) + 6 * sizeof(unsigned int));
+
+    // The shared storages only hold indices of a single format, so they are separated by the number of vertices
+    BufferObject* smallSharedBufferObject = bufferObjectManager->CreateBufferObject(vertexAttributes, BUFFER_USAGE_STATIC_SHARED);
+    smallSharedBufferObject->SetVertexData(smallVertexData, 0);
+    smallSharedBufferObject->SetIndexData(smallIndices, 3);
+    BufferObject* largeSharedBufferObject = bufferObjectManager->CreateBufferObject(vertexAttributes, BUFFER_USAGE_STATIC_SHARED);
+    largeSharedBufferObject->SetVertexData(largeVertexData, 0);
+    largeSharedBufferObject->SetIndexData(largeIndices, 3);
+
+    BOOST_CHECK(smallSharedBufferObject->GetSharedStorageId() != 0);
+    BOOST_CHECK(largeSharedBufferObject->GetSharedStorageId() != 0);
+    BOOST_CHECK(smallSharedBufferObject->GetSharedStorageId() != largeSharedBufferObject->GetSharedStorageId());
+    BOOST_CHECK_EQUAL(smallSharedBufferObject->GetIndexFormat(), INDEX_FORMAT_16);
+    BOOST_CHECK_EQUAL(largeSharedBufferObject->GetIndexFormat(), INDEX_FORMAT_32);
+
+    bufferObjectManager->DeleteBufferObject(smallBufferObject);
+    bufferObjectManager->DeleteBufferObject(largeBufferObject);
+    bufferObjectManager->DeleteBufferObject(smallSharedBufferObject);
+    bufferObjectManager->DeleteBufferObject(largeSharedBufferObject);
+}
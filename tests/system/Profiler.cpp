@@ -0,0 +1,101 @@
+#include <boost/test/unit_test.hpp>
+
+#include "system/Profiler.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+
+using namespace Sketch3D;
+
+static string ReadFile(const string& filename)
+{
+    ifstream file(filename);
+    stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// Path of a file in the temporary directory, so that the tests don't leave files in the working directory
+static string GetTemporaryPath(const string& filename)
+{
+    const char* directory = getenv("TMPDIR");
+    if (directory == nullptr) {
+        directory = getenv("TEMP");
+    }
+#ifdef P_tmpdir
+    if (directory == nullptr) {
+        directory = P_tmpdir;
+    }
+#endif
+
+    return (directory != nullptr) ? string(directory) + "/" + filename : filename;
+}
+
+static size_t CountOccurrences(const string& str, const string& pattern)
+{
+    size_t count = 0;
+    for (size_t pos = str.find(pattern); pos != string::npos; pos = str.find(pattern, pos + pattern.size())) {
+        count += 1;
+    }
+    return count;
+}
+
+BOOST_AUTO_TEST_CASE(test_profiler_disabled)
+{
+    Profiler* profiler = Profiler::GetInstance();
+    profiler->SetEnabled(false);
+    profiler->Clear();
+
+    {
+        ProfilerZone zone("Disabled");
+    }
+
+    BOOST_CHECK_EQUAL(profiler->GetNumberOfEvents(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_profiler_chrome_trace)
+{
+    Profiler* profiler = Profiler::GetInstance();
+    profiler->SetEnabled(true);
+    profiler->Clear();
+
+    {
+        ProfilerZone outer("Outer");
+        {
+            ProfilerZone inner("Inner \"quoted\"");
+        }
+    }
+
+    thread worker([] {
+        ProfilerZone zone("Worker");
+    });
+    worker.join();
+
+    profiler->SetEnabled(false);
+
+    {
+        ProfilerZone zone("Disabled");
+    }
+
+    BOOST_CHECK_EQUAL(profiler->GetNumberOfEvents(), 3);
+    string traceFilename = GetTemporaryPath("ProfilerTest.json");
+    BOOST_REQUIRE(profiler->ExportChromeTrace(traceFilename));
+
+    string trace = ReadFile(traceFilename);
+    remove(traceFilename.c_str());
+
+    BOOST_CHECK_EQUAL(trace.find("{\"traceEvents\":["), 0);
+    BOOST_CHECK_EQUAL(CountOccurrences(trace, "\"ph\":\"X\""), 3);
+    BOOST_CHECK_EQUAL(CountOccurrences(trace, "\"ph\":\"M\""), 2);
+    BOOST_CHECK(trace.find("\"name\":\"Outer\"") != string::npos);
+    BOOST_CHECK(trace.find("\"name\":\"Inner \\\"quoted\\\"\"") != string::npos);
+    BOOST_CHECK(trace.find("\"name\":\"Worker\"") != string::npos);
+    BOOST_CHECK(trace.find("Disabled") == string::npos);
+
+    profiler->Clear();
+    BOOST_CHECK_EQUAL(profiler->GetNumberOfEvents(), 0);
+}
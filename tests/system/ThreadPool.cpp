@@ -0,0 +1,38 @@
+#include <boost/test/unit_test.hpp>
+
+#include "system/ThreadPool.h"
+
+#include <atomic>
+#include <vector>
+
+using namespace Sketch3D;
+
+BOOST_AUTO_TEST_CASE(test_thread_pool_runs_every_task_once)
+{
+    const size_t numberOfThreads[] = { 1, 2, 4 };
+    for (size_t i = 0; i < sizeof(numberOfThreads) / sizeof(numberOfThreads[0]); i++) {
+        ThreadPool threadPool(numberOfThreads[i]);
+        BOOST_CHECK_EQUAL(threadPool.GetNumberOfThreads(), numberOfThreads[i]);
+
+        // Run several times to make sure that the worker threads pick up new tasks
+        for (size_t run = 0; run < 10; run++) {
+            const size_t numberOfTasks = 1000;
+            vector<atomic<int>> executions(numberOfTasks);
+            for (size_t j = 0; j < numberOfTasks; j++) {
+                executions[j].store(0);
+            }
+
+            threadPool.Run(numberOfTasks, [&](size_t task) {
+                executions[task].fetch_add(1);
+            });
+
+            for (size_t j = 0; j < numberOfTasks; j++) {
+                BOOST_CHECK_EQUAL(executions[j].load(), 1);
+            }
+        }
+
+        threadPool.Run(0, [](size_t) {
+            BOOST_ERROR("No task should be executed");
+        });
+    }
+}